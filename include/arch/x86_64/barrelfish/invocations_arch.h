@@ -111,6 +111,63 @@ static inline errval_t invoke_vnode_map(struct capref ptable, capaddr_t slot,
                         mcnlevel, mapping_slot).error;
 }
 
+/**
+ * \brief Map a frame into several leaf page tables with one invocation
+ *
+ * \param root     Root page table of the vspace
+ * \param entries  One entry per leaf table, see struct vnode_batch_entry
+ * \param count    Number of entries, at most VNODE_BATCH_MAX
+ * \param src_root Root CNode of the frame cap
+ * \param src      Address of the frame cap
+ * \param srclevel Level of the frame cap
+ * \param flags    Mapping flags, the same for all entries
+ * \param done     Filled in with the number of entries mapped
+ */
+static inline errval_t invoke_vnode_map_batch(struct capref root,
+                                              struct vnode_batch_entry *entries,
+                                              size_t count, capaddr_t src_root,
+                                              capaddr_t src,
+                                              enum cnode_type srclevel,
+                                              size_t flags, size_t *done)
+{
+    struct sysret sr = cap_invoke6(root, VNodeCmd_MapBatch, (uintptr_t)entries,
+                                   count, ((uint64_t)src_root << 32) | (uint64_t)src,
+                                   srclevel, flags);
+    *done = sr.value;
+    return sr.error;
+}
+
+/**
+ * \brief Unmap several mappings and delete their mapping caps
+ *
+ * \param done     Filled in with the number of mappings removed
+ */
+static inline errval_t invoke_vnode_unmap_batch(struct capref root,
+                                                struct vnode_batch_entry *entries,
+                                                size_t count, size_t *done)
+{
+    struct sysret sr = cap_invoke3(root, VNodeCmd_UnmapBatch,
+                                   (uintptr_t)entries, count);
+    *done = sr.value;
+    return sr.error;
+}
+
+/**
+ * \brief Modify the flags of (parts of) several mappings
+ *
+ * \param done     Filled in with the number of entries modified
+ */
+static inline errval_t invoke_vnode_modify_flags_batch(struct capref root,
+                                                       struct vnode_batch_entry *entries,
+                                                       size_t count, size_t flags,
+                                                       size_t *done)
+{
+    struct sysret sr = cap_invoke4(root, VNodeCmd_ModifyFlagsBatch,
+                                   (uintptr_t)entries, count, flags);
+    *done = sr.value;
+    return sr.error;
+}
+
 static inline errval_t invoke_iocap_in(struct capref iocap, enum io_cmd cmd,
                                        uint16_t port, uint32_t *data)
 {
@@ -49,6 +49,11 @@ errval_t cap_retype(struct capref dest_start, struct capref src, gensize_t offse
                     enum objtype new_type, gensize_t objsize, size_t count);
 errval_t cap_create(struct capref dest, enum objtype type, size_t bytes);
 errval_t cap_delete(struct capref cap);
+errval_t cap_copy_range(struct capref dest, struct capref src, size_t count,
+                        size_t *done);
+errval_t cap_mint_range(struct capref dest, struct capref src, size_t count,
+                        uint64_t param1, uint64_t param2, size_t *done);
+errval_t cap_delete_range(struct capref start, size_t count);
 errval_t cap_revoke(struct capref cap);
 struct cspace_allocator;
 errval_t cap_destroy(struct capref cap);
@@ -21,6 +21,7 @@
 #include <barrelfish/ram_alloc.h>
 #include <barrelfish/slot_alloc.h>
 #include <barrelfish/thread_sync.h>
+#include <barrelfish/heap.h>
 #include <barrelfish_kpi/paging_arch.h>
 #include <barrelfish_kpi/capabilities.h>
 #include <barrelfish_kpi/init.h> // for CNODE_SLOTS_*
@@ -41,6 +42,10 @@ struct morecore_state {
     struct thread_mutex mutex;
     Header header_base;
     Header *header_freep;
+#ifdef CONFIG_MALLOC_SIZECLASS
+    struct heap_sc sc_heap;     ///< Size-class heap backing malloc
+    bool sc_heap_ready;         ///< Has sc_heap been initialised?
+#endif
     struct vspace_mmu_aware mmu_state;
     struct v2pmap v2p_mappings[MAX_V2P_MAPPINGS];
     int v2p_entries;
@@ -55,6 +60,13 @@ struct ram_alloc_state {
     uint64_t default_maxlimit;
     int base_capnum;
     int earlycn_capnum;
+
+    /* base-page RAM caps prefetched from the memory server in one batch */
+    struct capref prefetch_cnode; ///< L1 slot holding the current batch CNode
+    cslot_t prefetch_next;        ///< Next unused slot in the batch CNode
+    cslot_t prefetch_count;       ///< Number of RAM caps in the batch CNode
+    bool prefetch_enabled;
+    bool prefetch_busy;           ///< Guards against recursion in setup
 };
 
 struct skb_state {
@@ -24,8 +24,9 @@ __BEGIN_DECLS
 
 struct deferred_event {
     struct waitset_chanstate waitset_state; ///< Waitset state
-    struct deferred_event *next, *prev; ///< Next/prev in dispatcher queue
+    struct deferred_event *next, *prev; ///< Next/prev in timer wheel slot
     systime_t time;                     ///< System time for event
+    uint16_t wheel_slot;                ///< Timer wheel level and slot
 };
 
 systime_t get_system_time(void);
@@ -49,6 +50,7 @@ errval_t periodic_event_create(struct periodic_event *event, struct waitset *ws,
 errval_t periodic_event_cancel(struct periodic_event *event);
 
 // XXX: internal to libbarrelfish; should be in another header file
+void deferred_events_init_disabled(dispatcher_handle_t dh);
 void trigger_deferred_events_disabled(dispatcher_handle_t dh, systime_t now);
 
 __END_DECLS
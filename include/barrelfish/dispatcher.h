@@ -32,6 +32,24 @@ struct notificator;
 /// Maximum number of buffered capability receive slots
 #define MAX_RECV_SLOTS   4
 
+/// Number of levels of the deferred event timer wheel
+#define DEFERRED_WHEEL_LEVELS       5
+/// log2 of the number of slots per level of the timer wheel
+#define DEFERRED_WHEEL_SLOT_BITS    6
+#define DEFERRED_WHEEL_SLOTS        (1 << DEFERRED_WHEEL_SLOT_BITS)
+
+/// Hierarchical timer wheel holding the deferred events (see deferred.c)
+struct deferred_wheel {
+    /// Per level and slot, list of queued events
+    struct deferred_event *slots[DEFERRED_WHEEL_LEVELS][DEFERRED_WHEEL_SLOTS];
+    /// Per level, bitmap of non-empty slots
+    uint64_t occupied[DEFERRED_WHEEL_LEVELS];
+    uint64_t now;           ///< First tick not processed yet
+    uint64_t next;          ///< Next tick to process, or UINT64_MAX if empty
+    size_t count;           ///< Number of queued events
+    uint8_t tick_shift;     ///< log2 of the system time ticks per wheel tick
+};
+
 // Architecture generic user only dispatcher struct
 struct dispatcher_generic {
     /// stack for traps and disabled pagefaults
@@ -61,7 +79,7 @@ struct dispatcher_generic {
 #endif // CONFIG_INTERCONNECT_DRIVER_LMP
 
     /// Queue of deferred events (i.e. timers)
-    struct deferred_event *deferred_events;
+    struct deferred_wheel deferred_events;
 
     /// The core the dispatcher is running on
     coreid_t core_id;
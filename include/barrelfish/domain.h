@@ -110,6 +110,11 @@ errval_t domain_wakeup_on_disabled(dispatcher_handle_t disp,
                                    struct thread *thread,
                                    dispatcher_handle_t mydisp);
 errval_t domain_thread_move_to(struct thread *thread, coreid_t core_id);
+errval_t domain_get_load(coreid_t core_id, size_t *runnable);
+errval_t domain_migrate_threads(coreid_t from, coreid_t to, size_t count);
+errval_t domain_balancer_start(coreid_t *cores, size_t ncores,
+                               delayus_t interval);
+void domain_balancer_stop(void);
 errval_t domain_cap_hash(struct capref domain_cap, uint64_t *ret_hash);
 
 __END_DECLS
@@ -15,6 +15,9 @@
 #ifndef LIBBARRELFISH_HEAP_H
 #define LIBBARRELFISH_HEAP_H
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <sys/cdefs.h>
 
 __BEGIN_DECLS
@@ -43,6 +46,98 @@ void *heap_alloc(struct heap *heap, size_t nbytes);
 void heap_free(struct heap *heap, void *ap);
 union heap_header *heap_default_morecore(struct heap *h, unsigned nu);
 
+/*
+ * Size-class segregated heap
+ *
+ * Small objects are served from spans (HEAP_SC_SPAN_SIZE aligned regions)
+ * holding objects of a single size class, larger objects get a run of
+ * spans of their own. Locking is left to the caller, except for the thread
+ * cache helpers which operate on caller-private state. Every span records the
+ * heap it belongs to. Objects freed to another heap (e.g. by a thread that
+ * migrated to another dispatcher) are handed back to the owning heap through
+ * a lock-free list, which it drains when it next needs memory.
+ */
+
+#define HEAP_SC_SPAN_BITS   16
+#define HEAP_SC_SPAN_SIZE   ((size_t)1 << HEAP_SC_SPAN_BITS)
+#define HEAP_SC_CHUNK_SIZE  (32 * HEAP_SC_SPAN_SIZE) ///< Minimum morecore request
+#define HEAP_SC_NCLASSES    28
+#define HEAP_SC_MAX_SMALL   4096    ///< Largest size served from a size class
+#define HEAP_SC_TCACHE_MAX  32      ///< Max. objects per class in a thread cache
+
+struct heap_sc_span;
+
+typedef void *(*heap_sc_morecore_func_t)(size_t bytes, size_t *retbytes);
+
+/// Per-thread cache of free small objects
+struct heap_sc_tcache {
+    void *list[HEAP_SC_NCLASSES];       ///< Free objects, linked through first word
+    uint16_t count[HEAP_SC_NCLASSES];   ///< Length of lists
+};
+
+struct heap_sc_stats {
+    size_t small_allocs;    ///< Number of small object allocations
+    size_t large_allocs;    ///< Number of large object allocations
+    size_t live_bytes;      ///< Bytes in live objects (rounded up to class size
+                            ///< or, for large objects, to whole spans)
+    size_t span_bytes;      ///< Bytes in spans and large runs holding objects,
+                            ///< including free objects in those spans
+    size_t core_bytes;      ///< Bytes obtained from morecore
+    size_t remote_frees;    ///< Objects handed back to their owning heap
+};
+
+struct heap_sc {
+    struct heap_sc_span *partial[HEAP_SC_NCLASSES]; ///< Spans with free objects
+    struct heap_sc_span *free_runs; ///< Runs of unused spans
+    char *chunk_base;               ///< Start of current morecore chunk
+    char *chunk_cur, *chunk_end;    ///< Unused part of current morecore chunk
+    heap_sc_morecore_func_t morecore_func; ///< Function to get more memory
+    struct heap_sc_stats stats;     ///< Usage counters
+    void *volatile remote_free;     ///< Objects freed through other heaps
+};
+
+void heap_sc_init(struct heap_sc *heap, heap_sc_morecore_func_t morecore_func);
+void *heap_sc_alloc(struct heap_sc *heap, size_t nbytes);
+void heap_sc_free(struct heap_sc *heap, void *ap);
+int heap_sc_size_class(size_t nbytes);
+int heap_sc_ptr_class(void *ap);
+size_t heap_sc_usable_size(void *ap);
+
+/// Get a free object of the given class from a thread cache, or NULL
+static inline void *heap_sc_tcache_pop(struct heap_sc_tcache *tc, int sc)
+{
+    void *p = tc->list[sc];
+    if (p != NULL) {
+        tc->list[sc] = *(void **)p;
+        tc->count[sc]--;
+    }
+    return p;
+}
+
+/// Put a free object into a thread cache. Returns false if the cache is full.
+static inline bool heap_sc_tcache_push(struct heap_sc_tcache *tc, int sc,
+                                       void *ap)
+{
+    if (tc->count[sc] >= HEAP_SC_TCACHE_MAX) {
+        return false;
+    }
+    *(void **)ap = tc->list[sc];
+    tc->list[sc] = ap;
+    tc->count[sc]++;
+    return true;
+}
+
+void heap_sc_tcache_fill(struct heap_sc *heap, struct heap_sc_tcache *tc,
+                         int sc, unsigned count);
+void heap_sc_tcache_drain(struct heap_sc *heap, struct heap_sc_tcache *tc,
+                          int sc, unsigned count);
+void heap_sc_tcache_flush(struct heap_sc *heap, struct heap_sc_tcache *tc);
+
+#ifdef CONFIG_MALLOC_SIZECLASS
+// counters of the size-class heap backing malloc() on this dispatcher
+void __malloc_get_stats(struct heap_sc_stats *stats);
+#endif
+
 __END_DECLS
 
 #endif // LIBBARRELFISH_HEAP_H
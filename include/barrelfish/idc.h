@@ -44,6 +44,14 @@ typedef enum idc_bind_flags {
 
     // request a multi-hop channel
     IDC_BIND_FLAG_MULTIHOP = 1 << 2,
+
+    // pass large string/buffer arguments through a shared payload pool
+    // instead of fragmenting them (UMP only, ignored by other transports)
+    IDC_BIND_FLAG_UMP_POOL = 1 << 3,
+
+    // poll for a while after each message before waiting for a notification,
+    // with the polling time learned from the message rate (ump_ipi only)
+    IDC_BIND_FLAG_UMP_ADAPTIVE = 1 << 4,
 } idc_bind_flags_t;
 
 #define IDC_BIND_FLAGS_DEFAULT 0
@@ -147,6 +147,91 @@ static inline errval_t invoke_cnode_delete(struct capref root, capaddr_t cap,
     return cap_invoke3(root, CNodeCmd_Delete, cap, level).error;
 }
 
+/**
+ * \brief Copy or mint a range of capabilities.
+ *
+ * Copies the caps in slots 'from_slot' to 'from_slot + count - 1' of the
+ * CNode addressed by 'from' into the same number of slots starting at
+ * 'to_slot' in the CNode addressed by 'to'. Empty source slots are skipped.
+ *
+ * See also cap_copy_range() and cap_mint_range(), which wrap this.
+ *
+ * \param root          Capability of the source cspace root CNode to invoke
+ * \param to_cspace     Destination cspace cap address relative to source cspace
+ * \param to            Destination CNode address relative to destination cspace
+ * \param to_slot       First slot in destination CNode
+ * \param from_cspace   Source cspace cap address relative to source cspace
+ * \param from          Source CNode address relative to source cspace
+ * \param from_slot     First slot in source CNode
+ * \param tolevel       Level/depth of 'to'.
+ * \param fromlevel     Level/depth of 'from'.
+ * \param count         Number of slots, at most CNODE_RANGE_MAX_COUNT
+ * \param mint          Mint instead of copy
+ * \param param1        1st cap-dependent parameter when minting.
+ * \param param2        2nd cap-dependent parameter when minting.
+ * \param done          Returns the number of slots processed
+ *
+ * \return Error code
+ */
+static inline errval_t invoke_cnode_copy_range(struct capref root,
+                                               capaddr_t to_cspace,
+                                               capaddr_t to, capaddr_t to_slot,
+                                               capaddr_t from_cspace,
+                                               capaddr_t from,
+                                               capaddr_t from_slot,
+                                               enum cnode_type tolevel,
+                                               enum cnode_type fromlevel,
+                                               size_t count, bool mint,
+                                               uint64_t param1, uint64_t param2,
+                                               size_t *done)
+{
+    assert(count <= CNODE_RANGE_MAX_COUNT);
+    uintptr_t word = count << 16 | (uintptr_t)fromlevel << 8 | tolevel;
+    struct sysret ret;
+    if (mint) {
+        ret = cap_invoke10(root, CNodeCmd_MintRange, to_cspace, to, to_slot,
+                           from_cspace, from, from_slot, word, param1, param2);
+    } else {
+        ret = cap_invoke8(root, CNodeCmd_CopyRange, to_cspace, to, to_slot,
+                          from_cspace, from, from_slot, word);
+    }
+    if (done) {
+        *done = ret.value;
+    }
+    return ret.error;
+}
+
+/**
+ * \brief Delete a range of capabilities.
+ *
+ * Deletes the caps in slots 'slot' to 'slot + count - 1' of the CNode
+ * addressed by 'cnode', skipping empty slots. Stops at the first cap that
+ * cannot be deleted locally.
+ *
+ * \param root  Capability of the cspace root CNode to invoke
+ * \param cnode Address of the CNode
+ * \param level Level/depth of 'cnode'.
+ * \param slot  First slot to delete
+ * \param count Number of slots, at most CNODE_RANGE_MAX_COUNT
+ * \param done  Returns the number of slots processed
+ *
+ * \return Error code
+ */
+static inline errval_t invoke_cnode_delete_range(struct capref root,
+                                                 capaddr_t cnode,
+                                                 enum cnode_type level,
+                                                 capaddr_t slot, size_t count,
+                                                 size_t *done)
+{
+    assert(count <= CNODE_RANGE_MAX_COUNT);
+    struct sysret ret = cap_invoke4(root, CNodeCmd_DeleteRange, cnode, slot,
+                                    count << 16 | level);
+    if (done) {
+        *done = ret.value;
+    }
+    return ret.error;
+}
+
 static inline errval_t invoke_cnode_revoke(struct capref root, capaddr_t cap,
                                            enum cnode_type level)
 {
@@ -36,6 +36,9 @@ enum memobj_type {
 typedef uint32_t memobj_flags_t;
 typedef uint32_t vs_prot_flags_t;
 
+/// Anonymous memobj: map suitably aligned frames with large pages
+#define MEMOBJ_FLAGS_PROMOTE    0x1
+
 struct memobj;
 struct vregion;
 struct memobj_funcs {
@@ -67,7 +70,7 @@ struct vregion_list {
 /// Public interface for memobj
 struct memobj {
     size_t size;              ///< Size of the object
-    memobj_flags_t flags;     ///< Flags for the object. NYI.
+    memobj_flags_t flags;     ///< Flags for the object (MEMOBJ_FLAGS_*)
     enum memobj_type type;    ///< Type of the memory object
     struct memobj_funcs f;    ///< Function pointers
 };
@@ -104,9 +107,18 @@ struct memobj_frame_list {
     size_t size;                    ///< Size of the frame
     genpaddr_t pa;                  ///< XXX: physical address of frame
     genpaddr_t foffset;             ///< Offset into frame
+    bool large;                     ///< Frame is promoted to large pages
     struct memobj_frame_list *next;
 };
 
+/// Large page promotion counters of an anonymous memobj
+struct memobj_anon_promote_stats {
+    size_t promoted;        ///< Large pages mapped for promoted frames
+    size_t base;            ///< Frames that had to be mapped with base pages
+    size_t demoted;         ///< Promoted frames remapped with base pages
+    size_t alloc_fallbacks; ///< Large frame allocations retried smaller
+};
+
 struct memobj_anon {
     struct memobj m;
     struct vregion_list *vregion_list;    ///< List of vregions mapped into the obj
@@ -115,6 +127,7 @@ struct memobj_anon {
     struct slab_allocator frame_slab;         ///< Slab to back the frame list
     bool frame_slab_refilling;      ///< True, iff we're currently refilling `frame_slab`
     bool vregion_slab_refilling;    ///< True, iff we're currently refilling `vregion_slab`
+    struct memobj_anon_promote_stats promote_stats; ///< Large page promotion
 };
 
 /**
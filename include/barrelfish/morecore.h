@@ -24,6 +24,9 @@ errval_t morecore_init(size_t alignment);
 void morecore_use_optimal(void);
 errval_t morecore_reinit(void);
 
+struct memobj_anon_promote_stats;
+void morecore_get_promote_stats(struct memobj_anon_promote_stats *stats);
+
 __END_DECLS
 
 #endif
@@ -126,7 +126,7 @@ bool pmap_inside_region(struct vnode *root, uint16_t entry, uint16_t npages);
 /**
  * \brief Pmap traversal: remove vnode `item` from vnode `root`
  */
-void pmap_remove_vnode(struct vnode *root, struct vnode *item);
+void pmap_remove_vnode(struct pmap *pmap, struct vnode *root, struct vnode *item);
 /**
  * \brief Pmap traversal: init
  */
@@ -138,7 +138,8 @@ void pmap_vnode_init(struct pmap *p, struct vnode *v);
 /**
  * \brief insert `newvnode` as child of `root` at entry `newvnode->entry`.
  */
-void pmap_vnode_insert_child(struct vnode *root, struct vnode *newvnode);
+void pmap_vnode_insert_child(struct pmap *pmap, struct vnode *root,
+                             struct vnode *newvnode);
 /**
  * \brief free per-vnode shadow pt fields
  */
@@ -147,6 +148,10 @@ void pmap_vnode_free(struct pmap *p, struct vnode *v);
  * \brief Refill shadow pt implementation slab allocators if necessary
  */
 errval_t pmap_refill_slabs(struct pmap *pmap, size_t max_slabs);
+/**
+ * \brief Account the memory of the shadow pt implementation in `buf`
+ */
+void pmap_ds_measure_res(struct pmap *pmap, struct pmap_res_info *buf);
 
 __END_DECLS
 
@@ -63,6 +63,40 @@ struct pmap_vnode_mgmt {
     uint8_t ptslab_buffer[INIT_PTSLAB_BUFFER_SIZE];
 };
 
+#elif defined(PMAP_RADIX)
+
+/// Children per radix tree node, a node fills a 64-byte cache line
+#define PMAP_RADIX_BITS   3
+#define PMAP_RADIX_FANOUT (1 << PMAP_RADIX_BITS)
+
+/**
+ * Inner node of the radix tree holding the children of a vnode. A slot
+ * either points to the next level, or holds a child vnode tagged with bit 0
+ * if it is the only child in the slot's subtree.
+ */
+struct pmap_radix_node {
+    uintptr_t slot[PMAP_RADIX_FANOUT];
+};
+
+#define RADIXSLAB_SLABSIZE (sizeof(struct pmap_radix_node))
+#define INIT_RADIXSLAB_BUFFER_SIZE SLAB_STATIC_SIZE(INIT_SLAB_COUNT, RADIXSLAB_SLABSIZE)
+
+// the children field is the root slot of the tree
+typedef struct pmap_radix_node pmap_ds_child_t;
+
+struct pmap_ds_meta {
+    // no metadata for datastructure
+};
+
+struct pmap_vnode_mgmt {
+    struct slab_allocator slab;     ///< Slab allocator for the shadow page table entries
+    struct slab_allocator ptslab;   ///< Slab allocator for the radix tree nodes
+    struct vregion vregion;         ///< Vregion used to reserve virtual address for metadata
+    genvaddr_t vregion_offset;      ///< Offset into amount of reserved virtual address used
+    uint8_t slab_buffer[INIT_SLAB_BUFFER_SIZE];
+    uint8_t ptslab_buffer[INIT_RADIXSLAB_BUFFER_SIZE];
+};
+
 #else
 #error Unknown Pmap datastructure.
 #endif
@@ -17,6 +17,7 @@
 #define BARRELFISH_RAM_ALLOC_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <errors/errno.h>
 #include <sys/cdefs.h>
 
@@ -27,11 +28,17 @@ struct capref;
 typedef errval_t (* ram_alloc_func_t)(struct capref *ret, uint8_t size_bits,
                                       uint64_t minbase, uint64_t maxlimit);
 
+/// Number of base-page RAM caps that ram_alloc() fetches in one batch
+#define RAM_ALLOC_PREFETCH      32
+
 errval_t ram_alloc_fixed(struct capref *ret, uint8_t size_bits,
                          uint64_t minbase, uint64_t maxlimit);
 errval_t ram_alloc(struct capref *retcap, uint8_t size_bits);
 errval_t ram_available(genpaddr_t *available, genpaddr_t *total);
+errval_t ram_alloc_batch(struct capref *retcn, uint8_t size_bits,
+                         uint32_t count, uint32_t *retcount);
 errval_t ram_alloc_set(ram_alloc_func_t local_allocator);
+void ram_alloc_set_prefetch(bool enable);
 void ram_set_affinity(uint64_t minbase, uint64_t maxlimit);
 void ram_get_affinity(uint64_t *minbase, uint64_t *maxlimit);
 void ram_alloc_init(void);
@@ -26,7 +26,7 @@ struct block_head;
 typedef errval_t (*slab_refill_func_t)(struct slab_allocator *slabs);
 
 struct slab_head {
-    struct slab_head *next; ///< Next slab in the allocator
+    struct slab_head *next, *prev; ///< Neighbours in the allocator's slab list
     uint32_t total, free;   ///< Count of total and free blocks in this slab
     struct block_head *blocks; ///< Pointer to free block list
 };
@@ -34,7 +34,10 @@ struct slab_head {
 struct slot_allocator;
 
 struct slab_allocator {
-    struct slab_head *slabs;    ///< Pointer to list of slabs
+    struct slab_head *partial;  ///< Slabs with some, but not all, blocks free
+    struct slab_head *full;     ///< Slabs with no free blocks
+    struct slab_head *empty;    ///< Slabs with all blocks free
+    size_t total, free;         ///< Count of total and free blocks in all slabs
     size_t blocksize;           ///< Size of blocks managed by this allocator
     slab_refill_func_t refill_func;  ///< Refill function
 };
@@ -43,15 +46,22 @@ void slab_init(struct slab_allocator *slabs, size_t blocksize,
                slab_refill_func_t refill_func);
 void slab_grow(struct slab_allocator *slabs, void *buf, size_t buflen);
 void *slab_alloc(struct slab_allocator *slabs);
+void *slab_alloc_nozero(struct slab_allocator *slabs);
 void slab_free(struct slab_allocator *slabs, void *block);
 size_t slab_freecount(struct slab_allocator *slabs);
+size_t slab_totalcount(struct slab_allocator *slabs);
 errval_t slab_default_refill(struct slab_allocator *slabs);
 
-// size of block header
+// size of block header (free list link, overlaps the block while allocated)
 #define SLAB_BLOCK_HDRSIZE (sizeof(void *))
+// size of per-block back-pointer to the owning slab, preceding each block
+#define SLAB_BLOCK_TAGSIZE (sizeof(void *))
 // should be able to fit the header into the block
-#define SLAB_REAL_BLOCKSIZE(blocksize) \
+#define SLAB_USER_BLOCKSIZE(blocksize) \
     (((blocksize) > SLAB_BLOCK_HDRSIZE) ? (blocksize) : SLAB_BLOCK_HDRSIZE)
+// space taken up by a block (including its tag) inside a slab
+#define SLAB_REAL_BLOCKSIZE(blocksize) \
+    (SLAB_USER_BLOCKSIZE(blocksize) + SLAB_BLOCK_TAGSIZE)
 
 /// Macro to compute the static buffer size required for a given allocation
 #define SLAB_STATIC_SIZE(nblocks, blocksize) \
@@ -0,0 +1,90 @@
+/**
+ * \file
+ * \brief Per-dispatcher magazine cache on top of the slab allocator
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#ifndef LIBBARRELFISH_SLAB_CACHE_H
+#define LIBBARRELFISH_SLAB_CACHE_H
+
+#include <machine/param.h>
+#include <barrelfish_kpi/spinlocks_arch.h>
+#include <barrelfish/slab.h>
+
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+/// Number of blocks ("rounds") held by a single magazine
+#define SLAB_MAGAZINE_ROUNDS 15
+
+/// Number of magazines in the storage given to slab_cache_enable_magazines()
+#define SLAB_CACHE_MAGAZINES 64
+
+/// Pseudo core ID to request statistics summed over all dispatchers
+#define SLAB_CACHE_ALL_CORES ((coreid_t)-1)
+
+struct slab_magazine {
+    struct slab_magazine *next;         ///< Next magazine in depot list
+    uint32_t rounds;                    ///< Number of blocks in magazine
+    void *round[SLAB_MAGAZINE_ROUNDS];  ///< Cached blocks
+};
+
+/// Counters for tuning a slab cache
+struct slab_cache_stats {
+    uint64_t allocs;        ///< Blocks handed out
+    uint64_t frees;         ///< Blocks returned
+    uint64_t depot_full;    ///< Full magazines taken from the depot
+    uint64_t depot_empty;   ///< Empty magazines taken from the depot
+    uint64_t slab_refills;  ///< Magazines filled from the backing slab allocator
+    uint64_t slab_frees;    ///< Blocks freed directly to the backing slab allocator
+    uint64_t mag_shortage;  ///< Refills or frees that found no spare magazine
+};
+
+/// Per-dispatcher part of a slab cache, on a cache line of its own
+struct slab_cache_cpu {
+    struct slab_magazine *loaded;   ///< Magazine currently used (or NULL)
+    struct slab_magazine *previous; ///< Previously loaded magazine (or NULL)
+    struct slab_cache_stats stats;  ///< Counters for this dispatcher
+} __attribute__ ((aligned (CACHE_LINE_SIZE)));
+
+/// Bytes of storage needed by slab_cache_enable_magazines()
+#define SLAB_CACHE_MAGAZINES_BUFSIZE                                    \
+    ((MAX_COREID + 1) * sizeof(struct slab_cache_cpu)                   \
+     + SLAB_CACHE_MAGAZINES * sizeof(struct slab_magazine) + CACHE_LINE_SIZE)
+
+struct slab_cache {
+    struct slab_allocator *slabs;   ///< Backing slab allocator
+    spinlock_t slabs_lock;          ///< Protects the backing slab allocator
+
+    spinlock_t depot_lock;          ///< Protects the depot lists
+    struct slab_magazine *depot_full;   ///< Depot list of full magazines
+    struct slab_magazine *depot_empty;  ///< Depot list of empty magazines
+    size_t depot_nfull, depot_nempty;   ///< Lengths of the depot lists
+
+    /// Per-dispatcher magazines indexed by core ID, NULL until enabled
+    struct slab_cache_cpu *cpu;
+};
+
+void slab_cache_init(struct slab_cache *cache, struct slab_allocator *slabs);
+void slab_cache_enable_magazines(struct slab_cache *cache, void *buf,
+                                 size_t buflen);
+void *slab_cache_alloc(struct slab_cache *cache);
+void *slab_cache_alloc_nozero(struct slab_cache *cache);
+void slab_cache_free(struct slab_cache *cache, void *block);
+void slab_cache_grow(struct slab_cache *cache, void *buf, size_t buflen);
+size_t slab_cache_freecount(struct slab_cache *cache);
+void slab_cache_get_stats(struct slab_cache *cache, coreid_t core,
+                          struct slab_cache_stats *stats);
+
+__END_DECLS
+
+#endif // LIBBARRELFISH_SLAB_CACHE_H
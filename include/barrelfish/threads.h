@@ -49,6 +49,11 @@ void thread_pause_and_capture_state(struct thread *thread,
                                     arch_registers_state_t **ret_regs);
 void thread_resume(struct thread *thread);
 
+void thread_set_migratable(struct thread *thread, bool migratable);
+errval_t thread_migrate(struct thread *thread, coreid_t core_id);
+size_t thread_migrate_runnable(coreid_t core_id, size_t count);
+size_t thread_runnable_count(void);
+
 void thread_mutex_init(struct thread_mutex *mutex);
 void thread_mutex_lock(struct thread_mutex *mutex);
 bool thread_mutex_trylock(struct thread_mutex *mutex);
@@ -73,6 +78,16 @@ void *thread_get_tls(void);
 void thread_set_tls_key(int, void *);
 void *thread_get_tls_key(int);
 
+/// thread_set_tls_key() key reserved for the malloc thread cache
+#define THREAD_TLS_KEY_MALLOC   15
+
+/// Function called by every thread when it exits, see thread_add_exit_hook()
+struct thread_exit_hook {
+    void (*func)(void);                 ///< Function to call
+    struct thread_exit_hook *next;      ///< Next hook, set by thread_add_exit_hook()
+};
+void thread_add_exit_hook(struct thread_exit_hook *hook);
+
 uintptr_t thread_id(void);
 uintptr_t thread_get_id(struct thread *t);
 void thread_set_id(uintptr_t id);
@@ -38,6 +38,70 @@ struct ump_bind_continuation {
     void *st;
 };
 
+/// Default size of each direction of a UMP payload pool, in bytes
+#define DEFAULT_UMP_POOLLEN (16 * BASE_PAGE_SIZE)
+
+/// Longest time an adaptive receiver polls before waiting for a notification
+#define UMP_SPIN_MAX_NS     10000
+
+/**
+ * \brief Per-direction control line, shared by both sides of a channel
+ *
+ * Only present if the binding side asked for payload pools or adaptive
+ * receive. Both fields are written by the receiver of the direction.
+ */
+struct ump_chan_ctrl {
+    uint64_t pool_tail;         ///< Payload pool bytes released by the receiver
+    uint64_t rx_waiting;        ///< Receiver waits for a notification
+};
+
+/// Counters of the adaptive receive policy of a UMP channel
+struct ump_notify_stats {
+    uint64_t spin_hits;         ///< Messages that arrived while polling
+    uint64_t spin_misses;       ///< Spin windows that expired without a message
+    uint64_t spin_time;         ///< Time spent in spin windows (systime ticks)
+    uint64_t blocks;            ///< Times the receiver waited for a notification
+    uint64_t wakeups;           ///< Messages that arrived while waiting
+    uint64_t ipis_sent;         ///< Notifications sent to the other side
+    uint64_t ipis_avoided;      ///< Sends that needed no notification
+};
+
+/**
+ * \brief State of the adaptive spin-then-block receive policy
+ *
+ * After a message, the receiver keeps polling the channel for a window that
+ * follows the observed message inter-arrival time (at most #UMP_SPIN_MAX_NS).
+ * Only if nothing arrives does it tell the sender, through the control line,
+ * that it wants a notification, and blocks. While the receiver polls, the
+ * sender does not send notifications.
+ */
+struct ump_adaptive {
+    bool enabled;               ///< Use the adaptive policy for this channel
+    bool blocked;               ///< Receiver currently waits for a notification
+    ump_index_t last_pos;       ///< Receive position at the last decision
+    systime_t last_arrival;     ///< Time the last message was seen
+    systime_t gap;              ///< Moving average of the inter-arrival time
+    systime_t max_spin;         ///< UMP_SPIN_MAX_NS in systime ticks
+    systime_t window_start;     ///< Start of the current spin window
+    struct ump_notify_stats stats;
+};
+
+/**
+ * \brief One direction of the out-of-line payload pool of a UMP channel
+ *
+ * The pool is a byte ring in the channel frame that is written by one side
+ * and read by the other. The sender allocates from it in cache-line units and
+ * only sends the position of the payload through the message ring; the
+ * receiver copies the payload out and releases it by advancing the shared
+ * tail.
+ */
+struct ump_pool {
+    volatile uint8_t *buf;      ///< Payload ring, or NULL if there is no pool
+    volatile uint64_t *tail;    ///< Bytes released by the receiver (shared)
+    size_t size;                ///< Size of buf in bytes (power of two)
+    uint64_t head;              ///< Bytes allocated (sender) or consumed (receiver)
+};
+
 /// A bidirectional UMP channel
 struct ump_chan {
     struct monitor_cap_handlers cap_handlers;   /* XXX: must be first */
@@ -60,6 +124,14 @@ struct ump_chan {
     uintptr_t monitor_id;       ///< Local monitor's connection ID for this channel
     struct monitor_binding *monitor_binding; ///< Monitor binding used for cap xfer
 
+    size_t poolsize;            ///< Size of each payload pool (0 for no pool)
+    struct ump_pool send_pool;  ///< Payload pool for outgoing messages
+    struct ump_pool recv_pool;  ///< Payload pool for incoming messages
+
+    volatile struct ump_chan_ctrl *send_ctrl; ///< Control line of outgoing direction
+    volatile struct ump_chan_ctrl *recv_ctrl; ///< Control line of incoming direction
+    struct ump_adaptive adaptive;             ///< Adaptive receive state
+
     uintptr_t sendid;  ///< id for tracing
     uintptr_t recvid;  ///< id for tracing
 
@@ -89,6 +161,8 @@ void ump_chan_send_bind_reply(struct monitor_binding *mb,
                               struct ump_chan *uc, errval_t err,
                               uintptr_t monitor_id, struct capref notify_cap);
 void ump_chan_destroy(struct ump_chan *uc);
+bool ump_chan_wait_notify(struct ump_chan *uc);
+bool ump_chan_notify_needed(struct ump_chan *uc);
 void ump_init(void);
 
 /**
@@ -19,6 +19,7 @@
 
 #include <barrelfish/waitset.h>
 #include <barrelfish/ump_impl.h>
+#include <barrelfish/systime.h>
 
 __BEGIN_DECLS
 
@@ -26,6 +27,7 @@ __BEGIN_DECLS
 struct ump_endpoint {
     struct waitset_chanstate waitset_state; ///< Waitset per-channel state
     struct ump_chan_state    chan;          ///< Incoming UMP channel state to poll
+    systime_t spin_deadline;  ///< Stop polling at this time (0: poll until a message)
 };
 
 errval_t ump_endpoint_init(struct ump_endpoint *ep, volatile void *buf,
@@ -77,6 +79,27 @@ static inline bool ump_endpoint_poll(struct waitset_chanstate *channel)
     return ump_endpoint_can_recv(ep);
 }
 
+/**
+ * \brief Return true if the spin window of a polled endpoint is over
+ *
+ * \param channel UMP channel
+ * \param now Current time, or 0 if it has not been read yet (updated)
+ */
+static inline bool ump_endpoint_spin_expired(struct waitset_chanstate *channel,
+                                             systime_t *now)
+{
+    struct ump_endpoint *ep = (struct ump_endpoint *)
+        ((char *)channel - offsetof(struct ump_endpoint, waitset_state));
+
+    if (ep->spin_deadline == 0) {
+        return false;
+    }
+    if (*now == 0) {
+        *now = systime_now();
+    }
+    return *now >= ep->spin_deadline;
+}
+
 
 __END_DECLS
 
@@ -46,6 +46,7 @@ errval_t vspace_mmu_aware_init_aligned(struct vspace_mmu_aware *state,
                                        struct slot_allocator *slot_alloc,
                                        size_t size, size_t alignment,
                                        vregion_flags_t flags);
+void vspace_mmu_aware_set_promote(struct vspace_mmu_aware *state, bool promote);
 errval_t vspace_mmu_aware_reset(struct vspace_mmu_aware *state,
                                 struct capref frame, size_t size);
 errval_t vspace_mmu_aware_map(struct vspace_mmu_aware *state, size_t req_size,
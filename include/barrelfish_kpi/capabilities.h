@@ -448,9 +448,15 @@ enum cnode_cmd {
     CNodeCmd_GetState,  ///< Get distcap state for capability
     CNodeCmd_GetSize,   ///< Get Size of CNode, only applicable for L1 Cnode
     CNodeCmd_Resize,    ///< Resize CNode, only applicable for L1 Cnode
-    CNodeCmd_CapIdentify ///< Identify capability
+    CNodeCmd_CapIdentify, ///< Identify capability
+    CNodeCmd_CopyRange, ///< Copy a range of capabilities
+    CNodeCmd_MintRange, ///< Mint a range of capabilities
+    CNodeCmd_DeleteRange ///< Delete a range of capabilities
 };
 
+/// Maximum number of slots handled by one CNode range invocation
+#define CNODE_RANGE_MAX_COUNT   0xffff
+
 enum vnode_cmd {
     VNodeCmd_Map,
     VNodeCmd_Unmap,
@@ -458,6 +464,33 @@ enum vnode_cmd {
     VNodeCmd_CleanDirtyBits, ///< Cleans all dirty bit in the table
     VNodeCmd_CopyRemap,      ///< Copy and remap page table for copy-on-write
     VNodeCmd_Inherit,        ///< Clone page table
+    VNodeCmd_MapBatch,       ///< Map a frame into several leaf tables
+    VNodeCmd_UnmapBatch,     ///< Unmap and delete several mappings
+    VNodeCmd_ModifyFlagsBatch, ///< Modify flags of several mappings
+};
+
+/// Maximum number of entries in a batched VNode invocation
+#define VNODE_BATCH_MAX         32
+
+/**
+ * \brief One leaf page table's worth of a batched VNode invocation
+ *
+ * VNodeCmd_MapBatch uses all fields. VNodeCmd_UnmapBatch only uses the
+ * mapping cap (mapping, mapping_level), VNodeCmd_ModifyFlagsBatch the mapping
+ * cap, offset and pte_count. All capability addresses are relative to the
+ * caller's cspace, except mapping, which for VNodeCmd_MapBatch names the L2
+ * CNode in the cspace rooted at mapping_croot.
+ */
+struct vnode_batch_entry {
+    capaddr_t ptable;           ///< Leaf page table to map into
+    capaddr_t mapping_croot;    ///< Root CNode for the mapping cap
+    capaddr_t mapping;          ///< L2 CNode (map) or mapping cap (unmap, modify)
+    cslot_t   mapping_slot;     ///< Slot for the new mapping cap (map)
+    uint8_t   ptable_level;
+    uint8_t   mapping_level;
+    uint16_t  slot;             ///< First entry in the leaf table (map)
+    uint64_t  offset;           ///< Frame offset (map), first page (modify)
+    uint64_t  pte_count;        ///< Number of entries
 };
 
 /**
@@ -509,6 +542,7 @@ enum kernel_cmd {
     KernelCmd_Suspend_kcb_sched,  ///< suspend/resume kcb scheduler
     KernelCmd_Get_platform,       ///< Get architecture platform
     KernelCmd_ReclaimRAM,         ///< Retrieve stored ram caps from KCB
+    KernelCmd_Setup_schedstat,    ///< Set up scheduler statistics frame
     KernelCmd_Count
 };
 
@@ -0,0 +1,71 @@
+/**
+ * \file
+ * \brief Scheduler statistics shared between kernel and user
+ *
+ * Each kernel keeps its scheduling counters in a frame provided by its
+ * monitor, which hands out read-only copies of the frame capability. Readers
+ * map the frame and sample it without system calls.
+ *
+ * The kernel bumps seq before and after every update, so it is odd while an
+ * update is in progress. A consistent snapshot is a copy taken while seq was
+ * even and did not change.
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#ifndef BARRELFISH_KPI_SCHEDSTAT_H
+#define BARRELFISH_KPI_SCHEDSTAT_H
+
+#include <stdint.h>
+
+#define SCHEDSTAT_MAGIC         0x54535342      ///< "BSST"
+#define SCHEDSTAT_VERSION       1
+
+/// Number of buckets in each histogram
+#define SCHEDSTAT_HIST_BUCKETS  40
+
+/**
+ * \brief Histogram of scheduler samples
+ *
+ * Time histograms are in systime ticks and bucket i counts the samples in
+ * [2^i, 2^(i+1)), bucket 0 also counts zero. The run queue histogram is
+ * linear: bucket i counts samples of length i, the last bucket everything
+ * longer.
+ */
+struct schedstat_hist {
+    uint64_t count;                             ///< Number of samples
+    uint64_t sum;                               ///< Sum of all samples
+    uint64_t max;                               ///< Largest sample
+    uint64_t bucket[SCHEDSTAT_HIST_BUCKETS];
+};
+
+/// Per-core scheduler statistics
+struct sched_stats {
+    uint32_t magic;                             ///< SCHEDSTAT_MAGIC once set up
+    uint16_t version;                           ///< SCHEDSTAT_VERSION
+    uint16_t core_id;                           ///< Core of the kernel
+    uint64_t systime_frequency;                 ///< Systime ticks per second
+    volatile uint64_t seq;                      ///< Odd while being updated
+
+    uint64_t schedules;                         ///< Scheduler invocations
+    uint64_t idle;                              ///< ... with nothing to run
+    uint64_t context_switches;                  ///< Dispatches of another DCB
+    uint64_t wakeups;                           ///< DCBs made runnable
+    uint64_t yields;                            ///< Voluntary yields
+    uint64_t preemptions;                       ///< Runnable DCBs switched away
+    uint64_t slack_overruns;                    ///< RT dispatches with negative slack
+    uint64_t runq_len;                          ///< Current run queue length
+
+    struct schedstat_hist wakeup_latency;       ///< Runnable until dispatched
+    struct schedstat_hist runq;                 ///< Run queue length at schedule
+    struct schedstat_hist slack;                ///< RT deadline slack at dispatch
+};
+
+#endif // BARRELFISH_KPI_SCHEDSTAT_H
@@ -15,6 +15,7 @@
 #ifndef BENCH_H
 #define BENCH_H
 
+#include <stdbool.h>
 #include <barrelfish/types.h> // for cycles_t
 #include <bench/bench_arch.h>
 #include <sys/cdefs.h>
@@ -33,6 +34,9 @@ cycles_t bench_min(cycles_t *array, size_t len);
 cycles_t bench_max(cycles_t *array, size_t len);
 cycles_t bench_tscoverhead(void);
 cycles_t bench_time_diff(cycles_t tsc_start, cycles_t tsc_end);
+void bench_shuffle(void *base, size_t nmemb, size_t size);
+bool bench_size_arg(int argc, char *argv[], const char *name, size_t min,
+                    size_t *value);
 __END_DECLS
 
 
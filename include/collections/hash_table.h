@@ -17,17 +17,38 @@
 #include "collections/list.h"
 
 /*
- * a simple hash table. 
+ * a simple hash table. elements are stored inline in an array of slots
+ * (open addressing with linear probing), so inserting does not allocate
+ * memory unless the table has to grow. the table doubles in size when it
+ * becomes 3/4 full. inserting during a traversal is allowed: the grow is
+ * deferred until collections_hash_traverse_end(), and a new element may or
+ * may not be returned by the traversal. only if the table fills up
+ * completely does it grow early, which restarts the traversal so elements
+ * can be returned twice. as deleting shifts elements back into earlier
+ * slots, the table must not have elements deleted during a traversal.
  */
 
 typedef void (* collections_hash_data_free)(void *);
 
+/*
+ * Structure of a hash table element (slot).
+ */
+typedef struct	_collections_hash_elem {
+
+	uint64_t	key;
+
+	void	*data;
+
+	// non-zero if the slot holds an element.
+	uint8_t		used;
+} collections_hash_elem;
+
 typedef struct	_collections_hash_table {
-	// number of buckets in the table.
+	// number of slots in the table, always a power of two.
 	int			num_buckets;
 
-	// pointer to the buckets.
-	collections_listnode	**buckets;
+	// pointer to the slots.
+	collections_hash_elem	*buckets;
 
 	// total number of elements in the table.
 	uint32_t	num_elems;
@@ -40,16 +61,6 @@ typedef struct	_collections_hash_table {
 	int32_t		cur_bucket_num;
 } collections_hash_table;
 
-/*
- * Structure of a hash table element.
- */
-typedef struct	_collections_hash_elem {
-
-	uint64_t	key;
-
-	void	*data;
-} collections_hash_elem;
-
 #define NUM_BUCKETS	1013
 
 #ifdef __cplusplus
@@ -71,6 +82,14 @@ int32_t		collections_hash_traverse_start(collections_hash_table* t);
 void*		collections_hash_traverse_next(collections_hash_table* t, uint64_t *key);
 int32_t		collections_hash_traverse_end(collections_hash_table* t);
 
+/*
+ * Inserts data under key, or replaces the data of the element with that key
+ * if there is one. Unlike collections_hash_insert(), an existing key is not
+ * an error. Returns the data previously stored under key (it is not passed
+ * to the data free function), or NULL if the key was not present.
+ */
+void*		collections_hash_insert_or_replace(collections_hash_table *t, uint64_t key, void *data);
+
 /*
  * Visitor function: returns 0 when visit should be considered finish.
  */
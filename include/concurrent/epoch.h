@@ -0,0 +1,65 @@
+/** \file
+ *  \brief Epoch-based memory reclamation for the non-blocking data structures.
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+#ifndef EPOCH_H_
+#define EPOCH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+/*
+ * A thread that reads shared nodes brackets the access with epoch_enter() and
+ * epoch_exit(). Unlinked nodes are handed to epoch_retire() and freed once
+ * every thread that was inside a critical section at that time has left it.
+ *
+ * Threads register themselves on their first epoch_enter(). The registration
+ * is kept in thread-local storage, so this works for threads of a domain
+ * spanned over several cores as well as for several threads on one
+ * dispatcher. A thread that exits should call epoch_unregister() first.
+ */
+
+/*
+ * \brief enter a critical section. May be nested.
+ */
+void epoch_enter(void);
+
+/*
+ * \brief leave a critical section.
+ */
+void epoch_exit(void);
+
+/*
+ * \brief free ptr with free_fn once no thread can hold a reference to it.
+ *        Must be called inside a critical section, after ptr was unlinked.
+ */
+void epoch_retire(void *ptr, void (*free_fn)(void *));
+
+/*
+ * \brief try to free retired memory, advancing the epoch if possible.
+ *        Called outside of a critical section.
+ * \return true if the calling thread has no retired memory left
+ */
+bool epoch_reclaim(void);
+
+/*
+ * \brief free all memory retired by this thread and release its registration
+ *        for reuse by another thread. Waits for the other threads to leave
+ *        their current critical sections.
+ */
+void epoch_unregister(void);
+
+__END_DECLS
+
+#endif /* EPOCH_H_ */
@@ -0,0 +1,95 @@
+/** \file
+ *  \brief A non-blocking hash set using split-ordered lists (Shalev and
+ *  Shavit).
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+#ifndef HASHSET_H_
+#define HASHSET_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+#define HS_SEGMENT_BITS 10
+#define HS_SEGMENT_SIZE (1UL << HS_SEGMENT_BITS)
+#define HS_MAX_SEGMENTS 1024
+#define HS_MAX_BUCKETS  (HS_SEGMENT_SIZE * HS_MAX_SEGMENTS)
+
+/// Average number of elements per bucket at which the table doubles
+#define HS_LOAD_FACTOR  2
+
+struct hs_node {
+    struct hs_node *volatile next;
+    uintptr_t so_key;           ///< split-order key, see hashset.c
+    void* key;
+    void* data;
+};
+
+struct hashset {
+    /// Bucket array, allocated one segment at a time as buckets are used
+    struct hs_node *volatile *volatile segments[HS_MAX_SEGMENTS];
+    volatile uintptr_t size;    ///< number of buckets, a power of two
+    volatile uintptr_t count;   ///< number of elements
+};
+
+/*
+ * All elements are kept in a single sorted non-blocking list. The buckets
+ * point to dummy nodes in that list, so growing the table only doubles the
+ * bucket count; new buckets are split off their parent the first time they
+ * are used and no element ever moves.
+ *
+ * Keys are compared by their pointer value and must not be NULL, as for the
+ * linked list. Removed nodes are freed through the epoch-based reclamation
+ * in concurrent/epoch.h.
+ */
+
+/*
+ * \brief create a new (empty) hash set. Creation is not thread-safe.
+ */
+void hs_create(struct hashset **hs);
+
+/*
+ * \brief free a hash set and all its elements. Not thread-safe.
+ */
+void hs_destroy(struct hashset *hs);
+
+/*
+ * \brief insert a new element into the hash set.
+ * \return false if the key is already present
+ */
+bool hs_insert(struct hashset *hs, void* key, void* data);
+
+/*
+ * \brief delete an element from the hash set.
+ */
+bool hs_delete(struct hashset *hs, void* key);
+
+/*
+ * \brief check if the hash set contains an element.
+ */
+bool hs_contains(struct hashset *hs, void* key);
+
+/*
+ * \brief look up the data of an element.
+ * \return false if the key is not present
+ */
+bool hs_get(struct hashset *hs, void* key, void** data);
+
+/*
+ * \brief print the content of the hash set to the screen. For debugging.
+ */
+void hs_print(struct hashset *hs);
+
+__END_DECLS
+
+#endif /* HASHSET_H_ */
@@ -0,0 +1,83 @@
+/** \file
+ *  \brief A non-blocking skiplist, after Keir Fraser's `Practical lock-freedom'.
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+#ifndef SKIPLIST_H_
+#define SKIPLIST_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+#define SL_MAX_LEVEL 24
+
+struct sl_node {
+    void* key;
+    void* data;
+    volatile uintptr_t state;   ///< insert/delete handshake, see skiplist.c
+    int top_level;              ///< number of levels the node is linked on
+    struct sl_node *volatile next[];
+};
+
+struct skiplist {
+    struct sl_node *head;
+    struct sl_node *tail;
+};
+
+/*
+ * Keys are ordered by their pointer value and must not be NULL, as for the
+ * linked list. Removed nodes are freed through the epoch-based reclamation
+ * in concurrent/epoch.h, so any number of threads on any core of a spanned
+ * domain may use the list at the same time.
+ */
+
+/*
+ * \brief create a new (empty) skiplist. Creation is not thread-safe.
+ */
+void sl_create(struct skiplist **sl);
+
+/*
+ * \brief free a skiplist and all its elements. Not thread-safe.
+ */
+void sl_destroy(struct skiplist *sl);
+
+/*
+ * \brief insert a new element into the skiplist.
+ * \return false if the key is already present
+ */
+bool sl_insert(struct skiplist *sl, void* key, void* data);
+
+/*
+ * \brief delete an element from the skiplist.
+ */
+bool sl_delete(struct skiplist *sl, void* key);
+
+/*
+ * \brief check if the skiplist contains an element.
+ */
+bool sl_contains(struct skiplist *sl, void* key);
+
+/*
+ * \brief look up the data of an element.
+ * \return false if the key is not present
+ */
+bool sl_get(struct skiplist *sl, void* key, void** data);
+
+/*
+ * \brief print the content of the skiplist to the screen. For debugging.
+ */
+void sl_print(struct skiplist *sl);
+
+__END_DECLS
+
+#endif /* SKIPLIST_H_ */
@@ -33,6 +33,12 @@ enum flounder_ump_msgtype {
     FL_UMP_CAP_ACK = (1 << FL_UMP_MSGTYPE_BITS) - 1,
 };
 
+/// Buffers of at least this many bytes are sent through the payload pool
+#define FL_UMP_POOL_THRESHOLD   (4 * UMP_MSG_BYTES)
+
+/// Set in the length word of a buffer fragment that refers to the pool
+#define FL_UMP_POOL_FLAG        ((uintptr_t)1 << (sizeof(uintptr_t) * 8 - 1))
+
 struct flounder_ump_state {
     struct ump_chan chan;
 
@@ -46,7 +52,8 @@ errval_t flounder_stub_ump_send_string(struct flounder_ump_state *s,
                                        int msgnum, const char *str,
                                        size_t *pos, size_t *len);
 
-errval_t flounder_stub_ump_recv_string(volatile struct ump_message *msg,
+errval_t flounder_stub_ump_recv_string(struct flounder_ump_state *s,
+                                       volatile struct ump_message *msg,
                                        char *str, size_t *pos, size_t *len,
                                        size_t maxsize);
 
@@ -54,7 +61,8 @@ errval_t flounder_stub_ump_send_buf(struct flounder_ump_state *s,
                                        int msgnum, const void *buf,
                                        size_t len, size_t *pos);
 
-errval_t flounder_stub_ump_recv_buf(volatile struct ump_message *msg,
+errval_t flounder_stub_ump_recv_buf(struct flounder_ump_state *s,
+                                    volatile struct ump_message *msg,
                                     void *buf, size_t *len, size_t *pos,
                                     size_t maxsize);
 
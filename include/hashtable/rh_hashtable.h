@@ -0,0 +1,95 @@
+/**
+ * \file
+ * \brief Open-addressing (robin hood) hashtable headers
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+#ifndef RH_HASHTABLE_H_
+#define RH_HASHTABLE_H_
+
+#include <hashtable/dictionary.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+/**
+ * \brief a slot of a robin hood hashtable. Empty slots have type 0.
+ */
+struct _rh_entry {
+    const void *key;
+    size_t key_len;
+    union {
+        void *value;
+        struct capref capvalue;
+    } v;
+    uint32_t hash_value;
+    ENTRY_TYPE type;
+};
+
+/**
+ * \brief one table of slots, the size is a power of two
+ */
+struct _rh_table {
+    struct _rh_entry *slots;
+    size_t mask;        ///< number of slots - 1
+    size_t count;       ///< occupied slots
+};
+
+/**
+ * \brief robin hood hashtable
+ *
+ * Uses linear probing where an insert displaces entries that are closer to
+ * their home slot than the new one, which keeps probe sequences short and
+ * lookups cache friendly. When the table gets too full a table of twice the
+ * size is allocated and the entries are migrated a few at a time on every
+ * subsequent operation rather than all at once.
+ */
+struct rh_hashtable {
+    struct dictionary d;
+    struct _rh_table cur;       ///< table all inserts go to
+    struct _rh_table old;       ///< table being migrated to cur, if any
+    size_t migrate_pos;         ///< next slot of old to migrate
+    size_t threshold;           ///< entries in cur at which we grow
+    int load_factor;            ///< in percent
+};
+
+/**
+ * \brief create an empty robin hood hashtable
+ * \param capacity the initial number of entries it can hold without growing
+ * \param load_factor maximum fill level in percent
+ * \return an empty hashtable, or NULL if out of memory
+ */
+struct rh_hashtable* create_rh_hashtable2(int capacity, int load_factor);
+
+/**
+ * \brief create an empty robin hood hashtable with default capacity and load
+ *  factor
+ * \return an empty hashtable, or NULL if out of memory
+ */
+struct rh_hashtable* create_rh_hashtable(void);
+
+/**
+ * \brief free a robin hood hashtable. Keys and values are not freed.
+ */
+void rh_hashtable_destroy(struct rh_hashtable *ht);
+
+/**
+ * \brief number of bytes of memory used by the hashtable
+ */
+size_t rh_hashtable_footprint(struct rh_hashtable *ht);
+
+/**
+ * \brief hash function used by the robin hood hashtable
+ */
+uint32_t rh_hash(const void *key, size_t key_len);
+
+__END_DECLS
+
+#endif /*RH_HASHTABLE_H_*/
@@ -34,7 +34,10 @@ enum nodetype {
 struct mmnode {
     enum nodetype type;     ///< Type of this node
     uint8_t childbits;      ///< Number of children (in bits / power of two)
+    uint8_t sizebits;       ///< Size of this region (valid for Free nodes)
     struct capref cap;    ///< Cap to this region (invalid for Dummy regions)
+    genpaddr_t base;        ///< Base of this region (valid for Free nodes)
+    struct mmnode *freenext, *freeprev; ///< Free index links (Free nodes only)
     struct mmnode *children[0];///< Child node pointers
 };
 
@@ -42,6 +45,9 @@ struct mmnode {
 #define MM_NODE_SIZE(maxchildbits) \
     (sizeof(struct mmnode) + sizeof(struct mmnode *) * (1UL << (maxchildbits)))
 
+/// Number of per-size free lists (one for every possible sizebits)
+#define MM_FREELISTS    (sizeof(genpaddr_t) * NBBY)
+
 /**
  * \brief Memory manager instance data
  *
@@ -59,6 +65,10 @@ struct mm {
     uint8_t sizebits;            ///< Size of root node (in bits)
     uint8_t maxchildbits;        ///< Maximum number of children of every node (in bits)
     bool delete_chunked;         ///< Delete chunked capabilities if true
+
+    /// Free leaf nodes, indexed by their size in bits
+    struct mmnode *freelist[MM_FREELISTS];
+    uint64_t freemap;            ///< Bit n set iff freelist[n] is non-empty
 };
 
 void mm_debug_print(struct mmnode *mmnode, int space);
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#ifndef TENACIOUSD_GROUP_H
+#define TENACIOUSD_GROUP_H
+
+struct storage_vsa;
+struct storage_vsic;
+
+// Group commit: appends to a log or queue are staged in memory and made
+// durable together with a single write and flush. A group is committed when
+// it holds max_entries entries or max_bytes bytes, or once its oldest entry
+// has waited max_delay TSC cycles. The delay is checked on every append and
+// by tenaciousd_{log,queue}_poll(), which callers should invoke regularly.
+struct tenaciousd_group_params {
+  size_t	max_entries;
+  size_t	max_bytes;
+  uint64_t	max_delay;	// in TSC cycles, 0 for no time bound
+};
+
+struct tenaciousd_group {
+  struct storage_vsa		*vsa;
+  struct storage_vsic		*vsic;
+  struct tenaciousd_group_params params;
+  uint8_t			*buf;		// Staging buffer of max_bytes
+  uint64_t			offset;		// Storage offset of buf
+  size_t			len;		// Bytes staged
+  size_t			pending;	// Entries staged
+  uint64_t			first;		// TSC when first entry was staged
+  uint64_t			committed;	// Entries durable so far
+  uint64_t			commits;	// Groups written so far
+};
+
+errval_t tenaciousd_group_init(struct tenaciousd_group *group,
+                               struct storage_vsa *vsa,
+                               struct storage_vsic *vsic,
+                               const struct tenaciousd_group_params *params);
+
+void tenaciousd_group_destroy(struct tenaciousd_group *group);
+
+errval_t tenaciousd_group_add(struct tenaciousd_group *group, uint64_t offset,
+                              const void *data, size_t size);
+
+errval_t tenaciousd_group_commit(struct tenaciousd_group *group);
+
+errval_t tenaciousd_group_poll(struct tenaciousd_group *group);
+
+#endif
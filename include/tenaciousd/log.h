@@ -12,6 +12,8 @@
 
 struct storage_vsa;
 struct storage_vsic;
+struct tenaciousd_group;
+struct tenaciousd_group_params;
 
 #define TENACIOUSD_LOG_MIN_ENTRY_SIZE(log)      \
     (STORAGE_VSIC_ROUND(log->vsic, sizeof(struct tenaciousd_log_entry)) - sizeof(struct tenaciousd_log_entry))
@@ -35,6 +37,7 @@ struct tenaciousd_log {
     struct storage_vsic *vsic;
     uint64_t entries;
     uint64_t end;
+    struct tenaciousd_group *group;	// NULL unless group commit is on
 };
 
 struct tenaciousd_log *tenaciousd_log_new(struct storage_vsa *vsa,
@@ -45,6 +48,13 @@ errval_t tenaciousd_log_delete(struct tenaciousd_log *log);
 errval_t tenaciousd_log_append(struct tenaciousd_log *log,
                                struct tenaciousd_log_entry *entry);
 
+errval_t tenaciousd_log_set_group_commit(struct tenaciousd_log *log,
+                                         const struct tenaciousd_group_params *params);
+
+errval_t tenaciousd_log_commit(struct tenaciousd_log *log);
+
+errval_t tenaciousd_log_poll(struct tenaciousd_log *log);
+
 errval_t tenaciousd_log_trim(struct tenaciousd_log *log, int nentries);
 
 struct tenaciousd_log_iter tenaciousd_log_begin(struct tenaciousd_log *log);
@@ -12,6 +12,8 @@
 
 struct storage_vsa;
 struct storage_vsic;
+struct tenaciousd_group;
+struct tenaciousd_group_params;
 
 struct tenaciousd_queue_element {
   uint8_t 	valid;
@@ -33,6 +35,7 @@ struct tenaciousd_queue {
   uint64_t elements;
   uint64_t last;
   uint64_t end;
+  struct tenaciousd_group *group;	// NULL unless group commit is on
 };
 
 void tenaciousd_queue_delete_element(struct tenaciousd_queue *queue,
@@ -50,6 +53,13 @@ tenaciousd_queue_element_new(struct tenaciousd_queue *queue,
 errval_t tenaciousd_queue_add(struct tenaciousd_queue *log,
                                struct tenaciousd_queue_element *element);
 
+errval_t tenaciousd_queue_set_group_commit(struct tenaciousd_queue *queue,
+                                           const struct tenaciousd_group_params *params);
+
+errval_t tenaciousd_queue_commit(struct tenaciousd_queue *queue);
+
+errval_t tenaciousd_queue_poll(struct tenaciousd_queue *queue);
+
 struct tenaciousd_queue_element * 
 tenaciousd_queue_remove(struct tenaciousd_queue *queue);
 
@@ -193,6 +193,7 @@ struct trace_buffer {
     struct trace_buffer *master;       // Pointer to the trace master
     volatile bool     running;
     volatile bool     autoflush;       // Are we flushing automatically?
+    volatile bool     streaming;       // Are events drained continuously?
     volatile uint64_t start_trigger;
     volatile uint64_t stop_trigger;
     volatile uint64_t stop_time;
@@ -200,6 +201,7 @@ struct trace_buffer {
     uint64_t          t0;              // Start time of trace
     uint64_t          duration;        // Max trace duration
     uint64_t          event_counter;        // Max number of events in trace
+    volatile uintptr_t lost;           // Events dropped because buffer was full
 
     // ... events ...
     struct trace_event events[TRACE_MAX_EVENTS];
@@ -209,6 +211,36 @@ struct trace_buffer {
     struct trace_application applications[TRACE_MAX_APPLICATIONS];
 };
 
+/*
+ * Streaming trace format
+ *
+ * A stream starts with a struct trace_stream_header, followed by any number
+ * of chunks. Each chunk is a struct trace_stream_chunk followed by
+ * num_events struct trace_event drained from the buffer of one core.
+ * Everything is in the byte order of the traced machine.
+ */
+#define TRACE_STREAM_MAGIC       0x53544642 // "BFTS"
+#define TRACE_STREAM_CHUNK_MAGIC 0x43544642 // "BFTC"
+#define TRACE_STREAM_VERSION     1
+
+/// Header at the start of a trace stream
+struct trace_stream_header {
+    uint32_t magic;           ///< TRACE_STREAM_MAGIC
+    uint16_t version;         ///< TRACE_STREAM_VERSION
+    uint16_t event_size;      ///< Size of struct trace_event
+    uint64_t tsc_per_ms;      ///< Timestamp frequency, 0 if unknown
+    uint64_t t0;              ///< Timestamp when streaming started
+};
+
+/// Header of a block of events drained from the buffer of one core
+struct trace_stream_chunk {
+    uint32_t magic;           ///< TRACE_STREAM_CHUNK_MAGIC
+    uint16_t core;            ///< Core the events were recorded on
+    uint16_t num_events;      ///< Number of events following the header
+    uint64_t lost;            ///< Events dropped on the core since the start
+    int64_t  t_offset;        ///< Time offset of the core relative to core 0
+};
+
 typedef errval_t (* trace_conditional_termination_t)(bool forced);
 
 static __attribute__((unused)) trace_conditional_termination_t
@@ -249,6 +281,14 @@ errval_t trace_my_setup(void);
 errval_t trace_set_subsys_enabled(uint16_t subsys, bool enabled);
 errval_t trace_set_all_subsys_enabled(bool enabled);
 
+errval_t trace_stream_start(void);
+void trace_stream_stop(void);
+size_t trace_stream_header(void *buf, size_t buflen);
+size_t trace_stream_drain_core(void *buf, size_t buflen, coreid_t core,
+                               size_t *number_of_events);
+size_t trace_stream_drain(void *buf, size_t buflen, size_t *number_of_events);
+uint64_t trace_stream_lost(coreid_t core);
+
 
 
 /**
@@ -283,33 +323,45 @@ void trace_init_disp(void);
 /**
  * \brief Reserve a slot in the trace buffer and write the event.
  *
- * Returns the slot index that was written.
+ * Returns the slot index that was written, or TRACE_MAX_EVENTS if the buffer
+ * was full and the event was dropped.
  * Lock-free implementation.
  *
+ * The timestamp is written last and marks the slot as complete, a streaming
+ * reader on another core stops at a reserved slot whose timestamp is still 0.
  */
 static inline uintptr_t
 trace_reserve_and_fill_slot(struct trace_event *ev,
                             struct trace_buffer *buf)
 {
-    uintptr_t i, nw;
+    uintptr_t i, nw, tail;
     struct trace_event *slot;
 
     do {
         i = buf->head_index;
-
-        if (buf->tail_index - buf->head_index == 1 ||
-                (buf->tail_index == 0 && (buf->head_index == TRACE_MAX_EVENTS-1))) {
-            // Buffer is full, overwrite last event
-            break;
+        // pairs with the release store of tail_index by a streaming reader,
+        // so we do not overwrite a slot it is still copying out
+        tail = __atomic_load_n(&buf->tail_index, __ATOMIC_ACQUIRE);
+
+        if (tail - i == 1 || (tail == 0 && i == TRACE_MAX_EVENTS-1)) {
+            // Buffer is full, drop the event and account for it
+            uintptr_t lost;
+            do {
+                lost = buf->lost;
+            } while (!trace_cas(&buf->lost, lost, lost + 1));
+            return TRACE_MAX_EVENTS;
         }
 
         nw = (i + 1) % TRACE_MAX_EVENTS;
 
     } while (!trace_cas(&buf->head_index, i, nw));
 
-    // Write the event
+    // Write the event. A non-zero timestamp tells a streaming reader on
+    // another core that the slot is complete, so it is stored with release
+    // semantics after the payload.
     slot = &buf->events[i];
-    *slot = *ev;
+    slot->u.raw = ev->u.raw;
+    __atomic_store_n(&slot->timestamp, ev->timestamp, __ATOMIC_RELEASE);
 
     return i;
 }
@@ -162,6 +162,59 @@ handle_copy(
     return copy_or_mint(root, &context->syscall_args, false);
 }
 
+static struct sysret copy_or_mint_range(struct capability *root,
+                                        struct registers_aarch64_syscall_args* args,
+                                        bool mint)
+{
+    /* Retrieve arguments */
+    capaddr_t dest_cspace_cptr = args->arg2;
+    capaddr_t destcn_cptr      = args->arg3;
+    cslot_t   dest_slot        = args->arg4;
+    capaddr_t source_croot_ptr = args->arg5;
+    capaddr_t sourcecn_cptr    = args->arg6;
+    cslot_t   source_slot      = args->arg7;
+    uint8_t   destcn_level     = args->x8 & 0xff;
+    uint8_t   sourcecn_level   = (args->x8 >> 8) & 0xff;
+    size_t    count            = args->x8 >> 16;
+    uintptr_t param1, param2;
+    // params only sent if mint operation
+    if (mint) {
+        param1 = args->x9;
+        param2 = args->x10;
+    } else {
+        param1 = param2 = 0;
+    }
+
+    return sys_copy_or_mint_range(root, dest_cspace_cptr, destcn_cptr,
+                                  dest_slot, source_croot_ptr, sourcecn_cptr,
+                                  source_slot, destcn_level, sourcecn_level,
+                                  count, param1, param2, mint);
+}
+
+static struct sysret
+handle_mint_range(
+    struct capability* root,
+    arch_registers_state_t* context,
+    int argc
+    )
+{
+    assert(11 == argc);
+
+    return copy_or_mint_range(root, &context->syscall_args, true);
+}
+
+static struct sysret
+handle_copy_range(
+    struct capability* root,
+    arch_registers_state_t* context,
+    int argc
+    )
+{
+    assert(9 == argc);
+
+    return copy_or_mint_range(root, &context->syscall_args, false);
+}
+
 static struct sysret
 handle_retype_common(
     struct capability* root,
@@ -227,6 +280,25 @@ handle_delete(
     return sys_delete(root, cptr, bits);
 }
 
+static struct sysret
+handle_delete_range(
+    struct capability* root,
+    arch_registers_state_t* context,
+    int argc
+    )
+{
+    assert(5 == argc);
+
+    struct registers_aarch64_syscall_args* sa = &context->syscall_args;
+
+    capaddr_t cn_cptr = (capaddr_t)sa->arg2;
+    cslot_t   slot    = (cslot_t)sa->arg3;
+    uint8_t   level   = sa->arg4 & 0xff;
+    size_t    count   = sa->arg4 >> 16;
+
+    return sys_delete_range(root, cn_cptr, level, slot, count);
+}
+
 static struct sysret
 handle_create(
     struct capability* root,
@@ -958,6 +1030,9 @@ static invocation_t invocations[ObjType_Num][CAP_MAX_CMD] = {
         [CNodeCmd_GetSize] = handle_get_size,
         [CNodeCmd_Resize] = handle_resize,
         [CNodeCmd_CapIdentify] = handle_cap_identify,
+        [CNodeCmd_CopyRange] = handle_copy_range,
+        [CNodeCmd_MintRange] = handle_mint_range,
+        [CNodeCmd_DeleteRange] = handle_delete_range,
     },
     [ObjType_L2CNode] = {
         [CNodeCmd_Copy]   = handle_copy,
@@ -969,6 +1044,9 @@ static invocation_t invocations[ObjType_Num][CAP_MAX_CMD] = {
         [CNodeCmd_GetState] = handle_get_state,
         [CNodeCmd_Resize] = handle_resize,
         [CNodeCmd_CapIdentify] = handle_cap_identify,
+        [CNodeCmd_CopyRange] = handle_copy_range,
+        [CNodeCmd_MintRange] = handle_mint_range,
+        [CNodeCmd_DeleteRange] = handle_delete_range,
     },
     [ObjType_VNode_AARCH64_l0] = {
         [VNodeCmd_Map]   = handle_map,
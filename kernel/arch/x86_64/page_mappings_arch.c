@@ -922,7 +922,7 @@ errval_t page_mappings_modify_flags(struct capability *mapping, size_t offset,
         // do computed selective flush
         debug(SUBSYS_PAGING, "computed selective flush\n");
         return paging_tlb_flush_range(cte_for_cap(mapping), offset, pages);
-    } else {
+    } else if (!paging_tlb_flush_batched()) {
         debug(SUBSYS_PAGING, "full flush\n");
         /* do full TLB flush */
         do_full_tlb_flush();
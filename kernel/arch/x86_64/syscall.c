@@ -14,6 +14,7 @@
 
 #include <kernel.h>
 #include <kcb.h>
+#include <string.h>
 #include <sys_debug.h>
 #include <syscall.h>
 #include <barrelfish_kpi/syscalls.h>
@@ -37,6 +38,7 @@
 #include <barrelfish_kpi/dispatcher_shared_target.h>
 #include <barrelfish_kpi/platform.h>
 #include <trace/trace.h>
+#include <schedstat.h>
 #include <useraccess.h>
 #ifndef __k1om__
 #include <vmkit.h>
@@ -204,6 +206,54 @@ static struct sysret handle_copy(struct capability *root,
     return copy_or_mint(root, args, false);
 }
 
+/**
+ * Common code for copying and minting ranges except the mint flag
+ */
+static struct sysret copy_or_mint_range(struct capability *root,
+                                        uintptr_t *args, bool mint)
+{
+    /* Retrieve arguments */
+    capaddr_t dest_cspace_cptr = args[0];
+    capaddr_t destcn_cptr      = args[1];
+    uint64_t  dest_slot        = args[2];
+    capaddr_t source_croot_ptr = args[3];
+    capaddr_t sourcecn_cptr    = args[4];
+    uint64_t  source_slot      = args[5];
+    uint8_t   destcn_level     = args[6] & 0xff;
+    uint8_t   sourcecn_level   = (args[6] >> 8) & 0xff;
+    size_t    count            = args[6] >> 16;
+    uint64_t param1, param2;
+    // params only sent if mint operation
+    if (mint) {
+        param1 = args[7];
+        param2 = args[8];
+    } else {
+        param1 = param2 = 0;
+    }
+
+    TRACE(KERNEL, SC_COPY_OR_MINT, 0);
+    struct sysret sr = sys_copy_or_mint_range(root, dest_cspace_cptr,
+                                              destcn_cptr, dest_slot,
+                                              source_croot_ptr, sourcecn_cptr,
+                                              source_slot, destcn_level,
+                                              sourcecn_level, count,
+                                              param1, param2, mint);
+    TRACE(KERNEL, SC_COPY_OR_MINT, 1);
+    return sr;
+}
+
+static struct sysret handle_mint_range(struct capability *root,
+                                       int cmd, uintptr_t *args)
+{
+    return copy_or_mint_range(root, args, true);
+}
+
+static struct sysret handle_copy_range(struct capability *root,
+                                       int cmd, uintptr_t *args)
+{
+    return copy_or_mint_range(root, args, false);
+}
+
 static struct sysret handle_delete(struct capability *root,
                                    int cmd, uintptr_t *args)
 {
@@ -212,6 +262,16 @@ static struct sysret handle_delete(struct capability *root,
     return sys_delete(root, cptr, level);
 }
 
+static struct sysret handle_delete_range(struct capability *root,
+                                         int cmd, uintptr_t *args)
+{
+    capaddr_t cn_cptr = args[0];
+    uint64_t slot     = args[1];
+    uint8_t level     = args[2] & 0xff;
+    size_t count      = args[2] >> 16;
+    return sys_delete_range(root, cn_cptr, level, slot, count);
+}
+
 static struct sysret handle_revoke(struct capability *root,
                                    int cmd, uintptr_t *args)
 {
@@ -330,6 +390,167 @@ static struct sysret handle_vnode_copy_remap(struct capability *ptable,
     return sr;
 }
 
+/**
+ * \brief Check and fetch the entries of a batched VNode invocation
+ */
+static errval_t vnode_batch_check(lvaddr_t entries, size_t count)
+{
+    if (count > VNODE_BATCH_MAX) {
+        return SYS_ERR_VNODE_BATCH_SIZE;
+    }
+    if (!access_ok(ACCESS_READ, entries,
+                   count * sizeof(struct vnode_batch_entry))) {
+        return SYS_ERR_INVALID_USER_BUFFER;
+    }
+    return SYS_ERR_OK;
+}
+
+/*
+ * The batched invocations are made on the root page table of a vspace. Every
+ * entry names its own leaf table or mapping cap, so they can span any number
+ * of leaf tables. Entries are processed in order; on failure the sysret value
+ * holds the number of entries that were completed.
+ */
+
+static struct sysret handle_vnode_map_batch(struct capability *root_pt,
+                                            int cmd, uintptr_t *args)
+{
+    /* Retrieve arguments */
+    lvaddr_t  entries         = args[0];
+    size_t    count           = args[1];
+    capaddr_t source_root_cptr= args[2] >> 32;
+    capaddr_t source_cptr     = args[2] & 0xffffffff;
+    uint8_t   source_level    = args[3];
+    uint64_t  flags           = args[4];
+
+    errval_t err = vnode_batch_check(entries, count);
+    if (err_is_fail(err)) {
+        return SYSRET(err);
+    }
+
+    struct capability *root = &dcb_current->cspace.cap;
+    struct vnode_batch_entry e;
+    struct sysret sr = { .error = SYS_ERR_OK, .value = 0 };
+
+    TRACE(KERNEL, SC_MAP, 0);
+    for (size_t i = 0; i < count; i++) {
+        memcpy(&e, (struct vnode_batch_entry *)entries + i, sizeof(e));
+
+        struct capability *ptable;
+        err = caps_lookup_cap(root, e.ptable, e.ptable_level, &ptable,
+                              CAPRIGHTS_READ);
+        if (err_is_fail(err)) {
+            sr.error = err_push(err, SYS_ERR_CAP_NOT_FOUND);
+            break;
+        }
+        if (!type_is_vnode(ptable->type)) {
+            sr.error = SYS_ERR_VNODE_TYPE;
+            break;
+        }
+
+        sr.error = sys_map(ptable, e.slot, source_root_cptr, source_cptr,
+                           source_level, flags, e.offset, e.pte_count,
+                           e.mapping_croot, e.mapping, e.mapping_level,
+                           e.mapping_slot).error;
+        if (err_is_fail(sr.error)) {
+            break;
+        }
+        sr.value++;
+    }
+    TRACE(KERNEL, SC_MAP, 1);
+
+    return sr;
+}
+
+static struct sysret handle_vnode_unmap_batch(struct capability *root_pt,
+                                              int cmd, uintptr_t *args)
+{
+    lvaddr_t entries = args[0];
+    size_t   count   = args[1];
+
+    errval_t err = vnode_batch_check(entries, count);
+    if (err_is_fail(err)) {
+        return SYSRET(err);
+    }
+
+    struct capability *root = &dcb_current->cspace.cap;
+    struct vnode_batch_entry e;
+    struct sysret sr = { .error = SYS_ERR_OK, .value = 0 };
+
+    TRACE(KERNEL, SC_UNMAP, 0);
+    paging_tlb_flush_batch_begin();
+    for (size_t i = 0; i < count; i++) {
+        memcpy(&e, (struct vnode_batch_entry *)entries + i, sizeof(e));
+
+        struct cte *mapping;
+        err = caps_lookup_slot(root, e.mapping, e.mapping_level, &mapping,
+                               CAPRIGHTS_READ_WRITE);
+        if (err_is_fail(err)) {
+            sr.error = err_push(err, SYS_ERR_CAP_NOT_FOUND);
+            break;
+        }
+        if (!type_is_mapping(mapping->cap.type)) {
+            sr.error = SYS_ERR_WRONG_MAPPING;
+            break;
+        }
+
+        // deleting the last copy of a mapping cap removes the mapping
+        sr.error = caps_delete(mapping);
+        if (err_is_fail(sr.error)) {
+            break;
+        }
+        sr.value++;
+    }
+    paging_tlb_flush_batch_end();
+    TRACE(KERNEL, SC_UNMAP, 1);
+
+    return sr;
+}
+
+static struct sysret handle_vnode_modify_flags_batch(struct capability *root_pt,
+                                                     int cmd, uintptr_t *args)
+{
+    lvaddr_t entries = args[0];
+    size_t   count   = args[1];
+    size_t   flags   = args[2];
+
+    errval_t err = vnode_batch_check(entries, count);
+    if (err_is_fail(err)) {
+        return SYSRET(err);
+    }
+
+    struct capability *root = &dcb_current->cspace.cap;
+    struct vnode_batch_entry e;
+    struct sysret sr = { .error = SYS_ERR_OK, .value = 0 };
+
+    paging_tlb_flush_batch_begin();
+    for (size_t i = 0; i < count; i++) {
+        memcpy(&e, (struct vnode_batch_entry *)entries + i, sizeof(e));
+
+        struct capability *mapping;
+        err = caps_lookup_cap(root, e.mapping, e.mapping_level, &mapping,
+                              CAPRIGHTS_READ_WRITE);
+        if (err_is_fail(err)) {
+            sr.error = err_push(err, SYS_ERR_CAP_NOT_FOUND);
+            break;
+        }
+        if (!type_is_mapping(mapping->type)) {
+            sr.error = SYS_ERR_WRONG_MAPPING;
+            break;
+        }
+
+        sr.error = page_mappings_modify_flags(mapping, e.offset, e.pte_count,
+                                              flags, 0);
+        if (err_is_fail(sr.error)) {
+            break;
+        }
+        sr.value++;
+    }
+    paging_tlb_flush_batch_end();
+
+    return sr;
+}
+
 /*
  *  MVAS Extension
  */
@@ -1015,6 +1236,33 @@ static struct sysret handle_trace_setup(struct capability *cap,
     return SYSRET(SYS_ERR_OK);
 }
 
+static struct sysret handle_schedstat_setup(struct capability *cap,
+                                            int cmd, uintptr_t *args)
+{
+    struct capability *frame;
+    errval_t err;
+
+    /* lookup passed cap */
+    capaddr_t cptr = args[0];
+    err = caps_lookup_cap(&dcb_current->cspace.cap, cptr, 2, &frame,
+                          CAPRIGHTS_READ_WRITE);
+    if (err_is_fail(err)) {
+        return SYSRET(err);
+    }
+
+    if (frame->type != ObjType_Frame) {
+        return SYSRET(SYS_ERR_INVALID_SOURCE_TYPE);
+    }
+    if (frame->u.frame.bytes < sizeof(struct sched_stats)) {
+        return SYSRET(SYS_ERR_INVALID_SIZE);
+    }
+
+    lpaddr_t lpaddr = gen_phys_to_local_phys(frame->u.frame.base);
+    schedstat_setup(local_phys_to_mem(lpaddr));
+
+    return SYSRET(SYS_ERR_OK);
+}
+
 static struct sysret handle_irqsrc_get_vec_start(struct capability * to, int cmd,
         uintptr_t *args)
 {
@@ -1362,6 +1610,9 @@ static invocation_handler_t invocations[ObjType_Num][CAP_MAX_CMD] = {
         [CNodeCmd_GetSize] = handle_get_size,
         [CNodeCmd_Resize] = handle_resize,
         [CNodeCmd_CapIdentify] = handle_cap_identify,
+        [CNodeCmd_CopyRange] = handle_copy_range,
+        [CNodeCmd_MintRange] = handle_mint_range,
+        [CNodeCmd_DeleteRange] = handle_delete_range,
     },
     [ObjType_L2CNode] = {
         [CNodeCmd_Copy]   = handle_copy,
@@ -1373,6 +1624,9 @@ static invocation_handler_t invocations[ObjType_Num][CAP_MAX_CMD] = {
         [CNodeCmd_GetState] = handle_get_state,
         [CNodeCmd_Resize] = handle_resize,
         [CNodeCmd_CapIdentify] = handle_cap_identify,
+        [CNodeCmd_CopyRange] = handle_copy_range,
+        [CNodeCmd_MintRange] = handle_mint_range,
+        [CNodeCmd_DeleteRange] = handle_delete_range,
     },
     [ObjType_VNode_VTd_root_table] = {
         [VNodeCmd_Map]         = handle_map,
@@ -1395,6 +1649,9 @@ static invocation_handler_t invocations[ObjType_Num][CAP_MAX_CMD] = {
         [VNodeCmd_ModifyFlags] = handle_vnode_modify_flags,
         [VNodeCmd_CopyRemap] = handle_vnode_copy_remap,
         [VNodeCmd_Inherit] = handle_inherit,
+        [VNodeCmd_MapBatch] = handle_vnode_map_batch,
+        [VNodeCmd_UnmapBatch] = handle_vnode_unmap_batch,
+        [VNodeCmd_ModifyFlagsBatch] = handle_vnode_modify_flags_batch,
     },
     [ObjType_VNode_x86_64_pdpt] = {
         [VNodeCmd_Map]   = handle_map,
@@ -1457,6 +1714,9 @@ static invocation_handler_t invocations[ObjType_Num][CAP_MAX_CMD] = {
     [ObjType_VNode_x86_64_ept_pml4] = {
         [VNodeCmd_Map]   = handle_map,
         [VNodeCmd_Unmap] = handle_unmap,
+        [VNodeCmd_MapBatch] = handle_vnode_map_batch,
+        [VNodeCmd_UnmapBatch] = handle_vnode_unmap_batch,
+        [VNodeCmd_ModifyFlagsBatch] = handle_vnode_modify_flags_batch,
     },
     [ObjType_VNode_x86_64_ept_pdpt] = {
         [VNodeCmd_Map]   = handle_map,
@@ -1482,6 +1742,7 @@ static invocation_handler_t invocations[ObjType_Num][CAP_MAX_CMD] = {
         [KernelCmd_Copy_existing] = monitor_copy_existing,
         [KernelCmd_Nullify_cap]  = monitor_nullify_cap,
         [KernelCmd_Setup_trace]  = handle_trace_setup,
+        [KernelCmd_Setup_schedstat] = handle_schedstat_setup,
         [KernelCmd_Register]     = monitor_handle_register,
         [KernelCmd_Domain_Id]    = monitor_handle_domain_id,
         [KernelCmd_Get_cap_owner] = monitor_get_cap_owner,
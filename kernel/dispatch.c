@@ -13,6 +13,7 @@
  */
 
 #include <kernel.h>
+#include <string.h>
 #include <barrelfish_kpi/cpu.h>
 #include <exec.h> /* XXX wait_for_interrupt, resume, execute */
 #include <paging_kernel_arch.h>
@@ -20,6 +21,7 @@
 #include <kcb.h>
 #include <wakeup.h>
 #include <systime.h>
+#include <schedstat.h>
 #include <barrelfish_kpi/syscalls.h>
 #include <barrelfish_kpi/lmp.h>
 #include <trace/trace.h>
@@ -52,6 +54,29 @@ uint64_t context_switch_counter = 0;
 /// Current execution dispatcher (when in system call or exception)
 struct dcb *dcb_current = NULL;
 
+/// Scheduler statistics of this core
+struct sched_stats *kernel_schedstat = NULL;
+
+/**
+ * \brief Start keeping scheduler statistics at 'base'
+ *
+ * The statistics start from zero, they are not carried over from a previous
+ * frame.
+ */
+void schedstat_setup(lvaddr_t base)
+{
+    struct sched_stats *s = (struct sched_stats *)base;
+
+    kernel_schedstat = NULL;
+    memset(s, 0, sizeof(*s));
+    s->magic = SCHEDSTAT_MAGIC;
+    s->version = SCHEDSTAT_VERSION;
+    s->core_id = my_core_id;
+    s->systime_frequency = systime_frequency;
+    s->runq_len = kcb_current->queue_len;
+    kernel_schedstat = s;
+}
+
 #if CONFIG_TRACE && NETWORK_STACK_BENCHMARK
 #define TRACE_N_BM 1
 #endif // CONFIG_TRACE && NETWORK_STACK_BENCHMARK
@@ -66,6 +91,12 @@ void __attribute__ ((noreturn)) dispatch(struct dcb *dcb)
         wait_for_interrupt();
     }
 
+    if (kernel_schedstat != NULL) {
+        schedstat_dispatch(dcb_current != dcb, dcb->runnable_since,
+                           systime_now());
+    }
+    dcb->runnable_since = 0;
+
     // Don't context switch if we are current already
     if (dcb_current != dcb) {
 
@@ -53,12 +53,17 @@ struct dcb {
 
     struct dcb          *next;          ///< Next DCB in schedule
     struct dcb          *prev;          ///< Previous DCB in schedule
-                                        /// (only valid iff CONFIG_SCHEDULER_RR)
+    systime_t           runnable_since; ///< When made runnable, 0 once dispatched
 #if defined(CONFIG_SCHEDULER_RBED)
     systime_t          release_time, etime, last_dispatch;
     systime_t          wcet, period, deadline;
     unsigned short      weight;
     enum task_type      type;
+    struct dcb          *heap_child;    ///< First child in run queue heap
+    struct dcb          *heap_next;     ///< Next sibling in run queue heap
+    struct dcb          *heap_prev;     ///< Previous sibling or parent
+    uint64_t            queue_seq;      ///< Order of insertion into run queue
+    bool                released;       ///< In released or unreleased heap?
 #endif
 };
 
@@ -57,6 +57,8 @@ struct kcb {
     struct dcb *ring_current;
     /// RBED scheduler state
     struct dcb *queue_head, *queue_tail;
+    struct dcb *released, *unreleased;
+    uint64_t queue_seq, queue_len;
     unsigned int u_hrt, u_srt, w_be, n_be;
     /// current time since kernel start in timeslices. This is necessary to
     /// make the scheduler work correctly
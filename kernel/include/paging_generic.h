@@ -15,6 +15,7 @@
 #ifndef PAGING_H
 #define PAGING_H
 
+#include <stdbool.h>
 #include <barrelfish/types.h>
 #include <errors/errno.h>
 
@@ -32,4 +33,8 @@ errval_t compile_vaddr(struct cte *ptable, size_t entry, genvaddr_t *retvaddr);
 errval_t unmap_capability(struct cte *mem);
 errval_t paging_tlb_flush_range(struct cte *frame, size_t offset, size_t pages);
 
+void paging_tlb_flush_batch_begin(void);
+bool paging_tlb_flush_batched(void);
+void paging_tlb_flush_batch_end(void);
+
 #endif // PAGING_H
@@ -0,0 +1,164 @@
+/**
+ * \file
+ * \brief Scheduler statistics
+ *
+ * The counters are only maintained once the monitor has handed the kernel a
+ * frame to keep them in, see schedstat_setup().
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#ifndef KERNEL_SCHEDSTAT_H
+#define KERNEL_SCHEDSTAT_H
+
+#include <kernel.h>
+#include <barrelfish_kpi/schedstat.h>
+
+/// Statistics of this core, NULL until set up by the monitor
+extern struct sched_stats *kernel_schedstat;
+
+void schedstat_setup(lvaddr_t base);
+
+/*
+ * Readers on other cores rely on the stores to seq and the counters becoming
+ * visible in program order, which holds on x86. Only x86_64 kernels set up
+ * the statistics frame so far.
+ */
+static inline void schedstat_begin(struct sched_stats *s)
+{
+    s->seq++;
+    __asm volatile("" ::: "memory");
+}
+
+static inline void schedstat_end(struct sched_stats *s)
+{
+    __asm volatile("" ::: "memory");
+    s->seq++;
+}
+
+static inline void schedstat_hist_add(struct schedstat_hist *h, uint64_t v,
+                                      unsigned int bucket)
+{
+    if (bucket >= SCHEDSTAT_HIST_BUCKETS) {
+        bucket = SCHEDSTAT_HIST_BUCKETS - 1;
+    }
+    h->bucket[bucket]++;
+    h->count++;
+    h->sum += v;
+    if (v > h->max) {
+        h->max = v;
+    }
+}
+
+static inline void schedstat_hist_add_log2(struct schedstat_hist *h,
+                                           uint64_t v)
+{
+    schedstat_hist_add(h, v, v == 0 ? 0 : 63 - __builtin_clzll(v));
+}
+
+/**
+ * \brief Account for an invocation of the scheduler
+ *
+ * \param runq_len      Number of runnable DCBs
+ * \param idle          Nothing to dispatch
+ * \param preempted     The current DCB is switched away from while runnable
+ */
+static inline void schedstat_schedule(size_t runq_len, bool idle,
+                                      bool preempted)
+{
+    struct sched_stats *s = kernel_schedstat;
+    if (s == NULL) {
+        return;
+    }
+
+    schedstat_begin(s);
+    s->schedules++;
+    if (idle) {
+        s->idle++;
+    }
+    if (preempted) {
+        s->preemptions++;
+    }
+    s->runq_len = runq_len;
+    schedstat_hist_add(&s->runq, runq_len, runq_len);
+    schedstat_end(s);
+}
+
+/**
+ * \brief Account for the slack of a real-time DCB selected to run
+ *
+ * \param slack Time left until its deadline after its remaining budget
+ */
+static inline void schedstat_slack(int64_t slack)
+{
+    struct sched_stats *s = kernel_schedstat;
+    if (s == NULL) {
+        return;
+    }
+
+    schedstat_begin(s);
+    if (slack < 0) {
+        s->slack_overruns++;
+    } else {
+        schedstat_hist_add_log2(&s->slack, slack);
+    }
+    schedstat_end(s);
+}
+
+static inline void schedstat_wakeup(void)
+{
+    struct sched_stats *s = kernel_schedstat;
+    if (s == NULL) {
+        return;
+    }
+
+    schedstat_begin(s);
+    s->wakeups++;
+    schedstat_end(s);
+}
+
+static inline void schedstat_yield(void)
+{
+    struct sched_stats *s = kernel_schedstat;
+    if (s == NULL) {
+        return;
+    }
+
+    schedstat_begin(s);
+    s->yields++;
+    schedstat_end(s);
+}
+
+/**
+ * \brief Account for a dispatch
+ *
+ * \param switched      Another DCB than the current one is dispatched
+ * \param wakeup_time   When the DCB was made runnable, 0 if it ran since
+ * \param now           Current system time
+ */
+static inline void schedstat_dispatch(bool switched, systime_t wakeup_time,
+                                      systime_t now)
+{
+    struct sched_stats *s = kernel_schedstat;
+    if (s == NULL) {
+        return;
+    }
+
+    schedstat_begin(s);
+    if (switched) {
+        s->context_switches++;
+    }
+    if (wakeup_time != 0 && now >= wakeup_time) {
+        schedstat_hist_add_log2(&s->wakeup_latency, now - wakeup_time);
+    }
+    schedstat_end(s);
+}
+
+#endif // KERNEL_SCHEDSTAT_H
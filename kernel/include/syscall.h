@@ -56,7 +56,16 @@ sys_copy_or_mint(struct capability *root, capaddr_t dest_cspace_cptr,
                  source_croot_ptr, capaddr_t source_cptr,
                  uint8_t destcn_level, uint8_t source_level,
                  uintptr_t param1, uintptr_t param2, bool mint);
+struct sysret
+sys_copy_or_mint_range(struct capability *root, capaddr_t dest_cspace_cptr,
+                       capaddr_t destcn_cptr, cslot_t dest_slot,
+                       capaddr_t source_croot_ptr, capaddr_t sourcecn_cptr,
+                       cslot_t source_slot, uint8_t destcn_level,
+                       uint8_t sourcecn_level, size_t count,
+                       uintptr_t param1, uintptr_t param2, bool mint);
 struct sysret sys_delete(struct capability *root, capaddr_t cptr, uint8_t level);
+struct sysret sys_delete_range(struct capability *root, capaddr_t cn_cptr,
+                               uint8_t cn_level, cslot_t slot, size_t count);
 struct sysret sys_revoke(struct capability *root, capaddr_t cptr, uint8_t level);
 struct sysret sys_get_state(struct capability *root, capaddr_t cptr, uint8_t level);
 struct sysret sys_get_size_l1cnode(struct capability *root);
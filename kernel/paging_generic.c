@@ -294,6 +294,46 @@ delete_mapping:
     return SYS_ERR_OK;
 }
 
+/*
+ * Batched VNode invocations unmap or change the flags of many mappings in one
+ * go. While a batch is open, page_mappings_unmap() and
+ * page_mappings_modify_flags() note the TLB flush they owe instead of doing
+ * it, and the batch ends with a single full flush.
+ */
+static bool tlb_flush_batch_open = false;
+static bool tlb_flush_batch_pending = false;
+
+void paging_tlb_flush_batch_begin(void)
+{
+    assert(!tlb_flush_batch_open);
+    tlb_flush_batch_open = true;
+    tlb_flush_batch_pending = false;
+}
+
+/**
+ * \brief Defer a full TLB flush to the end of the open batch, if any
+ *
+ * \return true if the flush was deferred and the caller must not flush
+ */
+bool paging_tlb_flush_batched(void)
+{
+    if (tlb_flush_batch_open) {
+        tlb_flush_batch_pending = true;
+        return true;
+    }
+    return false;
+}
+
+void paging_tlb_flush_batch_end(void)
+{
+    assert(tlb_flush_batch_open);
+    tlb_flush_batch_open = false;
+    if (tlb_flush_batch_pending) {
+        tlb_flush_batch_pending = false;
+        do_full_tlb_flush();
+    }
+}
+
 errval_t page_mappings_unmap(struct capability *pgtable, struct cte *mapping)
 {
     assert(type_is_vnode(pgtable->type));
@@ -338,7 +378,7 @@ errval_t page_mappings_unmap(struct capability *pgtable, struct cte *mapping)
     // flush TLB for unmapped pages if we got a valid virtual address
     // TODO: heuristic that decides if selective or full flush is more
     //       efficient?
-    if (tlb_flush_necessary) {
+    if (tlb_flush_necessary && !paging_tlb_flush_batched()) {
         if (info->pte_count > 1 || err_is_fail(err)) {
             do_full_tlb_flush();
         } else {
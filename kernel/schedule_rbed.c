@@ -60,6 +60,7 @@
 #       include <trace_definitions/trace_defs.h>
 #       include <timer.h> // update_sched_timer
 #       include <kcb.h>
+#       include <schedstat.h>
 #include <systime.h>
 #endif
 
@@ -79,6 +80,9 @@ struct dcb *queue_tail = NULL;
 /// Last (currently) scheduled task, for accounting purposes
 static struct dcb *lastdisp = NULL;
 
+/// Task that yielded since the last schedule, for statistics
+static struct dcb *yielded = NULL;
+
 /**
  * \brief Returns whether dcb is in scheduling queue.
  * \param dcb   Pointer to DCB to check.
@@ -108,51 +112,197 @@ static inline systime_t deadline(struct dcb *dcb)
     return dcb->release_time + dcb->deadline;
 }
 
-static void queue_insert(struct dcb *dcb)
+/*
+ * The run queue
+ *
+ * All queued DCBs are on an unordered list from queue_head to queue_tail,
+ * linked by ->next and ->prev. This is what in_queue() and the LRPC fast path
+ * check. For scheduling, every queued DCB is also in one of two pairing heaps:
+ * kcb_current->released holds the tasks whose release time has passed, in
+ * EDF order, and kcb_current->unreleased holds the tasks released in the
+ * future, ordered by release time. Tasks move from the second to the first as
+ * time passes, so schedule() never has to walk past unreleased tasks and
+ * insertion takes constant time.
+ */
+
+typedef bool (*heap_before_fn)(struct dcb *a, struct dcb *b);
+
+/**
+ * \brief Returns whether 'a' is scheduled before 'b'.
+ *
+ * This keeps the order of the former sorted run queue, where a task was
+ * inserted at the tail of a train of tasks with equal deadlines, as well as
+ * equal release times for best-effort tasks, so that trains of best-effort
+ * tasks with equal deadlines (and those released at the same time) get
+ * scheduled in a round-robin fashion. The release time check is important,
+ * as best-effort tasks have lazily allocated deadlines. In some
+ * circumstances (like when another task blocks), this might otherwise cause
+ * a wrong yielding behavior when old deadlines are encountered.
+ */
+static bool edf_before(struct dcb *a, struct dcb *b)
 {
-    // Empty queue case
-    if(kcb_current->queue_head == NULL) {
-        assert(kcb_current->queue_tail == NULL);
-        kcb_current->queue_head = kcb_current->queue_tail = queue_tail = dcb;
-        return;
+    struct dcb *newer = a->queue_seq > b->queue_seq ? a : b;
+    struct dcb *older = newer == a ? b : a;
+
+    bool newer_first = deadline(newer) < deadline(older) &&
+        (newer->type != TASK_TYPE_BEST_EFFORT ||
+         newer->release_time < older->release_time);
+
+    return (newer_first ? newer : older) == a;
+}
+
+/**
+ * \brief Returns whether 'a' is released before 'b'.
+ */
+static bool release_before(struct dcb *a, struct dcb *b)
+{
+    return a->release_time < b->release_time ||
+        (a->release_time == b->release_time && a->queue_seq < b->queue_seq);
+}
+
+/// Melds two heaps, given by their roots
+static struct dcb *heap_meld(struct dcb *a, struct dcb *b,
+                             heap_before_fn before)
+{
+    if(a == NULL) {
+        return b;
+    }
+    if(b == NULL) {
+        return a;
+    }
+    if(before(b, a)) {
+        struct dcb *tmp = a;
+        a = b;
+        b = tmp;
     }
 
-    /* Insert into priority queue (this is doing EDF). We insert at
-     * the tail of a train of tasks with equal deadlines, as well as
-     * equal release times for best-effort tasks, so that trains of
-     * best-effort tasks with equal deadlines (and those released at
-     * the same time) get scheduled in a round-robin fashion. The
-     * release time equality check is important, as best-effort tasks
-     * have lazily allocated deadlines. In some circumstances (like
-     * when another task blocks), this might otherwise cause a wrong
-     * yielding behavior when old deadlines are encountered.
-     */
-    struct dcb *prev = NULL;
-    for(struct dcb *i = kcb_current->queue_head; i != NULL; prev = i, i = i->next) {
-        // Skip over equal, smaller release times if best-effort
-        if(dcb->type == TASK_TYPE_BEST_EFFORT &&
-           dcb->release_time >= i->release_time) {
-            continue;
-        }
+    // b becomes the first child of a
+    b->heap_prev = a;
+    b->heap_next = a->heap_child;
+    if(a->heap_child != NULL) {
+        a->heap_child->heap_prev = b;
+    }
+    a->heap_child = b;
+
+    return a;
+}
+
+/// Melds a list of sibling heaps into one, using the two-pass method
+static struct dcb *heap_meld_siblings(struct dcb *first, heap_before_fn before)
+{
+    struct dcb *pairs = NULL;
+
+    // Meld pairs from left to right, keep the results on a stack
+    while(first != NULL) {
+        struct dcb *a = first, *b = first->heap_next;
+        first = b != NULL ? b->heap_next : NULL;
 
-        // Skip over equal deadlines
-        if(deadline(dcb) >= deadline(i)) {
-            continue;
+        a->heap_next = a->heap_prev = NULL;
+        if(b != NULL) {
+            b->heap_next = b->heap_prev = NULL;
         }
 
-        dcb->next = i;
-        if(prev == NULL) {      // Insert before head
-            kcb_current->queue_head = dcb;
-        } else {                // Insert inside queue
-            prev->next = dcb;
+        a = heap_meld(a, b, before);
+        a->heap_next = pairs;
+        pairs = a;
+    }
+
+    // Meld the results from right to left
+    struct dcb *root = NULL;
+    while(pairs != NULL) {
+        struct dcb *next = pairs->heap_next;
+        pairs->heap_next = NULL;
+        root = heap_meld(pairs, root, before);
+        pairs = next;
+    }
+
+    return root;
+}
+
+static void heap_insert(struct dcb **root, struct dcb *dcb,
+                        heap_before_fn before)
+{
+    dcb->heap_child = dcb->heap_next = dcb->heap_prev = NULL;
+    *root = heap_meld(*root, dcb, before);
+}
+
+static void heap_remove(struct dcb **root, struct dcb *dcb,
+                        heap_before_fn before)
+{
+    struct dcb *children = heap_meld_siblings(dcb->heap_child, before);
+
+    if(dcb == *root) {
+        *root = children;
+    } else {
+        // Cut dcb out of its parent's list of children
+        if(dcb->heap_prev->heap_child == dcb) {
+            dcb->heap_prev->heap_child = dcb->heap_next;
+        } else {
+            dcb->heap_prev->heap_next = dcb->heap_next;
+        }
+        if(dcb->heap_next != NULL) {
+            dcb->heap_next->heap_prev = dcb->heap_prev;
         }
+        *root = heap_meld(*root, children, before);
+    }
 
-        return;
+    dcb->heap_child = dcb->heap_next = dcb->heap_prev = NULL;
+}
+
+/// Puts a queued DCB into the heap matching its release time
+static void queue_sort_in(struct kcb *k, struct dcb *dcb, systime_t now)
+{
+    dcb->released = dcb->release_time <= now;
+    if(dcb->released) {
+        heap_insert(&k->released, dcb, edf_before);
+    } else {
+        heap_insert(&k->unreleased, dcb, release_before);
+    }
+}
+
+/// Takes a queued DCB out of its heap
+static void queue_sort_out(struct kcb *k, struct dcb *dcb)
+{
+    if(dcb->released) {
+        heap_remove(&k->released, dcb, edf_before);
+    } else {
+        heap_remove(&k->unreleased, dcb, release_before);
+    }
+}
+
+/**
+ * \brief Moves all tasks released by 'now' into the EDF heap.
+ */
+static void queue_release(systime_t now)
+{
+    struct kcb *k = kcb_current;
+
+    while(k->unreleased != NULL && k->unreleased->release_time <= now) {
+        struct dcb *dcb = k->unreleased;
+        heap_remove(&k->unreleased, dcb, release_before);
+        dcb->released = true;
+        heap_insert(&k->released, dcb, edf_before);
+    }
+}
+
+static void queue_insert(struct dcb *dcb)
+{
+    struct kcb *k = kcb_current;
+
+    // Append to list of queued tasks
+    dcb->next = NULL;
+    dcb->prev = k->queue_tail;
+    if(k->queue_tail != NULL) {
+        k->queue_tail->next = dcb;
+    } else {
+        assert(k->queue_head == NULL);
+        k->queue_head = dcb;
     }
+    k->queue_tail = queue_tail = dcb;
+    k->queue_len++;
 
-    // Insert after queue tail
-    kcb_current->queue_tail->next = dcb;
-    kcb_current->queue_tail = queue_tail = dcb;
+    dcb->queue_seq = k->queue_seq++;
+    queue_sort_in(k, dcb, systime_now());
 }
 
 /**
@@ -166,32 +316,28 @@ static void queue_insert(struct dcb *dcb)
  */
 static void queue_remove(struct dcb *dcb)
 {
+    struct kcb *k = kcb_current;
+
     // No-op if not in scheduler ring
     if(!in_queue(dcb)) {
         return;
     }
 
-    if(dcb == kcb_current->queue_head) {
-        kcb_current->queue_head = dcb->next;
-        if(kcb_current->queue_head == NULL) {
-            kcb_current->queue_tail = queue_tail =  NULL;
-        }
+    queue_sort_out(k, dcb);
 
-        goto out;
+    if(dcb->prev != NULL) {
+        dcb->prev->next = dcb->next;
+    } else {
+        k->queue_head = dcb->next;
     }
-
-    for(struct dcb *i = kcb_current->queue_head; i != NULL; i = i->next) {
-        if(i->next == dcb) {
-            i->next = i->next->next;
-            if(kcb_current->queue_tail == dcb) {
-                kcb_current->queue_tail = queue_tail = i;
-            }
-            break;
-        }
+    if(dcb->next != NULL) {
+        dcb->next->prev = dcb->prev;
+    } else {
+        k->queue_tail = queue_tail = dcb->prev;
     }
+    k->queue_len--;
 
- out:
-    dcb->next = NULL;
+    dcb->next = dcb->prev = NULL;
 }
 
 #if 0
@@ -310,42 +456,24 @@ struct dcb *schedule(void)
     }
 
  start_over:
-    todisp = kcb_current->queue_head;
-
-#ifndef SCHEDULER_SIMULATOR
-#define PRINT_NAME(d) \
-    do { \
-        if (!(d) || !(d)->disp) { \
-            debug(SUBSYS_DISPATCH, "todisp == NULL\n"); \
-            break; \
-        } \
-        struct dispatcher_shared_generic *dst = \
-            get_dispatcher_shared_generic(d->disp); \
-        debug(SUBSYS_DISPATCH, "looking at '%s', release_time=%lu, kernel_now=%zu\n", \
-                dst->name, d->release_time, now); \
-    }while(0)
-#else
-#define PRINT_NAME(d) do{}while(0)
-#endif
-
-    // Skip over all tasks released in the future, they're technically not
-    // in the schedule yet. We just have them to reduce book-keeping.
-    while(todisp != NULL && todisp->release_time > now) {
-        PRINT_NAME(todisp);
-        todisp = todisp->next;
-    }
-#undef PRINT_NAME
+    // Tasks released in the future are technically not in the schedule yet
+    queue_release(now);
+    todisp = kcb_current->released;
 
     // nothing to dispatch
     if(todisp == NULL) {
 #ifndef SCHEDULER_SIMULATOR
         debug(SUBSYS_DISPATCH, "schedule: no dcb runnable\n");
 #endif
+        schedstat_schedule(kcb_current->queue_len, true, false);
         lastdisp = NULL;
+        yielded = NULL;
         return NULL;
     }
 
-    // Lazy resource allocation for best-effort processes
+    // Lazy resource allocation for best-effort processes. This changes the
+    // deadline of the heap's root, which deliberately stays the root until it
+    // is re-queued, like the head of the former sorted run queue.
     if(todisp->type == TASK_TYPE_BEST_EFFORT) {
         set_best_effort_wcet(todisp);
 
@@ -372,9 +500,16 @@ struct dcb *schedule(void)
     if(todisp->etime < todisp->wcet) {
         todisp->last_dispatch = now;
 
+        if(todisp->type != TASK_TYPE_BEST_EFFORT) {
+            schedstat_slack((int64_t)(deadline(todisp) - now)
+                            - (int64_t)(todisp->wcet - todisp->etime));
+        }
+
         // If nothing changed, run whatever ran last (task might have
         // yielded to another), unless it is blocked
         if(lastdisp == todisp && dcb_current != NULL && in_queue(dcb_current)) {
+            schedstat_schedule(kcb_current->queue_len, false, false);
+            yielded = NULL;
             /* trace_event(TRACE_SUBSYS_KERNEL, TRACE_EVENT_KERNEL_SCHED_CURRENT, */
             /*             (uint32_t)(lvaddr_t)dcb_current & 0xFFFFFFFF); */
             return dcb_current;
@@ -383,6 +518,14 @@ struct dcb *schedule(void)
         /* trace_event(TRACE_SUBSYS_KERNEL, TRACE_EVENT_KERNEL_SCHED_SCHEDULE, */
         /*             (uint32_t)(lvaddr_t)todisp & 0xFFFFFFFF); */
 
+        // Runnable tasks we switch away from without them yielding were
+        // preempted, either by a task with an earlier deadline or because
+        // they used up their budget
+        schedstat_schedule(kcb_current->queue_len, false,
+                           dcb_current != NULL && dcb_current != todisp &&
+                           dcb_current != yielded && in_queue(dcb_current));
+        yielded = NULL;
+
         // Remember who we run next
         lastdisp = todisp;
         #ifdef CONFIG_ONESHOT_TIMER
@@ -426,10 +569,21 @@ struct dcb *schedule(void)
 void schedule_now(struct dcb *dcb)
 {
     systime_t now = systime_now();
+
+    // The heaps are ordered by the fields we change
+    bool queued = in_queue(dcb);
+    if (queued) {
+        queue_sort_out(kcb_current, dcb);
+    }
+
     if (dcb->release_time >= now) {
         dcb->release_time = now;
     }
     dcb->deadline = 1;
+
+    if (queued) {
+        queue_sort_in(kcb_current, dcb, now);
+    }
 }
 
 void make_runnable(struct dcb *dcb)
@@ -443,6 +597,7 @@ void make_runnable(struct dcb *dcb)
 
     trace_event(TRACE_SUBSYS_KERNEL, TRACE_EVENT_KERNEL_SCHED_MAKE_RUNNABLE,
                 (uint32_t)(lvaddr_t)dcb & 0xFFFFFFFF);
+    schedstat_wakeup();
 
     // Keep counters up to date
     switch(dcb->type) {
@@ -488,6 +643,7 @@ void make_runnable(struct dcb *dcb)
     }
     /* assert(dcb->release_time >= kernel_now); */
     dcb->etime = 0;
+    dcb->runnable_since = now;
     queue_insert(dcb);
 }
 
@@ -565,6 +721,8 @@ void scheduler_yield(struct dcb *dcb)
     }
     dcb->etime = 0;
     lastdisp = NULL;    // Don't account for us anymore
+    yielded = dcb;
+    schedstat_yield();
     queue_insert(dcb);
 }
 
@@ -577,10 +735,12 @@ void scheduler_reset_time(void)
     struct kcb *k = kcb_current;
     do {
         printk(LOG_NOTE, "clearing kcb %p\n", k);
+        k->released = k->unreleased = NULL;
         for(struct dcb *i = k->queue_head; i != NULL; i = i->next) {
             i->release_time = 0;
             i->etime = 0;
             i->last_dispatch = 0;
+            queue_sort_in(k, i, 0);
         }
         k = k->next;
     }while(k && k!=kcb_current);
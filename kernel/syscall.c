@@ -419,6 +419,157 @@ sys_copy_or_mint(struct capability *root, capaddr_t dest_cspace_cptr,
     }
 }
 
+/**
+ * \brief Look up a range of slots in a CNode
+ *
+ * \param cspace_root   Cspace root cnode in which to look up the CNode
+ * \param cnode_cptr    CNode cptr relative to cspace_root
+ * \param cnode_level   Level/depth of CNode
+ * \param slot          First slot of the range
+ * \param count         Number of slots in the range
+ * \param rights        Rights required on the CNode
+ * \param ret           Returns the CNode's cte
+ */
+static errval_t lookup_slot_range(struct capability *cspace_root,
+                                  capaddr_t cnode_cptr, uint8_t cnode_level,
+                                  cslot_t slot, size_t count,
+                                  CapRights rights, struct cte **ret)
+{
+    errval_t err;
+    struct cte *cnode;
+
+    err = caps_lookup_slot(cspace_root, cnode_cptr, cnode_level, &cnode,
+                           rights);
+    if (err_is_fail(err)) {
+        return err;
+    }
+    if (cnode->cap.type != ObjType_L1CNode &&
+        cnode->cap.type != ObjType_L2CNode) {
+        return SYS_ERR_CNODE_TYPE;
+    }
+    /* the slots are accessed through the CNode itself */
+    if ((cnode->cap.rights & rights) != rights) {
+        return SYS_ERR_CNODE_RIGHTS;
+    }
+    if (slot + count > cnode_get_slots(&cnode->cap)) {
+        return SYS_ERR_SLOTS_INVALID;
+    }
+
+    *ret = cnode;
+    return SYS_ERR_OK;
+}
+
+/**
+ * \brief Copy or mint a range of capabilities
+ *
+ * Copies the capabilities in `count` consecutive slots of the source CNode to
+ * the same number of consecutive slots of the destination CNode. Empty source
+ * slots are skipped, all destination slots must be empty. The ranges may not
+ * overlap. On failure, the return value holds the number of slots processed
+ * before the failing one.
+ *
+ * \param root              Source cspace root cnode
+ * \param dest_cspace_cptr  Destination cspace root cnode cptr in source cspace
+ * \param destcn_cptr       Destination cnode cptr relative to destination cspace
+ * \param dest_slot         First destination slot
+ * \param source_croot_ptr  Source cspace root cnode cptr in source cspace
+ * \param sourcecn_cptr     Source cnode cptr relative to source cspace
+ * \param source_slot       First source slot
+ * \param destcn_level      Level/depth of destination cnode
+ * \param sourcecn_level    Level/depth of source cnode
+ * \param count             Number of slots to copy
+ * \param param1            First parameter for mint
+ * \param param2            Second parameter for mint
+ * \param mint              Call is a minting operation
+ */
+struct sysret
+sys_copy_or_mint_range(struct capability *root, capaddr_t dest_cspace_cptr,
+                       capaddr_t destcn_cptr, cslot_t dest_slot,
+                       capaddr_t source_croot_ptr, capaddr_t sourcecn_cptr,
+                       cslot_t source_slot, uint8_t destcn_level,
+                       uint8_t sourcecn_level, size_t count,
+                       uintptr_t param1, uintptr_t param2, bool mint)
+{
+    errval_t err;
+
+    if (!mint) {
+        param1 = param2 = 0;
+    }
+
+    if (root->type != ObjType_L1CNode) {
+        return SYSRET(SYS_ERR_CNODE_NOT_ROOT);
+    }
+    if (count > CNODE_RANGE_MAX_COUNT) {
+        return SYSRET(SYS_ERR_SLOTS_INVALID);
+    }
+
+    /* Lookup source cspace and cnode */
+    struct capability *src_croot;
+    err = caps_lookup_cap(root, source_croot_ptr, 2, &src_croot,
+                          CAPRIGHTS_READ);
+    if (err_is_fail(err)) {
+        return SYSRET(err_push(err, SYS_ERR_SOURCE_ROOTCN_LOOKUP));
+    }
+    if (src_croot->type != ObjType_L1CNode) {
+        return SYSRET(SYS_ERR_CNODE_NOT_ROOT);
+    }
+    struct cte *src_cnode;
+    err = lookup_slot_range(src_croot, sourcecn_cptr, sourcecn_level,
+                            source_slot, count, CAPRIGHTS_READ, &src_cnode);
+    if (err_is_fail(err)) {
+        return SYSRET(err_push(err, SYS_ERR_SOURCE_CAP_LOOKUP));
+    }
+
+    /* Lookup destination cspace and cnode */
+    struct capability *dest_cspace_root;
+    err = caps_lookup_cap(root, dest_cspace_cptr, 2, &dest_cspace_root,
+                          CAPRIGHTS_READ);
+    if (err_is_fail(err)) {
+        return SYSRET(err_push(err, SYS_ERR_DEST_ROOTCN_LOOKUP));
+    }
+    if (dest_cspace_root->type != ObjType_L1CNode) {
+        return SYSRET(SYS_ERR_CNODE_TYPE);
+    }
+    struct cte *dest_cnode;
+    err = lookup_slot_range(dest_cspace_root, destcn_cptr, destcn_level,
+                            dest_slot, count, CAPRIGHTS_READ_WRITE,
+                            &dest_cnode);
+    if (err_is_fail(err)) {
+        return SYSRET(err_push(err, SYS_ERR_DEST_CNODE_LOOKUP));
+    }
+
+    /* Ranges within the same cnode must not overlap */
+    if (get_address(&src_cnode->cap) == get_address(&dest_cnode->cap) &&
+        source_slot < dest_slot + count && dest_slot < source_slot + count) {
+        return SYSRET(SYS_ERR_SLOTS_INVALID);
+    }
+
+    /* Check that destination slots are all empty */
+    lpaddr_t src_base = get_address(&src_cnode->cap);
+    lpaddr_t dest_base = get_address(&dest_cnode->cap);
+    for (cslot_t i = 0; i < count; i++) {
+        if (caps_locate_slot(dest_base, dest_slot + i)->cap.type
+            != ObjType_Null) {
+            return SYSRET(SYS_ERR_SLOTS_IN_USE);
+        }
+    }
+
+    /* Perform copies */
+    for (cslot_t i = 0; i < count; i++) {
+        struct cte *src_cap = caps_locate_slot(src_base, source_slot + i);
+        if (src_cap->cap.type == ObjType_Null) {
+            continue;
+        }
+        err = caps_copy_to_cnode(dest_cnode, dest_slot + i, src_cap, mint,
+                                 param1, param2);
+        if (err_is_fail(err)) {
+            return (struct sysret) { .error = err, .value = i };
+        }
+    }
+
+    return (struct sysret) { .error = SYS_ERR_OK, .value = count };
+}
+
 struct sysret
 sys_map(struct capability *ptable, cslot_t slot, capaddr_t source_root_cptr,
         capaddr_t source_cptr, uint8_t source_level, uintptr_t flags,
@@ -544,6 +695,51 @@ struct sysret sys_delete(struct capability *root, capaddr_t cptr, uint8_t level)
     return SYSRET(err);
 }
 
+/**
+ * \brief Delete a range of capabilities
+ *
+ * Deletes the capabilities in `count` consecutive slots of a CNode, skipping
+ * empty slots. Stops at the first capability that cannot be deleted, e.g.
+ * because the delete has to go through the monitor. The return value then
+ * holds the number of slots processed before that one.
+ *
+ * \param root      Cspace root cnode
+ * \param cn_cptr   CNode cptr relative to root
+ * \param cn_level  Level/depth of CNode
+ * \param slot      First slot to delete
+ * \param count     Number of slots to delete
+ */
+struct sysret sys_delete_range(struct capability *root, capaddr_t cn_cptr,
+                               uint8_t cn_level, cslot_t slot, size_t count)
+{
+    errval_t err;
+    struct cte *cnode;
+
+    if (count > CNODE_RANGE_MAX_COUNT) {
+        return SYSRET(SYS_ERR_SLOTS_INVALID);
+    }
+
+    err = lookup_slot_range(root, cn_cptr, cn_level, slot, count,
+                            CAPRIGHTS_READ_WRITE, &cnode);
+    if (err_is_fail(err)) {
+        return SYSRET(err);
+    }
+
+    lpaddr_t base = get_address(&cnode->cap);
+    for (cslot_t i = 0; i < count; i++) {
+        struct cte *cte = caps_locate_slot(base, slot + i);
+        if (cte->cap.type == ObjType_Null) {
+            continue;
+        }
+        err = caps_delete(cte);
+        if (err_is_fail(err)) {
+            return (struct sysret) { .error = err, .value = i };
+        }
+    }
+
+    return (struct sysret) { .error = SYS_ERR_OK, .value = count };
+}
+
 struct sysret sys_revoke(struct capability *root, capaddr_t cptr, uint8_t level)
 {
     errval_t err;
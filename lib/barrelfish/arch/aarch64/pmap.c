@@ -186,7 +186,7 @@ static errval_t alloc_vnode(struct pmap_aarch64 *pmap_aarch64, struct vnode *roo
     newvnode->v.is_vnode  = true;
     newvnode->v.entry     = entry;
     pmap_vnode_init(&pmap_aarch64->p, newvnode);
-    pmap_vnode_insert_child(root, newvnode);
+    pmap_vnode_insert_child(&pmap_aarch64->p, root, newvnode);
 
 #ifdef GLOBAL_MCN
     /* allocate mapping cnodes */
@@ -298,7 +298,7 @@ static errval_t do_single_map(struct pmap_aarch64 *pmap, genvaddr_t vaddr, genva
     page->v.u.frame.pte_count = pte_count;
 
     // only insert child in vtree after new vnode fully initialized
-    pmap_vnode_insert_child(ptable, page);
+    pmap_vnode_insert_child(&pmap->p, ptable, page);
 
     set_mapping_cap(&pmap->p, page, ptable, idx);
 
@@ -470,7 +470,7 @@ static errval_t do_single_unmap(struct pmap_aarch64 *pmap, genvaddr_t vaddr,
                         err_getstring(err));
             }
 #endif
-            pmap_remove_vnode(pt, page);
+            pmap_remove_vnode(&pmap->p, pt, page);
             slab_free(&pmap->p.m.slab, page);
         }
         else {
@@ -154,7 +154,7 @@ errval_t alloc_vnode(struct pmap_x86 *pmap, struct vnode *root,
     newvnode->v.entry     = entry;
     newvnode->v.type      = type;
     pmap_vnode_init(&pmap->p, newvnode);
-    pmap_vnode_insert_child(root, newvnode);
+    pmap_vnode_insert_child(&pmap->p, root, newvnode);
     newvnode->u.vnode.virt_base = 0;
     newvnode->u.vnode.page_table_frame  = NULL_CAP;
     newvnode->u.vnode.base = base;
@@ -240,7 +240,7 @@ void remove_empty_vnodes(struct pmap_x86 *pmap, struct vnode *root,
             pmap->used_cap_slots --;
 
             // remove vnode from list
-            pmap_remove_vnode(root, n);
+            pmap_remove_vnode(&pmap->p, root, n);
 
 #if GLOBAL_MCN
             /* delete mapping cap cnodes */
@@ -335,16 +335,15 @@ errval_t pmap_x86_measure_res(struct pmap *pmap, struct pmap_res_info *buf)
     assert(buf);
     struct pmap_x86 *x86 = (struct pmap_x86 *)pmap;
 
-    size_t free_slabs = 0;
-    size_t used_slabs = 0;
     // Count allocated and free slabs in bytes; this accounts for all vnodes
-    for (struct slab_head *sh = pmap->m.slab.slabs; sh != NULL; sh = sh->next) {
-        free_slabs += sh->free;
-        used_slabs += sh->total - sh->free;
-    }
+    size_t free_slabs = slab_freecount(&pmap->m.slab);
+    size_t used_slabs = slab_totalcount(&pmap->m.slab) - free_slabs;
     buf->vnode_used = used_slabs * pmap->m.slab.blocksize;
     buf->vnode_free = free_slabs * pmap->m.slab.blocksize;
 
+    // Add the memory of the child lookup structures
+    pmap_ds_measure_res(pmap, buf);
+
     // Report capability slots in use by pmap
     buf->slots_used = x86->used_cap_slots;
 
@@ -259,10 +259,162 @@ size_t ALL_THE_VNODES_MAX_ENTRIES = (15*4096);
 struct vnode **ALL_THE_VNODES = NULL;
 size_t all_the_vnodes_cnt = 0;
 
+/**
+ * \brief Leaf table operations of a map, unmap or modify_flags call that
+ * spans several leaf tables.
+ *
+ * Rather than invoking every leaf table (or mapping cap) on its own, the
+ * operations are collected and issued as one batched invocation on the root
+ * page table per VNODE_BATCH_MAX leaf tables.
+ */
+struct pmap_batch {
+    enum vnode_cmd cmd;     ///< VNodeCmd_{Map,Unmap,ModifyFlags}Batch
+    size_t count;
+    struct vnode_batch_entry e[VNODE_BATCH_MAX];
+    struct vnode *ptable[VNODE_BATCH_MAX];
+    struct vnode *page[VNODE_BATCH_MAX];
+    struct capref frame;            ///< frame to map (map)
+    paging_x86_64_flags_t flags;    ///< new flags (map, modify_flags)
+};
+
+/// Set to 0 to issue one invocation per leaf table, for benchmarking
+int pmap_batch_invocations = 1;
+
+static inline void batch_init(struct pmap_batch *b, enum vnode_cmd cmd)
+{
+    b->cmd = cmd;
+    b->count = 0;
+}
+
+/**
+ * \brief Free a page vnode after its mapping cap has been deleted
+ */
+static void free_page_vnode(struct pmap_x86 *pmap, struct vnode *ptable,
+                            struct vnode *page)
+{
+#ifndef GLOBAL_MCN
+    errval_t err = pmap->p.slot_alloc->free(pmap->p.slot_alloc, page->v.mapping);
+    if (err_is_fail(err)) {
+        debug_printf("remove_empty_vnodes: slot_free (mapping): %s\n",
+                err_getstring(err));
+    }
+#endif
+    assert(pmap->used_cap_slots > 0);
+    pmap->used_cap_slots --;
+    // Free up the resources
+    pmap_remove_vnode(&pmap->p, ptable, page);
+    slab_free(&pmap->p.m.slab, page);
+}
+
+/**
+ * \brief Unmap a page vnode with its own invocations
+ */
+static errval_t unmap_page_vnode(struct pmap_x86 *pmap, struct vnode *ptable,
+                                 struct vnode *page)
+{
+    errval_t err;
+
+    err = vnode_unmap(ptable->v.cap, page->v.mapping);
+    if (err_is_fail(err)) {
+        debug_printf("vnode_unmap returned error: %s (%d)\n",
+                err_getstring(err), err_no(err));
+        return err_push(err, LIB_ERR_VNODE_UNMAP);
+    }
+
+    // delete&free page->v.mapping after doing vnode_unmap()
+    err = cap_delete(page->v.mapping);
+    if (err_is_fail(err)) {
+        return err_push(err, LIB_ERR_CAP_DELETE);
+    }
+
+    free_page_vnode(pmap, ptable, page);
+    return SYS_ERR_OK;
+}
+
+/**
+ * \brief Issue the collected operations of a batch
+ */
+static errval_t batch_flush(struct pmap_x86 *pmap, struct pmap_batch *b)
+{
+    struct capref root = pmap->root.v.u.vnode.invokable;
+    errval_t err = SYS_ERR_OK;
+    size_t done = 0;
+
+    if (b->count == 0) {
+        return SYS_ERR_OK;
+    }
+
+    switch (b->cmd) {
+    case VNodeCmd_MapBatch:
+        err = invoke_vnode_map_batch(root, b->e, b->count,
+                                     get_croot_addr(b->frame),
+                                     get_cap_addr(b->frame),
+                                     get_cap_level(b->frame), b->flags, &done);
+        if (err_is_fail(err)) {
+            err = err_push(err, LIB_ERR_VNODE_MAP);
+        }
+        break;
+
+    case VNodeCmd_UnmapBatch:
+        err = invoke_vnode_unmap_batch(root, b->e, b->count, &done);
+        for (size_t i = 0; i < done; i++) {
+            free_page_vnode(pmap, b->ptable[i], b->page[i]);
+        }
+        // The kernel stops at the first mapping cap it cannot delete on its
+        // own, e.g. because the delete has to go through the monitor. Fall
+        // back to unmapping the rest one by one.
+        if (err_is_fail(err)) {
+            for (size_t i = done; i < b->count; i++) {
+                err = unmap_page_vnode(pmap, b->ptable[i], b->page[i]);
+                if (err_is_fail(err)) {
+                    break;
+                }
+            }
+        }
+        break;
+
+    case VNodeCmd_ModifyFlagsBatch:
+        err = invoke_vnode_modify_flags_batch(root, b->e, b->count, b->flags,
+                                              &done);
+        break;
+
+    default:
+        USER_PANIC("unknown batch command %d", b->cmd);
+    }
+
+    b->count = 0;
+    return err;
+}
+
+/**
+ * \brief Add an operation to a batch, issuing the batch if it is full
+ */
+static errval_t batch_add(struct pmap_x86 *pmap, struct pmap_batch *b,
+                          struct vnode *ptable, struct vnode *page,
+                          struct vnode_batch_entry *e)
+{
+    assert(b->count < VNODE_BATCH_MAX);
+    b->e[b->count] = *e;
+    b->ptable[b->count] = ptable;
+    b->page[b->count] = page;
+    b->count++;
+
+    if (b->count == VNODE_BATCH_MAX) {
+        return batch_flush(pmap, b);
+    }
+    return SYS_ERR_OK;
+}
+
+/**
+ * \brief Map part of a frame into a single leaf table
+ *
+ * If batch is not NULL, the map invocation is added to the batch rather than
+ * issued immediately.
+ */
 static errval_t do_single_map(struct pmap_x86 *pmap, genvaddr_t vaddr,
                               genvaddr_t vend, struct capref frame,
                               size_t offset, size_t pte_count,
-                              vregion_flags_t flags)
+                              vregion_flags_t flags, struct pmap_batch *batch)
 {
     if (pte_count == 0) {
         debug_printf("do_single_map: pte_count == 0, called from %p\n",
@@ -328,7 +480,7 @@ static errval_t do_single_map(struct pmap_x86 *pmap, genvaddr_t vaddr,
     page->u.frame.cloned_count = 0;
 
     // only insert after vnode fully initialized
-    pmap_vnode_insert_child(ptable, page);
+    pmap_vnode_insert_child(&pmap->p, ptable, page);
 
     set_mapping_cap(&pmap->p, page, ptable, table_base);
     pmap->used_cap_slots ++;
@@ -336,6 +488,21 @@ static errval_t do_single_map(struct pmap_x86 *pmap, genvaddr_t vaddr,
     // do map
     assert(!capref_is_null(ptable->v.u.vnode.invokable));
     assert(!capref_is_null(page->v.mapping));
+    if (batch) {
+        assert(get_croot_addr(ptable->v.u.vnode.invokable) == CPTR_ROOTCN);
+        struct vnode_batch_entry e = {
+            .ptable        = get_cap_addr(ptable->v.u.vnode.invokable),
+            .ptable_level  = get_cap_level(ptable->v.u.vnode.invokable),
+            .slot          = table_base,
+            .offset        = offset,
+            .pte_count     = pte_count,
+            .mapping_croot = get_croot_addr(page->v.mapping),
+            .mapping       = get_cnode_addr(page->v.mapping),
+            .mapping_level = get_cnode_level(page->v.mapping),
+            .mapping_slot  = page->v.mapping.slot,
+        };
+        return batch_add(pmap, batch, ptable, page, &e);
+    }
     err = vnode_map(ptable->v.u.vnode.invokable, frame, table_base,
                     pmap_flags, offset, pte_count, page->v.mapping);
     if (err_is_fail(err)) {
@@ -428,23 +595,31 @@ errval_t do_map(struct pmap *pmap_gen, genvaddr_t vaddr,
         if (debug_out) {
             debug_printf("  do_map: fast path: %zd\n", pte_count);
         }
-        err = do_single_map(pmap, vaddr, vend, frame, offset, pte_count, flags);
+        err = do_single_map(pmap, vaddr, vend, frame, offset, pte_count, flags,
+                            NULL);
         if (err_is_fail(err)) {
             trace_event(TRACE_SUBSYS_MEMORY, TRACE_EVENT_MEMORY_DO_MAP, 1);
             return err_push(err, LIB_ERR_PMAP_DO_MAP);
         }
     }
     else { // multiple leaf page tables
+        struct pmap_batch batch, *b = NULL;
+        if (pmap_batch_invocations) {
+            batch_init(&batch, VNodeCmd_MapBatch);
+            batch.frame = frame;
+            batch.flags = vregion_to_pmap_flag(flags);
+            b = &batch;
+        }
+
         // first leaf
         uint32_t c = X86_64_PTABLE_SIZE - table_base;
         if (debug_out) {
             debug_printf("  do_map: slow path: first leaf %"PRIu32"\n", c);
         }
         genvaddr_t temp_end = vaddr + c * page_size;
-        err = do_single_map(pmap, vaddr, temp_end, frame, offset, c, flags);
+        err = do_single_map(pmap, vaddr, temp_end, frame, offset, c, flags, b);
         if (err_is_fail(err)) {
-            trace_event(TRACE_SUBSYS_MEMORY, TRACE_EVENT_MEMORY_DO_MAP, 1);
-            return err_push(err, LIB_ERR_PMAP_DO_MAP);
+            goto out_batch;
         }
 
         // map full leaves
@@ -462,10 +637,9 @@ errval_t do_map(struct pmap *pmap_gen, genvaddr_t vaddr,
                 debug_printf("  do_map: slow path: full leaf\n");
             }
             err = do_single_map(pmap, vaddr, temp_end, frame, offset,
-                    X86_64_PTABLE_SIZE, flags);
+                    X86_64_PTABLE_SIZE, flags, b);
             if (err_is_fail(err)) {
-                trace_event(TRACE_SUBSYS_MEMORY, TRACE_EVENT_MEMORY_DO_MAP, 1);
-                return err_push(err, LIB_ERR_PMAP_DO_MAP);
+                goto out_batch;
             }
         }
 
@@ -482,12 +656,24 @@ errval_t do_map(struct pmap *pmap_gen, genvaddr_t vaddr,
             if (debug_out) {
                 debug_printf("do_map: slow path: last leaf %"PRIu32"\n", c);
             }
-            err = do_single_map(pmap, temp_end, vend, frame, offset, c, flags);
-            if (err_is_fail(err)) {
-                trace_event(TRACE_SUBSYS_MEMORY, TRACE_EVENT_MEMORY_DO_MAP, 1);
-                return err_push(err, LIB_ERR_PMAP_DO_MAP);
+            err = do_single_map(pmap, temp_end, vend, frame, offset, c, flags, b);
+        }
+
+out_batch:
+        // Issue the rest of the batch. On error, this still installs the
+        // leaves we have set up vnodes for, so that a later unmap finds our
+        // vnode tree and the kernel's page tables in agreement.
+        if (b) {
+            if (err_is_ok(err)) {
+                err = batch_flush(pmap, b);
+            } else {
+                batch_flush(pmap, b);
             }
         }
+        if (err_is_fail(err)) {
+            trace_event(TRACE_SUBSYS_MEMORY, TRACE_EVENT_MEMORY_DO_MAP, 1);
+            return err_push(err, LIB_ERR_PMAP_DO_MAP);
+        }
     }
 
     if (retoff) {
@@ -669,10 +855,15 @@ static bool find_mapping(struct pmap_x86 *pmap, genvaddr_t vaddr,
     }
 }
 
+/**
+ * \brief Remove the mapping starting at vaddr if it has pte_count entries
+ *
+ * If batch is not NULL, the unmap is added to the batch rather than issued
+ * immediately.
+ */
 static errval_t do_single_unmap(struct pmap_x86 *pmap, genvaddr_t vaddr,
-                                size_t pte_count)
+                                size_t pte_count, struct pmap_batch *batch)
 {
-    errval_t err;
     struct find_mapping_info info;
 
     if (!find_mapping(pmap, vaddr, &info)) {
@@ -681,30 +872,14 @@ static errval_t do_single_unmap(struct pmap_x86 *pmap, genvaddr_t vaddr,
     assert(info.page_table && info.page_table->v.is_vnode && info.page && !info.page->v.is_vnode);
 
     if (info.page->v.u.frame.pte_count == pte_count) {
-        err = vnode_unmap(info.page_table->v.cap, info.page->v.mapping);
-        if (err_is_fail(err)) {
-            debug_printf("vnode_unmap returned error: %s (%d)\n",
-                    err_getstring(err), err_no(err));
-            return err_push(err, LIB_ERR_VNODE_UNMAP);
-        }
-
-        // delete&free page->v.mapping after doing vnode_unmap()
-        err = cap_delete(info.page->v.mapping);
-        if (err_is_fail(err)) {
-            return err_push(err, LIB_ERR_CAP_DELETE);
-        }
-#ifndef GLOBAL_MCN
-        err = pmap->p.slot_alloc->free(pmap->p.slot_alloc, info.page->v.mapping);
-        if (err_is_fail(err)) {
-            debug_printf("remove_empty_vnodes: slot_free (mapping): %s\n",
-                    err_getstring(err));
+        if (batch) {
+            struct vnode_batch_entry e = {
+                .mapping       = get_cap_addr(info.page->v.mapping),
+                .mapping_level = get_cap_level(info.page->v.mapping),
+            };
+            return batch_add(pmap, batch, info.page_table, info.page, &e);
         }
-#endif
-        assert(pmap->used_cap_slots > 0);
-        pmap->used_cap_slots --;
-        // Free up the resources
-        pmap_remove_vnode(info.page_table, info.page);
-        slab_free(&pmap->p.m.slab, info.page);
+        return unmap_page_vnode(pmap, info.page_table, info.page);
     }
 
     return SYS_ERR_OK;
@@ -753,7 +928,7 @@ static errval_t unmap(struct pmap *pmap, genvaddr_t vaddr, size_t size,
         (is_same_pml4(vaddr, vend) && is_huge_page(info.page)))
     {
         // fast path
-        err = do_single_unmap(x86, vaddr, size / info.page_size);
+        err = do_single_unmap(x86, vaddr, size / info.page_size, NULL);
         if (err_is_fail(err) && err_no(err) != LIB_ERR_PMAP_FIND_VNODE) {
             printf("error fast path\n");
             trace_event(TRACE_SUBSYS_MEMORY, TRACE_EVENT_MEMORY_UNMAP, 1);
@@ -761,25 +936,29 @@ static errval_t unmap(struct pmap *pmap, genvaddr_t vaddr, size_t size,
         }
     }
     else { // slow path
+        struct pmap_batch batch, *b = NULL;
+        if (pmap_batch_invocations) {
+            batch_init(&batch, VNodeCmd_UnmapBatch);
+            b = &batch;
+        }
+
         // unmap first leaf
         uint32_t c = X86_64_PTABLE_SIZE - info.table_base;
 
-        err = do_single_unmap(x86, vaddr, c);
+        err = do_single_unmap(x86, vaddr, c, b);
         if (err_is_fail(err) && err_no(err) != LIB_ERR_PMAP_FIND_VNODE) {
             printf("error first leaf\n");
-            trace_event(TRACE_SUBSYS_MEMORY, TRACE_EVENT_MEMORY_UNMAP, 1);
-            return err_push(err, LIB_ERR_PMAP_UNMAP);
+            goto out_batch;
         }
 
         // unmap full leaves
         vaddr += c * info.page_size;
         while (get_addr_prefix(vaddr, info.map_bits) < get_addr_prefix(vend, info.map_bits)) {
             c = X86_64_PTABLE_SIZE;
-            err = do_single_unmap(x86, vaddr, X86_64_PTABLE_SIZE);
+            err = do_single_unmap(x86, vaddr, X86_64_PTABLE_SIZE, b);
             if (err_is_fail(err) && err_no(err) != LIB_ERR_PMAP_FIND_VNODE) {
                 printf("error while loop\n");
-                trace_event(TRACE_SUBSYS_MEMORY, TRACE_EVENT_MEMORY_UNMAP, 1);
-                return err_push(err, LIB_ERR_PMAP_UNMAP);
+                goto out_batch;
             }
             vaddr += c * info.page_size;
         }
@@ -791,13 +970,27 @@ static errval_t unmap(struct pmap *pmap, genvaddr_t vaddr, size_t size,
             get_addr_prefix(vaddr, info.map_bits - X86_64_PTABLE_BITS);
         assert(c < X86_64_PTABLE_SIZE);
         if (c) {
-            err = do_single_unmap(x86, vaddr, c);
+            err = do_single_unmap(x86, vaddr, c, b);
             if (err_is_fail(err) && err_no(err) != LIB_ERR_PMAP_FIND_VNODE) {
                 printf("error remaining part\n");
-                trace_event(TRACE_SUBSYS_MEMORY, TRACE_EVENT_MEMORY_UNMAP, 1);
-                return err_push(err, LIB_ERR_PMAP_UNMAP);
+                goto out_batch;
             }
         }
+        err = SYS_ERR_OK;
+
+out_batch:
+        // remove the mappings collected so far, even if we hit an error
+        if (b) {
+            if (err_is_ok(err)) {
+                err = batch_flush(x86, b);
+            } else {
+                batch_flush(x86, b);
+            }
+        }
+        if (err_is_fail(err)) {
+            trace_event(TRACE_SUBSYS_MEMORY, TRACE_EVENT_MEMORY_UNMAP, 1);
+            return err_push(err, LIB_ERR_PMAP_UNMAP);
+        }
     }
 
     if (retsize) {
@@ -810,8 +1003,16 @@ static errval_t unmap(struct pmap *pmap, genvaddr_t vaddr, size_t size,
 }
 
 int pmap_selective_flush = 0;
+
+/**
+ * \brief Modify the flags of pages within a single leaf table
+ *
+ * If batch is not NULL, the modification is added to the batch rather than
+ * issued immediately. Batched modifications end with one full TLB flush.
+ */
 static errval_t do_single_modify_flags(struct pmap_x86 *pmap, genvaddr_t vaddr,
-                                       size_t pages, vregion_flags_t flags)
+                                       size_t pages, vregion_flags_t flags,
+                                       struct pmap_batch *batch)
 {
     errval_t err = SYS_ERR_OK;
 
@@ -831,6 +1032,15 @@ static errval_t do_single_modify_flags(struct pmap_x86 *pmap, genvaddr_t vaddr,
         // pages, new flags. Invocation mask flags based on capability
         // access permissions.
         size_t off = info.table_base - info.page->v.entry;
+        if (batch) {
+            struct vnode_batch_entry e = {
+                .mapping       = get_cap_addr(info.page->v.mapping),
+                .mapping_level = get_cap_level(info.page->v.mapping),
+                .offset        = off,
+                .pte_count     = pages,
+            };
+            return batch_add(pmap, batch, info.page_table, info.page, &e);
+        }
         paging_x86_64_flags_t pmap_flags = vregion_to_pmap_flag(flags);
         // calculate TLB flushing hint
         genvaddr_t va_hint = 0;
@@ -906,30 +1116,37 @@ static errval_t modify_flags(struct pmap *pmap, genvaddr_t vaddr, size_t size,
         (is_same_pml4(vaddr, vend) && is_huge_page(info.page))) {
         // fast path
         assert(pages <= PTABLE_SIZE);
-        err = do_single_modify_flags(x86, vaddr, pages, flags);
+        err = do_single_modify_flags(x86, vaddr, pages, flags, NULL);
         if (err_is_fail(err)) {
             trace_event(TRACE_SUBSYS_MEMORY, TRACE_EVENT_MEMORY_MODIFY, 1);
             return err_push(err, LIB_ERR_PMAP_MODIFY_FLAGS);
         }
     }
     else { // slow path
+        // Batch the leaves unless a selective TLB flush strategy was asked
+        // for, which the batched invocation does not implement.
+        struct pmap_batch batch, *b = NULL;
+        if (pmap_batch_invocations && pmap_selective_flush == 0) {
+            batch_init(&batch, VNodeCmd_ModifyFlagsBatch);
+            batch.flags = vregion_to_pmap_flag(flags);
+            b = &batch;
+        }
+
         // modify first part
         uint32_t c = X86_64_PTABLE_SIZE - info.table_base;
         assert(c <= PTABLE_SIZE);
-        err = do_single_modify_flags(x86, vaddr, c, flags);
+        err = do_single_modify_flags(x86, vaddr, c, flags, b);
         if (err_is_fail(err)) {
-            trace_event(TRACE_SUBSYS_MEMORY, TRACE_EVENT_MEMORY_MODIFY, 1);
-            return err_push(err, LIB_ERR_PMAP_MODIFY_FLAGS);
+            goto out_batch;
         }
 
         // modify full leaves
         vaddr += c * info.page_size;
         while (get_addr_prefix(vaddr, info.map_bits) < get_addr_prefix(vend, info.map_bits)) {
             c = X86_64_PTABLE_SIZE;
-            err = do_single_modify_flags(x86, vaddr, X86_64_PTABLE_SIZE, flags);
+            err = do_single_modify_flags(x86, vaddr, X86_64_PTABLE_SIZE, flags, b);
             if (err_is_fail(err)) {
-                trace_event(TRACE_SUBSYS_MEMORY, TRACE_EVENT_MEMORY_MODIFY, 1);
-                return err_push(err, LIB_ERR_PMAP_MODIFY_FLAGS);
+                goto out_batch;
             }
             vaddr += c * info.page_size;
         }
@@ -939,12 +1156,21 @@ static errval_t modify_flags(struct pmap *pmap, genvaddr_t vaddr, size_t size,
                 get_addr_prefix(vaddr, info.map_bits - X86_64_PTABLE_BITS);
         if (c) {
             assert(c <= PTABLE_SIZE);
-            err = do_single_modify_flags(x86, vaddr, c, flags);
-            if (err_is_fail(err)) {
-                trace_event(TRACE_SUBSYS_MEMORY, TRACE_EVENT_MEMORY_MODIFY, 1);
-                return err_push(err, LIB_ERR_PMAP_MODIFY_FLAGS);
+            err = do_single_modify_flags(x86, vaddr, c, flags, b);
+        }
+
+out_batch:
+        if (b) {
+            if (err_is_ok(err)) {
+                err = batch_flush(x86, b);
+            } else {
+                batch_flush(x86, b);
             }
         }
+        if (err_is_fail(err)) {
+            trace_event(TRACE_SUBSYS_MEMORY, TRACE_EVENT_MEMORY_MODIFY, 1);
+            return err_push(err, LIB_ERR_PMAP_MODIFY_FLAGS);
+        }
     }
 
     if (retsize) {
@@ -1092,6 +1318,43 @@ static errval_t dump(struct pmap *pmap, struct pmap_dump_info *buf, size_t bufle
     }
     return SYS_ERR_OK;
 }
+#elif defined(PMAP_RADIX)
+static errval_t dump(struct pmap *pmap, struct pmap_dump_info *buf, size_t buflen, size_t *items_written)
+{
+    struct pmap_x86 *x86 = (struct pmap_x86 *)pmap;
+    struct pmap_dump_info *buf_ = buf;
+
+    struct vnode *pml4 = &x86->root;
+    struct vnode *pdpt, *pdir, *pt, *frame;
+    assert(pml4 != NULL);
+
+    *items_written = 0;
+
+    // iterate over PML4 entries
+    pmap_foreach_child(pml4, pdpt) {
+        // iterate over pdpt entries
+        pmap_foreach_child(pdpt, pdir) {
+            // iterate over pdir entries
+            pmap_foreach_child(pdir, pt) {
+                // iterate over pt entries
+                pmap_foreach_child(pt, frame) {
+                    if (*items_written < buflen) {
+                        buf_->pml4_index = pdpt->v.entry;
+                        buf_->pdpt_index = pdir->v.entry;
+                        buf_->pdir_index = pt->v.entry;
+                        buf_->pt_index   = frame->v.entry;
+                        buf_->cap = frame->v.cap;
+                        buf_->offset = frame->v.u.frame.offset;
+                        buf_->flags = frame->v.u.frame.flags;
+                        buf_++;
+                        (*items_written)++;
+                    }
+                }
+            }
+        }
+    }
+    return SYS_ERR_OK;
+}
 #else
 #error Invalid pmap datastructure
 #endif
@@ -1277,6 +1540,23 @@ static errval_t determine_addr_raw(struct pmap *pmap, size_t size,
             break;
         }
     }
+#elif defined(PMAP_RADIX)
+    // try to find free pml4 entry
+    bool f[X86_64_PTABLE_SIZE];
+    for (int i = 0; i < X86_64_PTABLE_SIZE; i++) {
+        f[i] = true;
+    }
+    struct vnode *walk_pml4;
+    pmap_foreach_child(&x86->root, walk_pml4) {
+        assert(walk_pml4->v.is_vnode);
+        f[walk_pml4->v.entry] = false;
+    }
+    genvaddr_t first_free = 16;
+    for (; first_free < X86_64_PTABLE_SIZE; first_free++) {
+        if (f[first_free]) {
+            break;
+        }
+    }
 #else
 #error Invalid pmap datastructure
 #endif
@@ -0,0 +1,144 @@
+/**
+ * \file
+ * \brief Load balancing of threads between a domain's dispatchers
+ *
+ * The balancer runs as a thread of the domain. It periodically samples the
+ * load of each of the given cores (see domain_get_load()) and, if they differ
+ * by more than one, asks the busiest dispatcher to move half of the
+ * difference to the least loaded one. The load includes the other domains'
+ * dispatchers running on a core where the kernel provides scheduler
+ * statistics. Elsewhere only the domain's own threads are counted, and a
+ * core saturated by other domains looks idle. Only threads marked with
+ * thread_set_migratable() are moved.
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <barrelfish/barrelfish.h>
+#include <barrelfish/deferred.h>
+
+struct balancer_state {
+    coreid_t cores[MAX_CPUS];
+    size_t ncores;
+    delayus_t interval;
+    struct thread *thread;
+    volatile bool stop;
+};
+
+static struct balancer_state *balancer = NULL;
+
+static void balance(struct balancer_state *st)
+{
+    coreid_t busiest = 0, idlest = 0;
+    size_t max_load = 0, min_load = SIZE_MAX;
+    errval_t err;
+
+    for (size_t i = 0; i < st->ncores; i++) {
+        size_t load;
+        err = domain_get_load(st->cores[i], &load);
+        if (err_is_fail(err)) {
+            DEBUG_ERR(err, "balancer: load of core %d", st->cores[i]);
+            continue;
+        }
+        if (load >= max_load) {
+            max_load = load;
+            busiest = st->cores[i];
+        }
+        if (load < min_load) {
+            min_load = load;
+            idlest = st->cores[i];
+        }
+    }
+
+    if (min_load == SIZE_MAX || max_load < min_load + 2) {
+        return;
+    }
+
+    err = domain_migrate_threads(busiest, idlest, (max_load - min_load) / 2);
+    if (err_is_fail(err) && err_no(err) != FLOUNDER_ERR_TX_BUSY) {
+        DEBUG_ERR(err, "balancer: migrating from core %d to %d", busiest,
+                  idlest);
+    }
+}
+
+static int balancer_thread(void *arg)
+{
+    struct balancer_state *st = arg;
+
+    while (!st->stop) {
+        barrelfish_usleep(st->interval);
+        if (!st->stop) {
+            balance(st);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * \brief Start balancing the domain's threads between the given cores
+ *
+ * The domain must have been spanned to all the cores. Replaces a previously
+ * started balancer.
+ *
+ * \param cores    Cores to balance between
+ * \param ncores   Number of cores
+ * \param interval Time between balancing rounds
+ */
+errval_t domain_balancer_start(coreid_t *cores, size_t ncores,
+                               delayus_t interval)
+{
+    assert(cores != NULL);
+    assert(ncores <= MAX_CPUS);
+
+    domain_balancer_stop();
+
+    struct balancer_state *st = malloc(sizeof(*st));
+    if (st == NULL) {
+        return LIB_ERR_MALLOC_FAIL;
+    }
+
+    memcpy(st->cores, cores, ncores * sizeof(*cores));
+    st->ncores = ncores;
+    st->interval = interval;
+    st->stop = false;
+
+    st->thread = thread_create(balancer_thread, st);
+    if (st->thread == NULL) {
+        free(st);
+        return LIB_ERR_THREAD_CREATE;
+    }
+
+    balancer = st;
+    return SYS_ERR_OK;
+}
+
+/**
+ * \brief Stop the balancer, if it is running
+ *
+ * Threads already moved stay where they are.
+ */
+void domain_balancer_stop(void)
+{
+    struct balancer_state *st = balancer;
+    if (st == NULL) {
+        return;
+    }
+
+    balancer = NULL;
+    st->stop = true;
+    errval_t err = thread_join(st->thread, NULL);
+    if (err_is_fail(err)) {
+        DEBUG_ERR(err, "joining balancer thread");
+    }
+    free(st);
+}
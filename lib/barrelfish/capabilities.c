@@ -392,6 +392,129 @@ errval_t cap_delete(struct capref cap)
     }
 }
 
+static errval_t cap_copy_or_mint_range(struct capref dest, struct capref src,
+                                       size_t count, bool mint,
+                                       uint64_t param1, uint64_t param2,
+                                       size_t *done)
+{
+    errval_t err;
+    size_t total = 0;
+    capaddr_t dcs_addr = get_croot_addr(dest);
+    capaddr_t dcn_addr = get_cnode_addr(dest);
+    enum cnode_type dcn_level = get_cnode_level(dest);
+    capaddr_t scs_addr = get_croot_addr(src);
+    capaddr_t scn_addr = get_cnode_addr(src);
+    enum cnode_type scn_level = get_cnode_level(src);
+
+    while (count > 0) {
+        size_t n = count < CNODE_RANGE_MAX_COUNT ? count : CNODE_RANGE_MAX_COUNT;
+        size_t chunk_done = 0;
+        err = invoke_cnode_copy_range(cap_root, dcs_addr, dcn_addr, dest.slot,
+                                      scs_addr, scn_addr, src.slot, dcn_level,
+                                      scn_level, n, mint, param1, param2,
+                                      &chunk_done);
+        if (err_is_fail(err)) {
+            if (done) {
+                *done = total + chunk_done;
+            }
+            return err;
+        }
+        dest.slot += n;
+        src.slot += n;
+        count -= n;
+        total += n;
+    }
+
+    if (done) {
+        *done = total;
+    }
+    return SYS_ERR_OK;
+}
+
+/**
+ * \brief Copy a range of capabilities between CNodes
+ *
+ * \param dest  First destination slot, all `count` slots must be empty
+ * \param src   First source slot
+ * \param count Number of slots to copy
+ * \param done  If not NULL, returns the number of slots processed
+ *
+ * Copies the capabilities in `count` consecutive slots starting at `src` to
+ * the slots starting at `dest` with a single invocation. Empty source slots
+ * are skipped. Both ranges must lie within one CNode each and may not
+ * overlap.
+ *
+ * On failure, the first `*done` destination slots have been filled (where
+ * the source slot was not empty) and the rest are untouched. The copies
+ * are not undone.
+ */
+errval_t cap_copy_range(struct capref dest, struct capref src, size_t count,
+                        size_t *done)
+{
+    return cap_copy_or_mint_range(dest, src, count, false, 0, 0, done);
+}
+
+/**
+ * \brief Mint a range of capabilities between CNodes
+ *
+ * \param dest   First destination slot, all `count` slots must be empty
+ * \param src    First source slot
+ * \param count  Number of slots to mint
+ * \param param1 1st cap-dependent parameter, applied to every capability
+ * \param param2 2nd cap-dependent parameter, applied to every capability
+ * \param done   If not NULL, returns the number of slots processed
+ *
+ * See cap_copy_range() and cap_mint().
+ */
+errval_t cap_mint_range(struct capref dest, struct capref src, size_t count,
+                        uint64_t param1, uint64_t param2, size_t *done)
+{
+    return cap_copy_or_mint_range(dest, src, count, true, param1, param2,
+                                  done);
+}
+
+/**
+ * \brief Delete a range of capabilities
+ *
+ * \param start First slot to delete
+ * \param count Number of slots
+ *
+ * Deletes (but does not revoke) the capabilities in `count` consecutive slots
+ * of a CNode, skipping empty slots. The kernel deletes as many as it can in
+ * one invocation. Capabilities that have to be deleted through the monitor
+ * are handed to it one at a time, as in cap_delete().
+ */
+errval_t cap_delete_range(struct capref start, size_t count)
+{
+    errval_t err;
+    struct capref croot = get_croot_capref(start);
+    capaddr_t cn_addr = get_cnode_addr(start);
+    enum cnode_type cn_level = get_cnode_level(start);
+
+    while (count > 0) {
+        size_t n = count < CNODE_RANGE_MAX_COUNT ? count : CNODE_RANGE_MAX_COUNT;
+        size_t done = 0;
+        err = invoke_cnode_delete_range(croot, cn_addr, cn_level, start.slot,
+                                        n, &done);
+        if (err_no(err) == SYS_ERR_RETRY_THROUGH_MONITOR) {
+            struct capref cap = start;
+            cap.slot += done;
+            TRACE(CAPOPS, USER_DELETE_RPC, 0);
+            err = cap_delete_remote(croot, get_cap_addr(cap),
+                                    get_cap_level(cap));
+            TRACE(CAPOPS, USER_DELETE_RPC_DONE, 0);
+            done++;
+        }
+        if (err_is_fail(err)) {
+            return err;
+        }
+        start.slot += done;
+        count -= done;
+    }
+
+    return SYS_ERR_OK;
+}
+
 /**
  * \brief Revoke (delete all copies and descendants of) the given capability
  *
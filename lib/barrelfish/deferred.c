@@ -16,6 +16,7 @@
 #include <barrelfish/deferred.h>
 #include <barrelfish/waitset_chan.h>
 #include <stdio.h>
+#include <string.h>
 #include <barrelfish/systime.h>
 
 // FIXME: why do I need quite so many dispatcher headers?
@@ -26,18 +27,175 @@
 
 #include "waitset_chan_priv.h"
 
+/*
+ * The deferred events of a dispatcher are kept in a hierarchical timer wheel
+ * (Varghese and Lauck), so that registering and cancelling an event is O(1)
+ * no matter how many timers are live.
+ *
+ * Time is divided into ticks of about a microsecond. Level 0 of the wheel has
+ * one slot per tick for the next DEFERRED_WHEEL_SLOTS ticks, and every level
+ * above covers DEFERRED_WHEEL_SLOTS times the range of the one below. An event
+ * is queued on the lowest level whose range reaches its expiry tick. When the
+ * wheel time reaches the start of a slot of a higher level, the events in it
+ * are moved down (cascaded). Events further away than the top level covers
+ * are parked in its last slot and cascaded there again until they are in
+ * range.
+ *
+ * Events of a tick are triggered once the tick has passed, so they fire at
+ * most one tick late.
+ */
+
+#define WHEEL_MASK          (DEFERRED_WHEEL_SLOTS - 1)
+#define WHEEL_RANGE         (1ULL << (DEFERRED_WHEEL_LEVELS \
+                                      * DEFERRED_WHEEL_SLOT_BITS))
+#define WHEEL_NONE          UINT64_MAX
+
+static inline unsigned level_shift(unsigned level)
+{
+    return level * DEFERRED_WHEEL_SLOT_BITS;
+}
+
+/// Next tick at or after the wheel time at which a slot is processed
+static uint64_t slot_tick(struct deferred_wheel *w, unsigned level,
+                          unsigned slot)
+{
+    unsigned shift = level_shift(level);
+    uint64_t k = ((w->now >> shift) & ~(uint64_t)WHEEL_MASK) | slot;
+    if ((k << shift) < w->now) {
+        k += DEFERRED_WHEEL_SLOTS;
+    }
+    return k << shift;
+}
+
+/// Find the next tick at which the wheel has work to do
+static uint64_t wheel_next_tick(struct deferred_wheel *w)
+{
+    uint64_t next = WHEEL_NONE;
+
+    for (unsigned level = 0; level < DEFERRED_WHEEL_LEVELS; level++) {
+        uint64_t occupied = w->occupied[level];
+        if (occupied == 0) {
+            continue;
+        }
+
+        // the slot the wheel time is in was already cascaded, unless the
+        // wheel time is exactly at its start
+        unsigned shift = level_shift(level);
+        unsigned first = (w->now >> shift) & WHEEL_MASK;
+        if ((w->now & ((1ULL << shift) - 1)) != 0) {
+            first = (first + 1) & WHEEL_MASK;
+        }
+
+        // first occupied slot, in cyclic order from there
+        uint64_t rotated = first == 0 ? occupied :
+            (occupied >> first) | (occupied << (DEFERRED_WHEEL_SLOTS - first));
+        unsigned slot = (first + __builtin_ctzll(rotated)) & WHEEL_MASK;
+
+        uint64_t tick = slot_tick(w, level, slot);
+        if (tick < next) {
+            next = tick;
+        }
+    }
+
+    return next;
+}
+
+static void wheel_insert(struct deferred_wheel *w, struct deferred_event *e)
+{
+    uint64_t tick = e->time >> w->tick_shift;
+    if (tick < w->now) {
+        tick = w->now;
+    }
+    uint64_t delta = tick - w->now;
+    if (delta >= WHEEL_RANGE) {
+        delta = WHEEL_RANGE - 1;
+        tick = w->now + delta;
+    }
+
+    unsigned level = 0;
+    while (delta >= (1ULL << level_shift(level + 1))) {
+        level++;
+    }
+    unsigned slot = (tick >> level_shift(level)) & WHEEL_MASK;
+
+    struct deferred_event **head = &w->slots[level][slot];
+    e->prev = NULL;
+    e->next = *head;
+    if (*head != NULL) {
+        (*head)->prev = e;
+    }
+    *head = e;
+    e->wheel_slot = level * DEFERRED_WHEEL_SLOTS + slot;
+    w->occupied[level] |= 1ULL << slot;
+    w->count++;
+}
+
+static void wheel_remove(struct deferred_wheel *w, struct deferred_event *e)
+{
+    unsigned level = e->wheel_slot / DEFERRED_WHEEL_SLOTS;
+    unsigned slot = e->wheel_slot % DEFERRED_WHEEL_SLOTS;
+
+    if (e->prev == NULL) {
+        assert(w->slots[level][slot] == e);
+        w->slots[level][slot] = e->next;
+        if (e->next == NULL) {
+            w->occupied[level] &= ~(1ULL << slot);
+        }
+    } else {
+        e->prev->next = e->next;
+    }
+    if (e->next != NULL) {
+        e->next->prev = e->prev;
+    }
+    e->next = e->prev = NULL;
+    w->count--;
+}
+
+/// Take all events out of a slot and return them as a list
+static struct deferred_event *wheel_take_slot(struct deferred_wheel *w,
+                                              unsigned level, unsigned slot)
+{
+    struct deferred_event *list = w->slots[level][slot];
+    w->slots[level][slot] = NULL;
+    w->occupied[level] &= ~(1ULL << slot);
+    for (struct deferred_event *e = list; e != NULL; e = e->next) {
+        w->count--;
+    }
+    return list;
+}
+
 static void update_wakeup_disabled(dispatcher_handle_t dh)
 {
     struct dispatcher_generic *dg = get_dispatcher_generic(dh);
     struct dispatcher_shared_generic *ds = get_dispatcher_shared_generic(dh);
+    struct deferred_wheel *w = &dg->deferred_events;
 
-    if (dg->deferred_events == NULL) {
+    w->next = wheel_next_tick(w);
+    if (w->next == WHEEL_NONE) {
         ds->wakeup = 0;
     } else {
-        ds->wakeup = dg->deferred_events->time;
+        // events of a tick are triggered once it has passed
+        ds->wakeup = (w->next + 1) << w->tick_shift;
     }
 }
 
+/// Initialise the timer wheel of a dispatcher, while disabled
+void deferred_events_init_disabled(dispatcher_handle_t dh)
+{
+    struct dispatcher_generic *dg = get_dispatcher_generic(dh);
+    struct deferred_wheel *w = &dg->deferred_events;
+
+    memset(w, 0, sizeof(*w));
+    w->next = WHEEL_NONE;
+
+    // a tick is the largest power of two of system time ticks <= 1us
+    systime_t per_us = systime_frequency / 1000000;
+    while ((per_us >> (w->tick_shift + 1)) != 0) {
+        w->tick_shift++;
+    }
+    w->now = systime_now() >> w->tick_shift;
+}
+
 /**
  * \brief Returns the system time when the current dispatcher was last dispatched
  */
@@ -72,32 +230,17 @@ errval_t deferred_event_register(struct deferred_event *event,
     err = waitset_chan_register_disabled(ws, &event->waitset_state, closure);
     if (err_is_ok(err)) {
         struct dispatcher_generic *dg = get_dispatcher_generic(dh);
+        struct deferred_wheel *w = &dg->deferred_events;
 
         // determine absolute time for event
-        event->time = systime_now() + ns_to_systime((uint64_t)delay * 1000);
-        // enqueue in sorted list of pending timers
-        for (struct deferred_event *e = dg->deferred_events, *p = NULL; ;
-             p = e, e = e->next) {
-            if (e == NULL || e->time > event->time) {
-                if (p == NULL) { // insert at head
-                    assert(e == dg->deferred_events);
-                    event->prev = NULL;
-                    event->next = e;
-                    if (e != NULL) {
-                        e->prev = event;
-                    }
-                    dg->deferred_events = event;
-                } else {
-                    event->next = e;
-                    event->prev = p;
-                    p->next = event;
-                    if (e != NULL) {
-                        e->prev = event;
-                    }
-                }
-                break;
-            }
+        systime_t now = systime_now();
+        event->time = now + ns_to_systime((uint64_t)delay * 1000);
+
+        // an empty wheel can skip ahead to the current time
+        if (w->count == 0 && (now >> w->tick_shift) > w->now) {
+            w->now = now >> w->tick_shift;
         }
+        wheel_insert(w, event);
     }
 
     update_wakeup_disabled(dh);
@@ -147,16 +290,9 @@ errval_t deferred_event_cancel(struct deferred_event *event)
     dispatcher_handle_t handle = disp_disable();
     errval_t err = waitset_chan_deregister_disabled(&event->waitset_state, handle);
     if (err_is_ok(err) && chanstate != CHAN_PENDING) {
-        // remove from dispatcher queue
+        // remove from timer wheel
         struct dispatcher_generic *disp = get_dispatcher_generic(handle);
-        if (event->prev == NULL) {
-            disp->deferred_events = event->next;
-        } else {
-            event->prev->next = event->next;
-        }
-        if (event->next != NULL) {
-            event->next->prev = event->prev;
-        }
+        wheel_remove(&disp->deferred_events, event);
         update_wakeup_disabled(handle);
     }
 
@@ -211,16 +347,45 @@ errval_t periodic_event_cancel(struct periodic_event *event)
 void trigger_deferred_events_disabled(dispatcher_handle_t dh, systime_t now)
 {
     struct dispatcher_generic *dg = get_dispatcher_generic(dh);
-    struct deferred_event *e;
+    struct deferred_wheel *w = &dg->deferred_events;
+    struct deferred_event *e, *next;
     errval_t err;
 
-    for (e = dg->deferred_events; e != NULL && e->time <= now; e = e->next) {
-        err = waitset_chan_trigger_disabled(&e->waitset_state, dh);
-        assert_disabled(err_is_ok(err));
+    // process all ticks before the current one
+    uint64_t end = now >> w->tick_shift;
+    if (w->next >= end) {
+        return;
+    }
+
+    for (uint64_t tick = w->next; tick < end; tick = wheel_next_tick(w)) {
+        w->now = tick;
+
+        // cascade the slots of the higher levels starting at this tick
+        for (unsigned level = DEFERRED_WHEEL_LEVELS - 1; level > 0; level--) {
+            unsigned shift = level_shift(level);
+            if ((tick & ((1ULL << shift) - 1)) != 0) {
+                continue;
+            }
+            e = wheel_take_slot(w, level, (tick >> shift) & WHEEL_MASK);
+            for (; e != NULL; e = next) {
+                next = e->next;
+                wheel_insert(w, e);
+            }
+        }
+
+        e = wheel_take_slot(w, 0, tick & WHEEL_MASK);
+        for (; e != NULL; e = next) {
+            next = e->next;
+            assert_disabled(e->time <= now);
+            err = waitset_chan_trigger_disabled(&e->waitset_state, dh);
+            assert_disabled(err_is_ok(err));
+        }
+
+        w->now = tick + 1;
     }
-    dg->deferred_events = e;
-    if (e != NULL) {
-        e->prev = NULL;
+
+    if (w->now < end) {
+        w->now = end;
     }
     update_wakeup_disabled(dh);
 }
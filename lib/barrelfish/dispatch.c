@@ -179,6 +179,7 @@ void disp_init_disabled(dispatcher_handle_t handle)
 
     disp_gen->timeslice = 1;
     systime_frequency = disp->systime_frequency;
+    deferred_events_init_disabled(handle);
     // Initialize important capability pointers
     if (disp_gen->dcb_cap.slot == 0) {
         disp_gen->dcb_cap.cnode = cnode_task;
@@ -27,12 +27,14 @@
 #include <barrelfish/monitor_client.h>
 #include <barrelfish/waitset_chan.h>
 #include <barrelfish_kpi/domain_params.h>
+#include <barrelfish_kpi/schedstat.h>
 #include <arch/registers.h>
 #include <barrelfish/dispatch.h>
 #include <if/interdisp_defs.h>
 #include "arch/threads.h"
 #include "init.h"
 #include <if/monitor_defs.h>
+#include <if/monitor_blocking_defs.h>
 #include "threads_priv.h"
 #include "waitset_chan_priv.h"
 #include "domain_priv.h"
@@ -223,6 +225,95 @@ static void join_thread_reply(struct interdisp_binding *b,
     r->reply_received = true;
 }
 
+/// Scheduler statistics of each core, mapped by the dispatcher on that core
+static volatile struct sched_stats *schedstat_frames[MAX_CPUS];
+/// The scheduler statistics of the core could not be mapped, do not retry
+static bool schedstat_unavailable[MAX_CPUS];
+
+/*
+ * Maps the scheduler statistics of the calling dispatcher's core, if the
+ * kernel provides them. Returns NULL if it does not.
+ */
+static volatile struct sched_stats *schedstat_get(void)
+{
+    coreid_t core = disp_get_core_id();
+    struct capref frame;
+    errval_t err, msgerr;
+    void *buf;
+
+    if (schedstat_frames[core] != NULL || schedstat_unavailable[core]) {
+        return schedstat_frames[core];
+    }
+    schedstat_unavailable[core] = true;
+
+    err = slot_alloc(&frame);
+    if (err_is_fail(err)) {
+        return NULL;
+    }
+
+    struct monitor_blocking_binding *mb = get_monitor_blocking_binding();
+    msgerr = mb->rpc_tx_vtbl.get_schedstat_cap(mb, &err, &frame);
+    if (err_is_fail(msgerr) || err_is_fail(err)) {
+        slot_free(frame);
+        return NULL;
+    }
+
+    err = vspace_map_one_frame_attr(&buf, BASE_PAGE_SIZE, frame,
+                                    VREGION_FLAGS_READ, NULL, NULL);
+    if (err_is_fail(err)) {
+        cap_destroy(frame);
+        return NULL;
+    }
+
+    schedstat_frames[core] = buf;
+    schedstat_unavailable[core] = false;
+    return buf;
+}
+
+/*
+ * Load of the calling dispatcher's core: our runnable threads, plus one for
+ * each other runnable dispatcher the kernel reported at its last scheduling
+ * decision. The latter is left out if the kernel has no statistics.
+ */
+static size_t dispatcher_load(void)
+{
+    size_t load = thread_runnable_count();
+    volatile struct sched_stats *s = schedstat_get();
+
+    // the kernel's run queue includes our own dispatcher
+    if (s != NULL && s->runq_len > 1) {
+        load += s->runq_len - 1;
+    }
+    return load;
+}
+
+static void load_request(struct interdisp_binding *b, genvaddr_t req)
+{
+    errval_t err = b->tx_vtbl.load_reply(b, NOP_CONT, dispatcher_load(), req);
+    if (err_is_fail(err)) {
+        DEBUG_ERR(err, "sending load_reply");
+    }
+}
+
+struct load_req {
+    size_t runnable;
+    bool reply_received;
+};
+
+static void load_reply(struct interdisp_binding *b, uint32_t runnable,
+                       genvaddr_t req)
+{
+    struct load_req *r = (struct load_req *)(lvaddr_t)req;
+    r->runnable = runnable;
+    r->reply_received = true;
+}
+
+static void migrate_threads_request(struct interdisp_binding *b,
+                                    coreid_t core_id, uint32_t count)
+{
+    thread_migrate_runnable(core_id, count);
+}
+
 /*
  * XXX: The whole span_slave*() thing is a hack to allow all
  * dispatchers to wait on both the monitor and interdisp waitsets
@@ -294,6 +385,10 @@ static struct interdisp_rx_vtbl interdisp_vtbl = {
     .join_thread_request   = join_thread_request,
     .join_thread_reply     = join_thread_reply,
 
+    .load_request          = load_request,
+    .load_reply            = load_reply,
+    .migrate_threads       = migrate_threads_request,
+
     // XXX: Hack to allow domain_new_dispatcher() to proceed when not all
     // default waitsets are serviced
     .span_slave       = span_slave_request,
@@ -849,9 +944,9 @@ errval_t domain_send_cap(coreid_t core_id, struct capref cap)
  *
  * \return SYS_ERR_OK on success.
  */
-static errval_t domain_wakeup_on_coreid_disabled(coreid_t core_id,
-                                                 struct thread *thread,
-                                                 dispatcher_handle_t mydisp)
+errval_t domain_wakeup_on_coreid_disabled(coreid_t core_id,
+                                          struct thread *thread,
+                                          dispatcher_handle_t mydisp)
 {
     struct domain_state *ds = get_domain_state();
 
@@ -1042,6 +1137,84 @@ errval_t domain_thread_join(struct thread *thread, int *retval)
     }
 }
 
+/**
+ * \brief Load on the given core
+ *
+ * The load is the number of runnable threads of this domain on the core,
+ * plus one for every other dispatcher the kernel has runnable there. The
+ * other dispatchers are taken from the scheduler statistics frame, and only
+ * counted on cores whose kernel provides it. Their own threads are not
+ * visible, so a busy dispatcher of another domain counts as one thread.
+ *
+ * Does not count the thread asking on the local core, or the thread
+ * answering on a remote one.
+ */
+errval_t domain_get_load(coreid_t core_id, size_t *runnable)
+{
+    assert(runnable != NULL);
+
+    if (disp_get_core_id() == core_id) {
+        *runnable = dispatcher_load();
+        return SYS_ERR_OK;
+    }
+
+    struct domain_state *domain_state = get_domain_state();
+    errval_t err;
+
+    if (domain_state->binding[core_id] == NULL) {
+        return LIB_ERR_NO_SPANNED_DISP;
+    }
+
+    struct interdisp_binding *b = domain_state->binding[core_id];
+    struct load_req req = { .reply_received = false };
+    // use special waitset to make sure loop exits properly.
+    struct waitset ws, *old_ws = b->waitset;
+    waitset_init(&ws);
+    b->change_waitset(b, &ws);
+    err = b->tx_vtbl.load_request(b, NOP_CONT, (genvaddr_t)(lvaddr_t)&req);
+    if (err_is_fail(err)) {
+        b->change_waitset(b, old_ws);
+        return err;
+    }
+
+    while (!req.reply_received) {
+        event_dispatch(&ws);
+    }
+    // change waitset back
+    b->change_waitset(b, old_ws);
+
+    *runnable = req.runnable;
+    return SYS_ERR_OK;
+}
+
+/**
+ * \brief Move up to 'count' migratable runnable threads between cores
+ *
+ * Threads can only be taken off a dispatcher by the dispatcher itself, so
+ * this only asks the dispatcher on 'from' to move them, and returns before
+ * they have moved.
+ */
+errval_t domain_migrate_threads(coreid_t from, coreid_t to, size_t count)
+{
+    struct domain_state *domain_state = get_domain_state();
+
+    if (domain_state->binding[to] == NULL && disp_get_core_id() != to) {
+        return LIB_ERR_NO_SPANNED_DISP;
+    }
+
+    if (disp_get_core_id() == from) {
+        thread_migrate_runnable(to, count);
+        return SYS_ERR_OK;
+    }
+
+    if (domain_state->binding[from] == NULL) {
+        return LIB_ERR_NO_SPANNED_DISP;
+    }
+
+    struct interdisp_binding *b = domain_state->binding[from];
+    return b->tx_vtbl.migrate_threads(b, NOP_CONT, to, count);
+}
+
 /**
  * \brief set the core_id.
  *
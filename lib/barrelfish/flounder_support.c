@@ -392,6 +392,72 @@ void flounder_stub_ump_state_init(struct flounder_ump_state *s, void *binding)
     flounder_stub_cap_state_init(&s->capst, binding);
 }
 
+/**
+ * \brief Place a buffer in the channel's outgoing payload pool
+ *
+ * On success, fills in the message with the length and pool offset of the
+ * buffer. Fails if the channel has no pool or the pool is too full, in which
+ * case the caller sends the buffer inline.
+ */
+static bool ump_pool_send(struct ump_pool *p, volatile struct ump_message *msg,
+                          const uint8_t *buf, size_t len)
+{
+    if (p->buf == NULL) {
+        return false;
+    }
+
+    // allocate whole cache lines, and never wrap around within a buffer
+    size_t bytes = ROUND_UP(len, UMP_MSG_BYTES);
+    size_t off = p->head & (p->size - 1);
+    size_t skip = (off + bytes > p->size) ? p->size - off : 0;
+    if (bytes + skip > p->size - (p->head - *p->tail)) {
+        return false;
+    }
+    off = (off + skip) & (p->size - 1);
+
+    memcpy((uint8_t *)p->buf + off, buf, len);
+    p->head += skip + bytes;
+
+    msg->data[0] = len | FL_UMP_POOL_FLAG;
+    msg->data[sizeof(uint64_t) / sizeof(uintptr_t)] = off;
+    return true;
+}
+
+/**
+ * \brief Copy a buffer out of the channel's incoming payload pool and release
+ *  its space to the sender
+ */
+static errval_t ump_pool_recv(struct ump_pool *p,
+                              volatile struct ump_message *msg,
+                              void *buf, size_t len, size_t maxsize)
+{
+    size_t off = msg->data[sizeof(uint64_t) / sizeof(uintptr_t)];
+    size_t bytes = ROUND_UP(len, UMP_MSG_BYTES);
+
+    errval_t err = SYS_ERR_OK;
+
+    if (p->buf == NULL || off + bytes > p->size) {
+        return FLOUNDER_ERR_RX_INVALID_LENGTH;
+    }
+
+    // a buffer we cannot take is dropped, but its space is still handed
+    // back, otherwise the sender's pool fills up and never drains
+    if (len > maxsize) {
+        err = FLOUNDER_ERR_RX_INVALID_LENGTH;
+    } else {
+        memcpy(buf, (uint8_t *)p->buf + off, len);
+    }
+
+    // skip any space the sender left at the end of the ring
+    p->head += ((off - p->head) & (p->size - 1)) + bytes;
+
+    // make sure we are done reading before the sender may reuse the space
+    flounder_stub_ump_barrier();
+    *p->tail = p->head;
+
+    return err;
+}
+
 errval_t flounder_stub_ump_send_buf(struct flounder_ump_state *s,
                                        int msgnum, const void *bufp,
                                        size_t len, size_t *pos)
@@ -409,7 +475,15 @@ errval_t flounder_stub_ump_send_buf(struct flounder_ump_state *s,
 
         // is this the start of the buffer?
         if (*pos == 0) {
-            // if so, send the length in the first word
+            // large buffers only send a reference to the payload pool
+            if (len >= FL_UMP_POOL_THRESHOLD
+                && ump_pool_send(&s->chan.send_pool, msg, buf, len)) {
+                flounder_stub_ump_barrier();
+                msg->header.control = ctrl;
+                return SYS_ERR_OK;
+            }
+
+            // if not, send the length in the first word
             msg->data[0] = len;
             // XXX: skip as many words as the largest word size
             msgpos = (sizeof(uint64_t) / sizeof(uintptr_t));
@@ -433,7 +507,8 @@ errval_t flounder_stub_ump_send_buf(struct flounder_ump_state *s,
     return SYS_ERR_OK;
 }
 
-errval_t flounder_stub_ump_recv_buf(volatile struct ump_message *msg,
+errval_t flounder_stub_ump_recv_buf(struct flounder_ump_state *s,
+                                    volatile struct ump_message *msg,
                                     void *buf, size_t *len, size_t *pos,
                                     size_t maxsize)
 {
@@ -445,6 +520,11 @@ errval_t flounder_stub_ump_recv_buf(volatile struct ump_message *msg,
     // if so, unmarshall the length and allocate a buffer
     if (*pos == 0) {
         *len = msg->data[0];
+        // is the payload in the pool?
+        if (*len & FL_UMP_POOL_FLAG) {
+            *len &= ~FL_UMP_POOL_FLAG;
+            return ump_pool_recv(&s->chan.recv_pool, msg, buf, *len, maxsize);
+        }
         assert(*len <= maxsize);
         // XXX: skip as many words as the largest word size
         msgpos = (sizeof(uint64_t) / sizeof(uintptr_t));
@@ -484,13 +564,14 @@ errval_t flounder_stub_ump_send_string(struct flounder_ump_state *s,
     return flounder_stub_ump_send_buf(s, msgnum, str, *len, pos);
 }
 
-errval_t flounder_stub_ump_recv_string(volatile struct ump_message *msg,
+errval_t flounder_stub_ump_recv_string(struct flounder_ump_state *s,
+                                       volatile struct ump_message *msg,
                                        char *str, size_t *pos, size_t *len,
                                        size_t maxsize)
 {
     errval_t err;
 
-    err = flounder_stub_ump_recv_buf(msg, (void *)str, len, pos, maxsize);
+    err = flounder_stub_ump_recv_buf(s, msg, (void *)str, len, pos, maxsize);
     if (*len == 0) {
         str[0] = '\0';
     }
@@ -157,3 +157,409 @@ union heap_header *heap_default_morecore(struct heap *heap, unsigned nu)
     heap_free(heap, (void *)(up + 1));
     return up;
 }
+
+/*
+ * Size-class segregated heap
+ */
+
+/// Size class (or state) of a span marking a run backing a large object
+#define HEAP_SC_LARGE   0xfffe
+/// Size class (or state) of a span marking an unused run
+#define HEAP_SC_FREE    0xffff
+
+/// Header at the start of every span (or run of spans)
+struct heap_sc_span {
+    struct heap_sc_span *next, *prev;   ///< Neighbours in partial / free list
+    void *freelist;                     ///< Free objects in this span
+    char *bump;                         ///< Start of never-used objects
+    struct heap_sc *heap;               ///< Heap owning this span
+    uint32_t nspans;                    ///< Number of spans in this run
+    uint16_t sizeclass;                 ///< Size class of objects
+    uint16_t nfree, ntotal;             ///< Free and total objects in span
+};
+
+/// Offset of first object in a span
+#define HEAP_SC_HDRSIZE  ROUND_UP(sizeof(struct heap_sc_span), 64)
+
+static const uint16_t heap_sc_sizes[HEAP_SC_NCLASSES] = {
+      16,   32,   48,   64,   80,   96,  112,  128,
+     160,  192,  224,  256,
+     320,  384,  448,  512,
+     640,  768,  896, 1024,
+    1280, 1536, 1792, 2048,
+    2560, 3072, 3584, 4096,
+};
+
+static inline struct heap_sc_span *heap_sc_span_of(void *ap)
+{
+    return (struct heap_sc_span *)((uintptr_t)ap & ~(HEAP_SC_SPAN_SIZE - 1));
+}
+
+static inline void heap_sc_list_remove(struct heap_sc_span **list,
+                                       struct heap_sc_span *s)
+{
+    if (s->prev != NULL) {
+        s->prev->next = s->next;
+    } else {
+        assert(*list == s);
+        *list = s->next;
+    }
+    if (s->next != NULL) {
+        s->next->prev = s->prev;
+    }
+    s->next = s->prev = NULL;
+}
+
+static inline void heap_sc_list_push(struct heap_sc_span **list,
+                                     struct heap_sc_span *s)
+{
+    s->prev = NULL;
+    s->next = *list;
+    if (*list != NULL) {
+        (*list)->prev = s;
+    }
+    *list = s;
+}
+
+/**
+ * \brief Initialise a new size-class heap
+ *
+ * \param heap          Heap structure to be filled in
+ * \param morecore_func Function to call to get more memory
+ */
+void heap_sc_init(struct heap_sc *heap, heap_sc_morecore_func_t morecore_func)
+{
+    assert(heap != NULL);
+    assert(morecore_func != NULL);
+
+    memset(heap, 0, sizeof(struct heap_sc));
+    heap->morecore_func = morecore_func;
+}
+
+/**
+ * \brief Returns the size class for an allocation, or -1 if it is too large
+ */
+int heap_sc_size_class(size_t nbytes)
+{
+    if (nbytes <= 128) {
+        return nbytes == 0 ? 0 : (nbytes + 15) / 16 - 1;
+    } else if (nbytes > HEAP_SC_MAX_SMALL) {
+        return -1;
+    }
+
+    // four classes per power of two above 128 bytes
+    unsigned log = sizeof(long) * 8 - 1 - __builtin_clzl(nbytes - 1);
+    return 8 + (log - 7) * 4 + ((nbytes - 1 - (1UL << log)) >> (log - 2));
+}
+
+/**
+ * \brief Returns the size class of an allocated object, or -1 if it is large
+ */
+int heap_sc_ptr_class(void *ap)
+{
+    struct heap_sc_span *s = heap_sc_span_of(ap);
+    assert(s->sizeclass != HEAP_SC_FREE);
+    return s->sizeclass == HEAP_SC_LARGE ? -1 : s->sizeclass;
+}
+
+/**
+ * \brief Returns the number of usable bytes in an allocated object
+ */
+size_t heap_sc_usable_size(void *ap)
+{
+    struct heap_sc_span *s = heap_sc_span_of(ap);
+    if (s->sizeclass == HEAP_SC_LARGE) {
+        return s->nspans * HEAP_SC_SPAN_SIZE - HEAP_SC_HDRSIZE;
+    }
+    assert(s->sizeclass < HEAP_SC_NCLASSES);
+    return heap_sc_sizes[s->sizeclass];
+}
+
+/// Is the span within the current chunk, and hence followed by another run?
+static inline bool heap_sc_in_chunk(struct heap_sc *heap, struct heap_sc_span *s)
+{
+    return (char *)s >= heap->chunk_base && (char *)s < heap->chunk_cur;
+}
+
+/**
+ * \brief Merge an unused run with the unused runs following it
+ *
+ * Runs in the current chunk tile it without gaps, so the span following a
+ * run always starts with a valid header. Runs are only merged forward;
+ * preceding unused runs merge with this one once they are visited.
+ */
+static void heap_sc_merge_forward(struct heap_sc *heap, struct heap_sc_span *s)
+{
+    assert(s->sizeclass == HEAP_SC_FREE);
+    while (heap_sc_in_chunk(heap, s)) {
+        char *next = (char *)s + (size_t)s->nspans * HEAP_SC_SPAN_SIZE;
+        if (next == heap->chunk_cur) {
+            break;
+        }
+        struct heap_sc_span *ns = (void *)next;
+        if (ns->sizeclass != HEAP_SC_FREE) {
+            break;
+        }
+        heap_sc_list_remove(&heap->free_runs, ns);
+        s->nspans += ns->nspans;
+    }
+}
+
+/// Return a run of spans to the heap's list of unused runs
+static void heap_sc_put_run(struct heap_sc *heap, struct heap_sc_span *s,
+                            uint32_t nspans)
+{
+    s->sizeclass = HEAP_SC_FREE;
+    s->nspans = nspans;
+    heap_sc_merge_forward(heap, s);
+
+    // give the run back to the chunk if it is at its end
+    if (heap_sc_in_chunk(heap, s) && (char *)s + (size_t)s->nspans
+        * HEAP_SC_SPAN_SIZE == heap->chunk_cur) {
+        heap->chunk_cur = (char *)s;
+        return;
+    }
+    heap_sc_list_push(&heap->free_runs, s);
+}
+
+/// Get a run of nspans contiguous, span-aligned spans
+static struct heap_sc_span *heap_sc_get_run(struct heap_sc *heap,
+                                            uint32_t nspans)
+{
+    size_t bytes = (size_t)nspans * HEAP_SC_SPAN_SIZE;
+
+    // first fit from unused runs, splitting off the remainder
+    for (struct heap_sc_span *s = heap->free_runs; s != NULL; s = s->next) {
+        heap_sc_merge_forward(heap, s);
+        if (s->nspans >= nspans) {
+            heap_sc_list_remove(&heap->free_runs, s);
+            if (s->nspans > nspans) {
+                heap_sc_put_run(heap, (void *)((char *)s + bytes),
+                                s->nspans - nspans);
+            }
+            s->nspans = nspans;
+            return s;
+        }
+    }
+
+    for (;;) {
+        // carve from current chunk
+        char *base = (char *)ROUND_UP((uintptr_t)heap->chunk_cur,
+                                      HEAP_SC_SPAN_SIZE);
+        if (heap->chunk_cur != NULL && base + bytes <= heap->chunk_end) {
+            heap->chunk_cur = base + bytes;
+            struct heap_sc_span *s = (void *)base;
+            s->nspans = nspans;
+            return s;
+        }
+
+        // get more memory; if it is contiguous, just extend the chunk
+        size_t retbytes = 0;
+        size_t request = bytes + HEAP_SC_SPAN_SIZE;
+        if (request < HEAP_SC_CHUNK_SIZE) {
+            request = HEAP_SC_CHUNK_SIZE;
+        }
+        char *buf = heap->morecore_func(request, &retbytes);
+        if (buf == NULL || retbytes == 0) {
+            return NULL;
+        }
+        heap->stats.core_bytes += retbytes;
+
+        if (buf != heap->chunk_end) {
+            // retire what is left of the old chunk
+            if (heap->chunk_cur != NULL && base + HEAP_SC_SPAN_SIZE <= heap->chunk_end) {
+                struct heap_sc_span *rest = (void *)base;
+                rest->sizeclass = HEAP_SC_FREE;
+                rest->nspans = (heap->chunk_end - base) / HEAP_SC_SPAN_SIZE;
+                heap_sc_list_push(&heap->free_runs, rest);
+            }
+            heap->chunk_base = heap->chunk_cur = buf;
+        }
+        heap->chunk_end = buf + retbytes;
+    }
+}
+
+/**
+ * \brief Free the objects other heaps handed back to this one
+ *
+ * Must be called with the heap's lock held.
+ */
+static void heap_sc_drain_remote(struct heap_sc *heap)
+{
+    if (heap->remote_free == NULL) {
+        return;
+    }
+
+    void *p = __sync_lock_test_and_set(&heap->remote_free, NULL);
+    while (p != NULL) {
+        void *next = *(void **)p;
+        heap_sc_free(heap, p);
+        p = next;
+    }
+}
+
+/// Allocate an object of size class sc
+static void *heap_sc_alloc_small(struct heap_sc *heap, int sc)
+{
+    struct heap_sc_span *s = heap->partial[sc];
+    if (s == NULL) {
+        heap_sc_drain_remote(heap);
+        s = heap->partial[sc];
+    }
+    if (s == NULL) {
+        s = heap_sc_get_run(heap, 1);
+        if (s == NULL) {
+            return NULL;
+        }
+        s->heap = heap;
+        s->sizeclass = sc;
+        s->freelist = NULL;
+        s->bump = (char *)s + HEAP_SC_HDRSIZE;
+        s->nfree = s->ntotal = (HEAP_SC_SPAN_SIZE - HEAP_SC_HDRSIZE)
+                               / heap_sc_sizes[sc];
+        heap_sc_list_push(&heap->partial[sc], s);
+        heap->stats.span_bytes += HEAP_SC_SPAN_SIZE;
+    }
+
+    void *p;
+    if (s->freelist != NULL) {
+        p = s->freelist;
+        s->freelist = *(void **)p;
+    } else {
+        p = s->bump;
+        s->bump += heap_sc_sizes[sc];
+    }
+    if (--s->nfree == 0) {
+        heap_sc_list_remove(&heap->partial[sc], s);
+    }
+
+    heap->stats.small_allocs++;
+    heap->stats.live_bytes += heap_sc_sizes[sc];
+    return p;
+}
+
+/// Free an object of a size class
+static void heap_sc_free_small(struct heap_sc *heap, struct heap_sc_span *s,
+                               void *ap)
+{
+    int sc = s->sizeclass;
+    assert(sc < HEAP_SC_NCLASSES);
+
+    if (s->nfree++ == 0) {
+        heap_sc_list_push(&heap->partial[sc], s);
+    }
+    *(void **)ap = s->freelist;
+    s->freelist = ap;
+    heap->stats.live_bytes -= heap_sc_sizes[sc];
+
+    // release completely free spans, unless it's the only one of this class
+    if (s->nfree == s->ntotal && (s->next != NULL || s->prev != NULL)) {
+        heap_sc_list_remove(&heap->partial[sc], s);
+        heap_sc_put_run(heap, s, 1);
+        heap->stats.span_bytes -= HEAP_SC_SPAN_SIZE;
+    }
+}
+
+/**
+ * \brief Equivalent of malloc; allocates memory out of given size-class heap.
+ *
+ * \returns NULL on failure
+ */
+void *heap_sc_alloc(struct heap_sc *heap, size_t nbytes)
+{
+    int sc = heap_sc_size_class(nbytes);
+    if (sc >= 0) {
+        return heap_sc_alloc_small(heap, sc);
+    }
+
+    // large object: run of spans with header in front
+    uint32_t nspans = DIVIDE_ROUND_UP(nbytes + HEAP_SC_HDRSIZE,
+                                      HEAP_SC_SPAN_SIZE);
+    heap_sc_drain_remote(heap);
+    struct heap_sc_span *s = heap_sc_get_run(heap, nspans);
+    if (s == NULL) {
+        return NULL;
+    }
+    s->heap = heap;
+    s->sizeclass = HEAP_SC_LARGE;
+    s->next = s->prev = NULL;
+
+    heap->stats.large_allocs++;
+    heap->stats.live_bytes += (size_t)nspans * HEAP_SC_SPAN_SIZE;
+    heap->stats.span_bytes += (size_t)nspans * HEAP_SC_SPAN_SIZE;
+    return (char *)s + HEAP_SC_HDRSIZE;
+}
+
+/**
+ * \brief Equivalent of free: return object to size-class heap.
+ *
+ * Objects allocated from another heap are handed back to that heap, which
+ * frees them the next time it runs out of free objects.
+ */
+void heap_sc_free(struct heap_sc *heap, void *ap)
+{
+    if (ap == NULL) {
+        return;
+    }
+
+    struct heap_sc_span *s = heap_sc_span_of(ap);
+    if (s->heap != heap) {
+        struct heap_sc *owner = s->heap;
+        void *head;
+        do {
+            head = owner->remote_free;
+            *(void **)ap = head;
+        } while (!__sync_bool_compare_and_swap(&owner->remote_free, head, ap));
+        heap->stats.remote_frees++;
+        return;
+    }
+
+    if (s->sizeclass != HEAP_SC_LARGE) {
+        heap_sc_free_small(heap, s, ap);
+        return;
+    }
+
+    assert(ap == (char *)s + HEAP_SC_HDRSIZE);
+    heap->stats.live_bytes -= (size_t)s->nspans * HEAP_SC_SPAN_SIZE;
+    heap->stats.span_bytes -= (size_t)s->nspans * HEAP_SC_SPAN_SIZE;
+    heap_sc_put_run(heap, s, s->nspans);
+}
+
+/**
+ * \brief Move up to count objects of size class sc from the heap into a
+ * thread cache
+ */
+void heap_sc_tcache_fill(struct heap_sc *heap, struct heap_sc_tcache *tc,
+                         int sc, unsigned count)
+{
+    for (unsigned i = 0; i < count; i++) {
+        void *p = heap_sc_alloc_small(heap, sc);
+        if (p == NULL || !heap_sc_tcache_push(tc, sc, p)) {
+            heap_sc_free(heap, p);
+            break;
+        }
+    }
+}
+
+/**
+ * \brief Move up to count objects of size class sc from a thread cache back
+ * to the heap
+ */
+void heap_sc_tcache_drain(struct heap_sc *heap, struct heap_sc_tcache *tc,
+                          int sc, unsigned count)
+{
+    void *p;
+    for (unsigned i = 0; i < count && (p = heap_sc_tcache_pop(tc, sc)); i++) {
+        heap_sc_free(heap, p);
+    }
+}
+
+/**
+ * \brief Return all objects in a thread cache to the heap
+ */
+void heap_sc_tcache_flush(struct heap_sc *heap, struct heap_sc_tcache *tc)
+{
+    for (int sc = 0; sc < HEAP_SC_NCLASSES; sc++) {
+        heap_sc_tcache_drain(heap, tc, sc, tc->count[sc]);
+    }
+}
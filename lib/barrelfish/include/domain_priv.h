@@ -16,5 +16,8 @@
 #define LIBBARRELFISH_DOMAIN_PRIV_H
 
 errval_t domain_new_dispatcher_arch(dispatcher_handle_t handle);
+errval_t domain_wakeup_on_coreid_disabled(coreid_t core_id,
+                                          struct thread *thread,
+                                          dispatcher_handle_t mydisp);
 
 #endif
@@ -0,0 +1,43 @@
+/**
+ * \file
+ * \brief pmap datastructure header for radix tree pmap. This file is
+ * included by selecting the right include dir in lib/barrelfish/Hakefile
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#ifndef LIBBF_INCLUDE_PMAP_DS_H
+#define LIBBF_INCLUDE_PMAP_DS_H
+
+/**
+ * \brief find the child of `root` with the smallest entry >= `entry`.
+ * \returns the entry after the one of the child found.
+ */
+int pmap_radix_next(struct vnode *root, int entry, struct vnode **n);
+
+#define PMAP_RADIX_CONCAT_(a, b) a ## b
+#define PMAP_RADIX_CONCAT(a, b) PMAP_RADIX_CONCAT_(a, b)
+
+/**
+ * \brief a macro that provides a datastructure-independent way of iterating
+ * through the non-null children of the vnode `root`.
+ * The entry to continue from is computed before the loop body runs, so the
+ * body may remove `iter` from `root`. Nested loops need to be on separate
+ * lines.
+ *
+ * Note: this macro requires both root and iter to be 'struct vnode *'.
+ */
+#define pmap_foreach_child(root, iter) \
+    pmap_foreach_child_(root, iter, PMAP_RADIX_CONCAT(pmap_radix_next_, __LINE__))
+#define pmap_foreach_child_(root, iter, next) \
+    for (int next = pmap_radix_next(root, 0, &iter); iter != NULL; \
+         next = pmap_radix_next(root, next, &iter))
+
+#endif // LIBBF_INCLUDE_PMAP_DS_H
@@ -66,6 +66,7 @@ struct thread {
     bool                detached;           ///< true if detached
     bool                joining;            ///< true if someone is joining
     bool                in_exception;       ///< true if running exception handler
+    bool                migratable;         ///< May be moved by the load balancer
 #if defined(__x86_64__)
     uint16_t            thread_seg_selector; ///< Segment selector for TCB
 #endif
@@ -26,6 +26,10 @@
 #       define HEAP_REGION (512UL * 1024 * 1024) /* 512MB */
 #endif
 
+#ifndef MORECORE_PROMOTE
+#       define MORECORE_PROMOTE 0
+#endif
+
 typedef void *(*morecore_alloc_func_t)(size_t bytes, size_t *retbytes);
 extern morecore_alloc_func_t sys_morecore_alloc;
 
@@ -143,7 +147,10 @@ errval_t morecore_reinit(void)
     if ((vregion_get_flags(&state->mmu_state.vregion)
             & (VREGION_FLAGS_HUGE|VREGION_FLAGS_LARGE)) == 0)
     {
-        // No need to do anything if the heap is using base pages anyway
+        // No need to remap if the heap is using base pages anyway, but now
+        // that we can get large frames from the memory server, grow it with
+        // large pages where possible.
+        vspace_mmu_aware_set_promote(&state->mmu_state, MORECORE_PROMOTE);
         return SYS_ERR_OK;
     }
 
@@ -171,3 +178,12 @@ errval_t morecore_reinit(void)
     }
     return vspace_mmu_aware_reset(&state->mmu_state, frame, remapsize);
 }
+
+/**
+ * \brief Return the large page promotion counters of the heap
+ */
+void morecore_get_promote_stats(struct memobj_anon_promote_stats *stats)
+{
+    struct morecore_state *state = get_morecore_state();
+    *stats = state->mmu_state.memobj.promote_stats;
+}
@@ -55,7 +55,7 @@ bool pmap_inside_region(struct vnode *root, uint16_t entry, uint16_t npages)
     return false;
 }
 
-void pmap_remove_vnode(struct vnode *root, struct vnode *item)
+void pmap_remove_vnode(struct pmap *pmap, struct vnode *root, struct vnode *item)
 {
     assert(root->v.is_vnode);
     size_t pte_count = item->v.is_vnode ? 1 : item->v.u.frame.pte_count;
@@ -106,7 +106,8 @@ void pmap_vnode_init(struct pmap *p, struct vnode *v)
     memset(v->v.u.vnode.children, 0, PTSLAB_SLABSIZE);
 }
 
-void pmap_vnode_insert_child(struct vnode *root, struct vnode *newvnode)
+void pmap_vnode_insert_child(struct pmap *pmap, struct vnode *root,
+                             struct vnode *newvnode)
 {
     size_t pte_count = newvnode->v.is_vnode ? 1 : newvnode->v.u.frame.pte_count;
     // check that we don't overflow children buffer
@@ -141,3 +142,11 @@ errval_t pmap_refill_slabs(struct pmap *pmap, size_t max_slabs)
     }
     return SYS_ERR_OK;
 }
+
+void pmap_ds_measure_res(struct pmap *pmap, struct pmap_res_info *buf)
+{
+    size_t free_slabs = slab_freecount(&pmap->m.ptslab);
+    size_t used_slabs = slab_totalcount(&pmap->m.ptslab) - free_slabs;
+    buf->vnode_used += used_slabs * pmap->m.ptslab.blocksize;
+    buf->vnode_free += free_slabs * pmap->m.ptslab.blocksize;
+}
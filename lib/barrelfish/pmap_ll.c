@@ -67,7 +67,7 @@ bool pmap_inside_region(struct vnode *root, uint16_t entry, uint16_t npages)
     return false;
 }
 
-void pmap_remove_vnode(struct vnode *root, struct vnode *item)
+void pmap_remove_vnode(struct pmap *pmap, struct vnode *root, struct vnode *item)
 {
     assert(root->v.is_vnode);
     struct vnode *walk = root->v.u.vnode.children;
@@ -114,7 +114,8 @@ void pmap_vnode_init(struct pmap *p, struct vnode *v)
     v->v.meta.next = NULL;
 }
 
-void pmap_vnode_insert_child(struct vnode *root, struct vnode *newvnode)
+void pmap_vnode_insert_child(struct pmap *pmap, struct vnode *root,
+                             struct vnode *newvnode)
 {
     newvnode->v.meta.next = root->v.u.vnode.children;
     root->v.u.vnode.children = newvnode;
@@ -129,3 +130,8 @@ errval_t pmap_refill_slabs(struct pmap *pmap, size_t max_slabs)
 {
     return pmap_slab_refill(pmap, &pmap->m.slab, max_slabs);
 }
+
+void pmap_ds_measure_res(struct pmap *pmap, struct pmap_res_info *buf)
+{
+    // the linked list lives in the vnodes themselves
+}
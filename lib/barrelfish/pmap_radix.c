@@ -0,0 +1,351 @@
+/**
+ * \file
+ * \brief architecture-independent shadow page table traversal code for
+ *        radix tree pmap implementation.
+ *
+ * The children of a vnode are kept in a radix tree over their entry, with
+ * PMAP_RADIX_FANOUT slots per node so that a node fills one cache line. The
+ * tree is compressed: a subtree holding a single child is replaced by the
+ * child itself, tagged in bit 0 of the slot. Nodes are only allocated where
+ * entries are densely populated, which keeps sparse page tables small while
+ * a lookup touches at most PMAP_RADIX_LEVELS cache lines.
+ *
+ * Every child is stored once, at its first entry. A mapping spanning several
+ * entries is found by looking for the child with the largest entry not
+ * greater than the one we're looking for.
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#include <barrelfish/barrelfish.h>
+#include <barrelfish/pmap_target.h>
+#include <string.h>
+
+#include <pmap_ds.h>
+#include <pmap_priv.h>
+
+/// Levels of the tree, each level consumes PMAP_RADIX_BITS of the entry
+#define PMAP_RADIX_LEVELS 3
+STATIC_ASSERT(PTABLE_ENTRIES <= 1 << (PMAP_RADIX_BITS * PMAP_RADIX_LEVELS),
+              "radix tree covers all page table entries");
+STATIC_ASSERT(sizeof(struct pmap_radix_node) == 64,
+              "radix tree node is a cache line");
+
+/// Tag of a slot holding a child vnode rather than the next level
+#define RADIX_LEAF ((uintptr_t)1)
+
+static inline bool is_leaf(uintptr_t s)
+{
+    return s & RADIX_LEAF;
+}
+
+static inline struct vnode *leaf(uintptr_t s)
+{
+    return (struct vnode *)(s & ~RADIX_LEAF);
+}
+
+static inline struct pmap_radix_node *node(uintptr_t s)
+{
+    return (struct pmap_radix_node *)s;
+}
+
+static inline unsigned digit(uint16_t entry, int level)
+{
+    return (entry >> (PMAP_RADIX_BITS * (PMAP_RADIX_LEVELS - 1 - level)))
+           & (PMAP_RADIX_FANOUT - 1);
+}
+
+static inline uintptr_t root_slot(struct vnode *root)
+{
+    return (uintptr_t)root->v.u.vnode.children;
+}
+
+static inline void set_root_slot(struct vnode *root, uintptr_t s)
+{
+    root->v.u.vnode.children = node(s);
+}
+
+/// Child with the smallest entry in the subtree of slot `s`
+static struct vnode *radix_first(uintptr_t s)
+{
+    while (s && !is_leaf(s)) {
+        struct pmap_radix_node *n = node(s);
+        int i = 0;
+        while (!n->slot[i]) {
+            i++;
+        }
+        assert(i < PMAP_RADIX_FANOUT); // nodes are never empty
+        s = n->slot[i];
+    }
+    return s ? leaf(s) : NULL;
+}
+
+/// Child with the largest entry in the subtree of slot `s`
+static struct vnode *radix_last(uintptr_t s)
+{
+    while (s && !is_leaf(s)) {
+        struct pmap_radix_node *n = node(s);
+        int i = PMAP_RADIX_FANOUT - 1;
+        while (!n->slot[i]) {
+            i--;
+        }
+        assert(i >= 0); // nodes are never empty
+        s = n->slot[i];
+    }
+    return s ? leaf(s) : NULL;
+}
+
+/// Child with the largest entry <= `entry` in the subtree of slot `s`
+static struct vnode *radix_pred(uintptr_t s, int level, uint16_t entry)
+{
+    if (!s) {
+        return NULL;
+    }
+    if (is_leaf(s)) {
+        struct vnode *v = leaf(s);
+        return v->v.entry <= entry ? v : NULL;
+    }
+
+    struct pmap_radix_node *n = node(s);
+    int d = digit(entry, level);
+    struct vnode *v = radix_pred(n->slot[d], level + 1, entry);
+    for (int i = d - 1; v == NULL && i >= 0; i--) {
+        v = radix_last(n->slot[i]);
+    }
+    return v;
+}
+
+/// Child with the smallest entry >= `entry` in the subtree of slot `s`
+static struct vnode *radix_succ(uintptr_t s, int level, uint16_t entry)
+{
+    if (!s) {
+        return NULL;
+    }
+    if (is_leaf(s)) {
+        struct vnode *v = leaf(s);
+        return v->v.entry >= entry ? v : NULL;
+    }
+
+    struct pmap_radix_node *n = node(s);
+    int d = digit(entry, level);
+    struct vnode *v = radix_succ(n->slot[d], level + 1, entry);
+    for (int i = d + 1; v == NULL && i < PMAP_RADIX_FANOUT; i++) {
+        v = radix_first(n->slot[i]);
+    }
+    return v;
+}
+
+/// Insert `v` into the subtree of slot `s`, returns the new slot value
+static uintptr_t radix_insert(struct pmap *pmap, uintptr_t s, int level,
+                              struct vnode *v)
+{
+    if (!s) {
+        return (uintptr_t)v | RADIX_LEAF;
+    }
+
+    if (is_leaf(s)) {
+        // split: push the child down into a new node
+        struct vnode *old = leaf(s);
+        assert(old->v.entry != v->v.entry);
+        assert(level < PMAP_RADIX_LEVELS);
+        struct pmap_radix_node *n = slab_alloc(&pmap->m.ptslab);
+        assert(n);
+        memset(n, 0, sizeof(*n));
+        n->slot[digit(old->v.entry, level)] = s;
+        s = (uintptr_t)n;
+    }
+
+    struct pmap_radix_node *n = node(s);
+    int d = digit(v->v.entry, level);
+    n->slot[d] = radix_insert(pmap, n->slot[d], level + 1, v);
+    return s;
+}
+
+/// Remove `item` from the subtree of slot `s`, returns the new slot value
+static uintptr_t radix_remove(struct pmap *pmap, uintptr_t s, int level,
+                              struct vnode *item)
+{
+    if (!s) {
+        USER_PANIC("Should not get here");
+    }
+    if (is_leaf(s)) {
+        assert(leaf(s) == item);
+        return 0;
+    }
+
+    struct pmap_radix_node *n = node(s);
+    int d = digit(item->v.entry, level);
+    n->slot[d] = radix_remove(pmap, n->slot[d], level + 1, item);
+
+    // collapse nodes that are empty or hold a single child
+    uintptr_t only = 0;
+    int count = 0;
+    for (int i = 0; i < PMAP_RADIX_FANOUT; i++) {
+        if (n->slot[i]) {
+            only = n->slot[i];
+            count++;
+        }
+    }
+    if (count == 0 || (count == 1 && is_leaf(only))) {
+        slab_free(&pmap->m.ptslab, n);
+        return only;
+    }
+    return s;
+}
+
+static void radix_free(struct pmap *pmap, uintptr_t s)
+{
+    if (!s || is_leaf(s)) {
+        return;
+    }
+    struct pmap_radix_node *n = node(s);
+    for (int i = 0; i < PMAP_RADIX_FANOUT; i++) {
+        radix_free(pmap, n->slot[i]);
+    }
+    slab_free(&pmap->m.ptslab, n);
+}
+
+int pmap_radix_next(struct vnode *root, int entry, struct vnode **n)
+{
+    assert(n);
+    if (entry >= PTABLE_ENTRIES) {
+        *n = NULL;
+        return PTABLE_ENTRIES;
+    }
+    *n = radix_succ(root_slot(root), 0, entry);
+    return *n ? (*n)->v.entry + 1 : PTABLE_ENTRIES;
+}
+
+/**
+ * \brief Starting at a given root, return the vnode with entry equal to #entry
+ */
+struct vnode *pmap_find_vnode(struct vnode *root, uint16_t entry)
+{
+    assert(root != NULL);
+    assert(root->v.is_vnode);
+    assert(entry < PTABLE_ENTRIES);
+
+    struct vnode *n = radix_pred(root_slot(root), 0, entry);
+    if (n == NULL) {
+        return NULL;
+    }
+    if (n->v.entry == entry) {
+        return n;
+    }
+    // check whether entry is inside a large region
+    if (!n->v.is_vnode && entry < n->v.entry + n->v.u.frame.pte_count) {
+        return n;
+    }
+    return NULL;
+}
+
+bool pmap_inside_region(struct vnode *root, uint16_t entry, uint16_t npages)
+{
+    assert(root != NULL);
+    assert(root->v.is_vnode);
+
+    struct vnode *n = radix_pred(root_slot(root), 0, entry);
+
+    // empty or ptable
+    if (!n || n->v.is_vnode) {
+        return false;
+    }
+
+    uint16_t end = n->v.entry + n->v.u.frame.pte_count;
+    return entry + npages <= end;
+}
+
+void pmap_remove_vnode(struct pmap *pmap, struct vnode *root, struct vnode *item)
+{
+    assert(root->v.is_vnode);
+    set_root_slot(root, radix_remove(pmap, root_slot(root), 0, item));
+}
+
+errval_t pmap_vnode_mgmt_init(struct pmap *pmap)
+{
+    struct pmap_vnode_mgmt *m = &pmap->m;
+    /* special case init of own pmap vnode mgmt */
+    if (get_current_pmap() == pmap) {
+        /* use core state buffers */
+        slab_init(&m->slab, sizeof(struct vnode), NULL);
+        slab_grow(&m->slab, m->slab_buffer, INIT_SLAB_BUFFER_SIZE);
+
+        /* Initialize slab allocator for radix tree nodes */
+        slab_init(&m->ptslab, RADIXSLAB_SLABSIZE, NULL);
+        slab_grow(&m->ptslab, m->ptslab_buffer, INIT_RADIXSLAB_BUFFER_SIZE);
+    } else {
+        /*initialize slab allocator for vnodes */
+        slab_init(&m->slab, sizeof(struct vnode), NULL);
+        uint8_t *buf = malloc(INIT_SLAB_BUFFER_SIZE);
+        if (!buf) {
+            return LIB_ERR_MALLOC_FAIL;
+        }
+        slab_grow(&m->slab, buf, INIT_SLAB_BUFFER_SIZE);
+
+        /* Initialize slab allocator for radix tree nodes */
+        slab_init(&m->ptslab, RADIXSLAB_SLABSIZE, NULL);
+        buf = malloc(INIT_RADIXSLAB_BUFFER_SIZE);
+        if (!buf) {
+            return LIB_ERR_MALLOC_FAIL;
+        }
+        slab_grow(&m->ptslab, buf, INIT_RADIXSLAB_BUFFER_SIZE);
+    }
+
+    return SYS_ERR_OK;
+}
+
+void pmap_vnode_init(struct pmap *p, struct vnode *v)
+{
+    v->v.u.vnode.children = NULL;
+}
+
+void pmap_vnode_insert_child(struct pmap *pmap, struct vnode *root,
+                             struct vnode *newvnode)
+{
+    assert(root->v.is_vnode);
+    assert(newvnode->v.entry < PTABLE_ENTRIES);
+    set_root_slot(root, radix_insert(pmap, root_slot(root), 0, newvnode));
+}
+
+void pmap_vnode_free(struct pmap *pmap, struct vnode *n)
+{
+    radix_free(pmap, root_slot(n));
+    slab_free(&pmap->m.slab, n);
+}
+
+errval_t pmap_refill_slabs(struct pmap *pmap, size_t max_slabs)
+{
+    errval_t err;
+    err = pmap_slab_refill(pmap, &pmap->m.slab, max_slabs);
+    if (err_is_fail(err)) {
+        return err;
+    }
+    /* inserting a vnode allocates at most one node per level */
+    err = pmap_slab_refill(pmap, &pmap->m.ptslab,
+                           PMAP_RADIX_LEVELS * max_slabs);
+    if (err_is_fail(err)) {
+        return err;
+    }
+    /* as for pmap_array, after refilling the node slabs, we need to make
+     * sure that we actually still have enough vnode slabs. */
+    err = pmap_slab_refill(pmap, &pmap->m.slab, max_slabs);
+    if (err_is_fail(err)) {
+        return err;
+    }
+    return SYS_ERR_OK;
+}
+
+void pmap_ds_measure_res(struct pmap *pmap, struct pmap_res_info *buf)
+{
+    size_t free_slabs = slab_freecount(&pmap->m.ptslab);
+    size_t used_slabs = slab_totalcount(&pmap->m.ptslab) - free_slabs;
+    buf->vnode_used += used_slabs * pmap->m.ptslab.blocksize;
+    buf->vnode_free += free_slabs * pmap->m.ptslab.blocksize;
+}
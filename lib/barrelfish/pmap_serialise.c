@@ -157,7 +157,7 @@ static errval_t deserialise_tree(struct pmap *pmap, struct serial_entry **in,
         n->v.cap.slot      = (*in)->slot;
         n->v.u.vnode.invokable     = n->v.cap;
         pmap_vnode_init(pmap, n);
-        pmap_vnode_insert_child((struct vnode *)parent, n);
+        pmap_vnode_insert_child(pmap, (struct vnode *)parent, n);
         n->v.type = (*in)->type;
 
         /* XXX: figure out if we want this
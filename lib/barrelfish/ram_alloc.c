@@ -21,12 +21,131 @@
 #include <if/hyper_defs.h>
 #endif
 
+/*
+ * batched allocation of count caps, returned in an L2 CNode that is received
+ * into the given (empty) slot. Must be called with the ram_alloc_lock held.
+ */
+static errval_t ram_alloc_batch_remote(struct capref recv, uint8_t size_bits,
+                                       uint32_t count, uint64_t minbase,
+                                       uint64_t maxlimit, uint32_t *retcount)
+{
+    errval_t err, result;
+
+    struct mem_binding *b = get_mem_client();
+    err = b->rpc_tx_vtbl.allocate_batch(b, disp_get_core_id(), size_bits, count,
+                                        minbase, maxlimit, &result, retcount,
+                                        &recv);
+    if (err_is_fail(err)) {
+        return err;
+    }
+
+    return result;
+}
+
+/* can this request be served from the prefetched batch? */
+static bool ram_prefetch_usable(struct ram_alloc_state *state,
+                                uint8_t size_bits, uint64_t minbase,
+                                uint64_t maxlimit)
+{
+    if (!state->prefetch_enabled || state->prefetch_busy
+        || size_bits != BASE_PAGE_BITS || minbase != 0 || maxlimit != 0) {
+        return false;
+    }
+
+    if (!capref_is_null(state->prefetch_cnode)) {
+        return true;
+    }
+
+    // We need a slot in the root CNode to address the batch CNode. Getting
+    // one may call back into ram_alloc, so this is done without holding the
+    // ram_alloc_lock and with the prefetch path disabled meanwhile.
+    struct capref cn;
+    state->prefetch_busy = true;
+    errval_t err = slot_alloc_root(&cn);
+    state->prefetch_busy = false;
+    if (err_is_fail(err)) {
+        return false;
+    }
+
+    thread_mutex_lock(&state->ram_alloc_lock);
+    if (capref_is_null(state->prefetch_cnode)) {
+        state->prefetch_cnode = cn;
+    } else {
+        slot_free(cn);
+    }
+    thread_mutex_unlock(&state->ram_alloc_lock);
+
+    return true;
+}
+
+/*
+ * hand out the next prefetched cap in the (empty) slot dest, fetching a new
+ * batch if needed. Must be called with the ram_alloc_lock held.
+ */
+static errval_t ram_prefetch_get(struct ram_alloc_state *state,
+                                 struct capref dest)
+{
+    errval_t err;
+
+    if (state->prefetch_next == state->prefetch_count) {
+        if (state->prefetch_count > 0) {
+            // all caps have been handed out: drop the empty CNode
+            err = cap_delete(state->prefetch_cnode);
+            if (err_is_fail(err)) {
+                return err_push(err, LIB_ERR_CAP_DELETE);
+            }
+            state->prefetch_next = state->prefetch_count = 0;
+        }
+
+        uint32_t count;
+        err = ram_alloc_batch_remote(dest, BASE_PAGE_BITS, RAM_ALLOC_PREFETCH,
+                                     0, 0, &count);
+        if (err_is_fail(err)) {
+            if (err_no(err) == LIB_ERR_RAM_ALLOC_BATCH_REMOTE
+                || err_no(err) == ERR_NOTIMP) {
+                state->prefetch_enabled = false;
+            }
+            return err;
+        }
+
+        err = cap_copy(state->prefetch_cnode, dest);
+        if (err_is_ok(err)) {
+            err = cap_delete(dest);
+        }
+        if (err_is_fail(err)) {
+            state->prefetch_enabled = false;
+            return err;
+        }
+        state->prefetch_count = count;
+    }
+
+    struct capref src = {
+        .cnode = build_cnoderef(state->prefetch_cnode, CNODE_TYPE_OTHER),
+        .slot = state->prefetch_next,
+    };
+    err = cap_copy(dest, src);
+    if (err_is_fail(err)) {
+        // leave the cap in the batch for the next request
+        return err_push(err, LIB_ERR_CAP_COPY);
+    }
+    state->prefetch_next++;
+
+    // dest holds the cap now; a copy left behind goes with the batch CNode
+    err = cap_delete(src);
+    if (err_is_fail(err)) {
+        DEBUG_ERR(err, "cap_delete of prefetched RAM cap");
+    }
+    return SYS_ERR_OK;
+}
+
 /* remote (indirect through a channel) version of ram_alloc, for most domains */
 static errval_t ram_alloc_remote(struct capref *ret, uint8_t size_bits,
                                  uint64_t minbase, uint64_t maxlimit)
 {
     struct ram_alloc_state *ram_alloc_state = get_ram_alloc_state();
     errval_t err, result;
+    bool prefetch = ram_prefetch_usable(ram_alloc_state, size_bits, minbase,
+                                        maxlimit);
 
     // XXX: the transport that ram_alloc uses will allocate slots,
     // which may cause slot_allocator to grow itself.
@@ -63,6 +182,15 @@ static errval_t ram_alloc_remote(struct capref *ret, uint8_t size_bits,
 
     thread_mutex_lock(&ram_alloc_state->ram_alloc_lock);
 
+    if (prefetch) {
+        err = ram_prefetch_get(ram_alloc_state, *ret);
+        if (err_is_ok(err)) {
+            thread_mutex_unlock(&ram_alloc_state->ram_alloc_lock);
+            return SYS_ERR_OK;
+        }
+        // fall back to a single allocation
+    }
+
     struct mem_binding *b = get_mem_client();
     err = b->rpc_tx_vtbl.allocate(b, size_bits, minbase, maxlimit, &result, ret);
 
@@ -178,6 +306,70 @@ errval_t ram_alloc(struct capref *ret, uint8_t size_bits)
     return err;
 }
 
+/**
+ * \brief Allocates a batch of equally-sized RAM capabilities in one request
+ *
+ * \param retcn     Filled-in with the location of an L2 CNode (in the root
+ *                  CNode) holding the caps in slots 0..*retcount-1
+ * \param size_bits Size of every cap, as a power of two
+ * \param count     Number of caps requested (at most L2_CNODE_SLOTS)
+ * \param retcount  Filled-in with the number of caps actually allocated
+ *
+ * Only available when talking to a memory server on the same core.
+ */
+errval_t ram_alloc_batch(struct capref *retcn, uint8_t size_bits,
+                         uint32_t count, uint32_t *retcount)
+{
+    struct ram_alloc_state *ram_alloc_state = get_ram_alloc_state();
+    struct capref recv;
+    errval_t err;
+
+    if (ram_alloc_state->ram_alloc_func != ram_alloc_remote) {
+        return LIB_ERR_NOT_IMPLEMENTED;
+    }
+
+    err = slot_alloc_root(retcn);
+    if (err_is_fail(err)) {
+        return err_push(err, LIB_ERR_SLOT_ALLOC);
+    }
+
+    err = slot_alloc(&recv);
+    if (err_is_fail(err)) {
+        slot_free(*retcn);
+        return err_push(err, LIB_ERR_SLOT_ALLOC);
+    }
+
+    thread_mutex_lock(&ram_alloc_state->ram_alloc_lock);
+    err = ram_alloc_batch_remote(recv, size_bits, count,
+                                 ram_alloc_state->default_minbase,
+                                 ram_alloc_state->default_maxlimit, retcount);
+    thread_mutex_unlock(&ram_alloc_state->ram_alloc_lock);
+
+    if (err_is_ok(err)) {
+        err = cap_copy(*retcn, recv);
+        if (err_is_ok(err)) {
+            err = cap_delete(recv);
+        } else {
+            err = err_push(err, LIB_ERR_CAP_COPY);
+        }
+    }
+    slot_free(recv);
+
+    if (err_is_fail(err)) {
+        slot_free(*retcn);
+    }
+    return err;
+}
+
+/**
+ * \brief Enable or disable prefetching of base-page RAM caps in ram_alloc()
+ */
+void ram_alloc_set_prefetch(bool enable)
+{
+    struct ram_alloc_state *ram_alloc_state = get_ram_alloc_state();
+    ram_alloc_state->prefetch_enabled = enable;
+}
+
 errval_t ram_available(genpaddr_t *available, genpaddr_t *total)
 {
     errval_t err;
@@ -234,6 +426,11 @@ void ram_alloc_init(void)
     ram_alloc_state->default_maxlimit = 0;
     ram_alloc_state->base_capnum      = 0;
     ram_alloc_state->earlycn_capnum   = 0;
+    ram_alloc_state->prefetch_cnode   = NULL_CAP;
+    ram_alloc_state->prefetch_next    = 0;
+    ram_alloc_state->prefetch_count   = 0;
+    ram_alloc_state->prefetch_enabled = true;
+    ram_alloc_state->prefetch_busy    = false;
 }
 
 /**
@@ -4,6 +4,11 @@
  *
  * This file implements a simple slab allocator. It allocates blocks of a fixed
  * size from a pool of contiguous memory regions ("slabs").
+ *
+ * Slabs are kept on one of three lists (partial, full and empty) depending on
+ * their number of free blocks, and every block carries a back-pointer to its
+ * slab, so that both allocation and free are constant-time operations
+ * regardless of the number of slabs in the allocator.
  */
 
 /*
@@ -20,10 +25,56 @@
 #include <barrelfish/static_assert.h>
 
 struct block_head {
+    struct slab_head *slab; ///< Slab this block belongs to (tag, never handed out)
     struct block_head *next;///< Pointer to next block in free list
 };
 
-STATIC_ASSERT_SIZEOF(struct block_head, SLAB_BLOCK_HDRSIZE);
+STATIC_ASSERT_SIZEOF(struct block_head, SLAB_BLOCK_TAGSIZE + SLAB_BLOCK_HDRSIZE);
+
+/// Convert block header to the pointer handed out to the user
+#define BLOCK_TO_USER(bh)   ((void *)&(bh)->next)
+/// Convert pointer handed out to the user back to its block header
+#define USER_TO_BLOCK(ptr)  \
+    ((struct block_head *)((char *)(ptr) - SLAB_BLOCK_TAGSIZE))
+
+/// Returns the list a slab belongs on, given its current free count
+static inline struct slab_head **slab_list(struct slab_allocator *slabs,
+                                           struct slab_head *sh)
+{
+    if (sh->free == 0) {
+        return &slabs->full;
+    } else if (sh->free == sh->total) {
+        return &slabs->empty;
+    } else {
+        return &slabs->partial;
+    }
+}
+
+static inline void slab_list_remove(struct slab_head **list,
+                                    struct slab_head *sh)
+{
+    if (sh->prev != NULL) {
+        sh->prev->next = sh->next;
+    } else {
+        assert(*list == sh);
+        *list = sh->next;
+    }
+    if (sh->next != NULL) {
+        sh->next->prev = sh->prev;
+    }
+    sh->next = sh->prev = NULL;
+}
+
+static inline void slab_list_push(struct slab_head **list,
+                                  struct slab_head *sh)
+{
+    sh->prev = NULL;
+    sh->next = *list;
+    if (*list != NULL) {
+        (*list)->prev = sh;
+    }
+    *list = sh;
+}
 
 /**
  * \brief Initialise a new slab allocator
@@ -35,8 +86,9 @@ STATIC_ASSERT_SIZEOF(struct block_head, SLAB_BLOCK_HDRSIZE);
 void slab_init(struct slab_allocator *slabs, size_t blocksize,
                slab_refill_func_t refill_func)
 {
-    slabs->slabs = NULL;
-    slabs->blocksize = SLAB_REAL_BLOCKSIZE(blocksize);
+    slabs->partial = slabs->full = slabs->empty = NULL;
+    slabs->total = slabs->free = 0;
+    slabs->blocksize = SLAB_USER_BLOCKSIZE(blocksize);
     slabs->refill_func = refill_func;
 }
 
@@ -63,7 +115,7 @@ void slab_grow(struct slab_allocator *slabs, void *buf, size_t buflen)
     buf = (char *)buf + sizeof(struct slab_head);
 
     /* calculate number of blocks in buffer */
-    size_t blocksize = slabs->blocksize;
+    size_t blocksize = SLAB_REAL_BLOCKSIZE(slabs->blocksize);
     assert(buflen / blocksize <= UINT32_MAX);
     head->free = head->total = buflen / blocksize;
     assert(head->total > 0);
@@ -72,29 +124,34 @@ void slab_grow(struct slab_allocator *slabs, void *buf, size_t buflen)
     struct block_head *bh = head->blocks = buf;
     for (uint32_t i = head->total; i > 1; i--) {
         buf = (char *)buf + blocksize;
+        bh->slab = head;
         bh->next = buf;
         bh = buf;
     }
+    bh->slab = head;
     bh->next = NULL;
 
-    /* enqueue slab in list of slabs */
-    head->next = slabs->slabs;
-    slabs->slabs = head;
+    /* enqueue slab in list of empty slabs */
+    slab_list_push(&slabs->empty, head);
+    slabs->total += head->total;
+    slabs->free += head->free;
 }
 
 /**
- * \brief Allocate a new block from the slab allocator
+ * \brief Allocate a new block from the slab allocator without clearing it
+ *
+ * Partially used slabs are preferred over empty ones, to keep fragmentation
+ * low. The contents of the returned block are undefined.
  *
  * \param slabs Pointer to slab allocator instance
  *
  * \returns Pointer to block on success, NULL on error (out of memory)
  */
-void *slab_alloc(struct slab_allocator *slabs)
+void *slab_alloc_nozero(struct slab_allocator *slabs)
 {
     errval_t err;
     /* find a slab with free blocks */
-    struct slab_head *sh;
-    for (sh = slabs->slabs; sh != NULL && sh->free == 0; sh = sh->next);
+    struct slab_head *sh = slabs->partial ? slabs->partial : slabs->empty;
 
     if (sh == NULL) {
         /* out of memory. try refill function if we have one */
@@ -106,22 +163,47 @@ void *slab_alloc(struct slab_allocator *slabs)
                 DEBUG_ERR(err, "slab refill_func failed");
                 return NULL;
             }
-            for (sh = slabs->slabs; sh != NULL && sh->free == 0; sh = sh->next);
+            sh = slabs->partial ? slabs->partial : slabs->empty;
             if (sh == NULL) {
                 return NULL;
             }
         }
     }
 
+    struct slab_head **oldlist = slab_list(slabs, sh);
+
     /* dequeue top block from freelist */
     struct block_head *bh = sh->blocks;
     assert(bh != NULL);
+    assert(bh->slab == sh);
     sh->blocks = bh->next;
     sh->free--;
+    slabs->free--;
 
-    memset(bh, 0, slabs->blocksize);
+    /* move slab to its new list, if it changed */
+    struct slab_head **newlist = slab_list(slabs, sh);
+    if (newlist != oldlist) {
+        slab_list_remove(oldlist, sh);
+        slab_list_push(newlist, sh);
+    }
 
-    return bh;
+    return BLOCK_TO_USER(bh);
+}
+
+/**
+ * \brief Allocate a new, zero-filled block from the slab allocator
+ *
+ * \param slabs Pointer to slab allocator instance
+ *
+ * \returns Pointer to block on success, NULL on error (out of memory)
+ */
+void *slab_alloc(struct slab_allocator *slabs)
+{
+    void *block = slab_alloc_nozero(slabs);
+    if (block != NULL) {
+        memset(block, 0, slabs->blocksize);
+    }
+    return block;
 }
 
 /**
@@ -136,26 +218,30 @@ void slab_free(struct slab_allocator *slabs, void *block)
         return;
     }
 
-    struct block_head *bh = (struct block_head *)block;
+    struct block_head *bh = USER_TO_BLOCK(block);
 
     /* find matching slab */
-    struct slab_head *sh;
-    size_t blocksize = slabs->blocksize;
-    for (sh = slabs->slabs; sh != NULL; sh = sh->next) {
-        /* check if block falls inside this slab */
-        uintptr_t slab_limit = (uintptr_t)sh + sizeof(struct slab_head)
-                               + blocksize * sh->total;
-        if ((uintptr_t)bh > (uintptr_t)sh && (uintptr_t)bh < slab_limit) {
-            break;
-        }
-    }
+    struct slab_head *sh = bh->slab;
     assert(sh != NULL);
+    assert((uintptr_t)bh > (uintptr_t)sh && (uintptr_t)bh <
+           (uintptr_t)sh + sizeof(struct slab_head)
+           + SLAB_REAL_BLOCKSIZE(slabs->blocksize) * sh->total);
+
+    struct slab_head **oldlist = slab_list(slabs, sh);
 
     /* re-enqueue in slab's free list */
     bh->next = sh->blocks;
     sh->blocks = bh;
     sh->free++;
+    slabs->free++;
     assert(sh->free <= sh->total);
+
+    /* move slab to its new list, if it changed */
+    struct slab_head **newlist = slab_list(slabs, sh);
+    if (newlist != oldlist) {
+        slab_list_remove(oldlist, sh);
+        slab_list_push(newlist, sh);
+    }
 }
 
 /**
@@ -167,13 +253,19 @@ void slab_free(struct slab_allocator *slabs, void *block)
  */
 size_t slab_freecount(struct slab_allocator *slabs)
 {
-    size_t ret = 0;
-
-    for (struct slab_head *sh = slabs->slabs; sh != NULL; sh = sh->next) {
-        ret += sh->free;
-    }
+    return slabs->free;
+}
 
-    return ret;
+/**
+ * \brief Returns the count of all (free and allocated) blocks in the allocator
+ *
+ * \param slabs Pointer to slab allocator instance
+ *
+ * \returns Total block count
+ */
+size_t slab_totalcount(struct slab_allocator *slabs)
+{
+    return slabs->total;
 }
 
 /**
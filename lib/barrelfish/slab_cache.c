@@ -0,0 +1,435 @@
+/**
+ * \file
+ * \brief Per-dispatcher magazine cache on top of the slab allocator.
+ *
+ * This implements the magazine layer described by Bonwick and Adams
+ * ("Magazines and Vmem", USENIX 2001) around a shared slab allocator. Every
+ * dispatcher of a domain owns a loaded and a previous magazine, each holding
+ * up to SLAB_MAGAZINE_ROUNDS blocks. Allocations and frees are served from
+ * these with the dispatcher disabled and without touching shared state. Only
+ * when both are exhausted (or both full) is a magazine exchanged with the
+ * depot, and only when the depot has nothing to offer is the backing slab
+ * allocator touched, one magazine's worth of blocks at a time.
+ *
+ * A cache starts out without magazines and passes every request straight to
+ * the backing slab allocator, which is all a single dispatcher needs. The
+ * per-dispatcher structures and the magazines live in storage handed in by
+ * slab_cache_enable_magazines(), usually when the domain first spans, so the
+ * cache itself never calls malloc and can sit below the heap. Every
+ * dispatcher's structure is on a cache line of its own. When all magazines
+ * are in use, blocks go to and come from the backing slab allocator directly.
+ *
+ * Locking: the depot spinlock is only taken while the dispatcher is disabled,
+ * so it is never held across a preemption. The backing slab allocator may
+ * have to refill itself, which needs an enabled dispatcher, so its spinlock
+ * is only taken while enabled (or if the caller was already disabled).
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#include <string.h>
+#include <barrelfish/barrelfish.h>
+#include <barrelfish/dispatch.h>
+#include <barrelfish/dispatcher_arch.h>
+#include <barrelfish/slab_cache.h>
+
+/// Returns the per-dispatcher cache of the given dispatcher, or NULL
+static inline struct slab_cache_cpu *cpu_cache(struct slab_cache *cache,
+                                               dispatcher_handle_t handle)
+{
+    if (cache->cpu == NULL) {
+        return NULL;
+    }
+    struct dispatcher_generic *disp = get_dispatcher_generic(handle);
+    return &cache->cpu[disp->core_id];
+}
+
+static inline void depot_push(struct slab_magazine **list, size_t *count,
+                              struct slab_magazine *m)
+{
+    m->next = *list;
+    *list = m;
+    (*count)++;
+}
+
+static inline struct slab_magazine *depot_pop(struct slab_magazine **list,
+                                              size_t *count)
+{
+    struct slab_magazine *m = *list;
+    if (m != NULL) {
+        *list = m->next;
+        (*count)--;
+    }
+    return m;
+}
+
+/// Return a magazine to the depot. Must be called disabled.
+static void depot_put(struct slab_cache *cache, struct slab_magazine *m)
+{
+    acquire_spinlock(&cache->depot_lock);
+    if (m->rounds > 0) {
+        depot_push(&cache->depot_full, &cache->depot_nfull, m);
+    } else {
+        depot_push(&cache->depot_empty, &cache->depot_nempty, m);
+    }
+    release_spinlock(&cache->depot_lock);
+}
+
+/**
+ * \brief Initialise a slab cache
+ *
+ * After this call, the backing slab allocator must only be accessed through
+ * the cache.
+ *
+ * \param cache Pointer to slab cache instance, to be filled-in
+ * \param slabs Backing slab allocator
+ */
+void slab_cache_init(struct slab_cache *cache, struct slab_allocator *slabs)
+{
+    memset(cache, 0, sizeof(struct slab_cache));
+    cache->slabs = slabs;
+}
+
+/**
+ * \brief Give a slab cache storage for per-dispatcher magazines
+ *
+ * Until this is called, the cache passes all requests to the backing slab
+ * allocator. Call it before a second dispatcher uses the cache, e.g. when
+ * the domain first spans. The storage is never returned.
+ *
+ * \param cache  Pointer to slab cache instance
+ * \param buf    Storage of at least SLAB_CACHE_MAGAZINES_BUFSIZE bytes
+ * \param buflen Size of storage (in bytes)
+ */
+void slab_cache_enable_magazines(struct slab_cache *cache, void *buf,
+                                 size_t buflen)
+{
+    assert(cache->cpu == NULL);
+    assert(buflen >= SLAB_CACHE_MAGAZINES_BUFSIZE);
+
+    size_t cpusize = (MAX_COREID + 1) * sizeof(struct slab_cache_cpu);
+    struct slab_cache_cpu *cpu =
+        (void *)ROUND_UP((uintptr_t)buf, CACHE_LINE_SIZE);
+    struct slab_magazine *magazines = (void *)((char *)cpu + cpusize);
+    memset(cpu, 0, cpusize);
+
+    // threads of this dispatcher see either no magazines or all of them
+    dispatcher_handle_t handle = disp_disable();
+    acquire_spinlock(&cache->depot_lock);
+    for (size_t i = 0; i < SLAB_CACHE_MAGAZINES; i++) {
+        magazines[i].rounds = 0;
+        depot_push(&cache->depot_empty, &cache->depot_nempty, &magazines[i]);
+    }
+    release_spinlock(&cache->depot_lock);
+    cache->cpu = cpu;
+    disp_enable(handle);
+}
+
+/**
+ * \brief Fill an empty magazine from the depot with blocks from the backing
+ * slab allocator and put it back into the depot
+ *
+ * Must be called enabled.
+ *
+ * \returns true if at least one block could be allocated, false if the slab
+ * allocator or the supply of magazines is exhausted
+ */
+static bool slab_cache_refill(struct slab_cache *cache,
+                              struct slab_cache_stats *stats)
+{
+    dispatcher_handle_t handle = disp_disable();
+    acquire_spinlock(&cache->depot_lock);
+    struct slab_magazine *m = depot_pop(&cache->depot_empty,
+                                        &cache->depot_nempty);
+    release_spinlock(&cache->depot_lock);
+    disp_enable(handle);
+
+    if (m == NULL) {
+        stats->mag_shortage++;
+        return false;
+    }
+    assert(m->rounds == 0);
+
+    acquire_spinlock(&cache->slabs_lock);
+    while (m->rounds < SLAB_MAGAZINE_ROUNDS) {
+        void *block = slab_alloc_nozero(cache->slabs);
+        if (block == NULL) {
+            break;
+        }
+        m->round[m->rounds++] = block;
+    }
+    release_spinlock(&cache->slabs_lock);
+    stats->slab_refills++;
+
+    // m may be taken by another dispatcher as soon as it is in the depot
+    bool refilled = m->rounds > 0;
+
+    handle = disp_disable();
+    depot_put(cache, m);
+    disp_enable(handle);
+
+    return refilled;
+}
+
+/**
+ * \brief Allocate a block from the slab cache without clearing it
+ *
+ * \param cache Pointer to slab cache instance
+ *
+ * \returns Pointer to block on success, NULL on error (out of memory)
+ */
+void *slab_cache_alloc_nozero(struct slab_cache *cache)
+{
+    dispatcher_handle_t handle;
+    bool was_enabled;
+    void *block;
+
+    for (;;) {
+        handle = disp_try_disable(&was_enabled);
+        struct slab_cache_cpu *cc = cpu_cache(cache, handle);
+        if (cc == NULL) {
+            if (was_enabled) {
+                disp_enable(handle);
+            }
+            break;
+        }
+
+        if (cc->previous != NULL && cc->previous->rounds > 0
+            && (cc->loaded == NULL || cc->loaded->rounds == 0)) {
+            struct slab_magazine *tmp = cc->loaded;
+            cc->loaded = cc->previous;
+            cc->previous = tmp;
+        }
+
+        if (cc->loaded == NULL || cc->loaded->rounds == 0) {
+            // both magazines exhausted: exchange previous one with the depot
+            acquire_spinlock(&cache->depot_lock);
+            struct slab_magazine *m = depot_pop(&cache->depot_full,
+                                                &cache->depot_nfull);
+            if (m != NULL && cc->previous != NULL) {
+                depot_push(&cache->depot_empty, &cache->depot_nempty,
+                           cc->previous);
+            }
+            release_spinlock(&cache->depot_lock);
+
+            if (m != NULL) {
+                cc->previous = cc->loaded;
+                cc->loaded = m;
+                cc->stats.depot_full++;
+            }
+        }
+
+        if (cc->loaded != NULL && cc->loaded->rounds > 0) {
+            block = cc->loaded->round[--cc->loaded->rounds];
+            cc->stats.allocs++;
+            if (was_enabled) {
+                disp_enable(handle);
+            }
+            return block;
+        }
+
+        if (!was_enabled) {
+            // cannot refill while disabled
+            break;
+        }
+
+        // depot is empty as well: refill it from the slab allocator and retry
+        disp_enable(handle);
+        if (!slab_cache_refill(cache, &cc->stats)) {
+            break;
+        }
+    }
+
+    // no magazines (available), go straight to the slab allocator
+    acquire_spinlock(&cache->slabs_lock);
+    block = slab_alloc_nozero(cache->slabs);
+    release_spinlock(&cache->slabs_lock);
+    return block;
+}
+
+/**
+ * \brief Allocate a new, zero-filled block from the slab cache
+ *
+ * \param cache Pointer to slab cache instance
+ *
+ * \returns Pointer to block on success, NULL on error (out of memory)
+ */
+void *slab_cache_alloc(struct slab_cache *cache)
+{
+    void *block = slab_cache_alloc_nozero(cache);
+    if (block != NULL) {
+        memset(block, 0, cache->slabs->blocksize);
+    }
+    return block;
+}
+
+/**
+ * \brief Free a block to the slab cache
+ *
+ * \param cache Pointer to slab cache instance
+ * \param block Pointer to block previously returned by #slab_cache_alloc
+ */
+void slab_cache_free(struct slab_cache *cache, void *block)
+{
+    bool was_enabled;
+
+    if (block == NULL) {
+        return;
+    }
+
+    dispatcher_handle_t handle = disp_try_disable(&was_enabled);
+    struct slab_cache_cpu *cc = cpu_cache(cache, handle);
+    if (cc == NULL) {
+        if (was_enabled) {
+            disp_enable(handle);
+        }
+        acquire_spinlock(&cache->slabs_lock);
+        slab_free(cache->slabs, block);
+        release_spinlock(&cache->slabs_lock);
+        return;
+    }
+
+    if (cc->previous != NULL
+        && cc->previous->rounds < SLAB_MAGAZINE_ROUNDS
+        && (cc->loaded == NULL
+            || cc->loaded->rounds == SLAB_MAGAZINE_ROUNDS)) {
+        struct slab_magazine *tmp = cc->loaded;
+        cc->loaded = cc->previous;
+        cc->previous = tmp;
+    }
+
+    if (cc->loaded == NULL || cc->loaded->rounds == SLAB_MAGAZINE_ROUNDS) {
+        // both magazines full: exchange previous one with the depot
+        acquire_spinlock(&cache->depot_lock);
+        struct slab_magazine *m = depot_pop(&cache->depot_empty,
+                                            &cache->depot_nempty);
+        if (m != NULL && cc->previous != NULL) {
+            depot_push(&cache->depot_full, &cache->depot_nfull,
+                       cc->previous);
+        }
+        release_spinlock(&cache->depot_lock);
+
+        if (m != NULL) {
+            cc->previous = cc->loaded;
+            cc->loaded = m;
+            cc->stats.depot_empty++;
+        }
+    }
+
+    if (cc->loaded != NULL && cc->loaded->rounds < SLAB_MAGAZINE_ROUNDS) {
+        cc->loaded->round[cc->loaded->rounds++] = block;
+        cc->stats.frees++;
+        if (was_enabled) {
+            disp_enable(handle);
+        }
+        return;
+    }
+
+    // all magazines in use, go straight to the slab allocator
+    cc->stats.mag_shortage++;
+    cc->stats.slab_frees++;
+    if (was_enabled) {
+        disp_enable(handle);
+    }
+
+    acquire_spinlock(&cache->slabs_lock);
+    slab_free(cache->slabs, block);
+    release_spinlock(&cache->slabs_lock);
+}
+
+/**
+ * \brief Add memory (a new slab) to the backing slab allocator
+ *
+ * \param cache Pointer to slab cache instance
+ * \param buf Pointer to start of memory region
+ * \param buflen Size of memory region (in bytes)
+ */
+void slab_cache_grow(struct slab_cache *cache, void *buf, size_t buflen)
+{
+    acquire_spinlock(&cache->slabs_lock);
+    slab_grow(cache->slabs, buf, buflen);
+    release_spinlock(&cache->slabs_lock);
+}
+
+/**
+ * \brief Returns the count of free blocks in the slab cache
+ *
+ * Includes the blocks in the backing slab allocator, the depot and the
+ * magazines of all dispatchers. Magazines loaded by other dispatchers are
+ * read without their cooperation, so the count is a snapshot that may be
+ * off by the blocks they allocate or free concurrently.
+ *
+ * \param cache Pointer to slab cache instance
+ *
+ * \returns Free block count
+ */
+size_t slab_cache_freecount(struct slab_cache *cache)
+{
+    size_t ret = 0;
+
+    bool was_enabled;
+    dispatcher_handle_t handle = disp_try_disable(&was_enabled);
+    acquire_spinlock(&cache->depot_lock);
+    for (struct slab_magazine *m = cache->depot_full; m != NULL; m = m->next) {
+        ret += m->rounds;
+    }
+    for (coreid_t c = 0; cache->cpu != NULL && c <= MAX_COREID; c++) {
+        // magazines are never freed, so a stale pointer is still valid
+        struct slab_magazine *loaded = cache->cpu[c].loaded;
+        struct slab_magazine *previous = cache->cpu[c].previous;
+        if (loaded != NULL) {
+            ret += loaded->rounds;
+        }
+        if (previous != NULL) {
+            ret += previous->rounds;
+        }
+    }
+    release_spinlock(&cache->depot_lock);
+    if (was_enabled) {
+        disp_enable(handle);
+    }
+
+    acquire_spinlock(&cache->slabs_lock);
+    ret += slab_freecount(cache->slabs);
+    release_spinlock(&cache->slabs_lock);
+
+    return ret;
+}
+
+/**
+ * \brief Read the counters of a slab cache
+ *
+ * Counters are read without synchronisation and may be slightly stale. They
+ * only count the magazine layer and stay zero until
+ * slab_cache_enable_magazines() has been called.
+ *
+ * \param cache Pointer to slab cache instance
+ * \param core  Core ID of dispatcher to read, or SLAB_CACHE_ALL_CORES
+ * \param stats Filled-in with the counters
+ */
+void slab_cache_get_stats(struct slab_cache *cache, coreid_t core,
+                          struct slab_cache_stats *stats)
+{
+    memset(stats, 0, sizeof(struct slab_cache_stats));
+
+    for (coreid_t c = 0; cache->cpu != NULL && c <= MAX_COREID; c++) {
+        struct slab_cache_cpu *cc = &cache->cpu[c];
+        if (core != SLAB_CACHE_ALL_CORES && core != c) {
+            continue;
+        }
+        stats->allocs += cc->stats.allocs;
+        stats->frees += cc->stats.frees;
+        stats->depot_full += cc->stats.depot_full;
+        stats->depot_empty += cc->stats.depot_empty;
+        stats->slab_refills += cc->stats.slab_refills;
+        stats->slab_frees += cc->stats.slab_frees;
+        stats->mag_shortage += cc->stats.mag_shortage;
+    }
+}
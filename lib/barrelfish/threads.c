@@ -20,6 +20,7 @@
 #include <barrelfish/dispatcher_arch.h>
 #include <barrelfish/debug.h>
 #include <barrelfish/slab.h>
+#include <barrelfish/slab_cache.h>
 #include <barrelfish/caddr.h>
 #include <barrelfish/curdispatcher_arch.h>
 #include <barrelfish/vspace_mmu_aware.h>
@@ -33,6 +34,7 @@
 #include "arch/threads.h"
 #include "threads_priv.h"
 #include "init.h"
+#include "domain_priv.h"
 
 #if defined(__x86_64__)
 #  include "arch/ldt.h"
@@ -58,15 +60,12 @@ static struct thread_mutex staticthread_lock = THREAD_MUTEX_INITIALIZER;
 static struct slab_allocator thread_slabs;
 static struct vspace_mmu_aware thread_slabs_vm;
 
-// XXX: mutex and spinlock protecting thread slabs in spanned domains
-/* This ought to be just a mutex. However, thread_create() is called on the
- * inter-disp message handler thread, and if it blocks in a mutex, there is no
- * way to wake it up and we will deadlock. This is a quick-fix workaround:
- *   The spinlock protects the data structure
- *   The mutex avoids unneccessary spinning (it is acquired first when safe)
+/* Per-dispatcher cache in front of thread_slabs. This must not block in a
+ * mutex, as thread_create() is called on the inter-disp message handler
+ * thread, and if it blocks there is no way to wake it up and we will
+ * deadlock. The cache only uses spinlocks.
  */
-static spinlock_t thread_slabs_spinlock;
-static struct thread_mutex thread_slabs_mutex = THREAD_MUTEX_INITIALIZER;
+static struct slab_cache thread_slabs_cache;
 
 /// Base and size of the original ("pristine") thread-local storage init data
 static void *tls_block_init_base;
@@ -210,7 +209,7 @@ static errval_t refill_thread_slabs(struct slab_allocator *slabs)
     void *buf;
     errval_t err;
 
-    size_t blocksize = sizeof(struct thread) + tls_block_total_len;
+    size_t blocksize = SLAB_STATIC_SIZE(1, slabs->blocksize);
     err = vspace_mmu_aware_map(&thread_slabs_vm, blocksize, &buf, &size);
     if (err_is_fail(err)) {
         return err_push(err, LIB_ERR_VSPACE_MMU_AWARE_MAP);
@@ -243,6 +242,7 @@ static void thread_init(dispatcher_handle_t disp, struct thread *newthread)
     newthread->joining = false;
     newthread->in_exception = false;
     newthread->paused = false;
+    newthread->migratable = false;
     newthread->slab = NULL;
     newthread->token = 0;
     newthread->token_number = 1;
@@ -333,11 +333,7 @@ static void free_thread(struct thread *thread)
         free(thread->tls_dtv);
     }
 
-    thread_mutex_lock(&thread_slabs_mutex);
-    acquire_spinlock(&thread_slabs_spinlock);
-    slab_free(&thread_slabs, thread->slab); // frees thread itself
-    release_spinlock(&thread_slabs_spinlock);
-    thread_mutex_unlock(&thread_slabs_mutex);
+    slab_cache_free(&thread_slabs_cache, thread->slab); // frees thread itself
 }
 
 #define ALIGN_PTR(ptr, alignment) ((((uintptr_t)(ptr)) + (alignment) - 1) & ~((alignment) - 1))
@@ -362,12 +358,8 @@ struct thread *thread_create_unrunnable(thread_func_t start_func, void *arg,
     }
 
     // allocate space for TCB + initial TLS data
-    // no mutex as it may deadlock: see comment for thread_slabs_spinlock
-    // thread_mutex_lock(&thread_slabs_mutex);
-    acquire_spinlock(&thread_slabs_spinlock);
-    void *space = slab_alloc(&thread_slabs);
-    release_spinlock(&thread_slabs_spinlock);
-    // thread_mutex_unlock(&thread_slabs_mutex);
+    // no mutex as it may deadlock: see comment for thread_slabs_cache
+    void *space = slab_cache_alloc(&thread_slabs_cache);
     if (space == NULL) {
         free(stack);
         return NULL;
@@ -813,11 +805,37 @@ static int cleanup_thread(void *arg)
     return 0;
 }
 
+/// Functions called on every exiting thread, most recently added first
+static struct thread_exit_hook *thread_exit_hooks;
+
+/**
+ * \brief Add a function to be called by every thread when it exits
+ *
+ * The hook runs on the exiting thread, before any cleanup, and can be used
+ * to release per-thread state kept by libraries (e.g. malloc caches). The
+ * caller provides the storage for the hook, which must stay valid for the
+ * lifetime of the domain, and must add each hook only once. Hooks cannot be
+ * removed.
+ */
+void thread_add_exit_hook(struct thread_exit_hook *hook)
+{
+    assert(hook != NULL && hook->func != NULL);
+    do {
+        hook->next = thread_exit_hooks;
+    } while (!__sync_bool_compare_and_swap(&thread_exit_hooks, hook->next,
+                                           hook));
+}
+
 /**
  * \brief Terminate the calling thread
  */
 void thread_exit(int status)
 {
+    for (struct thread_exit_hook *h = thread_exit_hooks; h != NULL;
+         h = h->next) {
+        h->func();
+    }
+
     struct thread *me = thread_self();
 
     thread_mutex_lock(&me->exit_lock);
@@ -1140,6 +1158,7 @@ static int bootstrap_thread(struct spawn_domain_params *params)
     // slabs above 4G.
     //assert(vregion_get_base_addr(&thread_slabs_vm.vregion) + vregion_get_size(&thread_slabs_vm.vregion) < 1ul << 32);
     slab_init(&thread_slabs, blocksize, refill_thread_slabs);
+    slab_cache_init(&thread_slabs_cache, &thread_slabs);
 
     if (init_domain_global) {
         // run main() on this thread, since we can't allocate
@@ -1245,10 +1264,17 @@ void threads_prepare_to_span(dispatcher_handle_t newdh)
     if (!called) {
         called = true;
 
-        thread_mutex_lock(&thread_slabs_mutex);
-        acquire_spinlock(&thread_slabs_spinlock);
+        // the thread slab cache only needs magazines once there are
+        // several dispatchers
+        void *mags = malloc(SLAB_CACHE_MAGAZINES_BUFSIZE);
+        if (mags != NULL) {
+            slab_cache_enable_magazines(&thread_slabs_cache, mags,
+                                        SLAB_CACHE_MAGAZINES_BUFSIZE);
+        } else {
+            DEBUG_ERR(LIB_ERR_MALLOC_FAIL, "allocating thread slab magazines");
+        }
 
-        while (slab_freecount(&thread_slabs) < MAX_THREADS - 1) {
+        while (slab_cache_freecount(&thread_slabs_cache) < MAX_THREADS - 1) {
             size_t size;
             void *buf;
             errval_t err;
@@ -1266,11 +1292,8 @@ void threads_prepare_to_span(dispatcher_handle_t newdh)
                                "thread slabs\n");
             }
 
-            slab_grow(&thread_slabs, buf, size);
+            slab_cache_grow(&thread_slabs_cache, buf, size);
         }
-
-        release_spinlock(&thread_slabs_spinlock);
-        thread_mutex_unlock(&thread_slabs_mutex);
     }
 }
 
@@ -1336,6 +1359,141 @@ void thread_resume(struct thread *thread)
     disp_enable(dh);
 }
 
+/**
+ * \brief Allow or forbid the load balancer to move the given thread
+ *
+ * Threads are not migratable by default, as they may depend on state of the
+ * dispatcher they run on, like channels bound to its waitsets.
+ */
+void thread_set_migratable(struct thread *thread, bool migratable)
+{
+    assert(thread != NULL);
+    thread->migratable = migratable;
+}
+
+/// Returns whether the thread can be moved off this dispatcher right now
+static bool thread_can_migrate_disabled(dispatcher_handle_t handle,
+                                        struct thread *thread)
+{
+    struct dispatcher_generic *disp_gen = get_dispatcher_generic(handle);
+
+    // threads on their way to another dispatcher have the new core id
+    return thread != disp_gen->current
+        && thread->coreid == disp_gen->core_id
+        && thread->state == THREAD_STATE_RUNNABLE
+        && !thread->paused && !thread->in_exception
+        && !thread->rpc_in_progress;
+}
+
+static errval_t thread_migrate_disabled(dispatcher_handle_t handle,
+                                        struct thread *thread,
+                                        coreid_t core_id)
+{
+    struct dispatcher_generic *disp_gen = get_dispatcher_generic(handle);
+    coreid_t old_core_id = thread->coreid;
+
+    thread_remove_from_queue(&disp_gen->runq, thread);
+
+    // the thread is enqueued on the other dispatcher by its interdisp thread
+    errval_t err = domain_wakeup_on_coreid_disabled(core_id, thread, handle);
+    if (err_is_fail(err)) {
+        thread->coreid = old_core_id;
+        thread_enqueue(thread, &disp_gen->runq);
+    }
+
+    return err;
+}
+
+/**
+ * \brief Move a thread to this domain's dispatcher on another core
+ *
+ * The thread must belong to the calling dispatcher. The calling thread moves
+ * itself, see domain_thread_move_to(). Other threads can only be moved while
+ * they are runnable, they continue to run on the other dispatcher.
+ */
+errval_t thread_migrate(struct thread *thread, coreid_t core_id)
+{
+    assert(thread != NULL);
+
+    if (thread == thread_self()) {
+        return domain_thread_move_to(thread, core_id);
+    }
+
+    dispatcher_handle_t handle = disp_disable();
+    errval_t err = SYS_ERR_OK;
+
+    if (thread->disp != handle) {
+        err = LIB_ERR_THREAD_NOT_LOCAL;
+    } else if (!thread_can_migrate_disabled(handle, thread)) {
+        err = LIB_ERR_THREAD_NOT_MIGRATABLE;
+    } else if (core_id != disp_get_core_id()) {
+        err = thread_migrate_disabled(handle, thread, core_id);
+    }
+
+    disp_enable(handle);
+    return err;
+}
+
+/**
+ * \brief Move up to 'count' migratable runnable threads to another core
+ *
+ * Takes the threads that would run last on this dispatcher.
+ *
+ * \returns Number of threads moved
+ */
+size_t thread_migrate_runnable(coreid_t core_id, size_t count)
+{
+    dispatcher_handle_t handle = disp_disable();
+    struct dispatcher_generic *disp_gen = get_dispatcher_generic(handle);
+    size_t moved = 0;
+
+    if (core_id == disp_get_core_id() || disp_gen->runq == NULL) {
+        disp_enable(handle);
+        return 0;
+    }
+
+    // walk backwards from the thread that runs last
+    struct thread *last = disp_gen->current != NULL ? disp_gen->current
+                                                    : disp_gen->runq;
+    struct thread *t = last->prev;
+    while (moved < count && t != last) {
+        struct thread *prev = t->prev;
+        if (t->migratable && thread_can_migrate_disabled(handle, t)) {
+            if (err_is_fail(thread_migrate_disabled(handle, t, core_id))) {
+                break;
+            }
+            moved++;
+        }
+        t = prev;
+    }
+
+    disp_enable(handle);
+    return moved;
+}
+
+/**
+ * \brief Number of runnable threads on this dispatcher besides the caller
+ */
+size_t thread_runnable_count(void)
+{
+    dispatcher_handle_t handle = disp_disable();
+    struct dispatcher_generic *disp_gen = get_dispatcher_generic(handle);
+    size_t count = 0;
+
+    struct thread *t = disp_gen->runq;
+    if (t != NULL) {
+        do {
+            if (t != disp_gen->current) {
+                count++;
+            }
+            t = t->next;
+        } while (t != disp_gen->runq);
+    }
+
+    disp_enable(handle);
+    return count;
+}
+
 /**
  * \brief Set old-style thread-local storage pointer.
  * \param p   User's pointer
@@ -27,6 +27,83 @@
 #error "This file shouldn't be compiled without CONFIG_INTERCONNECT_DRIVER_UMP"
 #endif
 
+/// Marks a channel frame that is extended after the message rings
+#define UMP_EXT_MAGIC 0x554d504558543031ULL // "UMPEXT01"
+
+/// Extension flag: both sides use the adaptive receive policy
+#define UMP_EXT_ADAPTIVE 0x1
+
+/// Header at the start of the extension of a channel frame
+struct ump_ext_header {
+    uint64_t magic;
+    uint64_t poolsize;  ///< Size of each direction's payload ring, or 0
+    uint64_t flags;     ///< UMP_EXT_* flags
+};
+
+/// Bytes of the channel frame used by an extension with the given pool size
+static size_t ump_ext_frame_bytes(size_t poolsize)
+{
+    // header line, then for each direction a control line and the pool ring
+    return UMP_MSG_BYTES + 2 * (UMP_MSG_BYTES + poolsize);
+}
+
+/// Set up the adaptive receive policy of a channel
+static void ump_chan_adaptive_init(struct ump_chan *uc)
+{
+    struct ump_adaptive *a = &uc->adaptive;
+
+    a->enabled = true;
+    a->blocked = false;
+    a->last_pos = uc->endpoint.chan.pos;
+    a->max_spin = ns_to_systime(UMP_SPIN_MAX_NS);
+    // start out assuming traffic, so that the first window is the longest
+    a->gap = a->max_spin / 2;
+    a->last_arrival = systime_now();
+}
+
+/**
+ * \brief Set up the control lines, payload pools and receive policy of a
+ *  channel from its frame extension
+ *
+ * The binding side sends on the first direction and receives on the second.
+ *
+ * \param uc Channel
+ * \param area Start of the extension (after both message rings)
+ * \param poolsize Size of each pool ring in bytes, or 0 for no pools
+ * \param flags UMP_EXT_* flags
+ * \param binder True on the side that initiated the binding
+ */
+static void ump_chan_ext_init(struct ump_chan *uc, volatile uint8_t *area,
+                              size_t poolsize, uint64_t flags, bool binder)
+{
+    volatile uint8_t *first = area + UMP_MSG_BYTES;
+    volatile uint8_t *second = first + UMP_MSG_BYTES + poolsize;
+    struct ump_pool *p;
+
+    uc->send_ctrl = (volatile struct ump_chan_ctrl *)(binder ? first : second);
+    uc->recv_ctrl = (volatile struct ump_chan_ctrl *)(binder ? second : first);
+
+    if (poolsize > 0) {
+        p = binder ? &uc->send_pool : &uc->recv_pool;
+        p->tail = &((volatile struct ump_chan_ctrl *)first)->pool_tail;
+        p->buf = first + UMP_MSG_BYTES;
+        p->size = poolsize;
+        p->head = 0;
+
+        p = binder ? &uc->recv_pool : &uc->send_pool;
+        p->tail = &((volatile struct ump_chan_ctrl *)second)->pool_tail;
+        p->buf = second + UMP_MSG_BYTES;
+        p->size = poolsize;
+        p->head = 0;
+
+        uc->poolsize = poolsize;
+    }
+
+    if (flags & UMP_EXT_ADAPTIVE) {
+        ump_chan_adaptive_init(uc);
+    }
+}
+
 /**
  * \brief Initialise a new UMP channel
  *
@@ -58,6 +135,13 @@ errval_t ump_chan_init(struct ump_chan *uc,
     uc->max_send_msgs = outbufsize / UMP_MSG_BYTES;
     uc->max_recv_msgs = inbufsize / UMP_MSG_BYTES;
 
+    // no frame extension unless set up by ump_chan_bind() or ump_chan_accept()
+    uc->poolsize = 0;
+    memset(&uc->send_pool, 0, sizeof(uc->send_pool));
+    memset(&uc->recv_pool, 0, sizeof(uc->recv_pool));
+    uc->send_ctrl = uc->recv_ctrl = NULL;
+    memset(&uc->adaptive, 0, sizeof(uc->adaptive));
+
     memset(&uc->cap_handlers, 0, sizeof(uc->cap_handlers));
     uc->iref = 0;
     uc->monitor_binding = get_monitor_binding(); // TODO: expose non-default to caller
@@ -225,6 +309,11 @@ static void send_bind_cont(void *arg)
  * \param inchanlen Size of incoming channel, in bytes (rounded to #UMP_MSG_BYTES)
  * \param outchanlen Size of outgoing channel, in bytes (rounded to #UMP_MSG_BYTES)
  * \param notify_cap Capability to use for notifications, or #NULL_CAP
+ *
+ * If uc->poolsize is non-zero on entry, the channel frame is extended with a
+ * payload pool of that many bytes (a power of two) in each direction. If
+ * uc->adaptive.enabled is set on entry, both sides of the channel use the
+ * adaptive receive policy.
  */
 errval_t ump_chan_bind(struct ump_chan *uc, struct ump_bind_continuation cont,
                        struct event_queue_node *qnode,  iref_t iref,
@@ -233,6 +322,11 @@ errval_t ump_chan_bind(struct ump_chan *uc, struct ump_bind_continuation cont,
                        struct capref notify_cap)
 {
     errval_t err;
+    size_t poolsize = uc->poolsize;
+    uint64_t extflags = uc->adaptive.enabled ? UMP_EXT_ADAPTIVE : 0;
+    bool extended = poolsize > 0 || extflags != 0;
+
+    assert((poolsize & (poolsize - 1)) == 0);
 
     // round up channel sizes to message size
     inchanlen = ROUND_UP(inchanlen, UMP_MSG_BYTES);
@@ -240,6 +334,9 @@ errval_t ump_chan_bind(struct ump_chan *uc, struct ump_bind_continuation cont,
 
     // compute size of frame needed and allocate it
     size_t framesize = inchanlen + outchanlen;
+    if (extended) {
+        framesize += ump_ext_frame_bytes(poolsize);
+    }
     err = frame_alloc(&uc->frame, framesize, &framesize);
     if (err_is_fail(err)) {
         return err_push(err, LIB_ERR_FRAME_ALLOC);
@@ -262,6 +359,16 @@ errval_t ump_chan_bind(struct ump_chan *uc, struct ump_bind_continuation cont,
         return err;
     }
 
+    // mark the frame as extended, so that the other side finds the extension
+    if (extended) {
+        volatile uint8_t *area = (uint8_t *)buf + inchanlen + outchanlen;
+        volatile struct ump_ext_header *hdr = (void *)area;
+        hdr->magic = UMP_EXT_MAGIC;
+        hdr->poolsize = poolsize;
+        hdr->flags = extflags;
+        ump_chan_ext_init(uc, area, poolsize, extflags, true);
+    }
+
     // Ids for tracing
     struct frame_identity id;
     err = frame_identify(uc->frame, &id);
@@ -339,6 +446,23 @@ errval_t ump_chan_accept(struct ump_chan *uc, uintptr_t mon_id,
         return err;
     }
 
+    // did the binding side extend the frame? (frames are zeroed)
+    size_t chanbytes = inchanlen + outchanlen;
+    if (frameid.bytes >= chanbytes + sizeof(struct ump_ext_header)) {
+        volatile uint8_t *area = (uint8_t *)buf + chanbytes;
+        volatile struct ump_ext_header *hdr = (void *)area;
+        if (hdr->magic == UMP_EXT_MAGIC) {
+            size_t poolsize = hdr->poolsize;
+            if ((poolsize & (poolsize - 1)) != 0
+                || frameid.bytes < chanbytes + ump_ext_frame_bytes(poolsize)) {
+                vregion_destroy(uc->vregion);
+                cap_destroy(uc->frame);
+                return LIB_ERR_UMP_FRAME_OVERFLOW;
+            }
+            ump_chan_ext_init(uc, area, poolsize, hdr->flags, false);
+        }
+    }
+
     /* mark connected */
     uc->connstate = UMP_CONNECTED;
     return SYS_ERR_OK;
@@ -402,6 +526,128 @@ void ump_channels_retry_send_disabled(dispatcher_handle_t handle)
     }
 }
 
+/// Length of the next spin window, 0 if we should not spin at all
+static systime_t ump_adaptive_window(struct ump_adaptive *a)
+{
+    // messages too far apart: polling would mostly be wasted
+    if (a->gap > a->max_spin) {
+        return 0;
+    }
+    return (2 * a->gap < a->max_spin) ? 2 * a->gap : a->max_spin;
+}
+
+/**
+ * \brief Decide whether the receiver of a channel should wait for a
+ *  notification or keep polling
+ *
+ * Called whenever the receiver re-registers for incoming messages. Channels
+ * without the adaptive policy always wait for notifications. Adaptive ones
+ * poll for a spin window after each message, and when that is over without a
+ * message, ask the sender for a notification.
+ *
+ * \param uc UMP channel
+ * \return true if the caller should wait for a notification, false if it
+ *  should poll the channel
+ */
+bool ump_chan_wait_notify(struct ump_chan *uc)
+{
+    struct ump_adaptive *a = &uc->adaptive;
+    struct ump_endpoint *ep = &uc->endpoint;
+
+    if (!a->enabled) {
+        a->blocked = true;
+        return true;
+    }
+
+    systime_t now = systime_now();
+
+    // stale notifications can wake us up, so stop asking for more
+    if (a->blocked) {
+        uc->recv_ctrl->rx_waiting = 0;
+    }
+
+    // did we receive anything since we last decided?
+    if (ep->chan.pos != a->last_pos) {
+        if (a->blocked) {
+            a->stats.wakeups++;
+        } else {
+            a->stats.spin_hits++;
+            if (ep->spin_deadline != 0) {
+                a->stats.spin_time += now - a->window_start;
+            }
+        }
+
+        systime_t sample = now - a->last_arrival;
+        if (sample > 4 * a->max_spin) {
+            sample = 4 * a->max_spin;
+        }
+        a->gap = a->gap - a->gap / 8 + sample / 8;
+        a->last_arrival = now;
+        a->last_pos = ep->chan.pos;
+        ep->spin_deadline = 0;
+    }
+    a->blocked = false;
+
+    if (ump_endpoint_can_recv(ep)) {
+        return false;
+    }
+
+    if (ep->spin_deadline == 0) {
+        // start a new spin window
+        systime_t window = ump_adaptive_window(a);
+        if (window > 0) {
+            a->window_start = now;
+            ep->spin_deadline = now + window;
+            return false;
+        }
+    } else if (now < ep->spin_deadline) {
+        return false;
+    } else {
+        a->stats.spin_misses++;
+        a->stats.spin_time += ep->spin_deadline - a->window_start;
+    }
+    ep->spin_deadline = 0;
+
+    // ask for a notification, then check for a message that raced with it
+    uc->recv_ctrl->rx_waiting = 1;
+    __sync_synchronize();
+    if (ump_endpoint_can_recv(ep)) {
+        uc->recv_ctrl->rx_waiting = 0;
+        return false;
+    }
+
+    a->blocked = true;
+    a->stats.blocks++;
+    return true;
+}
+
+/**
+ * \brief Decide whether the sender of a channel must notify the receiver
+ *  after sending a message
+ *
+ * \param uc UMP channel
+ * \return true unless the receiver uses the adaptive policy and is polling
+ */
+bool ump_chan_notify_needed(struct ump_chan *uc)
+{
+    struct ump_adaptive *a = &uc->adaptive;
+
+    if (!a->enabled) {
+        a->stats.ipis_sent++;
+        return true;
+    }
+
+    // the message must be visible before we look at the receiver's flag
+    __sync_synchronize();
+    if (uc->send_ctrl->rx_waiting
+        && __sync_lock_test_and_set(&uc->send_ctrl->rx_waiting, 0)) {
+        a->stats.ipis_sent++;
+        return true;
+    }
+
+    a->stats.ipis_avoided++;
+    return false;
+}
 
 /// Initialise the UMP channel driver
 void ump_init(void)
@@ -35,6 +35,7 @@ errval_t ump_endpoint_init(struct ump_endpoint *ep, volatile void *buf,
     }
 
     waitset_chanstate_init(&ep->waitset_state, CHANTYPE_UMP_IN);
+    ep->spin_deadline = 0;
     return SYS_ERR_OK;
 }
 
@@ -23,6 +23,7 @@
  */
 
 #include <barrelfish/barrelfish.h>
+#include <string.h>
 #include "vspace_internal.h"
 
 /**
@@ -131,6 +132,53 @@ static errval_t unmap_region(struct memobj *memobj, struct vregion *vregion)
     return err; // XXX: not quite the right error
 }
 
+/**
+ * \brief Remap a promoted frame with base pages
+ *
+ * \param anon     The memory object
+ * \param vregion  The vregion the frame is mapped in
+ * \param fwalk    The frame to demote
+ *
+ * Every large page mapping of the frame in the vregion is replaced by a base
+ * page mapping with the same flags, so that part of it can be protected.
+ */
+static errval_t demote(struct memobj_anon *anon, struct vregion *vregion,
+                       struct memobj_frame_list *fwalk)
+{
+    errval_t err;
+    struct vspace *vspace = vregion_get_vspace(vregion);
+    struct pmap *pmap     = vspace_get_pmap(vspace);
+    genvaddr_t fbase = vregion_get_base_addr(vregion)
+                       + vregion_get_offset(vregion) + fwalk->offset;
+    genvaddr_t va = fbase;
+
+    while (va < fbase + fwalk->size) {
+        struct pmap_mapping_info info;
+        err = pmap->f.lookup(pmap, va, &info);
+        if (err_is_fail(err)) {
+            // not faulted in yet, pagefault() will use base pages
+            break;
+        }
+        if (info.flags & VREGION_FLAGS_LARGE) {
+            err = pmap->f.unmap(pmap, info.vaddr, info.size, NULL);
+            if (err_is_fail(err)) {
+                return err_push(err, LIB_ERR_PMAP_UNMAP);
+            }
+            err = pmap->f.map(pmap, info.vaddr, fwalk->frame,
+                              fwalk->foffset + (info.vaddr - fbase), info.size,
+                              info.flags & ~VREGION_FLAGS_LARGE, NULL, NULL);
+            if (err_is_fail(err)) {
+                return err_push(err, LIB_ERR_PMAP_MAP);
+            }
+        }
+        va = info.vaddr + info.size;
+    }
+
+    fwalk->large = false;
+    anon->promote_stats.demoted++;
+    return SYS_ERR_OK;
+}
+
 /**
  * \brief Set the protection on a range
  *
@@ -162,8 +210,9 @@ static errval_t protect(struct memobj *memobj, struct vregion *vregion,
 
     offset += vregion_off;
 
-    // Special handling if the range cannot span frames
-    if (range <= BASE_PAGE_SIZE) {
+    // Special handling if the range cannot span frames. A base page inside
+    // a promoted frame needs the frame demoted first.
+    if (range <= BASE_PAGE_SIZE && !(memobj->flags & MEMOBJ_FLAGS_PROMOTE)) {
         err = pmap->f.modify_flags(pmap, vregion_base + offset, range, flags, NULL);
         if (err_is_fail(err)) {
             return err_push(err, LIB_ERR_PMAP_MODIFY_FLAGS);
@@ -183,6 +232,14 @@ static errval_t protect(struct memobj *memobj, struct vregion *vregion,
             size_t range_in_frame = fwalk->offset + fwalk->size - offset;
             size_t size = range_in_frame < range ? range_in_frame : range;
 
+            // the pmap protects whole large pages
+            if (fwalk->large && ((offset | size) & LARGE_PAGE_MASK) != 0) {
+                err = demote(anon, vregion, fwalk);
+                if (err_is_fail(err)) {
+                    return err;
+                }
+            }
+
             size_t retsize;
             err = pmap->f.modify_flags(pmap, vregion_base + offset, size, flags, &retsize);
             if (err_is_fail(err)) {
@@ -290,6 +347,11 @@ static errval_t fill_foff(struct memobj *memobj, genvaddr_t offset, struct capre
     assert(err_is_ok(err));
     new->pa = fi.base;
 
+    // Promote frames that can be mapped with large pages only. Whether the
+    // virtual address is aligned as well is up to the vregion.
+    new->large = (memobj->flags & MEMOBJ_FLAGS_PROMOTE) &&
+                 ((offset | size | (fi.base + foffset)) & LARGE_PAGE_MASK) == 0;
+
     // Insert in order
     struct memobj_frame_list *walk = anon->frame_list;
     struct memobj_frame_list *prev = NULL;
@@ -428,12 +490,21 @@ static errval_t pagefault(struct memobj *memobj, struct vregion *vregion,
             genvaddr_t base          = vregion_get_base_addr(vregion);
             genvaddr_t vregion_off   = vregion_get_offset(vregion);
             vregion_flags_t flags = vregion_get_flags(vregion);
-            err = pmap->f.map(pmap, base + vregion_off + walk->offset,
-                              walk->frame, walk->foffset, walk->size, flags,
-                              NULL, NULL);
+            genvaddr_t vaddr = base + vregion_off + walk->offset;
+            bool large = walk->large && (vaddr & LARGE_PAGE_MASK) == 0;
+            if (large) {
+                flags |= VREGION_FLAGS_LARGE;
+            }
+            err = pmap->f.map(pmap, vaddr, walk->frame, walk->foffset,
+                              walk->size, flags, NULL, NULL);
             if (err_is_fail(err)) {
                 return err_push(err, LIB_ERR_PMAP_MAP);
             }
+            if (large) {
+                anon->promote_stats.promoted += walk->size / LARGE_PAGE_SIZE;
+            } else if (memobj->flags & MEMOBJ_FLAGS_PROMOTE) {
+                anon->promote_stats.base++;
+            }
             return SYS_ERR_OK;
         }
         walk = walk->next;
@@ -499,6 +570,7 @@ errval_t memobj_create_anon(struct memobj_anon *anon, size_t size,
 
     anon->vregion_list = NULL;
     anon->frame_list = NULL;
+    memset(&anon->promote_stats, 0, sizeof(anon->promote_stats));
     return SYS_ERR_OK;
 }
 
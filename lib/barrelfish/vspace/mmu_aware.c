@@ -93,6 +93,79 @@ errval_t vspace_mmu_aware_init_aligned(struct vspace_mmu_aware *state,
     return SYS_ERR_OK;
 }
 
+/**
+ * \brief Enable or disable large page promotion
+ *
+ * \param state    The object metadata
+ * \param promote  Whether to back the region with large pages if possible
+ *
+ * With promotion, the region is grown in large page sized frames at large
+ * page aligned offsets, which the memobj then maps with large pages. The
+ * vregion should be aligned to a large page for this to take effect.
+ */
+void vspace_mmu_aware_set_promote(struct vspace_mmu_aware *state, bool promote)
+{
+    if (promote) {
+        state->memobj.m.flags |= MEMOBJ_FLAGS_PROMOTE;
+    } else {
+        state->memobj.m.flags &= ~MEMOBJ_FLAGS_PROMOTE;
+    }
+}
+
+/**
+ * \brief Map base page frames up to the next large page boundary
+ *
+ * \param state     The object metadata
+ * \param req_size  The amount still to map in, reduced by the padding
+ *
+ * Each frame is the largest power of two that keeps mapoffset aligned, so
+ * that the rest of the request starts on a large page boundary.
+ */
+static errval_t promote_pad(struct vspace_mmu_aware *state, size_t *req_size)
+{
+    errval_t err;
+    size_t gap = LARGE_PAGE_SIZE - (state->mapoffset & LARGE_PAGE_MASK);
+
+    if (gap == LARGE_PAGE_SIZE || *req_size <= gap) {
+        return SYS_ERR_OK;
+    }
+    if (state->mapoffset + gap > state->size) {
+        return LIB_ERR_VSPACE_MMU_AWARE_NO_SPACE;
+    }
+
+    while (state->mapoffset & LARGE_PAGE_MASK) {
+        size_t bytes = state->mapoffset & -state->mapoffset;
+        struct capref frame;
+
+        err = state->slot_alloc->alloc(state->slot_alloc, &frame);
+        if (err_is_fail(err)) {
+            return err_push(err, LIB_ERR_SLOT_ALLOC_NO_SPACE);
+        }
+        err = frame_create(frame, bytes, NULL);
+        if (err_is_fail(err)) {
+            state->slot_alloc->free(state->slot_alloc, frame);
+            if (err_no(err) == LIB_ERR_RAM_ALLOC_MS_CONSTRAINTS) {
+                return err_push(err, LIB_ERR_FRAME_CREATE_MS_CONSTRAINTS);
+            }
+            return err_push(err, LIB_ERR_FRAME_CREATE);
+        }
+        err = state->memobj.m.f.fill(&state->memobj.m, state->mapoffset, frame,
+                                     bytes);
+        if (err_is_fail(err)) {
+            return err_push(err, LIB_ERR_MEMOBJ_FILL);
+        }
+        err = state->memobj.m.f.pagefault(&state->memobj.m, &state->vregion,
+                                          state->mapoffset, 0);
+        if (err_is_fail(err)) {
+            return err_push(err, LIB_ERR_MEMOBJ_PAGEFAULT_HANDLER);
+        }
+        state->mapoffset += bytes;
+        *req_size -= bytes;
+    }
+
+    return SYS_ERR_OK;
+}
+
 /**
  * \brief Create mappings
  *
@@ -125,6 +198,15 @@ errval_t vspace_mmu_aware_map(struct vspace_mmu_aware *state, size_t req_size,
     size_t alloc_size = ROUND_UP(req_size, BASE_PAGE_SIZE);
     size_t ret_size = 0;
 
+    bool promote = state->memobj.m.flags & MEMOBJ_FLAGS_PROMOTE;
+    if (req_size > 0 && promote) {
+        err = promote_pad(state, &req_size);
+        if (err_is_fail(err)) {
+            return err;
+        }
+        alloc_size = ROUND_UP(req_size, BASE_PAGE_SIZE);
+    }
+
     if (req_size > 0) {
 #if __x86_64__
         if ((state->vregion.flags & VREGION_FLAGS_HUGE) &&
@@ -142,7 +224,7 @@ errval_t vspace_mmu_aware_map(struct vspace_mmu_aware *state, size_t req_size,
             goto allocate;
         }
 #endif
-        if ((state->vregion.flags & VREGION_FLAGS_LARGE) &&
+        if ((state->vregion.flags & VREGION_FLAGS_LARGE || promote) &&
             (state->mapoffset & LARGE_PAGE_MASK) == 0)
         {
             // this is an opportunity to switch to 2M pages if requested.
@@ -166,6 +248,12 @@ allocate:
                     alloc_size = BASE_PAGE_SIZE;
                     goto allocate;
                 }
+                // no large frame to promote; retry with what was asked for
+                if (promote && alloc_size > ROUND_UP(req_size, BASE_PAGE_SIZE)) {
+                    state->memobj.promote_stats.alloc_fallbacks++;
+                    alloc_size = ROUND_UP(req_size, BASE_PAGE_SIZE);
+                    goto allocate;
+                }
                 return err_push(err, LIB_ERR_FRAME_CREATE_MS_CONSTRAINTS);
             }
             return err_push(err, LIB_ERR_FRAME_CREATE);
@@ -29,6 +29,8 @@
 #include <string.h>
 
 #include <flounder/flounder.h>
+#include <trace/trace.h>
+#include <trace_definitions/trace_defs.h>
 
 #ifdef CONFIG_INTERCONNECT_DRIVER_UMP
 #  include <barrelfish/ump_endpoint.h>
@@ -224,39 +226,86 @@ void poll_ahci(struct waitset_chanstate *chan)
     assert(err_is_ok(err)); // should not be able to fail
 }
 
-/// Check polled channels
+/**
+ * \brief Check polled channels
+ *
+ * Scans the dispatcher's queue of polled channels once and takes the ready
+ * channels off it, then triggers them in one batch. Triggering does not touch
+ * the rest of the queue, so the scan never has to start over and costs one
+ * poll per channel no matter how many of them are ready.
+ *
+ * Channels of UMP bindings with IPI notification (ump_ipi) are only on this
+ * queue while an adaptive receiver polls them; otherwise they wait for their
+ * notification endpoint instead. An adaptive receiver's channel is also
+ * triggered when its spin window is over, so that it can start waiting.
+ */
 void poll_channels_disabled(dispatcher_handle_t handle) {
     struct dispatcher_generic *dp = get_dispatcher_generic(handle);
-    struct waitset_chanstate *chan;
+    struct waitset_chanstate *chan, *next, *last, *ready = NULL;
+    struct waitset_chanstate **ready_tail = &ready;
+    uint32_t scanned = 0, nready = 0;
+    systime_t now = 0;
+    bool poll_net = false;
+    errval_t err;
 
     if (!dp->polled_channels)
         return;
+
+    trace_event(TRACE_SUBSYS_WAITSET, TRACE_EVENT_WAITSET_POLL_SCAN, 0);
+
+    // scan every channel once, collecting the ready ones
     chan = dp->polled_channels;
-    do {
+    last = chan->polled_prev;
+    for (bool done = false; !done; chan = next) {
+        next = chan->polled_next;
+        done = chan == last;
+        scanned++;
         switch (chan->chantype) {
 #ifdef CONFIG_INTERCONNECT_DRIVER_UMP
-        case CHANTYPE_UMP_IN: {
-            if (ump_endpoint_poll(chan)) {
-                errval_t err = waitset_chan_trigger_disabled(chan, handle);
-                assert(err_is_ok(err)); // should not fail
-                if (!dp->polled_channels) // restart scan
-                    return;
-                chan = dp->polled_channels;
+        case CHANTYPE_UMP_IN:
+            // adaptive receivers also want to run when they should stop polling
+            if (!ump_endpoint_poll(chan) && !ump_endpoint_spin_expired(chan, &now)) {
                 continue;
-            } else
-                chan = chan->polled_next;
-        } break;
+            }
+            break;
 #endif // CONFIG_INTERCONNECT_DRIVER_UMP
         case CHANTYPE_LWIP_SOCKET:
-            arranet_polling_loop_proxy();
-            break;
+            // the network stack is polled once for all its sockets
+            poll_net = true;
+            continue;
         case CHANTYPE_AHCI:
-            poll_ahci(chan);
             break;
         default:
             assert(!"invalid channel type to poll!");
+            continue;
+        }
+
+        // take it off the polled queue, and append it to the ready batch
+        dequeue_polled(&dp->polled_channels, chan);
+        *ready_tail = chan;
+        ready_tail = &chan->polled_next;
+        nready++;
+    }
+
+    // trigger the batch
+    for (chan = ready; chan != NULL; chan = next) {
+        next = chan->polled_next;
+        chan->polled_next = NULL;
+        if (chan->chantype == CHANTYPE_AHCI) {
+            poll_ahci(chan);
+        } else {
+            err = waitset_chan_trigger_disabled(chan, handle);
+            assert(err_is_ok(err)); // should not fail
         }
-    } while (chan != dp->polled_channels);
+    }
+
+    if (poll_net) {
+        arranet_polling_loop_proxy();
+    }
+
+    trace_event(TRACE_SUBSYS_WAITSET, TRACE_EVENT_WAITSET_POLL_SCAN_DONE,
+                (scanned > 0xffff ? 0xffff0000 : scanned << 16)
+                | (nready > 0xffff ? 0xffff : nready));
 }
 
 /// Re-register a channel (if persistent)
@@ -861,7 +910,11 @@ errval_t waitset_chan_trigger_disabled(struct waitset_chanstate *chan,
     } else {
         assert_disabled(chan->state == CHAN_POLLED);
         dequeue(&ws->polled, chan);
-        dequeue_polled(&get_dispatcher_generic(handle)->polled_channels, chan);
+        // poll_channels_disabled() takes ready channels off the polled queue
+        if (chan->polled_prev != NULL) {
+            dequeue_polled(&get_dispatcher_generic(handle)->polled_channels,
+                           chan);
+        }
     }
 
     // else mark channel pending and move to end of pending event queue
@@ -13,6 +13,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <limits.h>
 #include <barrelfish/barrelfish.h>
 #include <bench/bench.h>
@@ -223,3 +224,54 @@ cycles_t bench_max(cycles_t *array, size_t len)
 
     return max;
 }
+
+/**
+ * \brief Randomly permute an array (Fisher-Yates)
+ *
+ * Uses rand(), so seed it with srand() for reproducible orders.
+ *
+ * \param base  Start of array
+ * \param nmemb Number of elements
+ * \param size  Size of an element (in bytes)
+ */
+void bench_shuffle(void *base, size_t nmemb, size_t size)
+{
+    char *a = base;
+
+    for (size_t i = nmemb; i > 1; i--) {
+        size_t j = rand() % i;
+        char *x = a + (i - 1) * size, *y = a + j * size;
+        for (size_t b = 0; b < size; b++) {
+            char tmp = x[b];
+            x[b] = y[b];
+            y[b] = tmp;
+        }
+    }
+}
+
+/**
+ * \brief Parse the optional size argument of a benchmark
+ *
+ * Takes the value from argv[1] if it is given, and prints a usage message
+ * if the value is below the minimum.
+ *
+ * \param argc  Argument count of main()
+ * \param argv  Arguments of main()
+ * \param name  Name of the argument, for the usage message
+ * \param min   Smallest value accepted
+ * \param value Holds the default value, filled-in with the value to use
+ *
+ * \returns false if the benchmark should exit with a failure
+ */
+bool bench_size_arg(int argc, char *argv[], const char *name, size_t min,
+                    size_t *value)
+{
+    if (argc > 1) {
+        *value = strtoul(argv[1], NULL, 0);
+    }
+    if (*value < min) {
+        printf("Usage: %s [%s >= %zu]\n", argv[0], name, min);
+        return false;
+    }
+    return true;
+}
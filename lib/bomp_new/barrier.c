@@ -12,14 +12,51 @@
  * These functions implement the BARRIER construct
  */
 
+/**
+ * \brief called in a busy wait loop, yields now and then
+ *
+ * \param waitcnt   counter of the loop, initialized to 0
+ */
+void bomp_spin_wait(uint64_t *waitcnt)
+{
+    if (++(*waitcnt) == 0x400) {
+        *waitcnt = 0;
+        thread_yield();
+    }
+}
+
+void bomp_barrier_init(struct bomp_barrier *barrier,
+                       uint32_t count)
+{
+    barrier->max = count;
+    barrier->cycle = 0;
+    barrier->counter = 0;
+}
+
+void bomp_barrier_wait(struct bomp_barrier *barrier)
+{
+    uint32_t cycle = barrier->cycle;
+    if (__sync_fetch_and_add(&barrier->counter, 1) == barrier->max - 1) {
+        barrier->counter = 0;
+        barrier->cycle = !cycle;
+    } else {
+        uint64_t waitcnt = 0;
+        while (cycle == barrier->cycle) {
+            bomp_spin_wait(&waitcnt);
+        }
+    }
+}
+
 void GOMP_barrier(void)
 {
-    assert(!"NYI");
-//    assert(g_bomp_state);
-//
-//    struct bomp_thread_local_data *th_local_data = g_bomp_state->backend.get_tls();
-//    assert(th_local_data != NULL);
-//    bomp_barrier_wait(th_local_data->work->barrier);
+    struct omp_icv_task *icvt = bomp_icv_get_task();
+
+    /* outside of a parallel region or in a nested one we are alone */
+    if (icvt == NULL || icvt->team == NULL || icvt->active_levels > 1) {
+        return;
+    }
+
+    bomp_barrier_wait(&icvt->team->barrier);
 }
 
 bool GOMP_barrier_cancel (void)
@@ -68,6 +68,8 @@ void bomp_start_processing(void (*fn)(void *),
 
     /* set the local thread ID */
     tls->thread_id = 0;
+    tls->loop.gen = 0;
+    tls->loop.loop = NULL;
 
     return;
 #if 0
@@ -138,8 +140,60 @@ void bomp_end_processing(void)
         }
     }
 
+    bomp_team_free(tls->icv.task->team);
     free(tls->icv.task);
     tls->icv.task = NULL;
 
     debug_printf("bomp_end_processing: done\n");
 }
+
+/**
+ * \brief allocates the shared state of a team
+ *
+ * \param nthreads the number of threads of the team
+ *
+ * \returns team state or NULL on failure
+ */
+struct bomp_team *bomp_team_new(coreid_t nthreads)
+{
+    struct bomp_team *team = calloc(1, sizeof(*team));
+    if (team == NULL) {
+        return NULL;
+    }
+
+    team->nthreads = nthreads;
+    bomp_barrier_init(&team->barrier, nthreads);
+
+    for (int i = 0; i < BOMP_LOOP_SLOTS; i++) {
+        struct bomp_loop *loop = &team->loops[i];
+        loop->ranges_mem = malloc((nthreads + 1) * sizeof(struct bomp_loop_range));
+        if (loop->ranges_mem == NULL) {
+            bomp_team_free(team);
+            return NULL;
+        }
+        loop->ranges = (struct bomp_loop_range *)
+            ROUND_UP((lvaddr_t)loop->ranges_mem, BOMP_CACHELINE_SIZE);
+        loop->nthreads = nthreads;
+        /* the slot is free: nobody is in the previous loop using it */
+        loop->left = nthreads;
+    }
+
+    return team;
+}
+
+/**
+ * \brief frees the shared state of a team
+ *
+ * \param team the team state, may be NULL
+ */
+void bomp_team_free(struct bomp_team *team)
+{
+    if (team == NULL) {
+        return;
+    }
+
+    for (int i = 0; i < BOMP_LOOP_SLOTS; i++) {
+        free(team->loops[i].ranges_mem);
+    }
+    free(team);
+}
@@ -286,6 +286,8 @@ static void execute__rx(struct bomp_binding *_binding,
     bomp_icv_set_task(&icvt);
 
     tls->thread_id = tid;
+    tls->loop.gen = 0;
+    tls->loop.loop = NULL;
 
     bomp_thread_fn_t func= (bomp_thread_fn_t)fn;
 
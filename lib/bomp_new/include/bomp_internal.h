@@ -112,11 +112,90 @@ struct bomp_work {
     coreid_t thread_id;
 };
 
+///< size of a cache line, to keep per-thread loop state apart
+#define BOMP_CACHELINE_SIZE 64
+
+///< number of loops threads may run ahead of the slowest one with nowait
+#define BOMP_LOOP_SLOTS 4
+
+/**
+ * \brief a sense reversing barrier for the threads of a team
+ */
+struct bomp_barrier {
+    uint32_t max;                ///< number of threads taking part
+    volatile uint32_t cycle;     ///< flips when all threads arrived
+    volatile uint32_t counter;   ///< number of threads arrived
+};
+
+/**
+ * \brief the part of a loop's iteration space a thread hands out chunks of
+ *
+ * Every thread takes chunks from its own range first and only steals from
+ * the ranges of the other threads when its own is empty. So the counter of a
+ * range mostly stays in the cache of the core that owns it, in contrast to a
+ * single counter shared by all threads.
+ */
+struct bomp_loop_range {
+    volatile long next;          ///< next iteration to hand out
+    long end;                    ///< end of the range
+    uint8_t pad[BOMP_CACHELINE_SIZE - 2 * sizeof(long)];
+};
+
+/**
+ * \brief shared state of a work sharing loop
+ *
+ * Iterations are numbered 0..niters-1 and converted to loop variable values
+ * when handed out.
+ */
+struct bomp_loop {
+    volatile uint32_t ready_gen;     ///< loop generation the state is set up for
+    volatile uint32_t claim_gen;     ///< loop generation being set up
+    volatile uint32_t left;          ///< number of threads done with the loop
+    coreid_t nthreads;               ///< number of threads in the team
+    omp_sched_t sched;               ///< schedule kind
+    bool monotonic;                  ///< hand out increasing chunks per thread
+    bool ordered;                    ///< the loop has an ordered region
+    long start;                      ///< value of the loop variable of iteration 0
+    long incr;                       ///< increment of the loop variable
+    long chunk;                      ///< chunk size, 0 for the default
+    long niters;                     ///< number of iterations
+    volatile long ordered_next;      ///< start of the chunk allowed to run ordered
+    struct bomp_loop_range *ranges;  ///< one range per thread, cache aligned
+    void *ranges_mem;                ///< allocated memory of ranges
+};
+
+/**
+ * \brief state shared by the threads executing a parallel region
+ *
+ * The loops are used round robin, so threads can enter up to BOMP_LOOP_SLOTS
+ * loops before the slowest thread left the first of them.
+ */
+struct bomp_team {
+    coreid_t nthreads;                       ///< number of threads in the team
+    struct bomp_barrier barrier;             ///< team barrier
+    struct bomp_loop loops[BOMP_LOOP_SLOTS]; ///< loop states
+};
+
+/**
+ * \brief per thread state of the work sharing loop being executed
+ */
+struct bomp_loop_state {
+    uint32_t gen;                ///< number of loops started in this region
+    struct bomp_loop *loop;      ///< the loop being executed
+    long chunk_start;            ///< first iteration of the current chunk
+    long chunk_end;              ///< end of the current chunk
+    long static_next;            ///< next chunk of a static chunked schedule
+    bool owns_ordered;           ///< we may run the ordered region
+    struct bomp_loop single;     ///< loop state when we are alone
+    struct bomp_loop_range single_range;
+};
+
 struct bomp_tls {
     struct thread *self;        ///< pointer ot the struct thread
     struct omp_icv icv;             ///< pointer holding the environment variables
     coreid_t thread_id;
     bomp_thread_role_t role;     ///< identifies the role of the thread
+    struct bomp_loop_state loop; ///< work sharing loop state
     union {
         struct bomp_master master;
         struct bomp_node   node;
@@ -142,6 +221,15 @@ void bomp_start_processing(void (*fn)(void *),
                            coreid_t nthreads);
 void bomp_end_processing(void);
 
+struct bomp_team *bomp_team_new(coreid_t nthreads);
+void bomp_team_free(struct bomp_team *team);
+
+void bomp_barrier_init(struct bomp_barrier *barrier, uint32_t count);
+void bomp_barrier_wait(struct bomp_barrier *barrier);
+void bomp_spin_wait(uint64_t *waitcnt);
+
+void bomp_loop_ordered_wait(void);
+
 /**
  * \brief obtaining a pointer to the control variables
  *
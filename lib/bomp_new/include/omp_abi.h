@@ -75,6 +75,25 @@ void GOMP_parallel_loop_runtime (void (*)(void *), void *,
                     unsigned, long, long, long,
                     unsigned);
 
+bool GOMP_loop_nonmonotonic_dynamic_start (long, long, long, long,
+                                           long *, long *);
+bool GOMP_loop_nonmonotonic_guided_start (long, long, long, long,
+                                          long *, long *);
+bool GOMP_loop_maybe_nonmonotonic_runtime_start (long, long, long,
+                                                 long *, long *);
+bool GOMP_loop_nonmonotonic_dynamic_next (long *, long *);
+bool GOMP_loop_nonmonotonic_guided_next (long *, long *);
+bool GOMP_loop_maybe_nonmonotonic_runtime_next (long *, long *);
+void GOMP_parallel_loop_nonmonotonic_dynamic (void (*)(void *), void *,
+                    unsigned, long, long, long, long,
+                    unsigned);
+void GOMP_parallel_loop_nonmonotonic_guided (void (*)(void *), void *,
+                    unsigned, long, long, long, long,
+                    unsigned);
+void GOMP_parallel_loop_maybe_nonmonotonic_runtime (void (*)(void *), void *,
+                    unsigned, long, long, long,
+                    unsigned);
+
 void GOMP_loop_end (void);
 void GOMP_loop_end_nowait (void);
 bool GOMP_loop_end_cancel (void);
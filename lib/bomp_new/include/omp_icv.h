@@ -128,6 +128,12 @@ struct omp_icv_task
      */
     omp_sched_t run_sched;
     int         run_sched_modifier;
+
+    /**
+     * not an ICV: the work sharing state of the team executing the parallel
+     * region. Workers get a copy of the task ICVs, so they share this pointer.
+     */
+    struct bomp_team *team;
 };
 
 /**
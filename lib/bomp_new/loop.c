@@ -31,14 +31,359 @@
  * GOMP_parallel_end ();
  */
 
-bool GOMP_loop_ordered_runtime_start(long start,
-                                     long end,
-                                     long incr,
-                                     long *istart,
-                                     long *iend)
+/*
+ * The iteration space is split into one contiguous range per thread, as for
+ * the static schedule. With the dynamic and guided schedules a thread takes
+ * its chunks from its own range and, once that is empty, steals chunks from
+ * the ranges of the other threads. Balanced loops thus only touch cache lines
+ * owned by the local core, while imbalanced loops still even out.
+ *
+ * Dynamic chunks have the requested chunk size. Guided chunks are half of
+ * what is left in the range, but at least the chunk size, which gives large
+ * chunks first and small ones towards the end of every range.
+ *
+ * Monotonic loops, which the plain GOMP_loop_dynamic/guided functions and
+ * ordered loops are, must hand out increasing chunks to every thread. They
+ * only steal from the ranges of threads with a higher id. The nonmonotonic
+ * variants, which newer compilers use for schedule(dynamic) and
+ * schedule(guided), steal from all threads.
+ *
+ * An ordered region may only run when all chunks before the current one are
+ * done, so a thread passes on the right to run it when it finishes a chunk.
+ */
+
+/**
+ * \brief returns the team executing the loop, or NULL if we are alone
+ */
+static struct bomp_team *loop_get_team(void)
+{
+    struct omp_icv_task *icvt = bomp_icv_get_task();
+    if (icvt == NULL || icvt->team == NULL || icvt->active_levels > 1
+        || icvt->team->nthreads == 1) {
+        return NULL;
+    }
+    return icvt->team;
+}
+
+static inline long loop_min(long a,
+                            long b)
+{
+    return a < b ? a : b;
+}
+
+static long loop_niters(long start,
+                        long end,
+                        long incr)
+{
+    if (incr > 0) {
+        return (end > start) ? (end - start + incr - 1) / incr : 0;
+    } else {
+        return (start > end) ? (start - end - incr - 1) / -incr : 0;
+    }
+}
+
+static void loop_setup(struct bomp_loop *loop,
+                       omp_sched_t sched,
+                       bool monotonic,
+                       bool ordered,
+                       long start,
+                       long end,
+                       long incr,
+                       long chunk)
+{
+    if (sched == OMP_SCHED_AUTO) {
+        /* behaves like static for balanced loops but can adapt */
+        sched = OMP_SCHED_GUIDED;
+    }
+    if (sched != OMP_SCHED_STATIC && chunk < 1) {
+        chunk = 1;
+    }
+
+    loop->sched = sched;
+    loop->monotonic = monotonic || ordered;
+    loop->ordered = ordered;
+    loop->start = start;
+    loop->incr = incr;
+    loop->chunk = chunk;
+    loop->niters = loop_niters(start, end, incr);
+    loop->ordered_next = 0;
+
+    /* the first niters % nthreads threads get one more iteration */
+    long per_thread = loop->niters / loop->nthreads;
+    long extra = loop->niters % loop->nthreads;
+    long next = 0;
+    for (coreid_t i = 0; i < loop->nthreads; i++) {
+        loop->ranges[i].next = next;
+        next += per_thread + (i < extra ? 1 : 0);
+        loop->ranges[i].end = next;
+    }
+}
+
+static void loop_init_thread(struct bomp_loop_state *st,
+                             struct bomp_loop *loop)
+{
+    struct bomp_tls *tls = thread_get_tls();
+
+    st->loop = loop;
+    st->chunk_start = 0;
+    st->chunk_end = 0;
+    st->static_next = (loop == &st->single ? 0 : tls->thread_id) * loop->chunk;
+}
+
+/**
+ * \brief enters a loop, the first thread to arrive sets it up
+ */
+static void loop_enter(omp_sched_t sched,
+                       bool monotonic,
+                       bool ordered,
+                       long start,
+                       long end,
+                       long incr,
+                       long chunk)
+{
+    struct bomp_tls *tls = thread_get_tls();
+    struct bomp_loop_state *st = &tls->loop;
+    struct bomp_team *team = loop_get_team();
+    struct bomp_loop *loop;
+
+    if (team == NULL) {
+        loop = &st->single;
+        loop->nthreads = 1;
+        loop->ranges = &st->single_range;
+        loop_setup(loop, sched, monotonic, ordered, start, end, incr, chunk);
+        loop_init_thread(st, loop);
+        return;
+    }
+
+    uint32_t gen = ++st->gen;
+    loop = &team->loops[gen % BOMP_LOOP_SLOTS];
+
+    uint64_t waitcnt = 0;
+    while (loop->ready_gen != gen) {
+        /* the slot is free once all threads left its previous loop */
+        uint32_t claimed = loop->claim_gen;
+        if (claimed < gen && loop->ready_gen == claimed
+            && loop->left == loop->nthreads
+            && __sync_bool_compare_and_swap(&loop->claim_gen, claimed, gen)) {
+            loop_setup(loop, sched, monotonic, ordered, start, end, incr, chunk);
+            loop->left = 0;
+            __sync_synchronize();
+            loop->ready_gen = gen;
+            break;
+        }
+        bomp_spin_wait(&waitcnt);
+    }
+
+    loop_init_thread(st, loop);
+}
+
+/**
+ * \brief joins a loop set up by GOMP_parallel_loop_*_start
+ */
+static void loop_attach(struct bomp_loop_state *st)
+{
+    struct bomp_team *team = loop_get_team();
+    assert(team != NULL);
+
+    uint32_t gen = ++st->gen;
+    struct bomp_loop *loop = &team->loops[gen % BOMP_LOOP_SLOTS];
+
+    uint64_t waitcnt = 0;
+    while (loop->ready_gen != gen) {
+        bomp_spin_wait(&waitcnt);
+    }
+
+    loop_init_thread(st, loop);
+}
+
+/**
+ * \brief waits until all chunks before ours are done
+ */
+static void loop_ordered_wait(struct bomp_loop_state *st)
+{
+    uint64_t waitcnt = 0;
+    while (st->loop->ordered_next != st->chunk_start) {
+        bomp_spin_wait(&waitcnt);
+    }
+}
+
+/**
+ * \brief marks our current chunk done for the ordered region
+ */
+static void loop_ordered_pass(struct bomp_loop_state *st)
+{
+    if (st->chunk_end > st->chunk_start) {
+        loop_ordered_wait(st);
+        st->loop->ordered_next = st->chunk_end;
+        st->chunk_start = st->chunk_end;
+    }
+}
+
+/**
+ * \brief takes a chunk from a range
+ */
+static bool loop_range_take(struct bomp_loop *loop,
+                            struct bomp_loop_range *range,
+                            long *ret_start,
+                            long *ret_end)
 {
-    assert(!"NYI");
-    return 0;
+    /* a plain read keeps the line shared once the range is empty */
+    if (range->next >= range->end) {
+        return false;
+    }
+
+    if (loop->sched == OMP_SCHED_GUIDED) {
+        long start = range->next;
+        while (start < range->end) {
+            long size = (range->end - start + 1) / 2;
+            if (size < loop->chunk) {
+                size = loop->chunk;
+            }
+            long end = loop_min(start + size, range->end);
+            long prev = __sync_val_compare_and_swap(&range->next, start, end);
+            if (prev == start) {
+                *ret_start = start;
+                *ret_end = end;
+                return true;
+            }
+            start = prev;
+        }
+        return false;
+    }
+
+    long start = __sync_fetch_and_add(&range->next, loop->chunk);
+    if (start >= range->end) {
+        return false;
+    }
+    *ret_start = start;
+    *ret_end = loop_min(start + loop->chunk, range->end);
+    return true;
+}
+
+static bool loop_next(long *istart,
+                      long *iend)
+{
+    struct bomp_tls *tls = thread_get_tls();
+    struct bomp_loop_state *st = &tls->loop;
+
+    if (st->loop == NULL) {
+        loop_attach(st);
+    }
+
+    struct bomp_loop *loop = st->loop;
+    coreid_t tid = (loop == &st->single) ? 0 : tls->thread_id;
+    struct bomp_loop_range *own = &loop->ranges[tid];
+    long start = 0, end = 0;
+    bool found = false;
+
+    if (loop->ordered) {
+        loop_ordered_pass(st);
+    }
+
+    if (loop->sched == OMP_SCHED_STATIC) {
+        if (loop->chunk == 0) {
+            /* nobody else touches our range */
+            start = own->next;
+            end = own->end;
+            own->next = end;
+            found = start < end;
+        } else if (st->static_next < loop->niters) {
+            start = st->static_next;
+            end = loop_min(start + loop->chunk, loop->niters);
+            st->static_next += loop->chunk * loop->nthreads;
+            found = true;
+        }
+    } else {
+        /* monotonic loops only steal from ranges above our own */
+        coreid_t nvictims = loop->monotonic ? loop->nthreads - tid : loop->nthreads;
+        found = loop_range_take(loop, own, &start, &end);
+        for (coreid_t i = 1; !found && i < nvictims; i++) {
+            coreid_t victim = (tid + i) % loop->nthreads;
+            found = loop_range_take(loop, &loop->ranges[victim], &start, &end);
+        }
+    }
+
+    if (!found) {
+        st->chunk_start = st->chunk_end;
+        return false;
+    }
+
+    st->chunk_start = start;
+    st->chunk_end = end;
+    *istart = loop->start + start * loop->incr;
+    *iend = loop->start + end * loop->incr;
+    return true;
+}
+
+static void loop_end(bool wait)
+{
+    struct bomp_tls *tls = thread_get_tls();
+    struct bomp_loop_state *st = &tls->loop;
+    struct bomp_loop *loop = st->loop;
+
+    if (loop == NULL) {
+        /* the thread never asked for work */
+        struct bomp_team *team = loop_get_team();
+        if (team != NULL) {
+            loop_attach(st);
+            loop = st->loop;
+        }
+    }
+
+    if (loop != NULL) {
+        if (loop->ordered) {
+            loop_ordered_pass(st);
+        }
+        if (loop != &st->single) {
+            __sync_fetch_and_add(&loop->left, 1);
+        }
+        st->loop = NULL;
+    }
+
+    if (wait) {
+        GOMP_barrier();
+    }
+}
+
+static omp_sched_t loop_runtime_sched(long *chunk)
+{
+    struct omp_icv_task *icvt = bomp_icv_get_task();
+    if (icvt == NULL) {
+        icvt = &g_omp_icv_task_default;
+    }
+    *chunk = icvt->run_sched_modifier;
+    return icvt->run_sched;
+}
+
+static void loop_parallel_start(void (*fn)(void *),
+                                void *data,
+                                unsigned num_threads,
+                                omp_sched_t sched,
+                                bool monotonic,
+                                long start,
+                                long end,
+                                long incr,
+                                long chunk)
+{
+    GOMP_parallel_start(fn, data, num_threads);
+
+    /* the workers wait in loop_attach() until the loop is set up */
+    loop_enter(sched, monotonic, false, start, end, incr, chunk);
+}
+
+/*
+ * start functions
+ */
+
+bool GOMP_loop_static_start(long start,
+                            long end,
+                            long incr,
+                            long chunk_size,
+                            long *istart,
+                            long *iend)
+{
+    loop_enter(OMP_SCHED_STATIC, true, false, start, end, incr, chunk_size);
+    return loop_next(istart, iend);
 }
 
 bool GOMP_loop_dynamic_start(long start,
@@ -48,38 +393,366 @@ bool GOMP_loop_dynamic_start(long start,
                              long *istart,
                              long *iend)
 {
-    assert(!"NYI");
-    return 0;
+    loop_enter(OMP_SCHED_DYNAMIC, true, false, start, end, incr, chunk_size);
+    return loop_next(istart, iend);
 }
 
-bool GOMP_loop_runtime_next(long *istart,
+bool GOMP_loop_guided_start(long start,
+                            long end,
+                            long incr,
+                            long chunk_size,
+                            long *istart,
                             long *iend)
 {
-    assert(!"NYI");
-    return 0;
+    loop_enter(OMP_SCHED_GUIDED, true, false, start, end, incr, chunk_size);
+    return loop_next(istart, iend);
 }
 
-bool GOMP_loop_ordered_runtime_next(long *istart,
+bool GOMP_loop_runtime_start(long start,
+                             long end,
+                             long incr,
+                             long *istart,
+                             long *iend)
+{
+    long chunk_size;
+    omp_sched_t sched = loop_runtime_sched(&chunk_size);
+    loop_enter(sched, true, false, start, end, incr, chunk_size);
+    return loop_next(istart, iend);
+}
+
+bool GOMP_loop_ordered_static_start(long start,
+                                    long end,
+                                    long incr,
+                                    long chunk_size,
+                                    long *istart,
                                     long *iend)
 {
-    assert(!"NYI");
-    return 0;
+    loop_enter(OMP_SCHED_STATIC, true, true, start, end, incr, chunk_size);
+    return loop_next(istart, iend);
+}
+
+bool GOMP_loop_ordered_dynamic_start(long start,
+                                     long end,
+                                     long incr,
+                                     long chunk_size,
+                                     long *istart,
+                                     long *iend)
+{
+    loop_enter(OMP_SCHED_DYNAMIC, true, true, start, end, incr, chunk_size);
+    return loop_next(istart, iend);
+}
+
+bool GOMP_loop_ordered_guided_start(long start,
+                                    long end,
+                                    long incr,
+                                    long chunk_size,
+                                    long *istart,
+                                    long *iend)
+{
+    loop_enter(OMP_SCHED_GUIDED, true, true, start, end, incr, chunk_size);
+    return loop_next(istart, iend);
+}
+
+bool GOMP_loop_ordered_runtime_start(long start,
+                                     long end,
+                                     long incr,
+                                     long *istart,
+                                     long *iend)
+{
+    long chunk_size;
+    omp_sched_t sched = loop_runtime_sched(&chunk_size);
+    loop_enter(sched, true, true, start, end, incr, chunk_size);
+    return loop_next(istart, iend);
+}
+
+/*
+ * next functions: the schedule is stored with the loop
+ */
+
+bool GOMP_loop_static_next(long *istart,
+                           long *iend)
+{
+    return loop_next(istart, iend);
 }
 
 bool GOMP_loop_dynamic_next(long *istart,
                             long *iend)
 {
-    assert(!"NYI");
-    return 0;
+    return loop_next(istart, iend);
 }
 
+bool GOMP_loop_guided_next(long *istart,
+                           long *iend)
+{
+    return loop_next(istart, iend);
+}
+
+bool GOMP_loop_runtime_next(long *istart,
+                            long *iend)
+{
+    return loop_next(istart, iend);
+}
+
+bool GOMP_loop_ordered_static_next(long *istart,
+                                   long *iend)
+{
+    return loop_next(istart, iend);
+}
+
+bool GOMP_loop_ordered_dynamic_next(long *istart,
+                                    long *iend)
+{
+    return loop_next(istart, iend);
+}
+
+bool GOMP_loop_ordered_guided_next(long *istart,
+                                   long *iend)
+{
+    return loop_next(istart, iend);
+}
+
+bool GOMP_loop_ordered_runtime_next(long *istart,
+                                    long *iend)
+{
+    return loop_next(istart, iend);
+}
+
+/*
+ * combined parallel loops
+ */
+
+void GOMP_parallel_loop_static_start(void (*fn)(void *),
+                                     void *data,
+                                     unsigned num_threads,
+                                     long start,
+                                     long end,
+                                     long incr,
+                                     long chunk_size)
+{
+    loop_parallel_start(fn, data, num_threads, OMP_SCHED_STATIC, true, start,
+                        end, incr, chunk_size);
+}
+
+void GOMP_parallel_loop_dynamic_start(void (*fn)(void *),
+                                      void *data,
+                                      unsigned num_threads,
+                                      long start,
+                                      long end,
+                                      long incr,
+                                      long chunk_size)
+{
+    loop_parallel_start(fn, data, num_threads, OMP_SCHED_DYNAMIC, true, start,
+                        end, incr, chunk_size);
+}
+
+void GOMP_parallel_loop_guided_start(void (*fn)(void *),
+                                     void *data,
+                                     unsigned num_threads,
+                                     long start,
+                                     long end,
+                                     long incr,
+                                     long chunk_size)
+{
+    loop_parallel_start(fn, data, num_threads, OMP_SCHED_GUIDED, true, start,
+                        end, incr, chunk_size);
+}
+
+void GOMP_parallel_loop_runtime_start(void (*fn)(void *),
+                                      void *data,
+                                      unsigned num_threads,
+                                      long start,
+                                      long end,
+                                      long incr)
+{
+    long chunk_size;
+    omp_sched_t sched = loop_runtime_sched(&chunk_size);
+    loop_parallel_start(fn, data, num_threads, sched, true, start, end,
+                        incr, chunk_size);
+}
+
+void GOMP_parallel_loop_static(void (*fn)(void *),
+                               void *data,
+                               unsigned num_threads,
+                               long start,
+                               long end,
+                               long incr,
+                               long chunk_size,
+                               unsigned flags)
+{
+    GOMP_parallel_loop_static_start(fn, data, num_threads, start, end, incr,
+                                    chunk_size);
+    fn(data);
+    GOMP_parallel_end();
+}
+
+void GOMP_parallel_loop_dynamic(void (*fn)(void *),
+                                void *data,
+                                unsigned num_threads,
+                                long start,
+                                long end,
+                                long incr,
+                                long chunk_size,
+                                unsigned flags)
+{
+    GOMP_parallel_loop_dynamic_start(fn, data, num_threads, start, end, incr,
+                                     chunk_size);
+    fn(data);
+    GOMP_parallel_end();
+}
+
+void GOMP_parallel_loop_guided(void (*fn)(void *),
+                               void *data,
+                               unsigned num_threads,
+                               long start,
+                               long end,
+                               long incr,
+                               long chunk_size,
+                               unsigned flags)
+{
+    GOMP_parallel_loop_guided_start(fn, data, num_threads, start, end, incr,
+                                    chunk_size);
+    fn(data);
+    GOMP_parallel_end();
+}
+
+void GOMP_parallel_loop_runtime(void (*fn)(void *),
+                                void *data,
+                                unsigned num_threads,
+                                long start,
+                                long end,
+                                long incr,
+                                unsigned flags)
+{
+    GOMP_parallel_loop_runtime_start(fn, data, num_threads, start, end, incr);
+    fn(data);
+    GOMP_parallel_end();
+}
+
+/*
+ * nonmonotonic loops: chunks may be stolen from any range
+ */
+
+bool GOMP_loop_nonmonotonic_dynamic_start(long start,
+                                          long end,
+                                          long incr,
+                                          long chunk_size,
+                                          long *istart,
+                                          long *iend)
+{
+    loop_enter(OMP_SCHED_DYNAMIC, false, false, start, end, incr, chunk_size);
+    return loop_next(istart, iend);
+}
+
+bool GOMP_loop_nonmonotonic_guided_start(long start,
+                                         long end,
+                                         long incr,
+                                         long chunk_size,
+                                         long *istart,
+                                         long *iend)
+{
+    loop_enter(OMP_SCHED_GUIDED, false, false, start, end, incr, chunk_size);
+    return loop_next(istart, iend);
+}
+
+bool GOMP_loop_maybe_nonmonotonic_runtime_start(long start,
+                                                long end,
+                                                long incr,
+                                                long *istart,
+                                                long *iend)
+{
+    long chunk_size;
+    omp_sched_t sched = loop_runtime_sched(&chunk_size);
+    loop_enter(sched, false, false, start, end, incr, chunk_size);
+    return loop_next(istart, iend);
+}
+
+bool GOMP_loop_nonmonotonic_dynamic_next(long *istart,
+                                         long *iend)
+{
+    return loop_next(istart, iend);
+}
+
+bool GOMP_loop_nonmonotonic_guided_next(long *istart,
+                                        long *iend)
+{
+    return loop_next(istart, iend);
+}
+
+bool GOMP_loop_maybe_nonmonotonic_runtime_next(long *istart,
+                                               long *iend)
+{
+    return loop_next(istart, iend);
+}
+
+void GOMP_parallel_loop_nonmonotonic_dynamic(void (*fn)(void *),
+                                             void *data,
+                                             unsigned num_threads,
+                                             long start,
+                                             long end,
+                                             long incr,
+                                             long chunk_size,
+                                             unsigned flags)
+{
+    loop_parallel_start(fn, data, num_threads, OMP_SCHED_DYNAMIC, false, start,
+                        end, incr, chunk_size);
+    fn(data);
+    GOMP_parallel_end();
+}
+
+void GOMP_parallel_loop_nonmonotonic_guided(void (*fn)(void *),
+                                            void *data,
+                                            unsigned num_threads,
+                                            long start,
+                                            long end,
+                                            long incr,
+                                            long chunk_size,
+                                            unsigned flags)
+{
+    loop_parallel_start(fn, data, num_threads, OMP_SCHED_GUIDED, false, start,
+                        end, incr, chunk_size);
+    fn(data);
+    GOMP_parallel_end();
+}
+
+void GOMP_parallel_loop_maybe_nonmonotonic_runtime(void (*fn)(void *),
+                                                   void *data,
+                                                   unsigned num_threads,
+                                                   long start,
+                                                   long end,
+                                                   long incr,
+                                                   unsigned flags)
+{
+    long chunk_size;
+    omp_sched_t sched = loop_runtime_sched(&chunk_size);
+    loop_parallel_start(fn, data, num_threads, sched, false, start, end,
+                        incr, chunk_size);
+    fn(data);
+    GOMP_parallel_end();
+}
+
+/*
+ * end functions
+ */
+
 void GOMP_loop_end_nowait(void)
 {
-    assert(!"NYI");
+    loop_end(false);
 }
 
 void GOMP_loop_end(void)
 {
-    assert(!"NYI");
+    loop_end(true);
 }
 
+/*
+ * used by GOMP_ordered_start()
+ */
+void bomp_loop_ordered_wait(void)
+{
+    struct bomp_tls *tls = thread_get_tls();
+    struct bomp_loop_state *st = &tls->loop;
+
+    if (st->loop != NULL && st->loop->ordered) {
+        loop_ordered_wait(st);
+    }
+}
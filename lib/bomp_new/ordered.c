@@ -10,17 +10,18 @@
 
 /*
  * This functions implement the ORDERED construct
+ *
+ * A thread keeps the right to run the ordered region until it is done with
+ * its current chunk of the loop, see loop.c
  */
 
 
 void GOMP_ordered_start(void)
 {
-    assert(!"NYI");
-    /* nop */
+    bomp_loop_ordered_wait();
 }
 
 void GOMP_ordered_end(void)
 {
     /* nop */
-    assert(!"NYI");
 }
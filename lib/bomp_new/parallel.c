@@ -53,6 +53,13 @@ void GOMP_parallel_start(void (*fn)(void *),
             debug_printf("resetting to = %u\n", icv_task->nthreads);
         }
 
+        icv_task->team = bomp_team_new(icv_task->nthreads);
+        if (!icv_task->team) {
+            debug_printf("no team\n");
+            free(icv_task);
+            return;
+        }
+
         bomp_icv_set_task(icv_task);
         debug_printf("icv task set %u\n", icv_task->nthreads);
 
@@ -95,7 +102,9 @@ void GOMP_parallel(void (*fn)(void *),
                    unsigned int flags)
 {
     debug_printf("GOMP_parallel");
-    assert(!"NYI");
+    GOMP_parallel_start(fn, data, num_threads);
+    fn(data);
+    GOMP_parallel_end();
 }
 
 #if OMP_VERSION >= OMP_VERSION_40
@@ -13,21 +13,40 @@
 
 #include "collections/hash_table.h"
 #include "inttypes.h"
+#include <stdbool.h>
 
 /******************************************************
  * a simple hash table implementation
  ******************************************************/
 
 /*
- * Function to identify the right element from the
- * linked list.
+ * Load factor at which the table grows, as a fraction num/den.
  */
-static int32_t match_key(void *data, void *arg)
+#define LOAD_FACTOR_NUM	3
+#define LOAD_FACTOR_DEN	4
+
+/*
+ * Mix the key before using it as a slot index. Keys are often small
+ * sequential integers or hashes whose low bits are poorly distributed.
+ */
+static inline uint32_t slot_for(collections_hash_table *t, uint64_t key)
+{
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdULL;
+	key ^= key >> 33;
+	key *= 0xc4ceb9fe1a85ec53ULL;
+	key ^= key >> 33;
+
+	return key & (t->num_buckets - 1);
+}
+
+static collections_hash_elem *collections_hash_alloc_slots(int num_buckets)
 {
-	collections_hash_elem *elem = (collections_hash_elem *) data;
-	uint64_t key  = *((uint64_t *)arg);
+	collections_hash_elem *slots;
 
-    return (elem->key == key);
+	slots = (collections_hash_elem *) calloc(num_buckets, sizeof(collections_hash_elem));
+	assert(slots != NULL);
+	return slots;
 }
 
 /*
@@ -35,18 +54,18 @@ static int32_t match_key(void *data, void *arg)
  */
 static void collections_hash_create_core(collections_hash_table **t, int num_buckets, collections_hash_data_free data_free)
 {
-	int i;
+	int size = 8;
+
+	// round up to a power of two, so we can mask instead of divide
+	while (size < num_buckets) {
+		size *= 2;
+	}
 
 	*t = (collections_hash_table *) malloc (sizeof(collections_hash_table));
 	memset(*t, 0, sizeof(collections_hash_table));
 
-	(*t)->num_buckets = num_buckets;
-
-	// create a linked list node for each bucket
-	(*t)->buckets = (collections_listnode **) malloc(sizeof(collections_listnode *) * num_buckets);
-	for (i = 0; i < num_buckets; i ++) {
-		collections_list_create(&(*t)->buckets[i], NULL);
-	}
+	(*t)->num_buckets = size;
+	(*t)->buckets = collections_hash_alloc_slots(size);
 
 	(*t)->num_elems = 0;
     (*t)->data_free = data_free;
@@ -66,39 +85,19 @@ void collections_hash_create_with_buckets(collections_hash_table **t, int num_bu
 	collections_hash_create_core(t, num_buckets, elem_free);
 }
 
-static int collections_hash_release_elem(void* elem, void * arg)
-{
-    collections_hash_table *t = (collections_hash_table *)arg;
-    collections_hash_elem *he = (collections_hash_elem *)elem;
-    if (t->data_free)
-    {
-        t->data_free(he->data);
-    }
-    free(he);
-
-	t->num_elems--;
-
-    return 1;
-}
-
 // delete the entire hash table
 void collections_hash_release(collections_hash_table *t)
 {
-	int bucket_num;
-	int bucket_size;
-	collections_listnode *bucket;
-
-	for (bucket_num = 0; bucket_num < t->num_buckets; bucket_num ++) {
-        uint32_t before, after;
-		bucket = t->buckets[bucket_num];
-		bucket_size = collections_list_size(bucket);
-        
-        before = t->num_elems;
-        collections_list_visit(bucket, collections_hash_release_elem, t);
-        after = t->num_elems;
-        assert(before - after == bucket_size);
-
-        collections_list_release(bucket);
+	int i;
+
+	for (i = 0; i < t->num_buckets; i ++) {
+		collections_hash_elem *elem = &t->buckets[i];
+		if (elem->used) {
+			if (t->data_free) {
+				t->data_free(elem->data);
+			}
+			t->num_elems--;
+		}
 	}
     assert(t->num_elems == 0);
 
@@ -106,16 +105,81 @@ void collections_hash_release(collections_hash_table *t)
 	free(t);
 }
 
+/*
+ * Returns the slot holding key, or the empty slot where it would go.
+ */
+static collections_hash_elem* collections_hash_find_slot(collections_hash_table *t, uint64_t key)
+{
+	uint32_t mask = t->num_buckets - 1;
+	uint32_t i = slot_for(t, key);
+
+	// the table is never full, so this terminates
+	while (t->buckets[i].used && t->buckets[i].key != key) {
+		i = (i + 1) & mask;
+	}
+	return &t->buckets[i];
+}
+
 static collections_hash_elem* collections_hash_find_elem(collections_hash_table *t, uint64_t key)
 {
-	uint32_t bucket_num;	
-	collections_listnode *bucket;	
-	collections_hash_elem *elem;
+	collections_hash_elem *elem = collections_hash_find_slot(t, key);
+	return elem->used ? elem : NULL;
+}
+
+/*
+ * Double the number of slots and re-insert all elements. If a traversal is
+ * in progress it restarts from the first slot, as elements have moved.
+ */
+static void collections_hash_grow(collections_hash_table *t)
+{
+	collections_hash_elem *old = t->buckets;
+	int old_num = t->num_buckets;
+	int i;
 
-	bucket_num = key % t->num_buckets;
-	bucket = t->buckets[bucket_num];
-	elem = (collections_hash_elem*) collections_list_find_if(bucket, match_key, &key);
-    return elem;
+	if (t->cur_bucket_num != -1) {
+		t->cur_bucket_num = 0;
+	}
+
+	t->num_buckets *= 2;
+	t->buckets = collections_hash_alloc_slots(t->num_buckets);
+
+	for (i = 0; i < old_num; i ++) {
+		if (old[i].used) {
+			*collections_hash_find_slot(t, old[i].key) = old[i];
+		}
+	}
+
+	free(old);
+}
+
+/*
+ * Returns true if the table is over its load factor once it holds num_elems
+ * elements.
+ */
+static inline bool collections_hash_overloaded(collections_hash_table *t, int num_elems)
+{
+	return (uint64_t)num_elems * LOAD_FACTOR_DEN >
+	       (uint64_t)t->num_buckets * LOAD_FACTOR_NUM;
+}
+
+/*
+ * Returns the slot for key, growing the table first if an insert would
+ * make it too full. During a traversal the grow is deferred to
+ * collections_hash_traverse_end(), as long as one slot stays empty to
+ * terminate probe sequences.
+ */
+static collections_hash_elem* collections_hash_insert_slot(collections_hash_table *t, uint64_t key)
+{
+	collections_hash_elem *elem = collections_hash_find_slot(t, key);
+
+	if (elem->used || !collections_hash_overloaded(t, t->num_elems + 1)) {
+		return elem;
+	}
+	if (t->cur_bucket_num == -1 || t->num_elems + 1 >= t->num_buckets) {
+		collections_hash_grow(t);
+		elem = collections_hash_find_slot(t, key);
+	}
+	return elem;
 }
 
 /*
@@ -123,27 +187,40 @@ static collections_hash_elem* collections_hash_find_elem(collections_hash_table
  */
 void collections_hash_insert(collections_hash_table *t, uint64_t key, void *data)
 {
-	uint32_t bucket_num;
-	collections_listnode *bucket;
 	collections_hash_elem *elem;
 
-    elem = collections_hash_find_elem(t, key);
-	if (elem != NULL) {
+    elem = collections_hash_insert_slot(t, key);
+	if (elem->used) {
 		printf("Error: key %" PRIu64 " already present in hash table %" PRIu64 "\n",
             key, elem->key);
 		assert(0);
 		return;
 	}
 
-	bucket_num = key % t->num_buckets;
-	bucket = t->buckets[bucket_num];
-	elem = (collections_hash_elem *) malloc(sizeof(collections_hash_elem));
 	elem->key = key;
 	elem->data = data;
-	collections_list_insert(bucket, (void *)elem);
+	elem->used = 1;
 	t->num_elems ++;
 }
 
+void *collections_hash_insert_or_replace(collections_hash_table *t, uint64_t key, void *data)
+{
+	collections_hash_elem *elem;
+	void *old = NULL;
+
+    elem = collections_hash_insert_slot(t, key);
+	if (elem->used) {
+		old = elem->data;
+	} else {
+		elem->key = key;
+		elem->used = 1;
+		t->num_elems ++;
+	}
+	elem->data = data;
+
+	return old;
+}
+
 /*
  * Retrieves an element from the hash table.
  */
@@ -158,22 +235,34 @@ void *collections_hash_find(collections_hash_table *t, uint64_t key)
  */
 void collections_hash_delete(collections_hash_table *t, uint64_t key)
 {	
-	uint32_t bucket_num;	
-	collections_listnode *bucket;	
+	uint32_t mask = t->num_buckets - 1;
 	collections_hash_elem *elem;
+	uint32_t i, j;
 
-	bucket_num = key % t->num_buckets;
-	bucket = t->buckets[bucket_num];
-	elem = (collections_hash_elem*) collections_list_remove_if(bucket, match_key, &key);
-	if (elem) {
-        uint32_t n = t->num_elems;
-        collections_hash_release_elem(elem, t);
-        assert(1 == n - t->num_elems);
-	}
-    else
-    {
+	elem = collections_hash_find_elem(t, key);
+	if (elem == NULL) {
 	    printf("Error: cannot find the node with key %" PRIu64 " in collections_hash_release\n", key);
-    }
+		return;
+	}
+
+	if (t->data_free) {
+		t->data_free(elem->data);
+	}
+	t->num_elems--;
+
+	// move back later elements of the probe sequence that would otherwise
+	// become unreachable through the hole we leave.
+	i = elem - t->buckets;
+	for (j = (i + 1) & mask; t->buckets[j].used; j = (j + 1) & mask) {
+		uint32_t home = slot_for(t, t->buckets[j].key);
+		// can the element at j live in slot i? only if its home slot is
+		// not cyclically within (i, j].
+		if (((j - home) & mask) >= ((j - i) & mask)) {
+			t->buckets[i] = t->buckets[j];
+			i = j;
+		}
+	}
+	memset(&t->buckets[i], 0, sizeof(collections_hash_elem));
 }
 
 /*
@@ -184,27 +273,6 @@ uint32_t collections_hash_size(collections_hash_table *t)
 	return (t->num_elems);
 }
 
-static collections_listnode* collections_hash_get_next_valid_bucket(collections_hash_table* t)
-{
-	collections_listnode* bucket;
-
-	do {
-		t->cur_bucket_num ++;
-		if (t->cur_bucket_num < t->num_buckets) {
-			if (!t->buckets[t->cur_bucket_num]) {
-				continue;
-			}
-		} else {
-			return NULL;
-		}
-	} while (collections_list_size(t->buckets[t->cur_bucket_num]) <= 0);
-
-	bucket = t->buckets[t->cur_bucket_num];
-	collections_list_traverse_start(bucket);
-
-	return bucket;
-}
-
 int32_t collections_hash_traverse_start(collections_hash_table *t)
 {
 	if (t->cur_bucket_num != -1) {
@@ -214,7 +282,7 @@ int32_t collections_hash_traverse_start(collections_hash_table *t)
 		return -1;
 	}
 
-	collections_hash_get_next_valid_bucket(t);
+	t->cur_bucket_num = 0;
 
 	return 1;
 }
@@ -233,39 +301,17 @@ void* collections_hash_traverse_next(collections_hash_table* t, uint64_t *key)
 		printf("Error: collections_hash_table must be opened for traversal first.\n");
 		return NULL;
 	}
-	
-	if (t->cur_bucket_num >= t->num_buckets) {
-		// all the buckets have been traversed.
-		return NULL;
-	} else {
-		collections_listnode*	bucket;
-		collections_hash_elem*	ret;
-
-		if (t->buckets[t->cur_bucket_num]) {
-			bucket = t->buckets[t->cur_bucket_num];
-			ret = (collections_hash_elem*) collections_list_traverse_next(bucket);
-
-			if (ret) {
-				*key = ret->key;
-				return ret->data;
-			} else {
-				// this list traversal is over.
-				// let's close it.
-				collections_list_traverse_end(bucket);
-			}
-		}
 
-		bucket = collections_hash_get_next_valid_bucket(t);
-		if (!bucket) {
-			return NULL;
-		} else {
-			ret = (collections_hash_elem*) collections_list_traverse_next(bucket);
-			assert(ret != NULL);
+	while (t->cur_bucket_num < t->num_buckets) {
+		collections_hash_elem *elem = &t->buckets[t->cur_bucket_num++];
+		if (elem->used) {
+			*key = elem->key;
+			return elem->data;
 		}
-
-		*key = ret->key;
-		return ret->data;
 	}
+
+	// all the slots have been traversed.
+	return NULL;
 }
 
 int32_t	collections_hash_traverse_end(collections_hash_table* t)
@@ -277,33 +323,20 @@ int32_t	collections_hash_traverse_end(collections_hash_table* t)
 		return -1;
 	}
 
-    // XXX The bucktes (list) are not reset here which may cause errors when the
-    // hash table is only traversed half way. 
-
 	t->cur_bucket_num = -1;
+	if (collections_hash_overloaded(t, t->num_elems)) {
+		collections_hash_grow(t);
+	}
 	return 1;
 }
 
-struct collections_hash_visitor_tuple
-{
-    collections_hash_visitor_func func;
-    void *arg;
-};
-
-static int collections_hash_visit0(void* list_data, void* arg)
-{
-    struct collections_hash_visitor_tuple *t = (struct collections_hash_visitor_tuple *)arg;
-    collections_hash_elem *he = (collections_hash_elem*)list_data;
-    return t->func(he->key, he->data, t->arg);
-}
-
 int collections_hash_visit(collections_hash_table* t, collections_hash_visitor_func func, void* arg)
 {
-    struct collections_hash_visitor_tuple tuple = { func, arg };
     int i = 0;
     while (i < t->num_buckets)
     {
-        if (collections_list_visit(t->buckets[i], collections_hash_visit0, &tuple) == 0) {
+        collections_hash_elem *he = &t->buckets[i];
+        if (he->used && func(he->key, he->data, arg) == 0) {
             break;
         }
         i++;
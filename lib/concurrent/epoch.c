@@ -0,0 +1,237 @@
+/** \file
+ *  \brief Epoch-based memory reclamation, after Keir Fraser's `Practical
+ *  lock-freedom'.
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+/*
+ * There is a global epoch counter. A thread entering a critical section
+ * records the global epoch it observed. The global epoch may only advance
+ * when all threads inside a critical section have observed the current one,
+ * so active threads lag behind it by at most one.
+ *
+ * Memory retired while the global epoch is e was unlinked at that time, so
+ * only threads that observed e or an earlier epoch can still reference it.
+ * Once the global epoch reaches e + 2 all of those have left their critical
+ * sections and the memory can be freed. Each thread keeps its retired memory
+ * in one limbo list per epoch modulo EPOCH_GENERATIONS.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <barrelfish/threads.h>
+#include <concurrent/arch/cas.h>
+#include <concurrent/epoch.h>
+
+#define EPOCH_GENERATIONS       3
+
+/// Number of retired objects after which a thread tries to advance the epoch
+#define EPOCH_RECLAIM_THRESHOLD 128
+
+#define LIMBO_BLOCK_ENTRIES     126
+
+struct limbo_block {
+    struct limbo_block *next;
+    size_t count;
+    struct {
+        void *ptr;
+        void (*free_fn)(void *);
+    } entries[LIMBO_BLOCK_ENTRIES];
+};
+
+struct epoch_record {
+    struct epoch_record *next;      ///< in the list of all records
+    volatile uintptr_t in_use;      ///< owned by a thread
+    volatile uintptr_t active;      ///< critical section nesting depth
+    volatile uintptr_t epoch;       ///< global epoch observed on entry
+    struct limbo_block *limbo[EPOCH_GENERATIONS];
+    uintptr_t limbo_epoch[EPOCH_GENERATIONS];
+    size_t retired;                 ///< objects in all limbo lists
+    size_t since_reclaim;           ///< objects retired since last attempt
+};
+
+static volatile uintptr_t global_epoch = EPOCH_GENERATIONS;
+
+/// Records are never freed, only handed to another thread on reuse
+static struct epoch_record *volatile records;
+
+static __thread struct epoch_record *my_record;
+
+static struct epoch_record *get_record(void)
+{
+    struct epoch_record *r = my_record;
+    if (r != NULL) {
+        return r;
+    }
+
+    // reuse the record of a thread that unregistered
+    for (r = records; r != NULL; r = r->next) {
+        if (r->in_use == 0 && cas(&r->in_use, 0, 1)) {
+            my_record = r;
+            return r;
+        }
+    }
+
+    r = calloc(1, sizeof(struct epoch_record));
+    assert(r != NULL);
+    r->in_use = 1;
+    do {
+        r->next = records;
+    } while (!cas((volatile uintptr_t *) &records, (uintptr_t) r->next,
+                  (uintptr_t) r));
+
+    my_record = r;
+    return r;
+}
+
+static void free_limbo(struct epoch_record *r, int gen)
+{
+    struct limbo_block *b = r->limbo[gen];
+    while (b != NULL) {
+        for (size_t i = 0; i < b->count; i++) {
+            b->entries[i].free_fn(b->entries[i].ptr);
+        }
+        r->retired -= b->count;
+        b->count = 0;
+
+        // keep the first block around for the next epoch
+        struct limbo_block *next = b->next;
+        if (b != r->limbo[gen]) {
+            free(b);
+        }
+        b = next;
+    }
+    if (r->limbo[gen] != NULL) {
+        r->limbo[gen]->next = NULL;
+    }
+}
+
+/// Free all limbo lists of r that were retired two or more epochs before e
+static void collect(struct epoch_record *r, uintptr_t e)
+{
+    for (int gen = 0; gen < EPOCH_GENERATIONS; gen++) {
+        if (r->limbo[gen] != NULL && r->limbo[gen]->count > 0
+            && r->limbo_epoch[gen] + 2 <= e) {
+            free_limbo(r, gen);
+        }
+    }
+}
+
+/// Advance the global epoch if all active threads have observed it
+static void try_advance(void)
+{
+    uintptr_t e = global_epoch;
+
+    for (struct epoch_record *r = records; r != NULL; r = r->next) {
+        if (r->in_use && r->active && r->epoch != e) {
+            return;
+        }
+    }
+
+    cas(&global_epoch, e, e + 1);
+}
+
+void epoch_enter(void)
+{
+    struct epoch_record *r = get_record();
+
+    if (r->active++ > 0) {
+        return;
+    }
+
+    // the active flag must be visible before we read the epoch or any node
+    __sync_synchronize();
+    uintptr_t e = global_epoch;
+    r->epoch = e;
+    __sync_synchronize();
+
+    collect(r, e);
+}
+
+void epoch_exit(void)
+{
+    struct epoch_record *r = my_record;
+    assert(r != NULL && r->active > 0);
+
+    __atomic_store_n(&r->active, r->active - 1, __ATOMIC_RELEASE);
+}
+
+void epoch_retire(void *ptr, void (*free_fn)(void *))
+{
+    struct epoch_record *r = my_record;
+    assert(r != NULL && r->active > 0);
+
+    // ptr is unlinked, so only threads that observed e or earlier can see it
+    uintptr_t e = global_epoch;
+    int gen = e % EPOCH_GENERATIONS;
+
+    if (r->limbo_epoch[gen] != e) {
+        // a list is reused three epochs later and is free to go by now
+        collect(r, e);
+        assert(r->limbo[gen] == NULL || r->limbo[gen]->count == 0);
+        r->limbo_epoch[gen] = e;
+    }
+
+    struct limbo_block *b = r->limbo[gen];
+    if (b == NULL || b->count == LIMBO_BLOCK_ENTRIES) {
+        struct limbo_block *nb = malloc(sizeof(struct limbo_block));
+        assert(nb != NULL);
+        nb->count = 0;
+        nb->next = b;
+        r->limbo[gen] = b = nb;
+    }
+    b->entries[b->count].ptr = ptr;
+    b->entries[b->count].free_fn = free_fn;
+    b->count++;
+    r->retired++;
+
+    if (++r->since_reclaim >= EPOCH_RECLAIM_THRESHOLD) {
+        r->since_reclaim = 0;
+        try_advance();
+        collect(r, global_epoch);
+    }
+}
+
+bool epoch_reclaim(void)
+{
+    struct epoch_record *r = my_record;
+    if (r == NULL) {
+        return true;
+    }
+
+    try_advance();
+    collect(r, global_epoch);
+    r->since_reclaim = 0;
+
+    return r->retired == 0;
+}
+
+void epoch_unregister(void)
+{
+    struct epoch_record *r = my_record;
+    if (r == NULL) {
+        return;
+    }
+    assert(r->active == 0);
+
+    while (!epoch_reclaim()) {
+        thread_yield();
+    }
+
+    for (int gen = 0; gen < EPOCH_GENERATIONS; gen++) {
+        free(r->limbo[gen]);
+        r->limbo[gen] = NULL;
+        r->limbo_epoch[gen] = 0;
+    }
+
+    my_record = NULL;
+    __atomic_store_n(&r->in_use, 0, __ATOMIC_RELEASE);
+}
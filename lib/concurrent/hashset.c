@@ -0,0 +1,334 @@
+/** \file
+ *  \brief A non-blocking hash set using split-ordered lists (Shalev and
+ *  Shavit).
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+/*
+ * The list is sorted by the bit-reversed hash of the keys. With 2^k buckets
+ * the elements of bucket b then form a contiguous run of the list, starting
+ * at the dummy node of bucket b whose split-order key is the reversed b.
+ * When the table doubles, bucket b + 2^k splits off the second half of the
+ * run of bucket b by inserting its dummy node in the middle.
+ *
+ * Element split-order keys have the lowest bit set and dummy keys have it
+ * clear, so a dummy sorts before all elements of its bucket. Elements whose
+ * split-order keys collide are ordered by their key.
+ *
+ * The list itself is Michael's variant of the Harris list, where the thread
+ * that unlinks a marked node retires it.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <concurrent/arch/cas.h>
+#include <concurrent/linked_list.h>
+#include <concurrent/epoch.h>
+#include <concurrent/hashset.h>
+
+#define NEXT(n)     ((volatile uintptr_t *) &(n)->next)
+
+static inline struct hs_node *unmarked(uintptr_t p)
+{
+    return (struct hs_node *) get_unmarked_reference(p);
+}
+
+static inline uint64_t reverse_bits(uint64_t x)
+{
+    x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+    x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+    x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    return __builtin_bswap64(x);
+}
+
+/// Finaliser of MurmurHash3, spreads pointer keys over the low bits
+static inline uint64_t hash_key(void* key)
+{
+    uint64_t h = (uintptr_t) key;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static inline uintptr_t regular_so_key(uint64_t hash)
+{
+    return reverse_bits(hash | (1ULL << 63));
+}
+
+static inline uintptr_t dummy_so_key(uintptr_t bucket)
+{
+    return reverse_bits(bucket);
+}
+
+/// Bucket b with its most significant set bit cleared
+static inline uintptr_t parent_bucket(uintptr_t b)
+{
+    assert(b > 0);
+    return b & ~(1UL << (63 - __builtin_clzl(b)));
+}
+
+static inline bool node_less(struct hs_node *n, uintptr_t so_key, void* key)
+{
+    return n->so_key < so_key || (n->so_key == so_key && n->key < key);
+}
+
+/*
+ * \brief find the first node not less than (so_key, key) after start,
+ *        unlinking and retiring marked nodes on the way.
+ * \return true if *ret_curr holds the key
+ */
+static bool list_search(struct hs_node *start, uintptr_t so_key, void* key,
+                        struct hs_node **ret_pred, struct hs_node **ret_curr)
+{
+    struct hs_node *pred, *curr;
+    uintptr_t succ;
+
+retry:
+    pred = start;
+    curr = unmarked(*NEXT(pred));
+    while (curr != NULL) {
+        succ = *NEXT(curr);
+        if (is_marked_reference(succ)) {
+            if (!cas(NEXT(pred), (uintptr_t) curr,
+                     get_unmarked_reference(succ))) {
+                goto retry;
+            }
+            epoch_retire(curr, free);
+            curr = unmarked(succ);
+            continue;
+        }
+        if (!node_less(curr, so_key, key)) {
+            break;
+        }
+        pred = curr;
+        curr = unmarked(succ);
+    }
+
+    *ret_pred = pred;
+    *ret_curr = curr;
+    return curr != NULL && curr->so_key == so_key && curr->key == key;
+}
+
+/*
+ * \brief find the node holding key after start without writing to the list.
+ */
+static struct hs_node *list_lookup(struct hs_node *start, uintptr_t so_key,
+                                   void* key)
+{
+    struct hs_node *curr = unmarked(*NEXT(start));
+    while (curr != NULL) {
+        uintptr_t succ = *NEXT(curr);
+        if (!is_marked_reference(succ) && !node_less(curr, so_key, key)) {
+            if (curr->so_key == so_key && curr->key == key) {
+                return curr;
+            }
+            return NULL;
+        }
+        curr = unmarked(succ);
+    }
+    return NULL;
+}
+
+static volatile uintptr_t *bucket_slot(struct hashset *hs, uintptr_t b)
+{
+    uintptr_t seg = b >> HS_SEGMENT_BITS;
+    assert(seg < HS_MAX_SEGMENTS);
+
+    if (hs->segments[seg] == NULL) {
+        struct hs_node **s = calloc(HS_SEGMENT_SIZE, sizeof(struct hs_node *));
+        assert(s != NULL);
+        if (!cas((volatile uintptr_t *) &hs->segments[seg], 0, (uintptr_t) s)) {
+            free(s);
+        }
+    }
+    return (volatile uintptr_t *) &hs->segments[seg][b & (HS_SEGMENT_SIZE - 1)];
+}
+
+static struct hs_node *get_bucket(struct hashset *hs, uintptr_t b);
+
+/// Insert the dummy node of bucket b, splitting its parent bucket
+static struct hs_node *init_bucket(struct hashset *hs, uintptr_t b)
+{
+    struct hs_node *parent = get_bucket(hs, parent_bucket(b));
+    struct hs_node *dummy = malloc(sizeof(struct hs_node));
+    assert(dummy != NULL);
+    dummy->so_key = dummy_so_key(b);
+    dummy->key = NULL;
+    dummy->data = NULL;
+
+    struct hs_node *pred, *curr;
+    while (1) {
+        if (list_search(parent, dummy->so_key, NULL, &pred, &curr)) {
+            // somebody else was faster
+            free(dummy);
+            dummy = curr;
+            break;
+        }
+        dummy->next = curr;
+        if (cas(NEXT(pred), (uintptr_t) curr, (uintptr_t) dummy)) {
+            break;
+        }
+    }
+
+    volatile uintptr_t *slot = bucket_slot(hs, b);
+    cas(slot, 0, (uintptr_t) dummy);
+    return (struct hs_node *) *slot;
+}
+
+static struct hs_node *get_bucket(struct hashset *hs, uintptr_t b)
+{
+    struct hs_node *dummy = (struct hs_node *) *bucket_slot(hs, b);
+    if (dummy == NULL) {
+        dummy = init_bucket(hs, b);
+    }
+    return dummy;
+}
+
+void hs_create(struct hashset **hs)
+{
+    (*hs) = calloc(1, sizeof(struct hashset));
+    assert(*hs != NULL);
+    (*hs)->size = 2;
+
+    struct hs_node *dummy = calloc(1, sizeof(struct hs_node));
+    assert(dummy != NULL);
+    dummy->so_key = dummy_so_key(0);
+    *bucket_slot(*hs, 0) = (uintptr_t) dummy;
+}
+
+void hs_destroy(struct hashset *hs)
+{
+    struct hs_node *n = (struct hs_node *) *bucket_slot(hs, 0);
+    while (n != NULL) {
+        struct hs_node *next = unmarked((uintptr_t) n->next);
+        free(n);
+        n = next;
+    }
+    for (int i = 0; i < HS_MAX_SEGMENTS; i++) {
+        free((void *) hs->segments[i]);
+    }
+    free(hs);
+}
+
+bool hs_insert(struct hashset *hs, void* key, void* data)
+{
+    assert(hs != NULL);
+    assert(key != NULL);
+
+    uint64_t hash = hash_key(key);
+    struct hs_node *node = malloc(sizeof(struct hs_node));
+    assert(node != NULL);
+    node->so_key = regular_so_key(hash);
+    node->key = key;
+    node->data = data;
+
+    epoch_enter();
+
+    uintptr_t size = hs->size;
+    struct hs_node *start = get_bucket(hs, hash & (size - 1));
+    struct hs_node *pred, *curr;
+    do {
+        if (list_search(start, node->so_key, key, &pred, &curr)) {
+            epoch_exit();
+            free(node);
+            return false;
+        }
+        node->next = curr;
+    } while (!cas(NEXT(pred), (uintptr_t) curr, (uintptr_t) node));
+
+    epoch_exit();
+
+    uintptr_t count = __sync_add_and_fetch(&hs->count, 1);
+    if (count > size * HS_LOAD_FACTOR && size < HS_MAX_BUCKETS) {
+        cas(&hs->size, size, size * 2);
+    }
+    return true;
+}
+
+bool hs_delete(struct hashset *hs, void* key)
+{
+    assert(hs != NULL);
+    assert(key != NULL);
+
+    uint64_t hash = hash_key(key);
+    uintptr_t so_key = regular_so_key(hash);
+
+    epoch_enter();
+
+    struct hs_node *start = get_bucket(hs, hash & (hs->size - 1));
+    struct hs_node *pred, *curr;
+    uintptr_t succ;
+    while (1) {
+        if (!list_search(start, so_key, key, &pred, &curr)) {
+            epoch_exit();
+            return false;
+        }
+        succ = *NEXT(curr);
+        if (!is_marked_reference(succ)
+            && cas(NEXT(curr), succ, get_marked_reference(succ))) {
+            break;
+        }
+    }
+
+    if (cas(NEXT(pred), (uintptr_t) curr, succ)) {
+        epoch_retire(curr, free);
+    } else {
+        list_search(start, so_key, key, &pred, &curr);
+    }
+
+    epoch_exit();
+
+    __sync_sub_and_fetch(&hs->count, 1);
+    return true;
+}
+
+bool hs_contains(struct hashset *hs, void* key)
+{
+    void *data;
+    return hs_get(hs, key, &data);
+}
+
+bool hs_get(struct hashset *hs, void* key, void** data)
+{
+    assert(hs != NULL);
+    assert(key != NULL);
+    assert(data != NULL);
+
+    uint64_t hash = hash_key(key);
+
+    epoch_enter();
+    struct hs_node *start = get_bucket(hs, hash & (hs->size - 1));
+    struct hs_node *n = list_lookup(start, regular_so_key(hash), key);
+    if (n != NULL) {
+        *data = n->data;
+    }
+    epoch_exit();
+    return n != NULL;
+}
+
+void hs_print(struct hashset *hs)
+{
+    printf("HASHSET %lu buckets {", hs->size);
+    epoch_enter();
+    struct hs_node *n = unmarked(*bucket_slot(hs, 0));
+    for (n = unmarked((uintptr_t) n->next); n != NULL;
+         n = unmarked((uintptr_t) n->next)) {
+        if ((n->so_key & 1) && !is_marked_reference((uintptr_t) n->next)) {
+            printf("key %lu,", (uintptr_t) n->key);
+        }
+    }
+    epoch_exit();
+    printf("}\n");
+}
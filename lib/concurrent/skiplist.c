@@ -0,0 +1,305 @@
+/** \file
+ *  \brief A non-blocking skiplist, after Keir Fraser's `Practical lock-freedom'.
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+/*
+ * Every level is a Harris list: a node is deleted by marking its next
+ * pointers, from the top level down to level 0, and unlinked by the next
+ * search that passes it. Marking level 0 is the linearisation point of a
+ * delete, linking level 0 that of an insert.
+ *
+ * An insert links the upper levels after level 0 and may race with a delete
+ * of the same node, so the node is only unlinked everywhere once both are
+ * done. Whichever of the two finishes last retires it, decided by the state
+ * word of the node.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <concurrent/arch/cas.h>
+#include <concurrent/linked_list.h>
+#include <concurrent/epoch.h>
+#include <concurrent/skiplist.h>
+
+#define SL_INSERTING    0
+#define SL_INSERTED     1
+#define SL_DELETED      2
+
+#define NEXT(n, l)      ((volatile uintptr_t *) &(n)->next[l])
+
+static __thread uint32_t level_seed;
+
+static inline struct sl_node *unmarked(uintptr_t p)
+{
+    return (struct sl_node *) get_unmarked_reference(p);
+}
+
+/// Level count with a geometric distribution, p = 1/2
+static int random_level(void)
+{
+    if (level_seed == 0) {
+        level_seed = (uint32_t) (uintptr_t) &level_seed | 1;
+    }
+    // xorshift32
+    level_seed ^= level_seed << 13;
+    level_seed ^= level_seed >> 17;
+    level_seed ^= level_seed << 5;
+
+    int level = 1;
+    uint32_t r = level_seed;
+    while ((r & 1) && level < SL_MAX_LEVEL) {
+        level++;
+        r >>= 1;
+    }
+    return level;
+}
+
+static struct sl_node *node_alloc(void* key, void* data, int top_level)
+{
+    struct sl_node *n = malloc(sizeof(struct sl_node)
+                               + top_level * sizeof(struct sl_node *));
+    assert(n != NULL);
+    n->key = key;
+    n->data = data;
+    n->state = SL_INSERTING;
+    n->top_level = top_level;
+    return n;
+}
+
+/*
+ * \brief find the predecessors and successors of key on every level,
+ *        unlinking marked nodes on the way.
+ * \return true if succs[0] holds key
+ */
+static bool search(struct skiplist *sl, void* key, struct sl_node **preds,
+                   struct sl_node **succs)
+{
+    struct sl_node *pred, *curr;
+    uintptr_t succ;
+
+retry:
+    pred = sl->head;
+    for (int l = SL_MAX_LEVEL - 1; l >= 0; l--) {
+        curr = unmarked(*NEXT(pred, l));
+        while (curr != sl->tail) {
+            succ = *NEXT(curr, l);
+            if (is_marked_reference(succ)) {
+                // curr is being deleted, help unlinking it
+                if (!cas(NEXT(pred, l), (uintptr_t) curr,
+                         get_unmarked_reference(succ))) {
+                    goto retry;
+                }
+                curr = unmarked(succ);
+                continue;
+            }
+            if (curr->key >= key) {
+                break;
+            }
+            pred = curr;
+            curr = unmarked(succ);
+        }
+        preds[l] = pred;
+        succs[l] = curr;
+    }
+
+    return succs[0] != sl->tail && succs[0]->key == key;
+}
+
+/*
+ * \brief find the node holding key without writing to the list.
+ */
+static struct sl_node *lookup(struct skiplist *sl, void* key)
+{
+    struct sl_node *pred = sl->head, *curr = NULL;
+    uintptr_t succ;
+
+    for (int l = SL_MAX_LEVEL - 1; l >= 0; l--) {
+        curr = unmarked(*NEXT(pred, l));
+        while (curr != sl->tail) {
+            succ = *NEXT(curr, l);
+            if (!is_marked_reference(succ)) {
+                if (curr->key >= key) {
+                    break;
+                }
+                pred = curr;
+            }
+            curr = unmarked(succ);
+        }
+    }
+
+    return (curr != sl->tail && curr->key == key) ? curr : NULL;
+}
+
+void sl_create(struct skiplist **sl)
+{
+    (*sl) = malloc(sizeof(struct skiplist));
+    assert(*sl != NULL);
+    (*sl)->head = node_alloc(NULL, NULL, SL_MAX_LEVEL);
+    (*sl)->tail = node_alloc(NULL, NULL, SL_MAX_LEVEL);
+    for (int l = 0; l < SL_MAX_LEVEL; l++) {
+        (*sl)->head->next[l] = (*sl)->tail;
+        (*sl)->tail->next[l] = NULL;
+    }
+}
+
+void sl_destroy(struct skiplist *sl)
+{
+    struct sl_node *n = sl->head;
+    while (n != sl->tail) {
+        struct sl_node *next = unmarked((uintptr_t) n->next[0]);
+        free(n);
+        n = next;
+    }
+    free(sl->tail);
+    free(sl);
+}
+
+bool sl_insert(struct skiplist *sl, void* key, void* data)
+{
+    assert(sl != NULL);
+    assert(key != NULL);
+
+    struct sl_node *preds[SL_MAX_LEVEL], *succs[SL_MAX_LEVEL];
+    struct sl_node *node = node_alloc(key, data, random_level());
+
+    epoch_enter();
+
+    do {
+        if (search(sl, key, preds, succs)) {
+            epoch_exit();
+            free(node);
+            return false;
+        }
+        for (int l = 0; l < node->top_level; l++) {
+            node->next[l] = succs[l];
+        }
+    } while (!cas(NEXT(preds[0], 0), (uintptr_t) succs[0], (uintptr_t) node));
+
+    // link the upper levels, unless somebody started deleting the node
+    for (int l = 1; l < node->top_level; l++) {
+        while (1) {
+            uintptr_t old = *NEXT(node, l);
+            if (is_marked_reference(old)) {
+                goto done;
+            }
+            if (old != (uintptr_t) succs[l]
+                && !cas(NEXT(node, l), old, (uintptr_t) succs[l])) {
+                goto done;
+            }
+            if (cas(NEXT(preds[l], l), (uintptr_t) succs[l],
+                    (uintptr_t) node)) {
+                break;
+            }
+            search(sl, key, preds, succs);
+            if (succs[0] != node) {
+                goto done;
+            }
+        }
+    }
+
+done:
+    if (!cas(&node->state, SL_INSERTING, SL_INSERTED)) {
+        // deleted while we were linking it, unlink what we linked
+        search(sl, key, preds, succs);
+        epoch_retire(node, free);
+    }
+    epoch_exit();
+    return true;
+}
+
+bool sl_delete(struct skiplist *sl, void* key)
+{
+    assert(sl != NULL);
+    assert(key != NULL);
+
+    struct sl_node *preds[SL_MAX_LEVEL], *succs[SL_MAX_LEVEL];
+
+    epoch_enter();
+
+    if (!search(sl, key, preds, succs)) {
+        epoch_exit();
+        return false;
+    }
+    struct sl_node *node = succs[0];
+
+    for (int l = node->top_level - 1; l >= 1; l--) {
+        uintptr_t succ = *NEXT(node, l);
+        while (!is_marked_reference(succ)) {
+            cas(NEXT(node, l), succ, get_marked_reference(succ));
+            succ = *NEXT(node, l);
+        }
+    }
+
+    uintptr_t succ = *NEXT(node, 0);
+    while (1) {
+        if (is_marked_reference(succ)) {
+            // somebody else deleted it first
+            epoch_exit();
+            return false;
+        }
+        if (cas(NEXT(node, 0), succ, get_marked_reference(succ))) {
+            break;
+        }
+        succ = *NEXT(node, 0);
+    }
+
+    // if the insert is still linking the node, it retires it when done
+    bool inserted = !cas(&node->state, SL_INSERTING, SL_DELETED);
+    search(sl, key, preds, succs);
+    if (inserted) {
+        epoch_retire(node, free);
+    }
+
+    epoch_exit();
+    return true;
+}
+
+bool sl_contains(struct skiplist *sl, void* key)
+{
+    assert(sl != NULL);
+    assert(key != NULL);
+
+    epoch_enter();
+    bool found = lookup(sl, key) != NULL;
+    epoch_exit();
+    return found;
+}
+
+bool sl_get(struct skiplist *sl, void* key, void** data)
+{
+    assert(sl != NULL);
+    assert(key != NULL);
+    assert(data != NULL);
+
+    epoch_enter();
+    struct sl_node *n = lookup(sl, key);
+    if (n != NULL) {
+        *data = n->data;
+    }
+    epoch_exit();
+    return n != NULL;
+}
+
+void sl_print(struct skiplist *sl)
+{
+    printf("SKIPLIST {");
+    epoch_enter();
+    for (struct sl_node *n = unmarked((uintptr_t) sl->head->next[0]);
+         n != sl->tail; n = unmarked((uintptr_t) n->next[0])) {
+        if (!is_marked_reference((uintptr_t) n->next[0])) {
+            printf("key %lu (%d),", (uintptr_t) n->key, n->top_level);
+        }
+    }
+    epoch_exit();
+    printf("}\n");
+}
@@ -0,0 +1,442 @@
+/**
+ * \file rh_hashtable.c
+ * \brief Open-addressing hashtable with robin hood probing
+ *
+ * All entries live in a single array of slots. An entry is stored at the
+ * first free slot at or after its home slot (hash & mask). On insert, an
+ * entry that is further from its home slot than the resident one takes the
+ * slot, and the resident moves on ("robin hood"). This bounds the variance
+ * of probe lengths and lets a lookup stop as soon as it meets an entry that
+ * is closer to its home than the key being looked for would be. Removal
+ * shifts the following entries back, so no tombstones are needed.
+ *
+ * Growing is incremental: the full table becomes the old table, a new table
+ * of twice the size is allocated, and every operation moves a few entries
+ * from the old table to the new one. Lookups check both tables until the
+ * old one is empty.
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+#include <stdint.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include <hashtable/rh_hashtable.h>
+
+/// Number of old table slots visited per operation while growing
+#define RH_MIGRATE_SLOTS        16
+
+/// Smallest table we allocate
+#define RH_MIN_SLOTS            8
+
+#define RH_DEFAULT_CAPACITY     16
+#define RH_DEFAULT_LOAD_FACTOR  85
+
+static inline uint64_t fmix64(uint64_t k)
+{
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+/**
+ * \brief get a hash value for a binary key
+ *
+ * Consumes the key eight bytes at a time and mixes every word with the
+ * MurmurHash3 finalizer, so all key bits influence the low bits we use to
+ * index the table.
+ */
+uint32_t rh_hash(const void *key, size_t key_len)
+{
+    const uint8_t *p = key;
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ key_len;
+    uint64_t k;
+
+    while (key_len >= sizeof(k)) {
+        memcpy(&k, p, sizeof(k));
+        h = (h ^ fmix64(k)) * 0x9e3779b97f4a7c15ULL;
+        p += sizeof(k);
+        key_len -= sizeof(k);
+    }
+
+    if (key_len > 0) {
+        k = 0;
+        memcpy(&k, p, key_len);
+        h = (h ^ fmix64(k)) * 0x9e3779b97f4a7c15ULL;
+    }
+
+    h = fmix64(h);
+    return (uint32_t)(h ^ (h >> 32));
+}
+
+#define equals(_k1, _k2, len) (!memcmp((_k1), (_k2), (len)))
+
+/// distance of the entry in slot idx from its home slot
+static inline size_t probe_dist(struct _rh_table *t, size_t idx,
+                                uint32_t hash_value)
+{
+    return (idx - (hash_value & t->mask)) & t->mask;
+}
+
+static int table_alloc(struct _rh_table *t, size_t nslots)
+{
+    assert((nslots & (nslots - 1)) == 0);
+
+    t->slots = calloc(nslots, sizeof(struct _rh_entry));
+    if (t->slots == NULL) {
+        return 1;
+    }
+    t->mask = nslots - 1;
+    t->count = 0;
+    return 0;
+}
+
+static void table_free(struct _rh_table *t)
+{
+    free(t->slots);
+    t->slots = NULL;
+    t->mask = 0;
+    t->count = 0;
+}
+
+/**
+ * \brief find a key in one table
+ * \return the slot index, or -1 if the key is not in the table
+ */
+static ssize_t table_find(struct _rh_table *t, const void *key, size_t key_len,
+                          uint32_t hash_value)
+{
+    if (t->slots == NULL) {
+        return -1;
+    }
+
+    size_t idx = hash_value & t->mask;
+    for (size_t dist = 0; ; dist++, idx = (idx + 1) & t->mask) {
+        struct _rh_entry *e = &t->slots[idx];
+        if (e->type == 0 || probe_dist(t, idx, e->hash_value) < dist) {
+            // we would have displaced this entry, so our key isn't here
+            return -1;
+        }
+        if (e->hash_value == hash_value && e->key_len == key_len
+            && equals(key, e->key, key_len)) {
+            return idx;
+        }
+    }
+}
+
+/// insert an entry whose key is not yet in the table; there must be room
+static void table_insert(struct _rh_table *t, struct _rh_entry entry)
+{
+    assert(t->count <= t->mask);
+
+    size_t idx = entry.hash_value & t->mask;
+    for (size_t dist = 0; ; dist++, idx = (idx + 1) & t->mask) {
+        struct _rh_entry *e = &t->slots[idx];
+        if (e->type == 0) {
+            *e = entry;
+            t->count++;
+            return;
+        }
+
+        size_t edist = probe_dist(t, idx, e->hash_value);
+        if (edist < dist) {
+            // resident is better off than us: take its slot
+            struct _rh_entry tmp = *e;
+            *e = entry;
+            entry = tmp;
+            dist = edist;
+        }
+    }
+}
+
+/// remove the entry in slot idx, shifting back the rest of its cluster
+static void table_delete(struct _rh_table *t, size_t idx)
+{
+    for (;;) {
+        size_t next = (idx + 1) & t->mask;
+        struct _rh_entry *n = &t->slots[next];
+        if (n->type == 0 || probe_dist(t, next, n->hash_value) == 0) {
+            break;
+        }
+        t->slots[idx] = *n;
+        idx = next;
+    }
+    memset(&t->slots[idx], 0, sizeof(struct _rh_entry));
+    t->count--;
+}
+
+/**
+ * \brief move up to nslots slots worth of entries from the old to the
+ *  current table, freeing the old table once it is empty
+ */
+static void migrate(struct rh_hashtable *ht, size_t nslots)
+{
+    struct _rh_table *old = &ht->old;
+
+    if (old->slots == NULL) {
+        return;
+    }
+
+    while (nslots-- > 0 && old->count > 0) {
+        assert(ht->migrate_pos <= old->mask);
+        struct _rh_entry *e = &old->slots[ht->migrate_pos];
+        if (e->type == 0) {
+            ht->migrate_pos++;
+            continue;
+        }
+        // deleting shifts the next entry of the cluster into this slot, so
+        // we stay here until the slot is empty
+        struct _rh_entry entry = *e;
+        table_delete(old, ht->migrate_pos);
+        table_insert(&ht->cur, entry);
+    }
+
+    if (old->count == 0) {
+        table_free(old);
+    }
+}
+
+static size_t threshold_for(size_t nslots, int load_factor)
+{
+    size_t t = (nslots * load_factor) / 100;
+    // always leave one slot free, so probing terminates
+    return t < nslots ? t : nslots - 1;
+}
+
+/// start migrating to a table of twice the size
+static int grow(struct rh_hashtable *ht)
+{
+    // finish a migration that is still running
+    migrate(ht, SIZE_MAX);
+    assert(ht->old.slots == NULL);
+
+    struct _rh_table bigger;
+    if (table_alloc(&bigger, (ht->cur.mask + 1) * 2) != 0) {
+        return 1;
+    }
+
+    ht->old = ht->cur;
+    ht->cur = bigger;
+    ht->migrate_pos = 0;
+    ht->threshold = threshold_for(ht->cur.mask + 1, ht->load_factor);
+    return 0;
+}
+
+/**
+ * \brief find a key in either table
+ * \return the entry, or NULL if the key is not in the hashtable
+ */
+static struct _rh_entry *rh_find(struct rh_hashtable *ht, const void *key,
+                                 size_t key_len, uint32_t hash_value)
+{
+    ssize_t idx = table_find(&ht->cur, key, key_len, hash_value);
+    if (idx >= 0) {
+        return &ht->cur.slots[idx];
+    }
+    idx = table_find(&ht->old, key, key_len, hash_value);
+    if (idx >= 0) {
+        return &ht->old.slots[idx];
+    }
+    return NULL;
+}
+
+static int rh_size(struct dictionary *dict)
+{
+    assert(dict != NULL);
+    struct rh_hashtable *ht = (struct rh_hashtable*) dict;
+
+    return ht->cur.count + ht->old.count;
+}
+
+/**
+ * \brief put a key/value pair into the hashtable, replacing the value of
+ *  an existing entry with the same key
+ * \return 0 if the operation succeeded, otherwise an error code.
+ */
+static int rh_put(struct rh_hashtable *ht, struct _rh_entry entry)
+{
+    migrate(ht, RH_MIGRATE_SLOTS);
+
+    entry.hash_value = rh_hash(entry.key, entry.key_len);
+
+    ssize_t idx = table_find(&ht->cur, entry.key, entry.key_len,
+                             entry.hash_value);
+    if (idx >= 0) {
+        ht->cur.slots[idx] = entry;
+        return 0;
+    }
+    idx = table_find(&ht->old, entry.key, entry.key_len, entry.hash_value);
+    if (idx >= 0) {
+        table_delete(&ht->old, idx);
+    }
+
+    if (ht->cur.count + ht->old.count + 1 > ht->threshold) {
+        if (grow(ht) != 0) {
+            return 1;
+        }
+    }
+
+    table_insert(&ht->cur, entry);
+    return 0;
+}
+
+static int rh_put_word(struct dictionary *dict, const char *key,
+                       size_t key_len, uintptr_t value)
+{
+    assert(dict != NULL);
+    struct _rh_entry e = {
+        .key = key,
+        .key_len = key_len,
+        .v.value = (void*) value,
+        .type = TYPE_WORD,
+    };
+
+    return rh_put((struct rh_hashtable*) dict, e);
+}
+
+static int rh_put_capability(struct dictionary *dict, char *key,
+                             struct capref cap)
+{
+    assert(dict != NULL);
+    struct _rh_entry e = {
+        .key = key,
+        .key_len = strlen(key),
+        .v.capvalue = cap,
+        .type = TYPE_CAPABILITY,
+    };
+
+    return rh_put((struct rh_hashtable*) dict, e);
+}
+
+static ENTRY_TYPE rh_get(struct dictionary *dict, const char *key,
+                         size_t key_len, void **value)
+{
+    assert(dict != NULL);
+    assert(key != NULL);
+    assert(value != NULL);
+
+    struct rh_hashtable *ht = (struct rh_hashtable*) dict;
+    migrate(ht, RH_MIGRATE_SLOTS);
+
+    struct _rh_entry *e = rh_find(ht, key, key_len, rh_hash(key, key_len));
+    if (e == NULL) {
+        *value = NULL;
+        return 0;
+    }
+
+    assert(e->type != TYPE_CAPABILITY);
+    *value = e->v.value;
+    return e->type;
+}
+
+static ENTRY_TYPE rh_get_capability(struct dictionary *dict, char *key,
+                                    struct capref *value)
+{
+    assert(dict != NULL);
+    assert(key != NULL);
+    assert(value != NULL);
+
+    struct rh_hashtable *ht = (struct rh_hashtable*) dict;
+    migrate(ht, RH_MIGRATE_SLOTS);
+
+    size_t key_len = strlen(key);
+    struct _rh_entry *e = rh_find(ht, key, key_len, rh_hash(key, key_len));
+    if (e == NULL) {
+        *value = NULL_CAP;
+        return 0;
+    }
+
+    assert(e->type == TYPE_CAPABILITY);
+    *value = e->v.capvalue;
+    return e->type;
+}
+
+static int rh_remove(struct dictionary *dict, const char *key, size_t key_len)
+{
+    assert(dict != NULL);
+    struct rh_hashtable *ht = (struct rh_hashtable*) dict;
+    migrate(ht, RH_MIGRATE_SLOTS);
+
+    uint32_t hash_value = rh_hash(key, key_len);
+
+    ssize_t idx = table_find(&ht->cur, key, key_len, hash_value);
+    if (idx >= 0) {
+        table_delete(&ht->cur, idx);
+        return 0;
+    }
+    idx = table_find(&ht->old, key, key_len, hash_value);
+    if (idx >= 0) {
+        table_delete(&ht->old, idx);
+        return 0;
+    }
+    return 1;
+}
+
+struct rh_hashtable* create_rh_hashtable2(int capacity, int load_factor)
+{
+    assert(capacity >= 0);
+    assert(load_factor > 0 && load_factor <= 100);
+
+    struct rh_hashtable *ht = malloc(sizeof(struct rh_hashtable));
+    if (ht == NULL) {
+        return NULL;
+    }
+    memset(ht, 0, sizeof(struct rh_hashtable));
+
+    size_t nslots = RH_MIN_SLOTS;
+    while (threshold_for(nslots, load_factor) < (size_t)capacity) {
+        nslots *= 2;
+    }
+    if (table_alloc(&ht->cur, nslots) != 0) {
+        free(ht);
+        return NULL;
+    }
+
+    ht->load_factor = load_factor;
+    ht->threshold = threshold_for(nslots, load_factor);
+
+    ht->d.size = rh_size;
+    ht->d.put_word = rh_put_word;
+    ht->d.put_capability = rh_put_capability;
+    ht->d.get = rh_get;
+    ht->d.get_capability = rh_get_capability;
+    ht->d.remove = rh_remove;
+
+    return ht;
+}
+
+struct rh_hashtable* create_rh_hashtable(void)
+{
+    return create_rh_hashtable2(RH_DEFAULT_CAPACITY, RH_DEFAULT_LOAD_FACTOR);
+}
+
+void rh_hashtable_destroy(struct rh_hashtable *ht)
+{
+    assert(ht != NULL);
+    table_free(&ht->cur);
+    table_free(&ht->old);
+    free(ht);
+}
+
+size_t rh_hashtable_footprint(struct rh_hashtable *ht)
+{
+    assert(ht != NULL);
+    size_t slots = ht->cur.mask + 1;
+    if (ht->old.slots != NULL) {
+        slots += ht->old.mask + 1;
+    }
+    return sizeof(struct rh_hashtable) + slots * sizeof(struct _rh_entry);
+}
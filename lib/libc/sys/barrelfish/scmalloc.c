@@ -0,0 +1,214 @@
+/**
+ * \file
+ * \brief malloc() and friends on top of the size-class heap
+ *
+ * This is used instead of the K&R malloc (oldmalloc.c) when Barrelfish is
+ * configured with malloc_sizeclass. Small objects are additionally cached
+ * per thread, so that the common malloc/free pairs do not take the heap lock.
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <barrelfish/barrelfish.h>
+#include <barrelfish/core_state.h>
+#include <barrelfish/heap.h>
+
+typedef void *(*morecore_alloc_func_t)(size_t bytes, size_t *retbytes);
+typedef void (*morecore_free_func_t)(void *base, size_t bytes);
+
+morecore_alloc_func_t sys_morecore_alloc;
+morecore_free_func_t sys_morecore_free;
+
+typedef void *(*alt_malloc_t)(size_t bytes);
+alt_malloc_t alt_malloc = NULL;
+
+typedef void (*alt_free_t)(void *p);
+alt_free_t alt_free = NULL;
+
+typedef void *(*alt_realloc_t)(void *p, size_t bytes);
+alt_realloc_t alt_realloc = NULL;
+
+/// Number of objects moved between thread cache and heap at once
+#define TCACHE_BATCH    (HEAP_SC_TCACHE_MAX / 2)
+
+#define MALLOC_LOCK thread_mutex_lock(&state->mutex)
+#define MALLOC_UNLOCK thread_mutex_unlock(&state->mutex)
+
+static void *sc_morecore(size_t bytes, size_t *retbytes)
+{
+    assert(sys_morecore_alloc);
+    return sys_morecore_alloc(bytes, retbytes);
+}
+
+/// Returns the heap of this dispatcher. Must be called with the lock held.
+static struct heap_sc *get_heap(struct morecore_state *state)
+{
+    if (!state->sc_heap_ready) {
+        heap_sc_init(&state->sc_heap, sc_morecore);
+        state->sc_heap_ready = true;
+    }
+    return &state->sc_heap;
+}
+
+/// Thread exit hook: give cached objects back to the heap
+static void tcache_release(void);
+static struct thread_exit_hook tcache_exit_hook = { .func = tcache_release };
+
+static void tcache_release(void)
+{
+    struct heap_sc_tcache *tc = thread_get_tls_key(THREAD_TLS_KEY_MALLOC);
+    if (tc == NULL) {
+        return;
+    }
+    thread_set_tls_key(THREAD_TLS_KEY_MALLOC, NULL);
+
+    struct morecore_state *state = get_morecore_state();
+    MALLOC_LOCK;
+    struct heap_sc *heap = get_heap(state);
+    heap_sc_tcache_flush(heap, tc);
+    heap_sc_free(heap, tc);
+    MALLOC_UNLOCK;
+}
+
+/// Returns the calling thread's cache, creating it if necessary (or NULL)
+static struct heap_sc_tcache *get_tcache(struct morecore_state *state)
+{
+    struct heap_sc_tcache *tc = thread_get_tls_key(THREAD_TLS_KEY_MALLOC);
+    if (tc != NULL) {
+        return tc;
+    }
+
+    // the first thread of any dispatcher to get here registers the hook
+    static bool hook_set;
+    if (!hook_set && __sync_bool_compare_and_swap(&hook_set, false, true)) {
+        thread_add_exit_hook(&tcache_exit_hook);
+    }
+
+    MALLOC_LOCK;
+    tc = heap_sc_alloc(get_heap(state), sizeof(struct heap_sc_tcache));
+    MALLOC_UNLOCK;
+
+    if (tc != NULL) {
+        memset(tc, 0, sizeof(struct heap_sc_tcache));
+        thread_set_tls_key(THREAD_TLS_KEY_MALLOC, tc);
+    }
+    return tc;
+}
+
+/*
+ * malloc: general-purpose storage allocator
+ */
+void *malloc(size_t nbytes)
+{
+    if (alt_malloc != NULL) {
+        return alt_malloc(nbytes);
+    }
+
+    struct morecore_state *state = get_morecore_state();
+    void *p;
+
+    int sc = heap_sc_size_class(nbytes);
+    struct heap_sc_tcache *tc = sc >= 0 ? get_tcache(state) : NULL;
+    if (tc != NULL) {
+        p = heap_sc_tcache_pop(tc, sc);
+        if (p != NULL) {
+            return p;
+        }
+    }
+
+    MALLOC_LOCK;
+    struct heap_sc *heap = get_heap(state);
+    p = heap_sc_alloc(heap, nbytes);
+    if (p != NULL && tc != NULL) {
+        heap_sc_tcache_fill(heap, tc, sc, TCACHE_BATCH);
+    }
+    MALLOC_UNLOCK;
+
+    return p;
+}
+
+void free(void *ap)
+{
+    if (ap == NULL) {
+        return;
+    }
+
+    if (alt_free != NULL) {
+        return alt_free(ap);
+    }
+
+    /* Dispatchers on different cores maintain different heaps. Memory
+     * allocated by another dispatcher (e.g. before the thread migrated here)
+     * is handed back to its heap by heap_sc_free().
+     */
+    struct morecore_state *state = get_morecore_state();
+
+    int sc = heap_sc_ptr_class(ap);
+    struct heap_sc_tcache *tc = sc >= 0 ? get_tcache(state) : NULL;
+    if (tc != NULL && heap_sc_tcache_push(tc, sc, ap)) {
+        return;
+    }
+
+    MALLOC_LOCK;
+    struct heap_sc *heap = get_heap(state);
+    if (tc != NULL) {
+        heap_sc_tcache_drain(heap, tc, sc, TCACHE_BATCH);
+    }
+    heap_sc_free(heap, ap);
+    MALLOC_UNLOCK;
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    if (alt_realloc != NULL) {
+        return alt_realloc(ptr, size);
+    }
+
+    if (ptr == NULL) {
+        return malloc(size);
+    }
+
+    size_t old_size = heap_sc_usable_size(ptr);
+    if (size <= old_size && heap_sc_size_class(size) == heap_sc_ptr_class(ptr)) {
+        return ptr;
+    }
+
+    void *new_ptr = malloc(size);
+    if (new_ptr == NULL) {
+        return NULL;
+    }
+    memcpy(new_ptr, ptr, old_size < size ? old_size : size);
+    free(ptr);
+    return new_ptr;
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+    void *ptr;
+    if (size != 0 && nmemb > SIZE_MAX / size) {
+        return NULL;
+    }
+    ptr = malloc(nmemb * size);
+    if (ptr) {
+        memset(ptr, '\0', nmemb * size);
+    }
+    return ptr;
+}
+
+/// Read the size-class heap counters of this dispatcher
+void __malloc_get_stats(struct heap_sc_stats *stats)
+{
+    struct morecore_state *state = get_morecore_state();
+    MALLOC_LOCK;
+    *stats = get_heap(state)->stats;
+    MALLOC_UNLOCK;
+}
@@ -1126,6 +1126,68 @@ mdb_choose_partial(genpaddr_t address, size_t size, struct cte *first,
     }
 }
 
+/**
+ * \brief Check whether a subtree cannot overlap a range of the given root.
+ *
+ * True if the subtree is empty, holds only caps of lower roots, or all its
+ * caps of the given root end at or before \a address. The end and end_root
+ * cached in every node make this a constant-time test.
+ */
+static inline bool
+mdb_subtree_ends_before(mdb_root_t root, genpaddr_t address, struct cte *cte)
+{
+    return !cte || N(cte)->end_root < root ||
+        (N(cte)->end_root == root && N(cte)->end <= address);
+}
+
+/**
+ * \brief Find the subtree that holds all caps possibly matching a range.
+ *
+ * Walks down from \a current as long as the node and one of its subtrees
+ * can be ruled out, i.e. to the topmost node of the root's caps that
+ * overlaps the range or splits it between its subtrees. This skips the
+ * caps of other roots and the search path above the range without
+ * recursing or merging results. Returns NULL if no cap can match.
+ */
+static struct cte*
+mdb_find_range_split(mdb_root_t root, genpaddr_t address, size_t size,
+                     struct cte *current)
+{
+    genpaddr_t search_end = address + size;
+
+    while (!mdb_subtree_ends_before(root, address, current)) {
+        mdb_root_t current_root = get_type_root(C(current)->type);
+        if (current_root < root) {
+            // current and its left subtree sort before the root's caps
+            current = N(current)->right;
+            continue;
+        }
+        if (current_root > root) {
+            // current and its right subtree sort after the root's caps
+            current = N(current)->left;
+            continue;
+        }
+
+        genpaddr_t current_address = get_address(C(current));
+        genpaddr_t current_end = current_address + get_size(C(current));
+        if (current_address > search_end) {
+            // current and its right subtree begin after the range
+            current = N(current)->left;
+            continue;
+        }
+        if (current_end < address &&
+            mdb_subtree_ends_before(root, address, N(current)->left))
+        {
+            // current and its left subtree end before the range
+            current = N(current)->right;
+            continue;
+        }
+        return current;
+    }
+
+    return NULL;
+}
+
 static int
 mdb_sub_find_range(mdb_root_t root, genpaddr_t address, size_t size,
                    int max_precision, struct cte *current,
@@ -1187,11 +1249,7 @@ mdb_sub_find_range(mdb_root_t root, genpaddr_t address, size_t size,
         return MDB_RANGE_NOT_FOUND;
     }
 
-    if (N(current)->end_root < root) {
-        *ret_node = NULL;
-        return MDB_RANGE_NOT_FOUND;
-    }
-    if (N(current)->end_root == root && N(current)->end <= address) {
+    if (mdb_subtree_ends_before(root, address, current)) {
         *ret_node = NULL;
         return MDB_RANGE_NOT_FOUND;
     }
@@ -1246,7 +1304,11 @@ mdb_sub_find_range(mdb_root_t root, genpaddr_t address, size_t size,
         }
     }
 
-    if (N(current)->left) {
+    // the left subtree only holds caps of lower roots if current's root is
+    // lower than the one searched
+    if (current_root >= root &&
+        !mdb_subtree_ends_before(root, address, N(current)->left))
+    {
         mdb_sub_find_range_merge(root, address, size, max_precision,
                                  N(current)->left, /*inout*/&ret,
                                  /*inout*/&result);
@@ -1256,8 +1318,14 @@ mdb_sub_find_range(mdb_root_t root, genpaddr_t address, size_t size,
         }
     }
 
-    if (N(current)->right && root >= current_root &&
-        (search_end > current_address || (search_end == current_address && size == 0))) {
+    // addresses are only comparable within a root, if current's root is
+    // lower the right subtree may hold caps of the searched root at any address
+    if ((root > current_root ||
+         (root == current_root &&
+          (search_end > current_address ||
+           (search_end == current_address && size == 0)))) &&
+        !mdb_subtree_ends_before(root, address, N(current)->right))
+    {
         mdb_sub_find_range_merge(root, address, size, max_precision,
                                  N(current)->right, /*inout*/&ret,
                                  /*inout*/&result);
@@ -1296,7 +1364,8 @@ mdb_find_range(mdb_root_t root, genpaddr_t address, gensize_t size,
         ret_node = &alt_ret_node;
     }
 
-    *result = mdb_sub_find_range(root, address, size, max_result, mdb_root, ret_node);
+    struct cte *split = mdb_find_range_split(root, address, size, mdb_root);
+    *result = mdb_sub_find_range(root, address, size, max_result, split, ret_node);
     return SYS_ERR_OK;
 }
 
@@ -21,6 +21,12 @@
  *      split up into child nodes for smaller allocations.
  *   2. A free node, which is a regular free child node in the tree.
  *   3. An allocated node.
+ *
+ * In addition to the tree, every free leaf node is kept on a per-size free
+ * list (see #mm.freelist) with a bitmap of the non-empty lists, so that
+ * unconstrained allocations find the smallest suitable free region in
+ * constant time instead of walking the tree. Constrained allocations (with
+ * a base/limit range) and frees still use the tree, which is O(depth).
  */
 
 /*
@@ -35,6 +41,7 @@
 #include <barrelfish/barrelfish.h>
 #include <mm/mm.h>
 #include <stdio.h>
+#include <string.h>
 #include <inttypes.h>
 
 #if 1
@@ -65,6 +72,71 @@ static inline int bitaddralign(size_t n, lpaddr_t base_addr)
     return((1UL << exponent) > n ? log2floor(n) : exponent);
 }
 
+/// Add a free leaf node to the free index
+static void freelist_insert(struct mm *mm, struct mmnode *node,
+                            genpaddr_t base, uint8_t sizebits)
+{
+    assert(node->type == NodeType_Free);
+    assert(sizebits < MM_FREELISTS);
+
+    node->base = base;
+    node->sizebits = sizebits;
+    node->freeprev = NULL;
+    node->freenext = mm->freelist[sizebits];
+    if (node->freenext != NULL) {
+        node->freenext->freeprev = node;
+    }
+    mm->freelist[sizebits] = node;
+    mm->freemap |= (uint64_t)1 << sizebits;
+}
+
+/// Remove a free leaf node from the free index
+static void freelist_remove(struct mm *mm, struct mmnode *node)
+{
+    assert(node->type == NodeType_Free);
+
+    if (node->freeprev != NULL) {
+        node->freeprev->freenext = node->freenext;
+    } else {
+        assert(mm->freelist[node->sizebits] == node);
+        mm->freelist[node->sizebits] = node->freenext;
+        if (node->freenext == NULL) {
+            mm->freemap &= ~((uint64_t)1 << node->sizebits);
+        }
+    }
+    if (node->freenext != NULL) {
+        node->freenext->freeprev = node->freeprev;
+    }
+    node->freenext = node->freeprev = NULL;
+}
+
+/// Return the smallest free leaf node of at least the given size, or NULL
+static struct mmnode *freelist_find(struct mm *mm, uint8_t sizebits)
+{
+    uint64_t map = mm->freemap & ~(((uint64_t)1 << sizebits) - 1);
+    if (map == 0) {
+        return NULL;
+    }
+    return mm->freelist[__builtin_ctzll(map)];
+}
+
+/// Remove all free leaves below (and including) a node from the free index
+static void freelist_remove_subtree(struct mm *mm, struct mmnode *node)
+{
+    if (node == NULL) {
+        return;
+    }
+    if (node->childbits == FLAGBITS) {
+        if (node->type == NodeType_Free) {
+            freelist_remove(mm, node);
+        }
+        return;
+    }
+    for (cslot_t i = 0; i < UNBITS_CA(node->childbits); i++) {
+        freelist_remove_subtree(mm, node->children[i]);
+    }
+}
+
 /// Allocate a new node of given type/size. Does NOT initialise children pointers.
 static struct mmnode *new_node(struct mm *mm, enum nodetype type,
                                uint8_t childbits)
@@ -415,6 +487,16 @@ static errval_t chunk_node(struct mm *mm, uint8_t sizebits,
         cap.slot++;
     }
 
+    /* the node is no longer a free leaf, but its children are */
+    if (node->type == NodeType_Free) {
+        freelist_remove(mm, node);
+        for (cslot_t i = 0; i < UNBITS_CA(childbits); i++) {
+            freelist_insert(mm, node->children[i],
+                            *nodebase + i * UNBITS_GENPA(*nodesizebits - childbits),
+                            *nodesizebits - childbits);
+        }
+    }
+
     // If configured to delete chunked capabilities, we do so now
     // The slot stays available so we could meld chunks later (NYI)
     if(mm->delete_chunked) {
@@ -513,6 +595,8 @@ errval_t mm_init(struct mm *mm, enum objtype objtype, genpaddr_t base,
     mm->slot_refill = slot_refill_func;
     mm->slot_alloc_inst = slot_alloc_inst;
     mm->delete_chunked = delete_chunked;
+    memset(mm->freelist, 0, sizeof(mm->freelist));
+    mm->freemap = 0;
 
     /* init slab allocator */
     slab_init(&mm->slabs, MM_NODE_SIZE(maxchildbits), slab_refill_func);
@@ -562,6 +646,7 @@ errval_t mm_add(struct mm *mm, struct capref cap, uint8_t sizebits, genpaddr_t b
                 return MM_ERR_NEW_NODE;
             }
             mm->root->cap = cap;
+            freelist_insert(mm, mm->root, base, sizebits);
             return SYS_ERR_OK;
         } else {
             mm->root = new_node(mm, NodeType_Dummy, FLAGBITS);
@@ -577,6 +662,7 @@ errval_t mm_add(struct mm *mm, struct capref cap, uint8_t sizebits, genpaddr_t b
     if (err_is_ok(err)) {
         assert(node != NULL);
         node->cap = cap;
+        freelist_insert(mm, node, base, sizebits);
     }
     return err;
 }
@@ -715,11 +801,22 @@ errval_t mm_alloc_range(struct mm *mm, uint8_t sizebits, genpaddr_t minbase,
     struct mmnode *node = NULL;
     errval_t err;
 
-    /* search for closest matching node in the tree */
-    err = find_node(mm, false, sizebits, minbase, maxlimit, mm->root, mm->base,
-                    mm->sizebits, &nodebase, &nodesizebits, &node);
-    if (err_is_fail(err)) {
-        return err;
+    if (minbase == mm->base
+        && maxlimit == mm->base + UNBITS_GENPA(mm->sizebits)) {
+        /* unconstrained: take the smallest free region from the index */
+        node = freelist_find(mm, sizebits);
+        if (node == NULL) {
+            return MM_ERR_NOT_FOUND;
+        }
+        nodebase = node->base;
+        nodesizebits = node->sizebits;
+    } else {
+        /* search for closest matching node in the tree */
+        err = find_node(mm, false, sizebits, minbase, maxlimit, mm->root,
+                        mm->base, mm->sizebits, &nodebase, &nodesizebits, &node);
+        if (err_is_fail(err)) {
+            return err;
+        }
     }
 
     assert(node != NULL);
@@ -736,6 +833,7 @@ errval_t mm_alloc_range(struct mm *mm, uint8_t sizebits, genpaddr_t minbase,
     }
 
     assert(nodebase >= minbase && nodebase + UNBITS_GENPA(sizebits) <= maxlimit);
+    freelist_remove(mm, node);
     node->type = NodeType_Allocated;
 
     assert(retcap != NULL);
@@ -794,6 +892,8 @@ errval_t mm_realloc_range(struct mm *mm, uint8_t sizebits, genpaddr_t base,
     assert(node != NULL);
     if (node->type == NodeType_Chunked) {
         assert(nodesizebits == sizebits);
+        /* the children are hidden behind the allocated node from now on */
+        freelist_remove_subtree(mm, node);
         node->type = NodeType_Allocated;
         /* FIXME: walk child nodes and mark them allocated? or destroy? */
         *retcap = node->cap;
@@ -813,6 +913,9 @@ errval_t mm_realloc_range(struct mm *mm, uint8_t sizebits, genpaddr_t base,
     }
 
     assert(nodebase == base && nodesizebits == sizebits);
+    if (node->type == NodeType_Free) {
+        freelist_remove(mm, node);
+    }
     node->type = NodeType_Allocated;
 
     assert(retcap != NULL);
@@ -869,6 +972,7 @@ errval_t mm_free(struct mm *mm, struct capref cap, genpaddr_t base,
 
     node->type = NodeType_Free;
     node->cap = cap;
+    freelist_insert(mm, node, nodebase, nodesizebits);
 
     return SYS_ERR_OK;
 }
@@ -17,6 +17,7 @@
 #include <fcntl.h>
 #include <aio.h>
 #include <string.h>
+#include <stdbool.h>
 #include <errors/errno.h>
 #include <storage/vsic.h>
 #include <storage/vsa.h>
@@ -54,6 +55,7 @@ static errval_t vsic_write(struct storage_vsic *vsic, struct storage_vsa *vsa,
     cb->aio_offset = offset;
     cb->aio_buf = buffer;
     cb->aio_nbytes = size;
+    cb->aio_lio_opcode = LIO_WRITE;
 
     int r = aio_write(cb);
     assert(r == 0);
@@ -75,6 +77,7 @@ static errval_t vsic_read(struct storage_vsic *vsic, struct storage_vsa *vsa,
     cb->aio_offset = offset;
     cb->aio_buf = buffer;
     cb->aio_nbytes = size;
+    cb->aio_lio_opcode = LIO_READ;
 
     int r = aio_read(cb);
     assert(r == 0);
@@ -91,6 +94,7 @@ static errval_t vsic_flush(struct storage_vsic *vsic, struct storage_vsa *vsa)
     assert(cb != NULL);
 
     cb->aio_fildes = vsa->fd;
+    cb->aio_lio_opcode = LIO_NOP;
     int r = aio_fsync(O_SYNC, cb);
     assert(r == 0);
 
@@ -112,11 +116,13 @@ static errval_t vsic_wait(struct storage_vsic *vsic)
                 if(err == 0) {
                     int status = aio_return((struct aiocb *)mydata->cb_list[i]);
                     /* printf("Status: %zd\n", status); */
+                    bool read = mydata->cb_list[i]->aio_lio_opcode == LIO_READ;
 
                     // Completed successfully
                     mydata->cb_list[i] = NULL;
 
-                    if(status == 0) {
+                    // A flush returns 0 as well
+                    if(read && status == 0) {
                         return VFS_ERR_EOF;
                     }
                 } else if(err == EINPROGRESS) {
@@ -189,6 +195,16 @@ errval_t storage_vsa_acquire(struct storage_vsa *vsa, const char *name,
     vsa->fd = open(filename, O_RDWR | O_CREAT, 0644);
     assert(vsa->fd != -1);
 
+    // Reads within the VSA must not hit EOF
+    struct stat st;
+    int r = fstat(vsa->fd, &st);
+    assert(r == 0);
+    if(st.st_size < size) {
+        r = ftruncate(vsa->fd, size);
+        assert(r == 0);
+    }
+    vsa->size = size;
+
     return SYS_ERR_OK;
 }
 
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <string.h>
+#include <errors/errno.h>
+#include <tenaciousd/group.h>
+#include <storage/storage.h>
+
+#ifndef BARRELFISH
+static inline uint64_t rdtsc(void)
+{
+    uint32_t eax, edx;
+    __asm volatile ("rdtsc" : "=a" (eax), "=d" (edx));
+    return ((uint64_t)edx << 32) | eax;
+}
+#endif
+
+errval_t tenaciousd_group_init(struct tenaciousd_group *group,
+                               struct storage_vsa *vsa,
+                               struct storage_vsic *vsic,
+                               const struct tenaciousd_group_params *params)
+{
+  assert(group != NULL);
+  assert(params != NULL);
+  assert(params->max_entries > 0);
+  assert(params->max_bytes > 0);
+
+  memset(group, 0, sizeof(struct tenaciousd_group));
+  group->vsa = vsa;
+  group->vsic = vsic;
+  group->params = *params;
+
+  group->buf = storage_malloc(vsic, params->max_bytes);
+  if(group->buf == NULL) {
+    return LIB_ERR_MALLOC_FAIL;
+  }
+
+  return SYS_ERR_OK;
+}
+
+void tenaciousd_group_destroy(struct tenaciousd_group *group)
+{
+  // Caller has to commit first
+  assert(group->pending == 0);
+  storage_free(group->vsic, group->buf);
+  group->buf = NULL;
+}
+
+static errval_t write_and_flush(struct tenaciousd_group *group,
+                                uint64_t offset, size_t size, void *data)
+{
+  struct storage_vsic *vsic = group->vsic;
+
+  errval_t err = vsic->ops.write(vsic, group->vsa, offset, size, data);
+  if(err_is_fail(err)) {
+    return err;
+  }
+  err = vsic->ops.flush(vsic, group->vsa);
+  if(err_is_fail(err)) {
+    return err;
+  }
+  return vsic->ops.wait(vsic);
+}
+
+errval_t tenaciousd_group_commit(struct tenaciousd_group *group)
+{
+  if(group->pending == 0) {
+    return SYS_ERR_OK;
+  }
+
+  errval_t err = write_and_flush(group, group->offset, group->len, group->buf);
+  if(err_is_fail(err)) {
+    return err;
+  }
+
+  group->committed += group->pending;
+  group->commits++;
+  group->pending = 0;
+  group->len = 0;
+
+  return SYS_ERR_OK;
+}
+
+errval_t tenaciousd_group_poll(struct tenaciousd_group *group)
+{
+  if(group->pending > 0 && group->params.max_delay > 0 &&
+     rdtsc() - group->first >= group->params.max_delay) {
+    return tenaciousd_group_commit(group);
+  }
+
+  return SYS_ERR_OK;
+}
+
+errval_t tenaciousd_group_add(struct tenaciousd_group *group, uint64_t offset,
+                              const void *data, size_t size)
+{
+  errval_t err;
+
+  // Commit the current group if the entry does not follow it or won't fit
+  if(group->pending > 0 &&
+     (offset < group->offset + group->len ||
+      offset + size > group->offset + group->params.max_bytes)) {
+    err = tenaciousd_group_commit(group);
+    if(err_is_fail(err)) {
+      return err;
+    }
+  }
+
+  if(size > group->params.max_bytes) {
+    // Too large to stage -- write it on its own
+    err = write_and_flush(group, offset, size, (void *)data);
+    if(err_is_fail(err)) {
+      return err;
+    }
+    group->committed++;
+    group->commits++;
+    return SYS_ERR_OK;
+  }
+
+  if(group->pending == 0) {
+    group->offset = offset;
+    group->len = 0;
+    group->first = rdtsc();
+  }
+
+  // Padding between entries is written as zeroes
+  size_t start = offset - group->offset;
+  memset(group->buf + group->len, 0, start - group->len);
+  memcpy(group->buf + start, data, size);
+  group->len = start + size;
+  group->pending++;
+
+  if(group->pending >= group->params.max_entries) {
+    return tenaciousd_group_commit(group);
+  }
+
+  return tenaciousd_group_poll(group);
+}
@@ -16,6 +16,7 @@
 #include <string.h>
 #include <errors/errno.h>
 #include <tenaciousd/log.h>
+#include <tenaciousd/group.h>
 #include <storage/storage.h>
 
 #define LOG_IDENTIFIER	"TenaciousD_Log_structure_rev01"
@@ -93,7 +94,7 @@ struct tenaciousd_log *tenaciousd_log_new(struct storage_vsa *vsa,
 
   struct tenaciousd_log *log = malloc(sizeof(struct tenaciousd_log));
   assert(log != NULL);
-  memset(log, 0, sizeof(log));
+  memset(log, 0, sizeof(struct tenaciousd_log));
 
   log->vsa = vsa;
   log->vsic = vsic;
@@ -153,8 +154,12 @@ struct tenaciousd_log *tenaciousd_log_new(struct storage_vsa *vsa,
 
 errval_t tenaciousd_log_delete(struct tenaciousd_log *log)
 {
+  // Commit pending group and stop group commit
+  errval_t err = tenaciousd_log_set_group_commit(log, NULL);
+  assert(err_is_ok(err));
+
   // Flush out log
-  errval_t err = log->vsic->ops.flush(log->vsic, log->vsa);
+  err = log->vsic->ops.flush(log->vsic, log->vsa);
   assert(err_is_ok(err));
 
   // Update header and flush again and wait for it to finish
@@ -192,11 +197,75 @@ errval_t tenaciousd_log_append(struct tenaciousd_log *log,
   log->entries++;
   entry->data[entry->size] = LOG_ENTRY_END_MARKER;
 
+  if(log->group != NULL) {
+    // Staged until the group is committed
+    return tenaciousd_group_add(log->group, end,
+                                entry, entry->size + sizeof(struct tenaciousd_log_entry));
+  }
+
   return log->vsic->ops.
     write(vsic, log->vsa, end,
 	  entry->size + sizeof(struct tenaciousd_log_entry), entry);
 }
 
+/**
+ * Enables group commit with the given parameters, or disables it if params
+ * is NULL. Pending entries are committed first.
+ */
+errval_t tenaciousd_log_set_group_commit(struct tenaciousd_log *log,
+                                         const struct tenaciousd_group_params *params)
+{
+  errval_t err = tenaciousd_log_commit(log);
+  if(err_is_fail(err)) {
+    return err;
+  }
+
+  if(log->group != NULL) {
+    tenaciousd_group_destroy(log->group);
+    free(log->group);
+    log->group = NULL;
+  }
+
+  if(params == NULL) {
+    return SYS_ERR_OK;
+  }
+
+  struct tenaciousd_group *group = malloc(sizeof(struct tenaciousd_group));
+  if(group == NULL) {
+    return LIB_ERR_MALLOC_FAIL;
+  }
+  err = tenaciousd_group_init(group, log->vsa, log->vsic, params);
+  if(err_is_fail(err)) {
+    free(group);
+    return err;
+  }
+
+  log->group = group;
+  return SYS_ERR_OK;
+}
+
+/**
+ * Makes all appended entries durable.
+ */
+errval_t tenaciousd_log_commit(struct tenaciousd_log *log)
+{
+  if(log->group == NULL) {
+    return SYS_ERR_OK;
+  }
+  return tenaciousd_group_commit(log->group);
+}
+
+/**
+ * Commits the pending group if it has waited longer than allowed.
+ */
+errval_t tenaciousd_log_poll(struct tenaciousd_log *log)
+{
+  if(log->group == NULL) {
+    return SYS_ERR_OK;
+  }
+  return tenaciousd_group_poll(log->group);
+}
+
 errval_t tenaciousd_log_trim(struct tenaciousd_log *log, int nentries)
 {
     assert(!"NYI");
@@ -204,6 +273,10 @@ errval_t tenaciousd_log_trim(struct tenaciousd_log *log, int nentries)
 
 struct tenaciousd_log_iter tenaciousd_log_begin(struct tenaciousd_log *log)
 {
+  // Staged entries are only visible on storage once committed
+  errval_t err = tenaciousd_log_commit(log);
+  assert(err_is_ok(err));
+
   struct tenaciousd_log_entry *entry =
       read_entry(log, LOG_FIRST_ENTRY_OFFSET(log));
 
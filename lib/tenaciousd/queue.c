@@ -16,6 +16,7 @@
 #include <string.h>
 #include <errors/errno.h>
 #include <tenaciousd/queue.h>
+#include <tenaciousd/group.h>
 #include <storage/storage.h>
 
 #define QUEUE_IDENTIFIER	"TenaciousD_Queue_structure_rev01"
@@ -95,7 +96,7 @@ static struct tenaciousd_queue_element *tenaciousd_queue_read_element(struct ten
 }
 
 
-void tenaciousd_queue_delete_entry(struct tenaciousd_queue *queue,
+void tenaciousd_queue_delete_element(struct tenaciousd_queue *queue,
 				 struct tenaciousd_queue_element *element)
 {
   storage_free(queue->vsic, element);
@@ -110,7 +111,7 @@ struct tenaciousd_queue *tenaciousd_queue_new(struct storage_vsa *vsa,
 
   struct tenaciousd_queue *queue = malloc(sizeof(struct tenaciousd_queue));
   assert(queue != NULL);
-  memset(queue, 0, sizeof(queue));
+  memset(queue, 0, sizeof(struct tenaciousd_queue));
 
   queue->vsa = vsa;
   queue->vsic = vsic;
@@ -176,8 +177,12 @@ struct tenaciousd_queue *tenaciousd_queue_new(struct storage_vsa *vsa,
 
 errval_t tenaciousd_queue_delete(struct tenaciousd_queue *queue)
 {
+  // Commit pending group and stop group commit
+  errval_t err = tenaciousd_queue_set_group_commit(queue, NULL);
+  assert(err_is_ok(err));
+
   // Flush out log
-  errval_t err = queue->vsic->ops.flush(queue->vsic, queue->vsa);
+  err = queue->vsic->ops.flush(queue->vsic, queue->vsa);
   assert(err_is_ok(err));
 
   // Update header and flush again and wait for it to finish
@@ -235,16 +240,84 @@ errval_t tenaciousd_queue_add(struct tenaciousd_queue *queue,
   element->valid = QUEUE_ELEMENT_VALID;
   element->data[element->size] = QUEUE_ELEMENT_END_MARKER;
 
+  if(queue->group != NULL) {
+    // Staged until the group is committed
+    return tenaciousd_group_add(queue->group, end,
+                                element, element->size + sizeof(struct tenaciousd_queue_element));
+  }
+
   return queue->vsic->ops.
     write(vsic, queue->vsa, end,
 	  element->size + sizeof(struct tenaciousd_queue_element), element);
 }
 
+/**
+ * Enables group commit with the given parameters, or disables it if params
+ * is NULL. Pending elements are committed first.
+ */
+errval_t tenaciousd_queue_set_group_commit(struct tenaciousd_queue *queue,
+                                           const struct tenaciousd_group_params *params)
+{
+  errval_t err = tenaciousd_queue_commit(queue);
+  if(err_is_fail(err)) {
+    return err;
+  }
+
+  if(queue->group != NULL) {
+    tenaciousd_group_destroy(queue->group);
+    free(queue->group);
+    queue->group = NULL;
+  }
+
+  if(params == NULL) {
+    return SYS_ERR_OK;
+  }
+
+  struct tenaciousd_group *group = malloc(sizeof(struct tenaciousd_group));
+  if(group == NULL) {
+    return LIB_ERR_MALLOC_FAIL;
+  }
+  err = tenaciousd_group_init(group, queue->vsa, queue->vsic, params);
+  if(err_is_fail(err)) {
+    free(group);
+    return err;
+  }
+
+  queue->group = group;
+  return SYS_ERR_OK;
+}
+
+/**
+ * Makes all added elements durable.
+ */
+errval_t tenaciousd_queue_commit(struct tenaciousd_queue *queue)
+{
+  if(queue->group == NULL) {
+    return SYS_ERR_OK;
+  }
+  return tenaciousd_group_commit(queue->group);
+}
+
+/**
+ * Commits the pending group if it has waited longer than allowed.
+ */
+errval_t tenaciousd_queue_poll(struct tenaciousd_queue *queue)
+{
+  if(queue->group == NULL) {
+    return SYS_ERR_OK;
+  }
+  return tenaciousd_group_poll(queue->group);
+}
+
 struct tenaciousd_queue_element * tenaciousd_queue_remove(struct tenaciousd_queue *queue) {
   if (queue->last == queue->end) {
     return NULL;
   }
 
+  // The last element may still be staged
+  errval_t err = tenaciousd_queue_commit(queue);
+  assert(err_is_ok(err));
+
   uint64_t last = queue->last;
 
   struct tenaciousd_queue_element * element = tenaciousd_queue_read_element(queue, queue->last);
@@ -263,6 +336,10 @@ struct tenaciousd_queue_element * tenaciousd_queue_remove(struct tenaciousd_queu
 
 struct tenaciousd_queue_iter tenaciousd_queue_begin(struct tenaciousd_queue *queue)
 {
+  // Staged elements are only visible on storage once committed
+  errval_t err = tenaciousd_queue_commit(queue);
+  assert(err_is_ok(err));
+
   struct tenaciousd_queue_element *element =
       tenaciousd_queue_read_element(queue, QUEUE_FIRST_ELEMENT_OFFSET(queue));
 
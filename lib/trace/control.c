@@ -48,6 +48,7 @@ void trace_reset_buffer(void)
         new = 1;
     } while (!trace_cas(&buf->head_index, i, new));
     buf->tail_index = 0;
+    buf->lost = 0;
 
     buf->num_applications = 0;
 }
@@ -65,6 +66,7 @@ void trace_reset_all(void)
         struct trace_buffer *tbuf = (struct trace_buffer *)compute_trace_buf_addr(core);
         tbuf->head_index = 1;
         tbuf->tail_index = 0;
+        tbuf->lost = 0;
     }
 }
 
@@ -285,6 +287,15 @@ size_t trace_dump_core(char *buf, size_t buflen, size_t *usedBytes,
             assert(len >= 0);
             ptr += len; totlen += len;
 
+            // Print the number of events dropped because the buffer was full
+            if (tbuf->lost > 0) {
+                assert(totlen < buflen);
+                len = snprintf(ptr, buflen-totlen,
+                        "# Lost %d %" PRIuPTR "\n", core, tbuf->lost);
+                assert(len >= 0);
+                ptr += len; totlen += len;
+            }
+
             // Print all application names
             for(int app_index = 0; app_index < tbuf->num_applications; app_index++ ) {
 
@@ -0,0 +1,222 @@
+/**
+ * \file
+ * \brief Streaming of trace buffers
+ *
+ * In streaming mode the per-core trace buffers are drained continuously while
+ * tracing is running, instead of being dumped once after the trace stopped.
+ * The writers on each core stay lock-free: a slot is reserved by advancing
+ * head_index and is complete once its timestamp is non-zero. The single
+ * reader copies complete events out, clears their timestamps and then
+ * advances tail_index to hand the slots back. When a buffer is full, writers
+ * drop the event and count it in the buffer's lost counter.
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#include <barrelfish/barrelfish.h>
+#include <barrelfish/sys_debug.h>
+#include <trace/trace.h>
+#include <string.h>
+
+STATIC_ASSERT(TRACE_MAX_EVENTS <= UINT16_MAX, "chunk event count fits");
+STATIC_ASSERT(TRACE_COREID_LIMIT <= UINT16_MAX, "chunk core id fits");
+
+/// Lost counter of each core at the time its last chunk was written
+static uint64_t reported_lost[TRACE_COREID_LIMIT];
+
+/**
+ * \brief Start streaming, discarding the current trace
+ *
+ * Clears all per-core buffers and starts tracing immediately, without start
+ * or stop triggers. Events recorded while the buffers are cleared may be lost.
+ */
+errval_t trace_stream_start(void)
+{
+    struct trace_buffer *master = (struct trace_buffer*)trace_buffer_master;
+    if (master == NULL) {
+        return TRACE_ERR_NO_BUFFER;
+    }
+
+    master->running = false;
+
+    for (coreid_t core = 0; core < TRACE_COREID_LIMIT; core++) {
+        struct trace_buffer *tbuf = (struct trace_buffer *)compute_trace_buf_addr(core);
+        // cleared timestamps mark the slots as not yet written
+        memset(tbuf->events, 0, sizeof(tbuf->events));
+        tbuf->head_index = 1;
+        tbuf->tail_index = 0;
+        tbuf->lost = 0;
+        reported_lost[core] = 0;
+    }
+
+    master->event_counter = 0;
+    master->start_trigger = 0;
+    master->stop_trigger = 0;
+    master->duration = 0;
+    master->stop_time = 0xFFFFFFFFFFFFFFFFULL;
+    master->t0 = TRACE_TIMESTAMP();
+    master->streaming = true;
+    master->running = true;
+
+    return SYS_ERR_OK;
+}
+
+/**
+ * \brief Stop streaming. Events still in the buffers can be drained.
+ */
+void trace_stream_stop(void)
+{
+    struct trace_buffer *master = (struct trace_buffer*)trace_buffer_master;
+    assert(master);
+
+    master->running = false;
+    master->streaming = false;
+}
+
+/**
+ * \brief Write the header of a trace stream
+ *
+ * \returns number of bytes written, 0 if buf is too small
+ */
+size_t trace_stream_header(void *buf, size_t buflen)
+{
+    struct trace_buffer *master = (struct trace_buffer*)trace_buffer_master;
+    assert(master);
+
+    if (buflen < sizeof(struct trace_stream_header)) {
+        return 0;
+    }
+
+    cycles_t tsc_per_ms = 0;
+    errval_t err = sys_debug_get_tsc_per_ms(&tsc_per_ms);
+    if (err_is_fail(err)) {
+        tsc_per_ms = 0;
+    }
+
+    struct trace_stream_header *hdr = buf;
+    hdr->magic = TRACE_STREAM_MAGIC;
+    hdr->version = TRACE_STREAM_VERSION;
+    hdr->event_size = sizeof(struct trace_event);
+    hdr->tsc_per_ms = tsc_per_ms;
+    hdr->t0 = master->t0;
+
+    return sizeof(*hdr);
+}
+
+/**
+ * \brief Move the complete events of one core into a stream chunk
+ *
+ * buf : The buffer to write the chunk into.
+ * buflen : Length of buf.
+ * number_of_events : (optional) Returns how many events have been drained.
+ * \returns number of bytes written, 0 if there was nothing new to report
+ */
+size_t trace_stream_drain_core(void *buf, size_t buflen, coreid_t core,
+                               size_t *number_of_events)
+{
+    assert(core < TRACE_COREID_LIMIT);
+    struct trace_buffer *tbuf = (struct trace_buffer *)compute_trace_buf_addr(core);
+
+    if (number_of_events != NULL) {
+        *number_of_events = 0;
+    }
+
+    if (buflen < sizeof(struct trace_stream_chunk)) {
+        return 0;
+    }
+
+    size_t max = (buflen - sizeof(struct trace_stream_chunk))
+                 / sizeof(struct trace_event);
+    if (max > UINT16_MAX) {
+        max = UINT16_MAX;
+    }
+
+    struct trace_stream_chunk *chunk = buf;
+    struct trace_event *out = (struct trace_event *)(chunk + 1);
+
+    uintptr_t tail = tbuf->tail_index;
+    uintptr_t head = tbuf->head_index;
+    size_t n = 0;
+    while (n < max) {
+        uintptr_t idx = (tail + 1) % TRACE_MAX_EVENTS;
+        if (idx == head) {
+            break;
+        }
+        volatile struct trace_event *slot = &tbuf->events[idx];
+        // pairs with the release store of the timestamp by the writer
+        uint64_t timestamp = __atomic_load_n(&slot->timestamp, __ATOMIC_ACQUIRE);
+        if (timestamp == 0) {
+            // reserved, but the writer has not finished yet
+            break;
+        }
+        out[n].timestamp = timestamp;
+        out[n].u.raw = slot->u.raw;
+        slot->timestamp = 0;
+        tail = idx;
+        n++;
+    }
+    // the slots are reused as soon as tail_index moves past them
+    __atomic_store_n(&tbuf->tail_index, tail, __ATOMIC_RELEASE);
+
+    uint64_t lost = tbuf->lost;
+    if (n == 0 && lost == reported_lost[core]) {
+        return 0;
+    }
+    reported_lost[core] = lost;
+
+    chunk->magic = TRACE_STREAM_CHUNK_MAGIC;
+    chunk->core = core;
+    chunk->num_events = n;
+    chunk->lost = lost;
+    chunk->t_offset = tbuf->t_offset;
+
+    if (number_of_events != NULL) {
+        *number_of_events = n;
+    }
+
+    return sizeof(*chunk) + n * sizeof(struct trace_event);
+}
+
+/**
+ * \brief Move the complete events of all cores into stream chunks
+ *
+ * \returns number of bytes written
+ */
+size_t trace_stream_drain(void *buf, size_t buflen, size_t *number_of_events)
+{
+    uint8_t *ptr = buf;
+    size_t totlen = 0;
+    size_t total_events = 0;
+
+    for (coreid_t core = 0; core < TRACE_COREID_LIMIT; core++) {
+        size_t events = 0;
+        size_t len = trace_stream_drain_core(ptr, buflen - totlen, core,
+                                             &events);
+        ptr += len;
+        totlen += len;
+        total_events += events;
+    }
+
+    if (number_of_events != NULL) {
+        *number_of_events = total_events;
+    }
+
+    return totlen;
+}
+
+/**
+ * \brief Number of events dropped on a core since streaming started
+ */
+uint64_t trace_stream_lost(coreid_t core)
+{
+    assert(core < TRACE_COREID_LIMIT);
+    struct trace_buffer *tbuf = (struct trace_buffer *)compute_trace_buf_addr(core);
+    return tbuf->lost;
+}
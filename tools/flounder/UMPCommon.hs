@@ -565,6 +565,17 @@ bind_fn p ifn =
         C.Ex $ C.Assignment (C.FieldOf (common_field "tx_cont_chanstate") "trigger") (C.AddressOf $ C.FieldOf chanvar "send_waitset"),
         C.StmtList $ (ump_binding_extra_fields_init p),
         C.SBlank,
+        C.SComment "ask for payload pools or adaptive receive in the channel frame?",
+        C.Ex $ C.Assignment (chanvar `C.FieldOf` "poolsize")
+            (C.Ternary (C.Binary C.BitwiseAnd (C.Variable "flags") (C.Variable "IDC_BIND_FLAG_UMP_POOL"))
+                       (C.Variable "DEFAULT_UMP_POOLLEN") (C.NumConstant 0)),
+        -- adaptive receive only makes sense for backends with notifications
+        C.Ex $ C.Assignment (chanvar `C.FieldOf` "adaptive" `C.FieldOf` "enabled")
+            (if isJust (ump_bind_alloc_notify p)
+             then C.Ternary (C.Binary C.BitwiseAnd (C.Variable "flags") (C.Variable "IDC_BIND_FLAG_UMP_ADAPTIVE"))
+                            (C.Variable "true") (C.Variable "false")
+             else C.Variable "false"),
+        C.SBlank,
         C.SComment "do we need a new monitor binding?",
         C.If (C.Binary C.BitwiseAnd (C.Variable "flags") (C.Variable "IDC_BIND_FLAG_RPC_CAP_TRANSFER"))
             [C.Ex $ C.Assignment errvar $ C.Call "monitor_client_new_binding"
@@ -1729,7 +1740,7 @@ rx_handler p ifn typedefs msgdefs msgs =
                 ],
             C.Break]
             where
-                args = [msg_arg, string_arg, pos_arg, len_arg, max_size]
+                args = [chanst, msg_arg, string_arg, pos_arg, len_arg, max_size]
                 msg_arg = C.Variable "msg"
                 string_arg = argfield_expr RX mn af
                 pos_arg = C.AddressOf $ C.DerefField bindvar "rx_str_pos"
@@ -1755,7 +1766,7 @@ rx_handler p ifn typedefs msgdefs msgs =
                 ],
             C.Break]
             where
-                args = [msg_arg, buf_arg, len_arg, pos_arg, max_size]
+                args = [chanst, msg_arg, buf_arg, len_arg, pos_arg, max_size]
                 msg_arg = C.Variable "msg"
                 buf_arg = C.Cast (C.Ptr C.Void) $ argfield_expr RX mn afn
                 len_arg = C.AddressOf $ argfield_expr RX mn afl
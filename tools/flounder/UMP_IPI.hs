@@ -70,9 +70,11 @@ ump_ipi_connect_extra_fields_init =
       exportvar = C.Variable "e"
 
 -- generate the code to register for receive notification
+-- (adaptive channels poll for a while before waiting for a notification)
 ump_ipi_register_recv :: String -> [C.Stmt]
 ump_ipi_register_recv ifn =
-    [ C.If (C.Call "capref_is_null" [notifyvar `C.FieldOf` "my_notify_cap"])
+    [ C.If (C.Binary C.Or (C.Call "capref_is_null" [notifyvar `C.FieldOf` "my_notify_cap"])
+                          (C.Unary C.Not $ C.Call "ump_chan_wait_notify" [chanaddr]))
       [ C.Ex $ C.Assignment errvar $ C.Call "ump_chan_register_recv"
         [C.AddressOf $ my_bindvar `C.DerefField` "ump_state" `C.FieldOf` "chan",
          bindvar `C.DerefField` "waitset", C.StructConstant "event_closure"
@@ -84,14 +86,19 @@ ump_ipi_register_recv ifn =
          [("handler", C.Variable $ rx_handler_name uparams ifn), ("arg", bindvar)]]
       ]
     ]
+    where
+      chanaddr = C.AddressOf $ my_bindvar `C.DerefField` "ump_state" `C.FieldOf` "chan"
 
 ump_ipi_deregister_recv :: String -> [C.Stmt]
 ump_ipi_deregister_recv ifn =
-    [ C.If (C.Call "capref_is_null" [notifyvar `C.FieldOf` "my_notify_cap"])
+    [ C.If (C.Binary C.Or (C.Call "capref_is_null" [notifyvar `C.FieldOf` "my_notify_cap"])
+                          (C.Unary C.Not $ chanvar `C.FieldOf` "adaptive" `C.FieldOf` "blocked"))
       [C.Ex $ C.Assignment errvar $ C.Call "ump_chan_deregister_recv"
-       [C.AddressOf $ my_bindvar `C.DerefField` "ump_state" `C.FieldOf` "chan"]]
+       [C.AddressOf chanvar]]
       [C.Ex $ C.Assignment errvar $ C.Call "ipi_notify_deregister" [notifyaddr]]
     ]
+    where
+      chanvar = my_bindvar `C.DerefField` "ump_state" `C.FieldOf` "chan"
 
 alloc_notify :: String -> [C.Stmt]
 alloc_notify handler =
@@ -217,12 +224,15 @@ store_notify_cap ifn capex
 
 do_notify :: [C.Stmt]
 do_notify =
-    [ C.If (C.Unary C.Not $ C.Call "capref_is_null" [notifyvar `C.FieldOf` "rmt_notify_cap"])
+    [ C.If (C.Binary C.And (C.Unary C.Not $ C.Call "capref_is_null" [notifyvar `C.FieldOf` "rmt_notify_cap"])
+                           (C.Call "ump_chan_notify_needed" [chanaddr]))
       [ C.Ex $ C.Assignment errvar $ C.Call "ipi_notify_raise" [notifyaddr],
         C.If (C.Call "err_is_fail" [errvar])
              [report_user_tx_err $
               C.Call "err_push" [errvar, C.Variable "LIB_ERR_IPI_NOTIFY"]] []] []
     ]
+    where
+      chanaddr = C.AddressOf $ my_bindvar `C.DerefField` "ump_state" `C.FieldOf` "chan"
 
 notifyvar = my_bindvar `C.DerefField` "ipi_notify"
 notifyaddr = C.AddressOf $ notifyvar
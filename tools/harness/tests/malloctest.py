@@ -31,3 +31,25 @@ class MallocTest(TestCommon):
             lastline = line
         passed = lastline.startswith(self.get_finish_string())
         return PassFailResult(passed)
+
+@tests.add_test
+class MallocStress(TestCommon):
+    '''malloc stress test, reporting throughput and fragmentation'''
+    name = "mallocstress"
+
+    def get_modules(self, build, machine):
+        modules = super(MallocStress, self).get_modules(build, machine)
+        modules.add_module("mallocstress")
+        return modules
+
+    def get_finish_string(self):
+        return "mallocstress done."
+
+    def process_data(self, testdir, rawiter):
+        passed = False
+        for line in rawiter:
+            if line.startswith(self.get_finish_string()):
+                passed = True
+            elif "PANIC" in line:
+                return PassFailResult(False)
+        return PassFailResult(passed)
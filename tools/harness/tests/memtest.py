@@ -64,3 +64,43 @@ class MemTestMulti(TestCommon):
             if line.startswith("memtest passed successfully!"):
                 nseen += 1
         return PassFailResult(nspawned > 0 and nspawned == nseen)
+
+@tests.add_test
+class MemAllocBench(TestCommon):
+    '''mem_serv allocation latency with mixed sizes'''
+    name = "mem_alloc_bench"
+
+    def get_modules(self, build, machine):
+        modules = super(MemAllocBench, self).get_modules(build, machine)
+        modules.add_module("mem_alloc_bench")
+        return modules
+
+    def get_finish_string(self):
+        return "mem_alloc_bench done."
+
+    def process_data(self, testdir, rawiter):
+        passed = False
+        for line in rawiter:
+            if line.startswith(self.get_finish_string()):
+                passed = True
+        return PassFailResult(passed)
+
+@tests.add_test
+class RamBatchBench(TestCommon):
+    '''RAM allocation throughput: single requests vs. batches'''
+    name = "ram_batch_bench"
+
+    def get_modules(self, build, machine):
+        modules = super(RamBatchBench, self).get_modules(build, machine)
+        modules.add_module("ram_batch_bench")
+        return modules
+
+    def get_finish_string(self):
+        return "ram_batch_bench done."
+
+    def process_data(self, testdir, rawiter):
+        passed = False
+        for line in rawiter:
+            if line.startswith(self.get_finish_string()):
+                passed = True
+        return PassFailResult(passed)
@@ -18,12 +18,19 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <time.h>
 #include <sys/param.h>
 
 
 /***** Prerequisite definitions copied from Barrelfish headers *****/
 
 #define trace_event(x,y,z)
+#define schedstat_schedule(len,idle,preempted)
+#define schedstat_slack(slack)
+#define schedstat_wakeup()
+#define schedstat_yield()
 
 #define DISP_NAME_LEN   16
 
@@ -58,10 +65,15 @@ struct dcb {
     struct cte          ep;
     size_t              vspace;
     struct dcb          *next;          ///< Next DCB in schedule
+    struct dcb          *prev;          ///< Previous DCB in schedule
+    unsigned long       runnable_since;
     unsigned long       release_time, etime, last_dispatch;
     unsigned long       wcet, period, deadline;
     unsigned short      weight;
     enum task_type      type;
+    struct dcb          *heap_child, *heap_next, *heap_prev;
+    uint64_t            queue_seq;
+    bool                released;
 
     // Simulator state
     int                 id;
@@ -73,8 +85,10 @@ struct dcb {
 struct kcb {
     struct kcb *prev, *next;
     struct dcb *queue_head, *queue_tail;
+    struct dcb *released, *unreleased;
+    uint64_t queue_seq, queue_len;
     unsigned int u_hrt, u_srt, w_be, n_be;
-} curr = { 0, 0, 0, 0, 0, 0, 0, 0 };
+} curr = { 0 };
 struct kcb *kcb_current = &curr;
 
 
@@ -119,7 +133,7 @@ static void init_dcb(struct dcb *dcb, int id)
     dcb->cspace.cap.type = ObjType_L1CNode;
     dcb->ep.cap.type = ObjType_EndPointLMP;
     dcb->vspace = 1;
-    dcb->next = NULL;
+    dcb->next = dcb->prev = NULL;
     dcb->release_time = 0;
     dcb->wcet = 0;
     dcb->period = 0;
@@ -130,6 +144,76 @@ static void init_dcb(struct dcb *dcb, int id)
     snprintf(dcb->dsg.name, DISP_NAME_LEN, "%d", id);
 }
 
+static inline uint64_t cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    uint32_t eax, edx;
+    __asm volatile ("rdtsc" : "=a" (eax), "=d" (edx));
+    return ((uint64_t)edx << 32) | eax;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+/**
+ * \brief Measures the cost of the run queue with many dispatchers.
+ *
+ * Every fourth task is a hard real-time task with a small utilization and a
+ * random release time, the others are best-effort. Each round, one
+ * best-effort task blocks and is woken up again, then the scheduler runs.
+ */
+static void run_bench(int ntasks, int rounds)
+{
+    struct dcb *dcbs = calloc(ntasks, sizeof(struct dcb));
+    assert(dcbs != NULL);
+    unsigned long period = 100 * ntasks;
+    uint64_t t_runnable = 0, t_schedule = 0;
+
+    srand(1);
+    for(int i = 0; i < ntasks; i++) {
+        struct dcb *dcb = &dcbs[i];
+        init_dcb(dcb, i);
+        if(i % 4 == 3) {
+            dcb->type = TASK_TYPE_HARD_REALTIME;
+            dcb->wcet = 1;
+            dcb->period = dcb->deadline = period;
+            dcb->release_time = kernel_now + rand() % period;
+        } else {
+            dcb->type = TASK_TYPE_BEST_EFFORT;
+            dcb->weight = 1;
+        }
+        make_runnable(dcb);
+    }
+
+    for(int r = 0; r < rounds; r++) {
+        kernel_now++;
+
+        struct dcb *dcb;
+        do {
+            dcb = &dcbs[rand() % ntasks];
+        } while(dcb->type != TASK_TYPE_BEST_EFFORT);
+        scheduler_remove(dcb);
+        if(dcb_current == dcb) {
+            dcb_current = NULL;
+        }
+
+        uint64_t start = cycles();
+        make_runnable(dcb);
+        uint64_t middle = cycles();
+        dcb_current = schedule();
+        uint64_t end = cycles();
+
+        t_runnable += middle - start;
+        t_schedule += end - middle;
+    }
+
+    printf("%d tasks: make_runnable %" PRIu64 " cycles, schedule %" PRIu64
+           " cycles\n", ntasks, t_runnable / rounds, t_schedule / rounds);
+    free(dcbs);
+}
+
 static inline char typechar(enum task_type type)
 {
     switch(type) {
@@ -154,10 +238,16 @@ int main(int argc, char **argv)
     int tasks = 0, alltasks = MAXTASKS, runtime, quantum = 1;
 
     if(argc < 3) {
-        printf("Usage: %s <config.cfg> <runtime> [quantum]\n", argv[0]);
+        printf("Usage: %s <config.cfg> <runtime> [quantum]\n"
+               "       %s -b <tasks> <rounds>\n", argv[0], argv[0]);
         exit(EXIT_FAILURE);
     }
 
+    if(!strcmp(argv[1], "-b") && argc >= 4) {
+        run_bench(atoi(argv[2]), atoi(argv[3]));
+        return 0;
+    }
+
     runtime = atoi(argv[2]);
     if(argc >= 4) {
         quantum = atoi(argv[3]);
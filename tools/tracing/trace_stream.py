@@ -0,0 +1,202 @@
+#!/usr/bin/env python
+
+##########################################################################
+# Copyright (c) 2026, ETH Zurich.
+# All rights reserved.
+#
+# This file is distributed under the terms in the attached LICENSE file.
+# If you do not find this file, copies can be found by writing to:
+# ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+##########################################################################
+
+# Decoder for streamed trace files, as written by "bfscope_nfs URL FILE stream".
+#
+# The stream format is defined in include/trace/trace.h: a stream header
+# followed by chunks of events, each drained from the buffer of one core.
+# Subsystem and event names are taken from trace_definitions/trace_defs.pleco,
+# where subsystems and the events of each subsystem are numbered in order.
+#
+# Latencies are measured between events of a subsystem on the same core that
+# form a begin/end pair by name: X or X_ENTER and X_DONE, X_START and X_END,
+# START and STOP, and so on. Nested pairs are matched innermost first.
+
+from __future__ import print_function
+
+import sys
+import os
+import re
+import struct
+import argparse
+
+STREAM_MAGIC = 0x53544642
+CHUNK_MAGIC = 0x43544642
+STREAM_VERSION = 1
+
+HEADER = struct.Struct("<IHHQQ")
+CHUNK = struct.Struct("<IHHQq")
+EVENT = struct.Struct("<QIHH")
+
+END_SUFFIXES = ["_DONE", "_END", "_STOP", "_EXIT", "_FINISHED", "_ACK"]
+BEGIN_SUFFIXES = ["", "_START", "_BEGIN", "_ENTER"]
+MAX_NESTING = 64
+
+DEFAULT_PLECO = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                             "..", "..", "trace_definitions",
+                             "trace_defs.pleco")
+
+
+def parse_pleco(path):
+    """Returns {subsys: (name, {event: name})} numbered like pleco does"""
+    text = open(path).read()
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    text = re.sub(r"//[^\n]*", "", text)
+    subsystems = {}
+    for num, m in enumerate(re.finditer(r"subsystem\s+(\w+)\s*\{(.*?)\}",
+                                        text, flags=re.S)):
+        events = re.findall(r"event\s+(\w+)", m.group(2))
+        subsystems[num] = (m.group(1), dict(enumerate(events)))
+    return subsystems
+
+
+def read_stream(path):
+    """Yields (header, chunk, events) for every complete chunk in the file"""
+    data = open(path, "rb").read()
+    if len(data) < HEADER.size:
+        sys.exit("%s: too short for a trace stream header" % path)
+    magic, version, event_size, tsc_per_ms, t0 = HEADER.unpack_from(data, 0)
+    if magic != STREAM_MAGIC:
+        sys.exit("%s: not a trace stream (magic %#x)" % (path, magic))
+    if version != STREAM_VERSION or event_size != EVENT.size:
+        sys.exit("%s: unsupported stream version %d, event size %d"
+                 % (path, version, event_size))
+    header = {"tsc_per_ms": tsc_per_ms, "t0": t0}
+
+    off = HEADER.size
+    while off + CHUNK.size <= len(data):
+        magic, core, num, lost, t_offset = CHUNK.unpack_from(data, off)
+        if magic != CHUNK_MAGIC:
+            sys.exit("%s: bad chunk magic %#x at offset %d"
+                     % (path, magic, off))
+        end = off + CHUNK.size + num * EVENT.size
+        if end > len(data):
+            # the file is still being written
+            break
+        events = []
+        for i in range(num):
+            ts, arg, ev, subsys = EVENT.unpack_from(
+                data, off + CHUNK.size + i * EVENT.size)
+            events.append((ts - t_offset, subsys, ev, arg))
+        chunk = {"core": core, "lost": lost}
+        yield header, chunk, events
+        off = end
+
+
+def begin_names(end):
+    """Possible names of the event beginning the interval ended by `end`"""
+    if end in ("STOP", "END"):
+        return ["START", "BEGIN"]
+    for suffix in END_SUFFIXES:
+        if end.endswith(suffix):
+            base = end[:-len(suffix)]
+            return [base + b for b in BEGIN_SUFFIXES if base + b != end]
+    return []
+
+
+def percentile(values, p):
+    return values[min(len(values) - 1, int(len(values) * p / 100.0))]
+
+
+def print_histogram(name, values, unit):
+    values.sort()
+    print("  %-40s n=%-8d min %-8d p50 %-8d p99 %-8d max %d %s"
+          % (name, len(values), values[0], percentile(values, 50),
+             percentile(values, 99), values[-1], unit))
+    buckets = {}
+    for v in values:
+        b = max(v, 1).bit_length() - 1
+        buckets[b] = buckets.get(b, 0) + 1
+    most = max(buckets.values())
+    for b in range(min(buckets), max(buckets) + 1):
+        n = buckets.get(b, 0)
+        print("    %10d .. %-10d %8d %s"
+              % (1 << b, (2 << b) - 1, n, "#" * (n * 50 // most)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode a streamed trace")
+    parser.add_argument("trace", help="streamed trace file")
+    parser.add_argument("--pleco", default=DEFAULT_PLECO,
+                        help="trace definitions (default: %(default)s)")
+    parser.add_argument("--events", action="store_true",
+                        help="print all decoded events")
+    parser.add_argument("--subsys", action="append",
+                        help="only report on the given subsystem(s)")
+    parser.add_argument("--cycles", action="store_true",
+                        help="report latencies in cycles, not nanoseconds")
+    args = parser.parse_args()
+
+    defs = parse_pleco(args.pleco)
+
+    def subsys_name(s):
+        return defs[s][0] if s in defs else "%#06x" % s
+
+    def event_name(s, e):
+        if s in defs and e in defs[s][1]:
+            return defs[s][1][e]
+        return "%#06x" % e
+
+    open_intervals = {}  # (core, subsys, event name) -> [begin timestamps]
+    latencies = {}       # subsys -> {interval name: [latencies]}
+    counts = {}          # subsys -> number of events
+    lost = {}            # core -> events lost
+    drained = {}         # core -> events received
+    header = None
+
+    for header, chunk, events in read_stream(args.trace):
+        core = chunk["core"]
+        lost[core] = chunk["lost"]
+        drained[core] = drained.get(core, 0) + len(events)
+        for ts, s, e, arg in events:
+            counts[s] = counts.get(s, 0) + 1
+            name = event_name(s, e)
+            if args.events:
+                print("%d %d %-12s %-32s %#x"
+                      % (core, ts, subsys_name(s), name, arg))
+            for begin in begin_names(name):
+                stack = open_intervals.get((core, s, begin))
+                if stack:
+                    interval = "%s -> %s" % (begin, name)
+                    latencies.setdefault(s, {}).setdefault(interval, []) \
+                        .append(ts - stack.pop())
+                    break
+            else:
+                stack = open_intervals.setdefault((core, s, name), [])
+                stack.append(ts)
+                # most events never end an interval, don't keep them all
+                if len(stack) > MAX_NESTING:
+                    del stack[0]
+
+    if header is None:
+        print("no events in %s" % args.trace)
+        return
+
+    scale, unit = 1.0, "cycles"
+    if not args.cycles and header["tsc_per_ms"] > 0:
+        scale, unit = 1e6 / header["tsc_per_ms"], "ns"
+
+    print("# core    events      lost")
+    for core in sorted(drained):
+        print("  %-4d %9d %9d" % (core, drained[core], lost[core]))
+
+    for s in sorted(counts):
+        name = subsys_name(s)
+        if args.subsys and name not in args.subsys:
+            continue
+        print("\n# subsystem %s: %d events" % (name, counts[s]))
+        for interval in sorted(latencies.get(s, {})):
+            values = [int(v * scale) for v in latencies[s][interval]]
+            print_histogram(interval, values, unit)
+
+
+if __name__ == "__main__":
+    main()
@@ -19,7 +19,7 @@
 #include <vfs/vfs.h>
 
 #include "bcached.h"
-#include <hashtable/hashtable.h>
+#include <hashtable/rh_hashtable.h>
 
 struct waitlist {
     struct waitlist *next;
@@ -42,7 +42,7 @@ struct lru_queue {
 struct capref cache_memory;
 size_t cache_size, block_size = BUFFER_CACHE_BLOCK_SIZE;
 void *cache_pool;
-static struct hashtable *cache_hash = NULL;
+static struct rh_hashtable *cache_hash = NULL;
 static struct lru_queue *lru_start, *lru_end, *lru;
 static size_t partial_hits = 0, hits = 0, misses = 0, allocations = 0, evictions = 0;
 
@@ -230,7 +230,7 @@ uintptr_t cache_allocate(const char *key, size_t key_len)
     e->block_length = 0;
     e->waiters.start = e->waiters.end = NULL;
 
-    int r = cache_hash->d.put_word(&cache_hash->d, key, key_len, e->index);
+    int r = cache_hash->d.put_word(&cache_hash->d, e->key, key_len, e->index);
     assert(r == 0);
 
     // Convert to byte offset from start of cache
@@ -301,7 +301,7 @@ int main(int argc, char *argv[])
         USER_PANIC_ERR(err, "create_cache_mem");
     }
 
-    cache_hash = create_hashtable2(2 * NUM_BLOCKS, 75);
+    cache_hash = create_rh_hashtable2(NUM_BLOCKS, 85);
     assert(cache_hash != NULL);
 
     lru_init();
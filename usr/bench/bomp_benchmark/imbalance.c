@@ -0,0 +1,193 @@
+/**
+ * \file
+ * \brief libbomp loop scheduling benchmark
+ *
+ * Runs loops whose iterations take different amounts of time with the
+ * static, dynamic and guided schedules and reports the time each takes, to
+ * show how much the dynamic schedules gain over static partitioning on
+ * imbalanced loops and what they cost on balanced ones.
+ *
+ * Usage: bomp_benchmark_imbalance <nthreads> [iterations]
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#include <stdio.h>
+#include <omp.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <assert.h>
+
+#ifdef POSIX
+static inline uint64_t rdtsc(void)
+{
+    uint32_t eax, edx;
+    __asm volatile ("rdtsc" : "=a" (eax), "=d" (edx));
+    return ((uint64_t)edx << 32) | eax;
+}
+#else
+#include <barrelfish/barrelfish.h>
+#endif
+
+#define DEFAULT_ITERATIONS 100000
+
+/// average cost of an iteration in rounds of work()
+#define UNIT 200
+
+#define RUNS 5
+
+enum workload {
+    WORKLOAD_BALANCED,      ///< every iteration costs the same
+    WORKLOAD_TRIANGULAR,    ///< iteration i costs proportional to i
+    WORKLOAD_SPIKES,        ///< a few random iterations cost a lot more
+};
+
+static const char *workload_names[] = {
+    [WORKLOAD_BALANCED]   = "balanced",
+    [WORKLOAD_TRIANGULAR] = "triangular",
+    [WORKLOAD_SPIKES]     = "spikes",
+};
+
+static long niters;
+static uint32_t *cost;
+static volatile uint64_t *result;
+
+static void make_costs(enum workload w)
+{
+    uint32_t seed = 42;
+
+    for (long i = 0; i < niters; i++) {
+        switch (w) {
+        case WORKLOAD_BALANCED:
+            cost[i] = UNIT;
+            break;
+        case WORKLOAD_TRIANGULAR:
+            cost[i] = (uint32_t)(2 * UNIT * i / niters);
+            break;
+        case WORKLOAD_SPIKES:
+            seed = seed * 1103515245 + 12345;
+            /* 2% of the iterations are 40 times as expensive */
+            cost[i] = ((seed >> 16) % 100 < 2) ? 40 * UNIT : UNIT / 5;
+            break;
+        }
+    }
+}
+
+static inline void work(long i)
+{
+    uint64_t x = i;
+    for (uint32_t r = 0; r < cost[i]; r++) {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+    result[i] = x;
+}
+
+static uint64_t run_static(void)
+{
+    uint64_t start = rdtsc();
+#pragma omp parallel for schedule(static)
+    for (long i = 0; i < niters; i++) {
+        work(i);
+    }
+    return rdtsc() - start;
+}
+
+static uint64_t run_dynamic_1(void)
+{
+    uint64_t start = rdtsc();
+#pragma omp parallel for schedule(dynamic)
+    for (long i = 0; i < niters; i++) {
+        work(i);
+    }
+    return rdtsc() - start;
+}
+
+static uint64_t run_dynamic_64(void)
+{
+    uint64_t start = rdtsc();
+#pragma omp parallel for schedule(dynamic, 64)
+    for (long i = 0; i < niters; i++) {
+        work(i);
+    }
+    return rdtsc() - start;
+}
+
+static uint64_t run_guided(void)
+{
+    uint64_t start = rdtsc();
+#pragma omp parallel for schedule(guided)
+    for (long i = 0; i < niters; i++) {
+        work(i);
+    }
+    return rdtsc() - start;
+}
+
+static struct {
+    const char *name;
+    uint64_t (*run)(void);
+} schedules[] = {
+    { "static", run_static },
+    { "dynamic,1", run_dynamic_1 },
+    { "dynamic,64", run_dynamic_64 },
+    { "guided", run_guided },
+};
+#define NSCHEDULES (sizeof(schedules) / sizeof(schedules[0]))
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        printf("Usage: %s <nthreads> [iterations]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int nthreads = atoi(argv[1]);
+    niters = DEFAULT_ITERATIONS;
+    if (argc > 2) {
+        niters = atol(argv[2]);
+    }
+
+#ifndef POSIX
+    bomp_init(nthreads);
+#endif
+    omp_set_num_threads(nthreads);
+
+    cost = malloc(niters * sizeof(*cost));
+    result = malloc(niters * sizeof(*result));
+    assert(cost != NULL && result != NULL);
+
+    for (int w = WORKLOAD_BALANCED; w <= WORKLOAD_SPIKES; w++) {
+        make_costs(w);
+
+        uint64_t base = 0;
+        for (size_t s = 0; s < NSCHEDULES; s++) {
+            uint64_t best = UINT64_MAX;
+            for (int r = 0; r < RUNS; r++) {
+                uint64_t t = schedules[s].run();
+                if (t < best) {
+                    best = t;
+                }
+            }
+            if (s == 0) {
+                base = best;
+            }
+            printf("imbalance: %-10s %-10s threads %2d: %12" PRIu64 " cycles, "
+                   "speedup over static %3" PRIu64 ".%02" PRIu64 "\n",
+                   workload_names[w], schedules[s].name, nthreads, best,
+                   base / best, (base * 100 / best) % 100);
+        }
+    }
+
+    free(cost);
+    free((void *)result);
+
+    printf("imbalance: done\n");
+    return EXIT_SUCCESS;
+}
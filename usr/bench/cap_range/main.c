@@ -0,0 +1,224 @@
+/**
+ * \file
+ * \brief Capability range invocation benchmark
+ *
+ * Copies a number of capabilities spread over L2 CNodes and deletes them
+ * again, once one capability per invocation and once with the range
+ * invocations. Then spawns a child domain whose argument CNode is filled
+ * either way and waits for it to exit, measuring the whole setup.
+ *
+ * Usage: cap_range_bench [caps [rounds]]
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <barrelfish/barrelfish.h>
+#include <barrelfish/spawn_client.h>
+#include <barrelfish/sys_debug.h>
+#include <bench/bench.h>
+
+#define DEFAULT_CAPS    10000
+#define DEFAULT_ROUNDS  10
+
+static size_t ncaps, ncnodes;
+static struct cnoderef *src, *dst;
+static uint64_t tscperms;
+
+static struct capref slot_of(struct cnoderef *cnodes, size_t i)
+{
+    return (struct capref) {
+        .cnode = cnodes[i / L2_CNODE_SLOTS],
+        .slot = i % L2_CNODE_SLOTS,
+    };
+}
+
+static size_t chunk_of(size_t i)
+{
+    size_t n = ncaps - i;
+    return n < L2_CNODE_SLOTS ? n : L2_CNODE_SLOTS;
+}
+
+static void copy_caps(bool range)
+{
+    errval_t err;
+
+    if (range) {
+        for (size_t i = 0; i < ncaps; i += L2_CNODE_SLOTS) {
+            err = cap_copy_range(slot_of(dst, i), slot_of(src, i), chunk_of(i),
+                                 NULL);
+            if (err_is_fail(err)) {
+                USER_PANIC_ERR(err, "cap_copy_range");
+            }
+        }
+    } else {
+        for (size_t i = 0; i < ncaps; i++) {
+            err = cap_copy(slot_of(dst, i), slot_of(src, i));
+            if (err_is_fail(err)) {
+                USER_PANIC_ERR(err, "cap_copy");
+            }
+        }
+    }
+}
+
+static void delete_caps(bool range)
+{
+    errval_t err;
+
+    if (range) {
+        for (size_t i = 0; i < ncaps; i += L2_CNODE_SLOTS) {
+            err = cap_delete_range(slot_of(dst, i), chunk_of(i));
+            if (err_is_fail(err)) {
+                USER_PANIC_ERR(err, "cap_delete_range");
+            }
+        }
+    } else {
+        for (size_t i = 0; i < ncaps; i++) {
+            err = cap_delete(slot_of(dst, i));
+            if (err_is_fail(err)) {
+                USER_PANIC_ERR(err, "cap_delete");
+            }
+        }
+    }
+}
+
+static void spawn_child(const char *path, bool range)
+{
+    errval_t err;
+    struct capref argcn_cap, domain_cap;
+    struct cnoderef argcn;
+    uint8_t exitcode;
+
+    err = cnode_create_l2(&argcn_cap, &argcn);
+    if (err_is_fail(err)) {
+        USER_PANIC_ERR(err, "cnode_create_l2");
+    }
+
+    size_t n = ncaps < L2_CNODE_SLOTS ? ncaps : L2_CNODE_SLOTS;
+    struct capref to = { .cnode = argcn, .slot = 0 };
+    err = SYS_ERR_OK;
+    if (range) {
+        err = cap_copy_range(to, slot_of(src, 0), n, NULL);
+    } else {
+        for (; to.slot < n && err_is_ok(err); to.slot++) {
+            err = cap_copy(to, slot_of(src, to.slot));
+        }
+    }
+    if (err_is_fail(err)) {
+        USER_PANIC_ERR(err, "filling argcn");
+    }
+
+    char *argv[] = { (char *)path, "child", NULL };
+    err = spawn_program_with_caps(disp_get_core_id(), path, argv, NULL,
+                                  NULL_CAP, argcn_cap, SPAWN_FLAGS_DEFAULT,
+                                  &domain_cap);
+    if (err_is_fail(err)) {
+        USER_PANIC_ERR(err, "spawn_program_with_caps");
+    }
+    err = spawn_wait(domain_cap, &exitcode, false);
+    if (err_is_fail(err)) {
+        USER_PANIC_ERR(err, "spawn_wait");
+    }
+
+    err = cap_destroy(argcn_cap);
+    if (err_is_fail(err)) {
+        USER_PANIC_ERR(err, "cap_destroy");
+    }
+}
+
+static void report(const char *name, bool range, cycles_t *t, size_t rounds,
+                   size_t ops)
+{
+    cycles_t sum = 0, min = t[0];
+    for (size_t r = 0; r < rounds; r++) {
+        sum += t[r];
+        if (t[r] < min) {
+            min = t[r];
+        }
+    }
+    double avg_us = (double)sum * 1000 / rounds / tscperms;
+    printf("%-6s %-6s caps=%zu: avg %10.1f us, min %10.1f us, %8.1f ns/cap\n",
+           name, range ? "range" : "single", ops, avg_us,
+           (double)min * 1000 / tscperms, avg_us * 1000 / ops);
+}
+
+int main(int argc, char *argv[])
+{
+    errval_t err;
+
+    if (argc > 1 && strcmp(argv[1], "child") == 0) {
+        return EXIT_SUCCESS;
+    }
+
+    ncaps = argc > 1 ? strtoul(argv[1], NULL, 0) : DEFAULT_CAPS;
+    size_t rounds = argc > 2 ? strtoul(argv[2], NULL, 0) : DEFAULT_ROUNDS;
+    if (ncaps == 0 || rounds == 0) {
+        printf("Usage: %s [caps [rounds]]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    ncnodes = (ncaps + L2_CNODE_SLOTS - 1) / L2_CNODE_SLOTS;
+
+    err = sys_debug_get_tsc_per_ms(&tscperms);
+    assert(err_is_ok(err));
+    bench_init();
+
+    src = malloc(ncnodes * sizeof(*src));
+    dst = malloc(ncnodes * sizeof(*dst));
+    cycles_t *t = malloc(rounds * sizeof(*t));
+    assert(src != NULL && dst != NULL && t != NULL);
+    for (size_t i = 0; i < ncnodes; i++) {
+        struct capref cnode_cap;
+        err = cnode_create_l2(&cnode_cap, &src[i]);
+        assert(err_is_ok(err));
+        err = cnode_create_l2(&cnode_cap, &dst[i]);
+        assert(err_is_ok(err));
+    }
+
+    // fill the source CNodes with copies of a single frame
+    struct capref frame;
+    err = frame_alloc(&frame, BASE_PAGE_SIZE, NULL);
+    if (err_is_fail(err)) {
+        USER_PANIC_ERR(err, "frame_alloc");
+    }
+    for (size_t i = 0; i < ncaps; i++) {
+        err = cap_copy(slot_of(src, i), frame);
+        assert(err_is_ok(err));
+    }
+
+    for (int range = 0; range <= 1; range++) {
+        cycles_t tcopy[rounds];
+        for (size_t r = 0; r < rounds; r++) {
+            cycles_t start = bench_tsc();
+            copy_caps(range);
+            cycles_t mid = bench_tsc();
+            delete_caps(range);
+            cycles_t end = bench_tsc();
+            tcopy[r] = bench_time_diff(start, mid);
+            t[r] = bench_time_diff(mid, end);
+        }
+        report("copy", range, tcopy, rounds, ncaps);
+        report("delete", range, t, rounds, ncaps);
+    }
+
+    size_t nargs = ncaps < L2_CNODE_SLOTS ? ncaps : L2_CNODE_SLOTS;
+    for (int range = 0; range <= 1; range++) {
+        for (size_t r = 0; r < rounds; r++) {
+            cycles_t start = bench_tsc();
+            spawn_child(argv[0], range);
+            t[r] = bench_time_diff(start, bench_tsc());
+        }
+        report("spawn", range, t, rounds, nargs);
+    }
+
+    printf("cap_range_bench done.\n");
+    return EXIT_SUCCESS;
+}
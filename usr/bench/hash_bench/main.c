@@ -0,0 +1,212 @@
+/**
+ * \file
+ * \brief Collections hash table benchmark
+ *
+ * Compares the open-addressing collections hash table with the previous
+ * chained implementation (old_hash_table.c). Both are created with the
+ * bucket count the octopus index uses and filled with keys as octopus
+ * generates them (64-bit FNV-1a hashes of record names such as
+ * "hw.pci.device.17") and as the multihop and process tables use them
+ * (small sequential integers). Reports insert, hit, miss and delete cost.
+ *
+ * Usage: hash_bench [max_entries]
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <barrelfish/barrelfish.h>
+#include <collections/hash_table.h>
+
+#include <bench/bench.h>
+
+#include "old_hash_table.h"
+
+#define DEFAULT_MAX_ENTRIES 100000
+
+// bucket count of the octopus record index (usr/skb/octopus/predicates.c)
+#define OCTOPUS_BUCKETS 6151
+
+#define EXPECT_NONNULL(ptr, msg) \
+    if ((ptr) == NULL) {USER_PANIC(msg);}
+
+enum variant {
+    VARIANT_OLD,
+    VARIANT_NEW,
+};
+
+static const char *variant_names[] = {
+    [VARIANT_OLD] = "chained",
+    [VARIANT_NEW] = "inline",
+};
+
+enum keys {
+    KEYS_OCTOPUS,
+    KEYS_SEQUENTIAL,
+};
+
+static const char *key_names[] = {
+    [KEYS_OCTOPUS]    = "octopus",
+    [KEYS_SEQUENTIAL] = "sequential",
+};
+
+// record name prefixes seen in a typical octopus instance
+static const char *record_prefixes[] = {
+    "hw.pci.device.", "hw.apic.", "hw.processor.", "spawn.", "nameservice.",
+    "dist.barrier.", "hw.pci.rootbridge.", "int_src.", "ioapic.", "domain.",
+};
+#define NPREFIXES (sizeof(record_prefixes) / sizeof(record_prefixes[0]))
+
+// the 2n keys: the first n are inserted, the others are used for misses
+static uint64_t *keys;
+static size_t *order;
+
+/// 64-bit FNV-1a, as used by octopus for its index keys
+static uint64_t fnv_64a_str(const char *str)
+{
+    uint64_t hval = 0xcbf29ce484222325ULL;
+    while (*str) {
+        hval ^= (uint64_t)*str++;
+        hval *= 0x100000001b3ULL;
+    }
+    return hval;
+}
+
+static void make_keys(enum keys kind, size_t n)
+{
+    char name[64];
+
+    for (size_t i = 0; i < n; i++) {
+        if (kind == KEYS_OCTOPUS) {
+            snprintf(name, sizeof(name), "%s%zu",
+                     record_prefixes[i % NPREFIXES], i / NPREFIXES);
+            keys[i] = fnv_64a_str(name);
+        } else {
+            keys[i] = i + 1;
+        }
+    }
+}
+
+static void print_result(enum variant v, enum keys k, size_t n,
+                         const char *op, cycles_t cycles)
+{
+    printf("%-8s %-10s n=%-8zu %-7s %8"PRIuCYCLES" cycles/op\n",
+           variant_names[v], key_names[k], n, op, cycles / n);
+}
+
+static void run(enum variant v, enum keys k, size_t n)
+{
+    collections_hash_table *nt = NULL;
+    old_hash_table *ot = NULL;
+    cycles_t start, end;
+    void *data;
+
+    if (v == VARIANT_OLD) {
+        old_hash_create_with_buckets(&ot, OCTOPUS_BUCKETS);
+    } else {
+        collections_hash_create_with_buckets(&nt, OCTOPUS_BUCKETS, NULL);
+    }
+
+    start = bench_tsc();
+    for (size_t i = 0; i < n; i++) {
+        data = (void *)(keys + i);
+        if (v == VARIANT_OLD) {
+            old_hash_insert(ot, keys[i], data);
+        } else {
+            collections_hash_insert(nt, keys[i], data);
+        }
+    }
+    end = bench_tsc();
+    print_result(v, k, n, "insert", bench_time_diff(start, end));
+
+    start = bench_tsc();
+    for (size_t i = 0; i < n; i++) {
+        size_t idx = order[i];
+        if (v == VARIANT_OLD) {
+            data = old_hash_find(ot, keys[idx]);
+        } else {
+            data = collections_hash_find(nt, keys[idx]);
+        }
+        if (data != (void *)(keys + idx)) {
+            USER_PANIC("lookup of key %zu failed", idx);
+        }
+    }
+    end = bench_tsc();
+    print_result(v, k, n, "hit", bench_time_diff(start, end));
+
+    // with octopus keys, a colliding hash among the misses is possible but
+    // vanishingly unlikely, so we don't check the result here
+    start = bench_tsc();
+    for (size_t i = 0; i < n; i++) {
+        if (v == VARIANT_OLD) {
+            old_hash_find(ot, keys[n + order[i]]);
+        } else {
+            collections_hash_find(nt, keys[n + order[i]]);
+        }
+    }
+    end = bench_tsc();
+    print_result(v, k, n, "miss", bench_time_diff(start, end));
+
+    start = bench_tsc();
+    for (size_t i = 0; i < n; i++) {
+        if (v == VARIANT_OLD) {
+            old_hash_delete(ot, keys[order[i]]);
+        } else {
+            collections_hash_delete(nt, keys[order[i]]);
+        }
+    }
+    end = bench_tsc();
+    print_result(v, k, n, "delete", bench_time_diff(start, end));
+
+    if (v == VARIANT_OLD) {
+        assert(ot->num_elems == 0);
+        old_hash_release(ot);
+    } else {
+        assert(collections_hash_size(nt) == 0);
+        collections_hash_release(nt);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    size_t max_entries = DEFAULT_MAX_ENTRIES;
+
+    if (!bench_size_arg(argc, argv, "max_entries", 1000, &max_entries)) {
+        return EXIT_FAILURE;
+    }
+
+    bench_init();
+
+    keys = malloc(2 * max_entries * sizeof(uint64_t));
+    EXPECT_NONNULL(keys, "no memory for keys");
+    order = malloc(max_entries * sizeof(size_t));
+    EXPECT_NONNULL(order, "no memory for lookup order");
+
+    srand(42);
+    for (enum keys k = KEYS_OCTOPUS; k <= KEYS_SEQUENTIAL; k++) {
+        make_keys(k, 2 * max_entries);
+        for (size_t n = 1000; n <= max_entries; n *= 10) {
+            for (size_t i = 0; i < n; i++) {
+                order[i] = i;
+            }
+            bench_shuffle(order, n, sizeof(*order));
+
+            run(VARIANT_OLD, k, n);
+            run(VARIANT_NEW, k, n);
+        }
+    }
+
+    free(keys);
+    free(order);
+
+    printf("hash_bench done.\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,85 @@
+/**
+ * \file
+ * \brief Previous (chained, fixed size) collections hash table, kept for
+ *  comparison.
+ */
+
+/*
+ * Copyright (c) 2010, 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#include <barrelfish/barrelfish.h>
+
+#include "old_hash_table.h"
+
+static int32_t match_key(void *data, void *arg)
+{
+    old_hash_elem *elem = (old_hash_elem *) data;
+    uint64_t key  = *((uint64_t *)arg);
+
+    return (elem->key == key);
+}
+
+void old_hash_create_with_buckets(old_hash_table **t, int num_buckets)
+{
+    *t = malloc(sizeof(old_hash_table));
+    assert(*t != NULL);
+
+    (*t)->num_buckets = num_buckets;
+    (*t)->buckets = malloc(sizeof(collections_listnode *) * num_buckets);
+    assert((*t)->buckets != NULL);
+    for (int i = 0; i < num_buckets; i ++) {
+        collections_list_create(&(*t)->buckets[i], free);
+    }
+    (*t)->num_elems = 0;
+}
+
+void old_hash_release(old_hash_table *t)
+{
+    for (int i = 0; i < t->num_buckets; i ++) {
+        // frees the elements through the list's data_free
+        collections_list_release(t->buckets[i]);
+    }
+    free(t->buckets);
+    free(t);
+}
+
+static old_hash_elem *old_hash_find_elem(old_hash_table *t, uint64_t key)
+{
+    collections_listnode *bucket = t->buckets[key % t->num_buckets];
+    return collections_list_find_if(bucket, match_key, &key);
+}
+
+void old_hash_insert(old_hash_table *t, uint64_t key, void *data)
+{
+    old_hash_elem *elem = old_hash_find_elem(t, key);
+    assert(elem == NULL);
+
+    elem = malloc(sizeof(old_hash_elem));
+    assert(elem != NULL);
+    elem->key = key;
+    elem->data = data;
+    collections_list_insert(t->buckets[key % t->num_buckets], elem);
+    t->num_elems ++;
+}
+
+void *old_hash_find(old_hash_table *t, uint64_t key)
+{
+    old_hash_elem *elem = old_hash_find_elem(t, key);
+    return elem ? elem->data : NULL;
+}
+
+void old_hash_delete(old_hash_table *t, uint64_t key)
+{
+    collections_listnode *bucket = t->buckets[key % t->num_buckets];
+    old_hash_elem *elem = collections_list_remove_if(bucket, match_key, &key);
+    if (elem != NULL) {
+        free(elem);
+        t->num_elems--;
+    }
+}
@@ -0,0 +1,38 @@
+/**
+ * \file
+ * \brief Previous (chained, fixed size) collections hash table, kept for
+ *  comparison.
+ */
+
+/*
+ * Copyright (c) 2010, 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#ifndef HASH_BENCH_OLD_HASH_TABLE_H
+#define HASH_BENCH_OLD_HASH_TABLE_H
+
+#include <collections/list.h>
+
+typedef struct old_hash_table {
+    int num_buckets;
+    collections_listnode **buckets;
+    uint32_t num_elems;
+} old_hash_table;
+
+typedef struct old_hash_elem {
+    uint64_t key;
+    void *data;
+} old_hash_elem;
+
+void old_hash_create_with_buckets(old_hash_table **t, int num_buckets);
+void old_hash_release(old_hash_table *t);
+void old_hash_insert(old_hash_table *t, uint64_t key, void *data);
+void *old_hash_find(old_hash_table *t, uint64_t key);
+void old_hash_delete(old_hash_table *t, uint64_t key);
+
+#endif
@@ -0,0 +1,185 @@
+/**
+ * \file
+ * \brief Hashtable benchmark
+ *
+ * Compares insert and lookup throughput and the memory footprint of the
+ * chained hashtable (create_hashtable2) with the open-addressing robin hood
+ * hashtable (create_rh_hashtable) at increasing numbers of entries. The
+ * chained table is created with its final size, as it never grows; the robin
+ * hood table starts small and grows incrementally.
+ *
+ * Usage: hashtable_bench [max_entries]
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <barrelfish/barrelfish.h>
+#include <hashtable/hashtable.h>
+#include <hashtable/rh_hashtable.h>
+
+#include <bench/bench.h>
+
+#define DEFAULT_MAX_ENTRIES 1000000
+
+// length of the generated keys, bcached-style block names
+#define KEY_LEN 16
+
+#define EXPECT_NONNULL(ptr, msg) \
+    if ((ptr) == NULL) {USER_PANIC(msg);}
+
+enum variant {
+    VARIANT_CHAINED,
+    VARIANT_ROBINHOOD,
+};
+
+static const char *variant_names[] = {
+    [VARIANT_CHAINED]   = "chained",
+    [VARIANT_ROBINHOOD] = "robinhood",
+};
+
+static char *keys;
+static size_t *order;
+
+static inline const char *key(size_t i)
+{
+    return &keys[i * KEY_LEN];
+}
+
+/// Free a chained hashtable; the library has no destructor for it
+static void chained_destroy(struct hashtable *ht)
+{
+    for (int i = 0; i < ht->table_length; i++) {
+        struct _ht_entry *e = ht->entries[i];
+        while (e != NULL) {
+            struct _ht_entry *next = e->next;
+            free(e);
+            e = next;
+        }
+    }
+    free(ht->entries);
+    free(ht);
+}
+
+static size_t chained_footprint(struct hashtable *ht)
+{
+    // ht_init allocates table_length entries for the bucket array
+    return sizeof(struct hashtable)
+        + ht->table_length * sizeof(struct _ht_entry)
+        + ht->entry_count * sizeof(struct _ht_entry);
+}
+
+static void print_result(enum variant v, size_t n, const char *op,
+                         cycles_t cycles)
+{
+    uint64_t us = bench_tsc_to_us(cycles);
+    printf("%-9s n=%-9zu %-7s %6"PRIuCYCLES" cycles/op %8"PRIu64" kops/s\n",
+           variant_names[v], n, op, cycles / n,
+           us > 0 ? (uint64_t)n * 1000 / us : 0);
+}
+
+static void run(enum variant v, size_t n)
+{
+    struct dictionary *d;
+    struct hashtable *cht = NULL;
+    struct rh_hashtable *rht = NULL;
+    cycles_t start, end;
+    void *val;
+
+    if (v == VARIANT_CHAINED) {
+        cht = create_hashtable2(n, 75);
+        EXPECT_NONNULL(cht, "create_hashtable2 failed");
+        d = &cht->d;
+    } else {
+        rht = create_rh_hashtable();
+        EXPECT_NONNULL(rht, "create_rh_hashtable failed");
+        d = &rht->d;
+    }
+
+    // insert keys 0..n-1
+    start = bench_tsc();
+    for (size_t i = 0; i < n; i++) {
+        if (d->put_word(d, key(i), KEY_LEN, i) != 0) {
+            USER_PANIC("put_word failed");
+        }
+    }
+    end = bench_tsc();
+    print_result(v, n, "insert", bench_time_diff(start, end));
+
+    // look them up in random order
+    start = bench_tsc();
+    for (size_t i = 0; i < n; i++) {
+        ENTRY_TYPE t = d->get(d, key(order[i]), KEY_LEN, &val);
+        if (t != TYPE_WORD || (uintptr_t)val != order[i]) {
+            USER_PANIC("lookup of key %zu failed", order[i]);
+        }
+    }
+    end = bench_tsc();
+    print_result(v, n, "hit", bench_time_diff(start, end));
+
+    // keys n..2n-1 are not in the table
+    start = bench_tsc();
+    for (size_t i = 0; i < n; i++) {
+        if (d->get(d, key(n + order[i]), KEY_LEN, &val) != 0) {
+            USER_PANIC("lookup of missing key %zu succeeded", n + order[i]);
+        }
+    }
+    end = bench_tsc();
+    print_result(v, n, "miss", bench_time_diff(start, end));
+
+    size_t bytes;
+    if (v == VARIANT_CHAINED) {
+        bytes = chained_footprint(cht);
+        chained_destroy(cht);
+    } else {
+        bytes = rh_hashtable_footprint(rht);
+        rh_hashtable_destroy(rht);
+    }
+    printf("%-9s n=%-9zu memory  %zu bytes, %zu bytes/entry\n",
+           variant_names[v], n, bytes, bytes / n);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t max_entries = DEFAULT_MAX_ENTRIES;
+
+    if (!bench_size_arg(argc, argv, "max_entries", 10000, &max_entries)) {
+        return EXIT_FAILURE;
+    }
+
+    bench_init();
+
+    keys = malloc(2 * max_entries * KEY_LEN);
+    EXPECT_NONNULL(keys, "no memory for keys");
+    order = malloc(max_entries * sizeof(size_t));
+    EXPECT_NONNULL(order, "no memory for lookup order");
+
+    for (size_t i = 0; i < 2 * max_entries; i++) {
+        snprintf(&keys[i * KEY_LEN], KEY_LEN, "blk-%011zu", i);
+    }
+
+    srand(42);
+    for (size_t n = 10000; n <= max_entries; n *= 10) {
+        for (size_t i = 0; i < n; i++) {
+            order[i] = i;
+        }
+        bench_shuffle(order, n, sizeof(*order));
+
+        run(VARIANT_CHAINED, n);
+        run(VARIANT_ROBINHOOD, n);
+    }
+
+    free(keys);
+    free(order);
+
+    printf("hashtable_bench done.\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,174 @@
+/**
+ * \file
+ * \brief Large page promotion benchmark
+ *
+ * Grows two anonymous regions the way morecore grows the heap, one with and
+ * one without large page promotion, and chases pointers through one word per
+ * base page in random order. The working set covers far more base pages than
+ * the TLB holds, so the run time is dominated by TLB misses. A third run
+ * protects a single page of the promoted region, which demotes the frame
+ * holding it. Prints the promotion counters of each region and of the heap.
+ *
+ * Usage: largepage_promote_bench [region_mb]
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <barrelfish/barrelfish.h>
+#include <barrelfish/vspace_mmu_aware.h>
+#include <barrelfish/morecore.h>
+
+#include <bench/bench.h>
+
+#define DEFAULT_REGION_MB 256
+#define MIN_REGION_MB     16
+
+// morecore asks for at least this much at a time
+#define GROW_STEP (16UL * 1024 * 1024)
+
+#define ACCESSES  (1UL << 24)
+#define RUN_COUNT 5
+
+#define EXPECT_SUCCESS(err, msg) \
+    if (err_is_fail(err)) {USER_PANIC_ERR(err, msg);}
+#define EXPECT_NONNULL(ptr, msg) \
+    if ((ptr) == NULL) {USER_PANIC(msg);}
+
+static struct vspace_mmu_aware regions[2];
+static size_t *order;
+static void * volatile sink;
+
+/// Address of the word of page \p i that is part of the chain
+static inline void **slot(uint8_t *base, size_t i)
+{
+    // spread the words over the cache sets
+    return (void **)(base + i * BASE_PAGE_SIZE + (i % 64) * 64);
+}
+
+static uint8_t *grow(struct vspace_mmu_aware *state, size_t bytes, bool promote)
+{
+    errval_t err;
+    void *buf;
+    size_t retsize;
+
+    err = vspace_mmu_aware_init_aligned(state, NULL, 2 * bytes,
+                                        LARGE_PAGE_SIZE,
+                                        VREGION_FLAGS_READ_WRITE);
+    EXPECT_SUCCESS(err, "vspace_mmu_aware_init_aligned");
+    vspace_mmu_aware_set_promote(state, promote);
+
+    // start off a large page boundary, as a heap in use for a while would
+    err = vspace_mmu_aware_map(state, BASE_PAGE_SIZE, &buf, &retsize);
+    EXPECT_SUCCESS(err, "vspace_mmu_aware_map");
+
+    uint8_t *base = NULL;
+    size_t mapped = 0;
+    while (mapped < bytes) {
+        err = vspace_mmu_aware_map(state, GROW_STEP, &buf, &retsize);
+        EXPECT_SUCCESS(err, "vspace_mmu_aware_map");
+        if (base == NULL) {
+            base = buf;
+        }
+        mapped += retsize;
+    }
+
+    return base;
+}
+
+static void make_chain(uint8_t *base, size_t pages)
+{
+    for (size_t i = 0; i < pages; i++) {
+        *slot(base, order[i]) = slot(base, order[(i + 1) % pages]);
+    }
+}
+
+static void chase(const char *name, uint8_t *base)
+{
+    cycles_t start, end, total = 0;
+
+    for (int r = 0; r < RUN_COUNT; r++) {
+        void **p = slot(base, order[0]);
+        start = bench_tsc();
+        for (size_t i = 0; i < ACCESSES; i++) {
+            p = *p;
+        }
+        end = bench_tsc();
+        sink = p;
+        total += bench_time_diff(start, end);
+    }
+
+    printf("%-9s %6"PRIuCYCLES" cycles/access\n", name,
+           total / RUN_COUNT / ACCESSES);
+}
+
+static void print_stats(const char *name, struct memobj_anon_promote_stats *s)
+{
+    printf("%-9s promoted %zu large pages, %zu base page frames, "
+           "%zu demoted, %zu allocation fallbacks\n", name, s->promoted,
+           s->base, s->demoted, s->alloc_fallbacks);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t region_mb = DEFAULT_REGION_MB;
+    errval_t err;
+
+    if (!bench_size_arg(argc, argv, "region_mb", MIN_REGION_MB, &region_mb)) {
+        return EXIT_FAILURE;
+    }
+
+    bench_init();
+
+    size_t bytes = region_mb * 1024 * 1024;
+    size_t pages = bytes / BASE_PAGE_SIZE;
+    order = malloc(pages * sizeof(size_t));
+    EXPECT_NONNULL(order, "no memory for access order");
+
+    srand(42);
+    for (size_t i = 0; i < pages; i++) {
+        order[i] = i;
+    }
+    bench_shuffle(order, pages, sizeof(*order));
+
+    printf("region of %zu MiB, %zu pages, %lu accesses, %d runs each\n",
+           region_mb, pages, ACCESSES, RUN_COUNT);
+
+    uint8_t *base = grow(&regions[0], bytes, false);
+    make_chain(base, pages);
+    chase("base", base);
+    print_stats("base", &regions[0].memobj.promote_stats);
+
+    uint8_t *promoted = grow(&regions[1], bytes, true);
+    make_chain(promoted, pages);
+    chase("promoted", promoted);
+    print_stats("promoted", &regions[1].memobj.promote_stats);
+
+    // protecting a single page demotes the frame that holds it
+    genvaddr_t off = vspace_lvaddr_to_genvaddr((lvaddr_t)promoted + bytes / 2)
+                     - vregion_get_base_addr(&regions[1].vregion);
+    err = regions[1].memobj.m.f.protect(&regions[1].memobj.m,
+                                        &regions[1].vregion,
+                                        ROUND_DOWN(off, BASE_PAGE_SIZE),
+                                        BASE_PAGE_SIZE, VREGION_FLAGS_READ);
+    EXPECT_SUCCESS(err, "protect");
+    chase("demoted", promoted);
+    print_stats("demoted", &regions[1].memobj.promote_stats);
+
+    struct memobj_anon_promote_stats heap;
+    morecore_get_promote_stats(&heap);
+    print_stats("heap", &heap);
+
+    free(order);
+
+    printf("largepage_promote_bench done.\n");
+    return EXIT_SUCCESS;
+}
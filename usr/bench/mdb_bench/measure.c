@@ -188,6 +188,34 @@ static cycles_t measure_query_address(struct cte *ctes, size_t count)
 
     return end - begin;
 }
+
+static cycles_t measure_query_range(struct cte *ctes, size_t count)
+{
+    for (int i = 0; i < count; i++) {
+        INS(&ctes[i]);
+    }
+
+    // randomly select a cap whose region to query
+    size_t pos, mod = 1;
+    while (mod < count) { mod <<= 1; }
+    do {
+        // assuming count is power-of-two
+        pos = rand() % mod;
+    } while (pos >= count);
+    genpaddr_t base = ctes[pos].cap.u.ram.base;
+    gensize_t bytes = ctes[pos].cap.u.ram.bytes;
+    mdb_root_t root = get_type_root(ObjType_RAM);
+    struct cte *result;
+    int ret;
+
+    __asm volatile ("" : : : "memory");
+
+    cycles_t begin = bench_tsc();
+    mdb_find_range(root, base, bytes, MDB_RANGE_FOUND_PARTIAL, &result, &ret);
+    cycles_t end = bench_tsc();
+
+    return end - begin;
+}
 #endif
 
 struct measure_opt measure_opts[] = {
@@ -202,6 +230,7 @@ struct measure_opt measure_opts[] = {
     { "has_descendants", measure_has_descendants, },
 #ifndef OLD_MDB
     { "query_address", measure_query_address, },
+    { "query_range", measure_query_range, },
 #endif
     { NULL, NULL, },
 };
@@ -0,0 +1,152 @@
+/**
+ * \file
+ * \brief RAM allocation latency benchmark
+ *
+ * Hammers the memory server with ram_alloc() requests of mixed sizes. A
+ * window of allocations is kept live and random caps from the window are
+ * deleted (which hands the RAM back to mem_serv through the monitor), so the
+ * allocator sees a fragmented, changing free space. Reports latency
+ * percentiles for the allocations and the frees.
+ *
+ * Usage: mem_alloc_bench [runs [minbits [maxbits [window]]]]
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <inttypes.h>
+
+#include <barrelfish/barrelfish.h>
+#include <bench/bench.h>
+
+#define DEFAULT_RUNS    10000
+#define DEFAULT_MINBITS BASE_PAGE_BITS
+#define DEFAULT_MAXBITS 22
+#define DEFAULT_WINDOW  256
+
+static int cycles_cmp(const void *a, const void *b)
+{
+    cycles_t x = *(const cycles_t *)a, y = *(const cycles_t *)b;
+    return (x > y) - (x < y);
+}
+
+/// Sort the samples and print the interesting percentiles
+static void print_percentiles(const char *label, cycles_t *samples, size_t n)
+{
+    static const unsigned permille[] = { 500, 900, 990, 999 };
+
+    qsort(samples, n, sizeof(cycles_t), cycles_cmp);
+
+    printf("%-6s n=%zu min=%"PRIuCYCLES, label, n, samples[0]);
+    for (size_t i = 0; i < sizeof(permille) / sizeof(permille[0]); i++) {
+        size_t idx = (n * permille[i]) / 1000;
+        if (idx >= n) {
+            idx = n - 1;
+        }
+        printf(" p%u.%u=%"PRIuCYCLES, permille[i] / 10, permille[i] % 10,
+               samples[idx]);
+    }
+    printf(" max=%"PRIuCYCLES" cycles (p50 %"PRIu64" us, p99 %"PRIu64" us)\n",
+           samples[n - 1], bench_tsc_to_us(samples[n / 2]),
+           bench_tsc_to_us(samples[(n * 99) / 100]));
+}
+
+/// Pick a size, geometrically biased towards small allocations
+static uint8_t pick_bits(uint8_t minbits, uint8_t maxbits)
+{
+    uint8_t bits = minbits;
+    while (bits < maxbits && (rand() & 1)) {
+        bits++;
+    }
+    return bits;
+}
+
+int main(int argc, char *argv[])
+{
+    errval_t err;
+    size_t runs = DEFAULT_RUNS, window = DEFAULT_WINDOW;
+    uint8_t minbits = DEFAULT_MINBITS, maxbits = DEFAULT_MAXBITS;
+
+    if (argc > 1) {
+        runs = strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2) {
+        minbits = strtoul(argv[2], NULL, 0);
+    }
+    if (argc > 3) {
+        maxbits = strtoul(argv[3], NULL, 0);
+    }
+    if (argc > 4) {
+        window = strtoul(argv[4], NULL, 0);
+    }
+    if (runs == 0 || window == 0 || minbits > maxbits) {
+        printf("Usage: %s [runs [minbits [maxbits [window]]]]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    bench_init();
+
+    struct capref *live = calloc(window, sizeof(struct capref));
+    cycles_t *alloc_cycles = calloc(runs, sizeof(cycles_t));
+    cycles_t *free_cycles = calloc(runs, sizeof(cycles_t));
+    if (live == NULL || alloc_cycles == NULL || free_cycles == NULL) {
+        USER_PANIC("out of memory for result buffers");
+    }
+
+    printf("mem_alloc_bench: runs=%zu bits=%u-%u window=%zu\n", runs, minbits,
+           maxbits, window);
+
+    srand(42);
+
+    /* fill the window */
+    for (size_t i = 0; i < window; i++) {
+        err = ram_alloc(&live[i], pick_bits(minbits, maxbits));
+        if (err_is_fail(err)) {
+            USER_PANIC_ERR(err, "ram_alloc while filling window");
+        }
+    }
+
+    /* steady state: replace a random live allocation with a new one */
+    for (size_t i = 0; i < runs; i++) {
+        size_t victim = rand() % window;
+        uint8_t bits = pick_bits(minbits, maxbits);
+        cycles_t start, end;
+
+        start = bench_tsc();
+        err = cap_destroy(live[victim]);
+        end = bench_tsc();
+        if (err_is_fail(err)) {
+            USER_PANIC_ERR(err, "cap_destroy");
+        }
+        free_cycles[i] = bench_time_diff(start, end);
+
+        start = bench_tsc();
+        err = ram_alloc(&live[victim], bits);
+        end = bench_tsc();
+        if (err_is_fail(err)) {
+            USER_PANIC_ERR(err, "ram_alloc of %u bits", bits);
+        }
+        alloc_cycles[i] = bench_time_diff(start, end);
+    }
+
+    print_percentiles("alloc", alloc_cycles, runs);
+    print_percentiles("free", free_cycles, runs);
+
+    for (size_t i = 0; i < window; i++) {
+        cap_destroy(live[i]);
+    }
+    free(live);
+    free(alloc_cycles);
+    free(free_cycles);
+
+    printf("mem_alloc_bench done.\n");
+    return EXIT_SUCCESS;
+}
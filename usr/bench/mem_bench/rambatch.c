@@ -0,0 +1,158 @@
+/**
+ * \file
+ * \brief Batched RAM allocation benchmark
+ *
+ * Measures the throughput of allocating base-page RAM caps from the memory
+ * server with one request per cap (ram_alloc() with prefetching disabled),
+ * through the ram_alloc() prefetch cache, and with raw ram_alloc_batch()
+ * calls.
+ *
+ * Usage: ram_batch_bench [count [rounds]]
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <inttypes.h>
+
+#include <barrelfish/barrelfish.h>
+#include <bench/bench.h>
+
+#define DEFAULT_COUNT   1024
+#define DEFAULT_ROUNDS  10
+
+enum mode {
+    MODE_SINGLE,
+    MODE_PREFETCH,
+    MODE_BATCH,
+};
+
+static const char *mode_names[] = {
+    [MODE_SINGLE]   = "single",
+    [MODE_PREFETCH] = "prefetch",
+    [MODE_BATCH]    = "batch",
+};
+
+static struct capref *caps;
+static struct capref *cnodes;
+
+/// Allocate count base pages and return the number of cycles it took
+static cycles_t run_one(enum mode mode, size_t count, size_t *retcnodes)
+{
+    cycles_t start, end;
+    errval_t err;
+    size_t ncnodes = 0;
+
+    start = bench_tsc();
+    if (mode == MODE_BATCH) {
+        for (size_t done = 0; done < count; ncnodes++) {
+            uint32_t want = count - done, got;
+            if (want > L2_CNODE_SLOTS) {
+                want = L2_CNODE_SLOTS;
+            }
+            err = ram_alloc_batch(&cnodes[ncnodes], BASE_PAGE_BITS, want, &got);
+            if (err_is_fail(err)) {
+                USER_PANIC_ERR(err, "ram_alloc_batch");
+            }
+            done += got;
+        }
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            err = ram_alloc(&caps[i], BASE_PAGE_BITS);
+            if (err_is_fail(err)) {
+                USER_PANIC_ERR(err, "ram_alloc");
+            }
+        }
+    }
+    end = bench_tsc();
+
+    *retcnodes = ncnodes;
+    return bench_time_diff(start, end);
+}
+
+/// Give all memory of a run back to the memory server
+static void cleanup(enum mode mode, size_t count, size_t ncnodes)
+{
+    errval_t err;
+
+    if (mode == MODE_BATCH) {
+        // deleting the CNode deletes all the RAM caps in it
+        for (size_t i = 0; i < ncnodes; i++) {
+            err = cap_destroy(cnodes[i]);
+            assert(err_is_ok(err));
+        }
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            err = cap_destroy(caps[i]);
+            assert(err_is_ok(err));
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    size_t count = DEFAULT_COUNT, rounds = DEFAULT_ROUNDS;
+
+    if (argc > 1) {
+        count = strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2) {
+        rounds = strtoul(argv[2], NULL, 0);
+    }
+    if (count == 0 || rounds == 0) {
+        printf("Usage: %s [count [rounds]]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    bench_init();
+
+    caps = calloc(count, sizeof(struct capref));
+    // worst case: the server hands out a single cap per batch
+    cnodes = calloc(count, sizeof(struct capref));
+    if (caps == NULL || cnodes == NULL) {
+        USER_PANIC("out of memory for cap arrays");
+    }
+
+    printf("ram_batch_bench: %zu base pages, %zu rounds, prefetch %u\n",
+           count, rounds, RAM_ALLOC_PREFETCH);
+
+    for (enum mode m = MODE_SINGLE; m <= MODE_BATCH; m++) {
+        bench_ctl_t *ctl = bench_ctl_init(BENCH_MODE_FIXEDRUNS, 1, rounds);
+
+        ram_alloc_set_prefetch(m == MODE_PREFETCH);
+
+        cycles_t total = 0;
+        do {
+            size_t ncnodes;
+            cycles_t cycles = run_one(m, count, &ncnodes);
+            cleanup(m, count, ncnodes);
+            total += cycles;
+            if (bench_ctl_add_run(ctl, &cycles)) {
+                break;
+            }
+        } while (true);
+
+        uint64_t us = bench_tsc_to_us(total / rounds);
+        printf("%-8s avg %"PRIuCYCLES" cycles per %zu allocations, "
+               "%"PRIuCYCLES" cycles per allocation, %"PRIu64" allocs/s\n",
+               mode_names[m], total / rounds, count, total / rounds / count,
+               us > 0 ? (uint64_t)count * 1000000 / us : 0);
+        bench_ctl_dump_analysis(ctl, 0, mode_names[m], bench_tsc_per_us());
+        bench_ctl_destroy(ctl);
+    }
+
+    ram_alloc_set_prefetch(true);
+    free(caps);
+    free(cnodes);
+
+    printf("ram_batch_bench done.\n");
+    return EXIT_SUCCESS;
+}
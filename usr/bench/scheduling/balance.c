@@ -0,0 +1,158 @@
+/**
+ * \file
+ * \brief Thread load balancing benchmark
+ *
+ * Spans the domain to a number of cores and starts all worker threads on the
+ * first one, a worst-case skewed workload. Each worker runs a fixed number
+ * of compute chunks. The benchmark reports the throughput in chunks per
+ * second and on which cores the chunks ran, first with the threads left
+ * where they were started and then with the domain's load balancer running,
+ * followed by the speedup the balancer gave.
+ *
+ * Usage: balance_bench cores threads [chunks]
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <barrelfish/barrelfish.h>
+#include <barrelfish/sys_debug.h>
+#include <bench/bench.h>
+
+#define DEFAULT_CHUNKS          1000
+#define CHUNK_US                100     ///< Length of a compute chunk
+#define BALANCE_INTERVAL_US     10000   ///< Time between balancing rounds
+
+struct workcnt {
+    uint64_t cnt;
+} __attribute__ ((aligned (64)));
+
+static int init_done = 1;
+static struct workcnt workcnt[MAX_CPUS];
+static struct thread_sem done_sem = THREAD_SEM_INITIALIZER;
+static size_t chunks;
+static cycles_t chunk_cycles;
+
+static int worker(void *arg)
+{
+    errval_t err = thread_detach(thread_self());
+    assert(err_is_ok(err));
+
+    for (size_t i = 0; i < chunks; i++) {
+        cycles_t end = bench_tsc() + chunk_cycles;
+        while (bench_tsc() < end);
+
+        // the thread may have moved while computing
+        __sync_fetch_and_add(&workcnt[disp_get_core_id()].cnt, 1);
+        thread_yield();
+    }
+
+    thread_sem_post(&done_sem);
+    return 0;
+}
+
+static void domain_spanned(void *arg, errval_t reterr)
+{
+    assert(err_is_ok(reterr));
+    init_done++;
+}
+
+/// Runs the workload once and returns its throughput in chunks per second
+static double run(const char *name, coreid_t *cores, int ncores, int nthreads,
+                  bool balance, uint64_t tscperms)
+{
+    errval_t err;
+
+    memset(workcnt, 0, sizeof(workcnt));
+
+    if (balance) {
+        err = domain_balancer_start(cores, ncores, BALANCE_INTERVAL_US);
+        if (err_is_fail(err)) {
+            USER_PANIC_ERR(err, "domain_balancer_start");
+        }
+    }
+
+    cycles_t start = bench_tsc();
+    for (int i = 0; i < nthreads; i++) {
+        struct thread *t = thread_create(worker, NULL);
+        if (t == NULL) {
+            USER_PANIC("thread_create failed");
+        }
+        thread_set_migratable(t, true);
+    }
+    for (int i = 0; i < nthreads; i++) {
+        thread_sem_wait(&done_sem);
+    }
+    cycles_t end = bench_tsc();
+
+    if (balance) {
+        domain_balancer_stop();
+    }
+
+    double ms = (double)bench_time_diff(start, end) / tscperms;
+    double throughput = nthreads * chunks * 1000.0 / ms;
+    printf("%-10s cores=%d threads=%d chunks=%zu: %8.1f ms, %10.1f chunks/s\n",
+           name, ncores, nthreads, chunks, ms, throughput);
+    for (int i = 0; i < ncores; i++) {
+        printf("%-10s   core %3d: %8"PRIu64" chunks\n", name, cores[i],
+               workcnt[cores[i]].cnt);
+    }
+
+    return throughput;
+}
+
+int main(int argc, char *argv[])
+{
+    coreid_t my_core_id = disp_get_core_id();
+    coreid_t cores[MAX_CPUS];
+    uint64_t tscperms;
+    errval_t err;
+
+    if (argc < 3) {
+        printf("Usage: %s cores threads [chunks]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    int ncores = atoi(argv[1]);
+    int nthreads = atoi(argv[2]);
+    chunks = argc > 3 ? strtoul(argv[3], NULL, 0) : DEFAULT_CHUNKS;
+    if (ncores < 1 || my_core_id + ncores > MAX_CPUS || nthreads < 1) {
+        printf("Usage: %s cores threads [chunks]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    err = sys_debug_get_tsc_per_ms(&tscperms);
+    assert(err_is_ok(err));
+    chunk_cycles = tscperms * CHUNK_US / 1000;
+
+    bench_init();
+
+    /* Span domain to the other cores */
+    cores[0] = my_core_id;
+    for (int i = 1; i < ncores; i++) {
+        cores[i] = my_core_id + i;
+        err = domain_new_dispatcher(cores[i], domain_spanned, NULL);
+        if (err_is_fail(err)) {
+            USER_PANIC_ERR(err, "failed to span domain");
+        }
+    }
+
+    while (init_done < ncores) {
+        thread_yield();
+    }
+
+    double skewed = run("skewed", cores, ncores, nthreads, false, tscperms);
+    double balanced = run("balanced", cores, ncores, nthreads, true, tscperms);
+    printf("speedup with balancer: %.2fx\n", balanced / skewed);
+
+    printf("balance_bench done.\n");
+    return EXIT_SUCCESS;
+}
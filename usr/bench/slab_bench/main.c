@@ -0,0 +1,232 @@
+/**
+ * \file
+ * \brief Slab allocator benchmark
+ *
+ * Compares allocation and free latency of the list-walking slab allocator
+ * (old_slab.c) with the current lib/barrelfish slab allocator on a
+ * fragmented allocator, i.e. where free blocks are scattered randomly across
+ * a large number of slabs. The "locked" and "cache" variants compare the
+ * slab allocator made safe for multiple dispatchers with a spinlock against
+ * the per-dispatcher magazine cache in front of it.
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <barrelfish/barrelfish.h>
+#include <barrelfish/slab.h>
+#include <barrelfish/slab_cache.h>
+#include <barrelfish/dispatch.h>
+
+#include <bench/bench.h>
+
+#include "old_slab.h"
+
+#define PRINT_CSV_VALUES 1
+
+// number of measured free/alloc pairs per configuration
+#define BENCH_RUN_COUNT 2000
+
+// size of the blocks handed out by the allocators
+#define BLOCK_SIZE 64
+
+// size of a single slab
+#define SLAB_SIZE BASE_PAGE_SIZE
+
+// percentage of blocks that are freed before the measurement starts
+#define FRAG_FREE_PERCENT 10
+
+#define EXPECT_NONNULL(ptr, msg) \
+    if ((ptr) == NULL) {USER_PANIC(msg);}
+
+static const size_t slab_counts[] = { 1, 16, 256, 1024, 4096 };
+
+enum variant {
+    VARIANT_OLD,
+    VARIANT_NEW,
+    VARIANT_NEW_NOZERO,
+    VARIANT_LOCKED,
+    VARIANT_CACHE,
+};
+
+static const char *variant_names[] = {
+    [VARIANT_OLD]        = "old",
+    [VARIANT_NEW]        = "new",
+    [VARIANT_NEW_NOZERO] = "new_nozero",
+    [VARIANT_LOCKED]     = "locked",
+    [VARIANT_CACHE]      = "cache",
+};
+
+static struct old_slab_allocator old_slabs;
+static struct slab_allocator new_slabs;
+static spinlock_t new_slabs_lock;
+static struct slab_cache new_slabs_cache;
+static char magazine_buf[SLAB_CACHE_MAGAZINES_BUFSIZE];
+
+static void *do_alloc(enum variant v)
+{
+    switch (v) {
+    case VARIANT_OLD:
+        return old_slab_alloc(&old_slabs);
+    case VARIANT_NEW:
+        return slab_alloc(&new_slabs);
+    case VARIANT_NEW_NOZERO:
+        return slab_alloc_nozero(&new_slabs);
+    case VARIANT_LOCKED: {
+        dispatcher_handle_t handle = disp_disable();
+        acquire_spinlock(&new_slabs_lock);
+        void *block = slab_alloc(&new_slabs);
+        release_spinlock(&new_slabs_lock);
+        disp_enable(handle);
+        return block;
+    }
+    case VARIANT_CACHE:
+        return slab_cache_alloc(&new_slabs_cache);
+    }
+    return NULL;
+}
+
+static void do_free(enum variant v, void *block)
+{
+    if (v == VARIANT_OLD) {
+        old_slab_free(&old_slabs, block);
+    } else if (v == VARIANT_LOCKED) {
+        dispatcher_handle_t handle = disp_disable();
+        acquire_spinlock(&new_slabs_lock);
+        slab_free(&new_slabs, block);
+        release_spinlock(&new_slabs_lock);
+        disp_enable(handle);
+    } else if (v == VARIANT_CACHE) {
+        slab_cache_free(&new_slabs_cache, block);
+    } else {
+        slab_free(&new_slabs, block);
+    }
+}
+
+static void run_fragmented(enum variant v, size_t nslabs)
+{
+    char buf[50];
+    cycles_t tsc_start, tsc_end, elapsed;
+
+    /* create allocator with nslabs slabs */
+    void **bufs = calloc(nslabs, sizeof(void *));
+    EXPECT_NONNULL(bufs, "calloc slab buffers");
+    if (v == VARIANT_OLD) {
+        old_slab_init(&old_slabs, BLOCK_SIZE);
+    } else {
+        slab_init(&new_slabs, BLOCK_SIZE, NULL);
+        slab_cache_init(&new_slabs_cache, &new_slabs);
+        if (v == VARIANT_CACHE) {
+            slab_cache_enable_magazines(&new_slabs_cache, magazine_buf,
+                                        sizeof(magazine_buf));
+        }
+    }
+    for (size_t i = 0; i < nslabs; i++) {
+        bufs[i] = malloc(SLAB_SIZE);
+        EXPECT_NONNULL(bufs[i], "malloc slab buffer");
+        if (v == VARIANT_OLD) {
+            old_slab_grow(&old_slabs, bufs[i], SLAB_SIZE);
+        } else if (v == VARIANT_CACHE) {
+            slab_cache_grow(&new_slabs_cache, bufs[i], SLAB_SIZE);
+        } else {
+            slab_grow(&new_slabs, bufs[i], SLAB_SIZE);
+        }
+    }
+
+    /* allocate all blocks */
+    size_t nblocks = 0, maxblocks = nslabs * (SLAB_SIZE / sizeof(void *));
+    void **blocks = calloc(maxblocks, sizeof(void *));
+    EXPECT_NONNULL(blocks, "calloc block array");
+    while ((blocks[nblocks] = do_alloc(v)) != NULL) {
+        nblocks++;
+        assert(nblocks < maxblocks);
+    }
+
+    /* fragment: free a random subset of blocks scattered over all slabs */
+    srand(42);
+    for (size_t i = 0; i < nblocks * FRAG_FREE_PERCENT / 100; i++) {
+        size_t idx = rand() % nblocks;
+        do_free(v, blocks[idx]);
+        blocks[idx] = blocks[--nblocks];
+    }
+
+    /*
+     * warm up: random frees followed by allocations drive the allocator into
+     * its steady state, where the remaining free blocks are spread over the
+     * slabs that allocation reaches last
+     */
+    for (size_t i = 0; i < nblocks; i++) {
+        size_t idx = rand() % nblocks;
+        do_free(v, blocks[idx]);
+        blocks[idx] = do_alloc(v);
+        EXPECT_NONNULL(blocks[idx], "slab alloc during warm up");
+    }
+
+    /* measure: free a random block and allocate a new one */
+    bench_ctl_t *a_ctl = bench_ctl_init(BENCH_MODE_FIXEDRUNS, 1, BENCH_RUN_COUNT);
+    bench_ctl_t *f_ctl = bench_ctl_init(BENCH_MODE_FIXEDRUNS, 1, BENCH_RUN_COUNT);
+    do {
+        size_t idx = rand() % nblocks;
+
+        tsc_start = bench_tsc();
+        do_free(v, blocks[idx]);
+        tsc_end = bench_tsc();
+        elapsed = bench_time_diff(tsc_start, tsc_end);
+        bench_ctl_add_run(f_ctl, &elapsed);
+
+        tsc_start = bench_tsc();
+        blocks[idx] = do_alloc(v);
+        tsc_end = bench_tsc();
+        EXPECT_NONNULL(blocks[idx], "slab alloc in steady state");
+        elapsed = bench_time_diff(tsc_start, tsc_end);
+    } while (!bench_ctl_add_run(a_ctl, &elapsed));
+
+    snprintf(buf, sizeof(buf), "alloc %s %zu slabs", variant_names[v], nslabs);
+    bench_ctl_dump_analysis(a_ctl, 0, buf, bench_tsc_per_us());
+#if PRINT_CSV_VALUES
+    snprintf(buf, sizeof(buf), "alloc_%s_%zu", variant_names[v], nslabs);
+    bench_ctl_dump_csv(a_ctl, buf, bench_tsc_per_us());
+#endif
+
+    snprintf(buf, sizeof(buf), "free %s %zu slabs", variant_names[v], nslabs);
+    bench_ctl_dump_analysis(f_ctl, 0, buf, bench_tsc_per_us());
+#if PRINT_CSV_VALUES
+    snprintf(buf, sizeof(buf), "free_%s_%zu", variant_names[v], nslabs);
+    bench_ctl_dump_csv(f_ctl, buf, bench_tsc_per_us());
+#endif
+
+    bench_ctl_destroy(a_ctl);
+    bench_ctl_destroy(f_ctl);
+
+    free(blocks);
+    for (size_t i = 0; i < nslabs; i++) {
+        free(bufs[i]);
+    }
+    free(bufs);
+}
+
+int main(int argc, char *argv[])
+{
+    bench_init();
+
+    debug_printf("slab benchmark: %u byte blocks, %u%% fragmentation\n",
+                 BLOCK_SIZE, FRAG_FREE_PERCENT);
+    debug_printf("---------------------------------------\n");
+
+    for (size_t i = 0; i < sizeof(slab_counts) / sizeof(slab_counts[0]); i++) {
+        for (enum variant v = VARIANT_OLD; v <= VARIANT_CACHE; v++) {
+            run_fragmented(v, slab_counts[i]);
+        }
+    }
+
+    debug_printf("slab benchmark done.\n");
+    return EXIT_SUCCESS;
+}
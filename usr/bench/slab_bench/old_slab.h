@@ -0,0 +1,42 @@
+/**
+ * \file
+ * \brief Previous (list-walking) slab allocator, kept for comparison.
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#ifndef SLAB_BENCH_OLD_SLAB_H
+#define SLAB_BENCH_OLD_SLAB_H
+
+struct old_block_head;
+
+struct old_slab_head {
+    struct old_slab_head *next; ///< Next slab in the allocator
+    uint32_t total, free;       ///< Count of total and free blocks in this slab
+    struct old_block_head *blocks; ///< Pointer to free block list
+};
+
+struct old_slab_allocator {
+    struct old_slab_head *slabs;    ///< Pointer to list of slabs
+    size_t blocksize;               ///< Size of blocks managed by this allocator
+};
+
+#define OLD_SLAB_REAL_BLOCKSIZE(blocksize) \
+    (((blocksize) > sizeof(void *)) ? (blocksize) : sizeof(void *))
+
+#define OLD_SLAB_STATIC_SIZE(nblocks, blocksize) \
+    ((nblocks) * OLD_SLAB_REAL_BLOCKSIZE(blocksize) + sizeof(struct old_slab_head))
+
+void old_slab_init(struct old_slab_allocator *slabs, size_t blocksize);
+void old_slab_grow(struct old_slab_allocator *slabs, void *buf, size_t buflen);
+void *old_slab_alloc(struct old_slab_allocator *slabs);
+void old_slab_free(struct old_slab_allocator *slabs, void *block);
+
+#endif // SLAB_BENCH_OLD_SLAB_H
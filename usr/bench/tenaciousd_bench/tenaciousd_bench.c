@@ -7,61 +7,178 @@
  * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
  */
 
+/*
+ * Measures durable log appends with group commit. For each batch size, a
+ * number of entries is appended and the time from an entry's append until it
+ * is durable is recorded. Reports appends/sec and the median and 99th
+ * percentile commit latency. A batch size of 1 writes and flushes every
+ * entry on its own.
+ *
+ * Usage: tenaciousd_bench [appends [max delay in us]]
+ *
+ * Builds for Barrelfish via Hake and for Linux via the Makefile in this
+ * directory.
+ */
+
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <inttypes.h>
+#ifdef BARRELFISH
 #include <barrelfish/barrelfish.h>
+#include <barrelfish/sys_debug.h>
+#else
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <time.h>
+#include <errors/errno.h>
+#endif
 #include <storage/storage.h>
 #include <tenaciousd/log.h>
+#include <tenaciousd/group.h>
 
-#define ITERATIONS      2
+#define DEFAULT_APPENDS 2048
+#define DEFAULT_DELAY   1000                    // us
+#define MAX_BATCH       64
+#define ENTRY_SIZE      32
 #define VSA_SIZE        (10*1024*1024)          // 10MB
 
 static struct storage_vsa vsa;
 static struct storage_vsic vsic;
-static uint64_t durations[ITERATIONS][2];
 
-int main(int argc, char *argv[])
+#ifndef BARRELFISH
+static inline uint64_t rdtsc(void)
 {
-    // XXX: Need to support multiple backend drivers eventually
-    errval_t err = storage_vsic_driver_init(argc, (const char **)argv, &vsic);
-    assert(err_is_ok(err));
+    uint32_t eax, edx;
+    __asm volatile ("rdtsc" : "=a" (eax), "=d" (edx));
+    return ((uint64_t)edx << 32) | eax;
+}
+#endif
 
-    err = storage_vsa_alloc(&vsa, VSA_SIZE);
+static uint64_t get_tsc_per_us(void)
+{
+#ifdef BARRELFISH
+    uint64_t tsc_per_ms;
+    errval_t err = sys_debug_get_tsc_per_ms(&tsc_per_ms);
     assert(err_is_ok(err));
+    return tsc_per_ms / 1000;
+#else
+    struct timespec ts = { .tv_sec = 0, .tv_nsec = 100 * 1000 * 1000 };
+    uint64_t start = rdtsc();
+    nanosleep(&ts, NULL);
+    return (rdtsc() - start) / (100 * 1000);
+#endif
+}
 
-    struct tenaciousd_log *log = tenaciousd_log_new(&vsa, &vsic);
-    assert(log != NULL);
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
 
-    size_t size = 32;
+static void run(struct tenaciousd_log *log, size_t batch, size_t appends,
+                uint64_t max_delay, uint64_t tsc_per_us, uint64_t *appended,
+                uint64_t *latencies)
+{
+    size_t size = ENTRY_SIZE;
     struct tenaciousd_log_entry *entry = tenaciousd_log_entry_new(log, &size);
     assert(entry != NULL);
+    memset(entry->data, 'x', size);
+
+    size_t entry_bytes =
+        STORAGE_VSIC_ROUND(&vsic, size + sizeof(struct tenaciousd_log_entry));
+    struct tenaciousd_group_params params = {
+        .max_entries = batch,
+        .max_bytes = batch * entry_bytes,
+        .max_delay = max_delay,
+    };
+    errval_t err = tenaciousd_log_set_group_commit(log, &params);
+    assert(err_is_ok(err));
 
-    char *str = (char *)entry->data;
-    strcpy(str, "This is a test...");
-
-    for(int i = 0; i < ITERATIONS; i++) {
-        uint64_t start = rdtsc();
-
+    uint64_t done = 0;
+    uint64_t start = rdtsc();
+    for(size_t i = 0; i < appends; i++) {
+        appended[i] = rdtsc();
         err = tenaciousd_log_append(log, entry);
         assert(err_is_ok(err));
 
-        uint64_t middle = rdtsc();
-        durations[i][0] = middle - start;
+        uint64_t committed = log->group->committed;
+        if(committed > done) {
+            uint64_t now = rdtsc();
+            for(; done < committed; done++) {
+                latencies[done] = now - appended[done];
+            }
+        }
+    }
+    err = tenaciousd_log_commit(log);
+    assert(err_is_ok(err));
+    uint64_t end = rdtsc();
+    for(; done < appends; done++) {
+        latencies[done] = end - appended[done];
+    }
+    uint64_t commits = log->group->commits;
+
+    err = tenaciousd_log_set_group_commit(log, NULL);
+    assert(err_is_ok(err));
+    tenaciousd_log_entry_delete(log, entry);
+
+    qsort(latencies, appends, sizeof(uint64_t), compare_u64);
+    uint64_t us = (end - start) / tsc_per_us;
+    printf("batch %3zu: %8" PRIu64 " appends/s, %6" PRIu64 " commits, "
+           "latency p50 %6" PRIu64 " us, p99 %6" PRIu64 " us\n",
+           batch, us ? appends * 1000000 / us : 0, commits,
+           latencies[appends / 2] / tsc_per_us,
+           latencies[appends * 99 / 100] / tsc_per_us);
+}
 
-        err = vsic.ops.wait(&vsic);
-        assert(err_is_ok(err));
+int main(int argc, char *argv[])
+{
+    size_t appends = DEFAULT_APPENDS;
+    uint64_t delay_us = DEFAULT_DELAY;
 
-        uint64_t end = rdtsc();
-        durations[i][1] = end - middle;
+    if(argc > 1) {
+        appends = strtoul(argv[1], NULL, 0);
+    }
+    if(argc > 2) {
+        delay_us = strtoul(argv[2], NULL, 0);
+    }
+    if(appends == 0) {
+        printf("Usage: %s [appends [max delay in us]]\n", argv[0]);
+        return 1;
     }
 
-    err = tenaciousd_log_delete(log);
+    // XXX: Need to support multiple backend drivers eventually
+    errval_t err = storage_vsic_driver_init(argc, (const char **)argv, &vsic);
     assert(err_is_ok(err));
 
-    for(int i = 0; i < ITERATIONS; i++) {
-        printf("iteration %d = %" PRIu64 " %" PRIu64 "\n",
-               i, durations[i][0], durations[i][1]);
+#ifdef BARRELFISH
+    err = storage_vsa_alloc(&vsa, VSA_SIZE);
+#else
+    err = storage_vsa_acquire(&vsa, "tenaciousd_bench", VSA_SIZE);
+#endif
+    assert(err_is_ok(err));
+
+    struct tenaciousd_log *log = tenaciousd_log_new(&vsa, &vsic);
+    assert(log != NULL);
+
+    uint64_t tsc_per_us = get_tsc_per_us();
+    uint64_t *appended = malloc(appends * sizeof(uint64_t));
+    uint64_t *latencies = malloc(appends * sizeof(uint64_t));
+    assert(appended != NULL && latencies != NULL);
+
+    printf("%zu appends of %d bytes, max delay %" PRIu64 " us\n",
+           appends, ENTRY_SIZE, delay_us);
+    for(size_t batch = 1; batch <= MAX_BATCH; batch *= 2) {
+        run(log, batch, appends, delay_us * tsc_per_us, tsc_per_us,
+            appended, latencies);
     }
 
+    err = tenaciousd_log_delete(log);
+    assert(err_is_ok(err));
+
+    free(appended);
+    free(latencies);
+
     return 0;
 }
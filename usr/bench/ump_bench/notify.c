@@ -0,0 +1,239 @@
+/**
+ * \file
+ * \brief UMP receive policy benchmark
+ *
+ * Compares how a UMP receiver waits for messages: polling all the time
+ * (IDC_BIND_FLAG_NO_NOTIFY), blocking on an IPI notification (the default for
+ * ump_ipi bindings) and the adaptive spin-then-block policy
+ * (IDC_BIND_FLAG_UMP_ADAPTIVE). The client sends requests that the server
+ * answers after a given service time, and waits for the reply. Longer service
+ * times mean a less loaded channel. For each service time, it reports the
+ * reply latency on top of the service time, and from the channel counters the
+ * share of the waiting time the client spent polling and how often it blocked.
+ * A polling client polls during all of its waiting time, a blocking one never.
+ *
+ * Usage: ump_notify [client core]
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <barrelfish/barrelfish.h>
+#include <barrelfish/nameservice_client.h>
+#include <barrelfish/spawn_client.h>
+#include <barrelfish/systime.h>
+
+#include <bench/bench.h>
+#include <if/bench_defs.h>
+
+#define NUM_ROUNDS  2000
+
+enum variant {
+    VARIANT_POLL,
+    VARIANT_IPI,
+    VARIANT_ADAPTIVE,
+    NUM_VARIANTS
+};
+
+static const char *variant_names[] = {
+    [VARIANT_POLL]     = "poll",
+    [VARIANT_IPI]      = "ipi",
+    [VARIANT_ADAPTIVE] = "adaptive",
+};
+
+static const idc_bind_flags_t variant_flags[] = {
+    [VARIANT_POLL]     = IDC_BIND_FLAG_NO_NOTIFY,
+    [VARIANT_IPI]      = IDC_BIND_FLAGS_DEFAULT,
+    [VARIANT_ADAPTIVE] = IDC_BIND_FLAG_UMP_ADAPTIVE,
+};
+
+/// server service times (in us), from a busy to a mostly idle channel
+static const int service_us[] = { 0, 1, 5, 20, 100, 500 };
+#define NUM_LOADS (sizeof(service_us) / sizeof(service_us[0]))
+
+static char my_name[100];
+
+static struct bench_binding *bindings[NUM_VARIANTS];
+static int num_bound;
+static bool replied;
+
+/* ------------------------------ server ------------------------------ */
+
+static void rx_request(struct bench_binding *b, int32_t us)
+{
+    errval_t err;
+
+    // simulate the work of serving the request
+    cycles_t start = bench_tsc();
+    while (bench_tsc() - start < us * bench_tsc_per_us()) {
+    }
+
+    err = b->tx_vtbl.fsb_payload1_reply(b, NOP_CONT, us);
+    if (err_is_fail(err)) {
+        USER_PANIC_ERR(err, "sending reply");
+    }
+}
+
+static struct bench_rx_vtbl server_rx_vtbl = {
+    .fsb_payload1_request = rx_request,
+};
+
+static void export_cb(void *st, errval_t err, iref_t iref)
+{
+    if (err_is_fail(err)) {
+        USER_PANIC_ERR(err, "export failed");
+    }
+
+    err = nameservice_register("ump_notify_server", iref);
+    if (err_is_fail(err)) {
+        USER_PANIC_ERR(err, "nameservice_register failed");
+    }
+}
+
+static errval_t connect_cb(void *st, struct bench_binding *b)
+{
+    b->rx_vtbl = server_rx_vtbl;
+    return SYS_ERR_OK;
+}
+
+/* ------------------------------ client ------------------------------ */
+
+static void rx_reply(struct bench_binding *b, int32_t us)
+{
+    replied = true;
+}
+
+static struct bench_rx_vtbl client_rx_vtbl = {
+    .fsb_payload1_reply = rx_reply,
+};
+
+/// Channel counters; ump and ump_ipi bindings share the layout up to ump_state
+static struct ump_notify_stats *get_stats(struct bench_binding *b)
+{
+    struct bench_ump_binding *bu = (struct bench_ump_binding *)b;
+    return &bu->ump_state.chan.adaptive.stats;
+}
+
+static void run(enum variant v, int us)
+{
+    struct bench_binding *b = bindings[v];
+    struct ump_notify_stats *stats = get_stats(b);
+    cycles_t service = us * bench_tsc_per_us();
+    cycles_t start, end, total = 0;
+    errval_t err;
+
+    memset(stats, 0, sizeof(*stats));
+
+    for (int i = 0; i < NUM_ROUNDS; i++) {
+        replied = false;
+        start = bench_tsc();
+        err = b->tx_vtbl.fsb_payload1_request(b, NOP_CONT, us);
+        if (err_is_fail(err)) {
+            USER_PANIC_ERR(err, "sending request");
+        }
+        while (!replied) {
+            err = event_dispatch(get_default_waitset());
+            if (err_is_fail(err)) {
+                USER_PANIC_ERR(err, "event_dispatch");
+            }
+        }
+        end = bench_tsc();
+        total += bench_time_diff(start, end);
+    }
+
+    cycles_t latency = total / NUM_ROUNDS;
+    latency = latency > service ? latency - service : 0;
+    uint64_t spin_us = systime_to_us(stats->spin_time);
+    uint64_t total_us = bench_tsc_to_us(total);
+
+    printf("%-8s service=%-4dus latency %7"PRIuCYCLES" cycles, "
+           "polling %3"PRIu64"%%, blocks %5"PRIu64", spin hits %5"PRIu64
+           ", spin misses %5"PRIu64", ipis sent %5"PRIu64"\n",
+           variant_names[v], us, latency,
+           total_us > 0 ? spin_us * 100 / total_us : 0,
+           stats->blocks, stats->spin_hits, stats->spin_misses,
+           stats->ipis_sent);
+}
+
+static void bind_cb(void *st, errval_t err, struct bench_binding *b)
+{
+    if (err_is_fail(err)) {
+        USER_PANIC_ERR(err, "bind failed");
+    }
+
+    enum variant v = (enum variant)(uintptr_t)st;
+    b->rx_vtbl = client_rx_vtbl;
+    bindings[v] = b;
+    num_bound++;
+}
+
+static void client(void)
+{
+    errval_t err;
+    iref_t iref;
+
+    err = nameservice_blocking_lookup("ump_notify_server", &iref);
+    if (err_is_fail(err)) {
+        USER_PANIC_ERR(err, "nameservice_blocking_lookup failed");
+    }
+
+    for (enum variant v = 0; v < NUM_VARIANTS; v++) {
+        err = bench_bind(iref, bind_cb, (void *)(uintptr_t)v,
+                         get_default_waitset(), variant_flags[v]);
+        if (err_is_fail(err)) {
+            USER_PANIC_ERR(err, "bind failed");
+        }
+    }
+    while (num_bound < NUM_VARIANTS) {
+        event_dispatch(get_default_waitset());
+    }
+
+    for (size_t l = 0; l < NUM_LOADS; l++) {
+        for (enum variant v = 0; v < NUM_VARIANTS; v++) {
+            run(v, service_us[l]);
+        }
+    }
+
+    printf("client done\n");
+}
+
+int main(int argc, char *argv[])
+{
+    errval_t err;
+
+    strncpy(my_name, argv[0], sizeof(my_name) - 1);
+
+    bench_init();
+
+    if (argc == 2 && strcmp(argv[1], "client") == 0) {
+        client();
+        return EXIT_SUCCESS;
+    }
+
+    coreid_t client_core = (argc > 1) ? atoi(argv[1]) : 1;
+
+    err = bench_export(NULL, export_cb, connect_cb, get_default_waitset(),
+                       IDC_EXPORT_FLAGS_DEFAULT);
+    if (err_is_fail(err)) {
+        USER_PANIC_ERR(err, "export failed");
+    }
+
+    char *xargv[] = {my_name, "client", NULL};
+    err = spawn_program(client_core, my_name, xargv, NULL,
+                        SPAWN_FLAGS_DEFAULT, NULL);
+    if (err_is_fail(err)) {
+        USER_PANIC_ERR(err, "spawning client on core %d", client_core);
+    }
+
+    messages_handler_loop();
+}
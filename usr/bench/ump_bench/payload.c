@@ -0,0 +1,244 @@
+/**
+ * \file
+ * \brief UMP payload throughput benchmark
+ *
+ * Measures the throughput of flounder messages carrying a single buffer
+ * argument of increasing size between two cores, once on a binding that
+ * fragments the buffer into UMP messages and once on a binding created with
+ * IDC_BIND_FLAG_UMP_POOL, which passes large buffers through the payload pool.
+ *
+ * Usage: ump_payload [client core]
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <barrelfish/barrelfish.h>
+#include <barrelfish/nameservice_client.h>
+#include <barrelfish/spawn_client.h>
+
+#include <bench/bench.h>
+#include <if/bench_defs.h>
+
+#define NUM_MSGS    1000
+#define MIN_SIZE    64
+#define MAX_SIZE    16384   // maximum size of the ump_payload argument
+
+enum variant {
+    VARIANT_INLINE,
+    VARIANT_POOL,
+    NUM_VARIANTS
+};
+
+static const char *variant_names[] = {
+    [VARIANT_INLINE] = "inline",
+    [VARIANT_POOL]   = "pool",
+};
+
+static const idc_bind_flags_t variant_flags[] = {
+    [VARIANT_INLINE] = IDC_BIND_FLAGS_DEFAULT,
+    [VARIANT_POOL]   = IDC_BIND_FLAG_UMP_POOL,
+};
+
+static char my_name[100];
+
+/* server state */
+static uint32_t rx_count;
+
+/* client state */
+static struct bench_binding *bindings[NUM_VARIANTS];
+static int num_bound;
+static uint8_t payload[MAX_SIZE];
+static size_t tx_size;
+static int tx_sent;
+static bool acked;
+
+/* ------------------------------ server ------------------------------ */
+
+static void rx_ump_payload(struct bench_binding *b, const uint8_t *buf,
+                           size_t size)
+{
+    errval_t err;
+
+    if (++rx_count == NUM_MSGS) {
+        rx_count = 0;
+        err = b->tx_vtbl.ump_payload_ack(b, NOP_CONT, NUM_MSGS);
+        if (err_is_fail(err)) {
+            USER_PANIC_ERR(err, "sending ump_payload_ack");
+        }
+    }
+}
+
+static struct bench_rx_vtbl server_rx_vtbl = {
+    .ump_payload = rx_ump_payload,
+};
+
+static void export_cb(void *st, errval_t err, iref_t iref)
+{
+    if (err_is_fail(err)) {
+        USER_PANIC_ERR(err, "export failed");
+    }
+
+    err = nameservice_register("ump_payload_server", iref);
+    if (err_is_fail(err)) {
+        USER_PANIC_ERR(err, "nameservice_register failed");
+    }
+}
+
+static errval_t connect_cb(void *st, struct bench_binding *b)
+{
+    b->rx_vtbl = server_rx_vtbl;
+    return SYS_ERR_OK;
+}
+
+/* ------------------------------ client ------------------------------ */
+
+static void send_payload(void *arg)
+{
+    struct bench_binding *b = arg;
+    errval_t err;
+
+    if (tx_sent == NUM_MSGS) {
+        return;
+    }
+
+    err = b->tx_vtbl.ump_payload(b, MKCONT(send_payload, b), payload, tx_size);
+    if (err_is_ok(err)) {
+        tx_sent++;
+    } else if (err_no(err) == FLOUNDER_ERR_TX_BUSY) {
+        err = b->register_send(b, get_default_waitset(),
+                               MKCONT(send_payload, b));
+        assert(err_is_ok(err));
+    } else {
+        USER_PANIC_ERR(err, "sending ump_payload");
+    }
+}
+
+static void rx_ump_payload_ack(struct bench_binding *b, uint32_t count)
+{
+    assert(count == NUM_MSGS);
+    acked = true;
+}
+
+static struct bench_rx_vtbl client_rx_vtbl = {
+    .ump_payload_ack = rx_ump_payload_ack,
+};
+
+static void run(enum variant v, size_t size, bool report)
+{
+    struct bench_binding *b = bindings[v];
+    cycles_t start, end;
+    errval_t err;
+
+    tx_size = size;
+    tx_sent = 0;
+    acked = false;
+
+    start = bench_tsc();
+    send_payload(b);
+    while (!acked) {
+        err = event_dispatch(get_default_waitset());
+        if (err_is_fail(err)) {
+            USER_PANIC_ERR(err, "event_dispatch");
+        }
+    }
+    end = bench_tsc();
+
+    if (!report) {
+        return;
+    }
+
+    uint64_t us = bench_tsc_to_us(bench_time_diff(start, end));
+    printf("%-6s size=%-6zu %8"PRIuCYCLES" cycles/msg %8"PRIu64" MB/s\n",
+           variant_names[v], size, bench_time_diff(start, end) / NUM_MSGS,
+           us > 0 ? (uint64_t)size * NUM_MSGS / us : 0);
+}
+
+static void bind_cb(void *st, errval_t err, struct bench_binding *b)
+{
+    if (err_is_fail(err)) {
+        USER_PANIC_ERR(err, "bind failed");
+    }
+
+    enum variant v = (enum variant)(uintptr_t)st;
+    b->rx_vtbl = client_rx_vtbl;
+    bindings[v] = b;
+    num_bound++;
+}
+
+static void client(void)
+{
+    errval_t err;
+    iref_t iref;
+
+    err = nameservice_blocking_lookup("ump_payload_server", &iref);
+    if (err_is_fail(err)) {
+        USER_PANIC_ERR(err, "nameservice_blocking_lookup failed");
+    }
+
+    for (enum variant v = 0; v < NUM_VARIANTS; v++) {
+        err = bench_bind(iref, bind_cb, (void *)(uintptr_t)v,
+                         get_default_waitset(), variant_flags[v]);
+        if (err_is_fail(err)) {
+            USER_PANIC_ERR(err, "bind failed");
+        }
+    }
+    while (num_bound < NUM_VARIANTS) {
+        event_dispatch(get_default_waitset());
+    }
+
+    memset(payload, 0xa5, sizeof(payload));
+
+    for (size_t size = MIN_SIZE; size <= MAX_SIZE; size *= 2) {
+        // warm up both channels before measuring
+        for (enum variant v = 0; v < NUM_VARIANTS; v++) {
+            run(v, size, false);
+        }
+        for (enum variant v = 0; v < NUM_VARIANTS; v++) {
+            run(v, size, true);
+        }
+    }
+
+    printf("client done\n");
+}
+
+int main(int argc, char *argv[])
+{
+    errval_t err;
+
+    strncpy(my_name, argv[0], sizeof(my_name) - 1);
+
+    bench_init();
+
+    if (argc == 2 && strcmp(argv[1], "client") == 0) {
+        client();
+        return EXIT_SUCCESS;
+    }
+
+    coreid_t client_core = (argc > 1) ? atoi(argv[1]) : 1;
+
+    err = bench_export(NULL, export_cb, connect_cb, get_default_waitset(),
+                       IDC_EXPORT_FLAGS_DEFAULT);
+    if (err_is_fail(err)) {
+        USER_PANIC_ERR(err, "export failed");
+    }
+
+    char *xargv[] = {my_name, "client", NULL};
+    err = spawn_program(client_core, my_name, xargv, NULL,
+                        SPAWN_FLAGS_DEFAULT, NULL);
+    if (err_is_fail(err)) {
+        USER_PANIC_ERR(err, "spawning client on core %d", client_core);
+    }
+
+    messages_handler_loop();
+}
@@ -0,0 +1,139 @@
+/**
+ * \file
+ * \brief vspace map/unmap throughput benchmark
+ *
+ * Maps, protects and unmaps a large region backed by a single frame with 4K,
+ * 2M and 1G pages, and reports the throughput of each operation. Every page
+ * size is run once with the pmap issuing one invocation per leaf page table
+ * and once with the batched VNode invocations.
+ *
+ * Usage: vspace_map_tput [region_bits]
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <barrelfish/barrelfish.h>
+
+#include <bench/bench.h>
+
+// defined in lib/barrelfish/arch/x86_64/pmap.c
+extern int pmap_batch_invocations;
+
+#define DEFAULT_REGION_BITS 30
+#define MIN_REGION_BITS     22
+#define MAX_REGION_BITS     35
+
+#define RUN_COUNT 10
+
+#define EXPECT_SUCCESS(err, msg) \
+    if (err_is_fail(err)) {USER_PANIC_ERR(err, msg);}
+
+struct page_kind {
+    const char *name;
+    vregion_flags_t flags;
+    size_t size;
+};
+
+static struct page_kind kinds[] = {
+    { "4K", 0,                   BASE_PAGE_SIZE },
+    { "2M", VREGION_FLAGS_LARGE, LARGE_PAGE_SIZE },
+    { "1G", VREGION_FLAGS_HUGE,  HUGE_PAGE_SIZE },
+};
+#define NKINDS (sizeof(kinds) / sizeof(kinds[0]))
+
+static void print_result(struct page_kind *k, const char *mode,
+                         const char *op, size_t bytes, cycles_t cycles)
+{
+    size_t pages = bytes / k->size;
+    uint64_t us = bench_tsc_to_us(cycles);
+    printf("%-2s %-7s %-7s %10"PRIuCYCLES" cycles %8"PRIuCYCLES" cycles/page"
+           " %10"PRIu64" pages/s\n", k->name, mode, op, cycles, cycles / pages,
+           us > 0 ? (uint64_t)pages * 1000000 / us : 0);
+}
+
+static void run(struct capref frame, size_t bytes, struct page_kind *k,
+                bool batched)
+{
+    cycles_t map = 0, protect = 0, unmap = 0;
+    cycles_t start, end;
+    errval_t err;
+
+    pmap_batch_invocations = batched;
+
+    for (int i = 0; i < RUN_COUNT; i++) {
+        struct memobj *memobj;
+        struct vregion *vregion;
+        void *addr;
+
+        start = bench_tsc();
+        err = vspace_map_one_frame_attr_aligned(&addr, bytes, frame,
+                                                VREGION_FLAGS_READ_WRITE | k->flags,
+                                                k->size, &memobj, &vregion);
+        end = bench_tsc();
+        EXPECT_SUCCESS(err, "vspace_map_one_frame_attr_aligned");
+        map += bench_time_diff(start, end);
+
+        start = bench_tsc();
+        err = memobj->f.protect(memobj, vregion, 0, bytes, VREGION_FLAGS_READ);
+        end = bench_tsc();
+        EXPECT_SUCCESS(err, "protect");
+        protect += bench_time_diff(start, end);
+
+        start = bench_tsc();
+        err = vspace_unmap(addr);
+        end = bench_tsc();
+        EXPECT_SUCCESS(err, "vspace_unmap");
+        unmap += bench_time_diff(start, end);
+    }
+
+    const char *mode = batched ? "batched" : "leaf";
+    print_result(k, mode, "map", bytes, map / RUN_COUNT);
+    print_result(k, mode, "protect", bytes, protect / RUN_COUNT);
+    print_result(k, mode, "unmap", bytes, unmap / RUN_COUNT);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned region_bits = DEFAULT_REGION_BITS;
+    struct capref frame;
+    errval_t err;
+
+    if (argc > 1) {
+        region_bits = strtoul(argv[1], NULL, 0);
+    }
+    if (region_bits < MIN_REGION_BITS || region_bits > MAX_REGION_BITS) {
+        printf("Usage: %s [region_bits %d..%d]\n", argv[0],
+               MIN_REGION_BITS, MAX_REGION_BITS);
+        return EXIT_FAILURE;
+    }
+
+    bench_init();
+
+    size_t bytes = 1UL << region_bits;
+    err = frame_alloc(&frame, bytes, NULL);
+    EXPECT_SUCCESS(err, "frame_alloc");
+
+    printf("region of %zu MiB, %d runs each\n", bytes >> 20, RUN_COUNT);
+    for (size_t i = 0; i < NKINDS; i++) {
+        if (kinds[i].size > bytes) {
+            printf("%-2s skipped, region smaller than a page\n", kinds[i].name);
+            continue;
+        }
+        run(frame, bytes, &kinds[i], false);
+        run(frame, bytes, &kinds[i], true);
+    }
+
+    pmap_batch_invocations = 1;
+
+    printf("vspace_map_tput done.\n");
+    return EXIT_SUCCESS;
+}
@@ -14,6 +14,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <errno.h>
 
 #include <barrelfish/barrelfish.h>
@@ -46,6 +47,9 @@ static vfs_handle_t dump_file_vh;
 static bool local_flush = false;
 
 static char *trace_buf = NULL;
+
+/// In streaming mode, events are drained into the file while they are recorded
+static bool streaming = false;
 static bool dump_in_progress = false;
 
 struct bfscope_ack_send_state {
@@ -99,35 +103,16 @@ static void bfscope_trace_dump_finished(void)
     }
 }
 
-static void bfscope_trace_dump(void)
+static void bfscope_write(char *buf, size_t trace_length)
 {
     errval_t err;
-    int number_of_events = 0;
-    size_t trace_length = 0;
-
-    if(dump_in_progress) {
-        // Currently there is already a dump in progress, do nothing.
-        return;
-    }
-
-    // Acquire the trace buffer
-    trace_length = trace_dump(trace_buf, BFSCOPE_BUFLEN, &number_of_events);
-
-    DEBUG("bfscope: trace length %zu, nr. of events %d\n", trace_length, number_of_events);
-
-    if (trace_length <= 0 || number_of_events <= 0) {
-        DEBUG("bfscope: trace length too small, not dumping.\n");
-        goto finish;
-    }
-
-    dump_in_progress = true;
 
     DEBUG("dumping %zu bytes to NFS share\n", trace_length);
 
     size_t total_written = 0;
     while (total_written < trace_length) {
         size_t written = 0;
-        char *bufptr = trace_buf + total_written;
+        char *bufptr = buf + total_written;
         size_t bytes = trace_length - total_written;
         // artificially limit nfs writes
         //bytes = bytes > MAX_NFS_CHUNK ? MAX_NFS_CHUNK : bytes;
@@ -140,6 +125,38 @@ static void bfscope_trace_dump(void)
         DEBUG("dumping to NFS share: %zu/%zu bytes written\n", total_written, trace_length);
     }
     DEBUG("dump to NFS share done!\n");
+}
+
+static void bfscope_trace_dump(void)
+{
+    int number_of_events = 0;
+    size_t trace_length = 0;
+
+    if(dump_in_progress) {
+        // Currently there is already a dump in progress, do nothing.
+        return;
+    }
+
+    // Acquire the trace buffer
+    if (streaming) {
+        size_t events = 0;
+        trace_length = trace_stream_drain(trace_buf, BFSCOPE_BUFLEN, &events);
+        number_of_events = events;
+    } else {
+        trace_length = trace_dump(trace_buf, BFSCOPE_BUFLEN, &number_of_events);
+    }
+
+    DEBUG("bfscope: trace length %zu, nr. of events %d\n", trace_length, number_of_events);
+
+    // in streaming mode, chunks without events still carry loss counters
+    if (trace_length <= 0 || (!streaming && number_of_events <= 0)) {
+        DEBUG("bfscope: trace length too small, not dumping.\n");
+        goto finish;
+    }
+
+    dump_in_progress = true;
+
+    bfscope_write(trace_buf, trace_length);
 
 finish:
     bfscope_trace_dump_finished();
@@ -188,12 +205,15 @@ int main(int argc, char**argv)
     vfs_init();
 
     if(argc < 3) {
-        printf("Usage: %s mount-URL filepath\n", argv[0]);
+        printf("Usage: %s mount-URL filepath [stream]\n", argv[0]);
         printf("Example: %s nfs://10.110.4.4/mnt/local/nfs/gerbesim  /bfscope/trace.data\n\n"
                "    This example mounts the nfs share /mnt/local/nfs/gerbesim\n"
                "    on 10.110.4.4 (emmentaler1) in the hardcoded directory /bfscope\n"
                "    in the barrelfish VFS, and then writes the trace data into the\n"
-               "    file trace.data in the NFS share.\n",
+               "    file trace.data in the NFS share.\n\n"
+               "    With 'stream', events are written in the binary streaming\n"
+               "    format as they are recorded, decode the file with\n"
+               "    tools/tracing/trace_stream.py.\n",
                 argv[0]);
         exit(EXIT_FAILURE);
     }
@@ -212,11 +232,24 @@ int main(int argc, char**argv)
         return 1;
     }
 
+    streaming = argc > 3 && strcmp(argv[3], "stream") == 0;
+
     // do a write to the file, to check that we're able to write
     char header[] = "# bfscope trace dump\n";
+    struct trace_stream_header stream_header;
     size_t written = 0;
-    // take sizeof(header)-1 to not write null byte to file
-    err = vfs_write(dump_file_vh, header, sizeof(header)-1, &written);
+    if (streaming) {
+        err = trace_stream_start();
+        if (err_is_fail(err)) {
+            DEBUG_ERR(err, "starting trace stream");
+            return 1;
+        }
+        size_t len = trace_stream_header(&stream_header, sizeof(stream_header));
+        err = vfs_write(dump_file_vh, &stream_header, len, &written);
+    } else {
+        // take sizeof(header)-1 to not write null byte to file
+        err = vfs_write(dump_file_vh, header, sizeof(header)-1, &written);
+    }
     if (err_is_fail(err)) {
         DEBUG_ERR(err, "writing header to trace dump file");
         return 1;
@@ -266,8 +299,8 @@ int main(int argc, char**argv)
         DEBUG("bfscope: dispatched event, autoflush: %d\n",
                 ((struct trace_buffer*) trace_buffer_master)->autoflush);
 
-        // Check if we are in autoflush mode
-        if(((struct trace_buffer*) trace_buffer_master)->autoflush) {
+        // Check if we are in autoflush or streaming mode
+        if(((struct trace_buffer*) trace_buffer_master)->autoflush || streaming) {
             local_flush = true;
             bfscope_trace_dump();
         }
@@ -86,6 +86,22 @@
 #define BLOCK_COUNT DEFAULT_BLOCK_COUNT
 #define BLOCK_SIZE DEFAULT_BLOCK_SIZE
 
+/*
+ * BLOCK CACHE SETTINGS
+ */
+
+/// enables the block cache in front of the block storage
+#define BLOCK_CACHE_ENABLE 1
+
+/// the number of blocks held by the cache
+#define BLOCK_CACHE_BLOCKS (BLOCK_COUNT / 4)
+
+/// the number of independently locked shards of the cache
+#define BLOCK_CACHE_SHARDS 8
+
+/// the number of blocks read ahead when a sequential access is detected
+#define BLOCK_CACHE_READAHEAD 8
+
 /* setting the backend flags */
 #ifdef NET_PROXY
 #define BULK_NET_BACKEND_PROXY 1
@@ -35,6 +35,7 @@
 
 #if (BLOCK_ENABLE_NETWORKING == 0)
 #include "block_storage.h"
+#include "block_storage_cache.h"
 #endif // (RUN_NET == 0)
 
 /**
@@ -110,10 +111,6 @@ int main(int argc, char *argv[])
     return EXIT_SUCCESS;
 #endif
 #endif
-    /*
-     * TODO: Setup block caching
-     */
-
     /*
      * Initialize the core local server (flounder interface)
      */
@@ -127,6 +124,12 @@ int main(int argc, char *argv[])
         USER_PANIC_ERR(err, "could not initialize the block service.\n");
         exit(EXIT_FAILURE);
     }
+
+    err = block_cache_init(BLOCK_COUNT, block_storage_get_block_size());
+    if (err_is_fail(err)) {
+        USER_PANIC_ERR(err, "could not initialize the block cache.\n");
+        exit(EXIT_FAILURE);
+    }
 #endif // RUN_NET
 
     err = block_local_init(&block_server, flags);
@@ -12,19 +12,389 @@
  * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
  */
 
+#include <string.h>
+
 #include <barrelfish/barrelfish.h>
+#include <barrelfish/threads.h>
 
 #include "block_server.h"
-
+#include "block_storage.h"
 #include "block_storage_cache.h"
 
+/*
+ * The block cache keeps copies of recently used blocks in front of the block
+ * storage. It is split into BLOCK_CACHE_SHARDS shards by block id, each with
+ * its own lock, hash table and replacement state.
+ *
+ * Every shard uses the 2Q replacement policy: a block seen for the first time
+ * enters the FIFO queue a1in. When it is evicted from there, its id is kept in
+ * the ghost queue a1out. A block that misses while its id is in a1out is being
+ * reused and goes into the LRU queue am. Blocks of a single sequential scan
+ * thus never push the frequently used blocks out of am.
+ */
+
+enum cache_queue
+{
+    CACHE_FREE,
+    CACHE_A1IN,
+    CACHE_AM,
+    CACHE_A1OUT,
+};
+
+struct cache_entry
+{
+    size_t blockid;
+    enum cache_queue queue;
+    bool readahead;                     ///< read ahead and not used yet
+    void *data;                         ///< NULL for ghost entries
+    struct cache_entry *prev;
+    struct cache_entry *next;
+    struct cache_entry *hnext;          ///< next entry in the hash bucket
+};
+
+struct cache_list
+{
+    struct cache_entry *head;
+    struct cache_entry *tail;
+    size_t count;
+};
+
+struct cache_shard
+{
+    struct thread_mutex lock;
+    struct cache_entry **buckets;
+    size_t nbuckets;
+    struct cache_list free;             ///< unused entries with data
+    struct cache_list ghosts;           ///< unused ghost entries
+    struct cache_list a1in;
+    struct cache_list am;
+    struct cache_list a1out;
+    size_t kin;                         ///< target size of a1in
+    struct block_cache_stats stats;
+};
+
+struct block_cache
+{
+    bool ready;
+    bool enabled;
+    size_t num_blocks;
+    size_t block_size;
+    size_t last_read;                   ///< hint for sequential detection
+    struct cache_shard shards[BLOCK_CACHE_SHARDS];
+};
+
+static struct block_cache cache;
+
+/* ---------------------------  Queue Handling  --------------------------- */
+
+static void list_push_head(struct cache_list *l, struct cache_entry *e)
+{
+    e->prev = NULL;
+    e->next = l->head;
+    if (l->head) {
+        l->head->prev = e;
+    } else {
+        l->tail = e;
+    }
+    l->head = e;
+    l->count++;
+}
+
+static void list_remove(struct cache_list *l, struct cache_entry *e)
+{
+    if (e->prev) {
+        e->prev->next = e->next;
+    } else {
+        l->head = e->next;
+    }
+    if (e->next) {
+        e->next->prev = e->prev;
+    } else {
+        l->tail = e->prev;
+    }
+    e->prev = e->next = NULL;
+    l->count--;
+}
+
+static struct cache_entry *list_pop_tail(struct cache_list *l)
+{
+    struct cache_entry *e = l->tail;
+    if (e) {
+        list_remove(l, e);
+    }
+    return e;
+}
+
+static struct cache_list *queue_list(struct cache_shard *s,
+                                     enum cache_queue q)
+{
+    switch (q) {
+    case CACHE_A1IN:
+        return &s->a1in;
+    case CACHE_AM:
+        return &s->am;
+    case CACHE_A1OUT:
+        return &s->a1out;
+    default:
+        assert(!"entry not on a queue");
+        return NULL;
+    }
+}
+
+/* ---------------------------  Hash Table  ------------------------------- */
+
+static inline struct cache_shard *shard_of(size_t blockid)
+{
+    return &cache.shards[blockid % BLOCK_CACHE_SHARDS];
+}
+
+static inline struct cache_entry **bucket_of(struct cache_shard *s,
+                                             size_t blockid)
+{
+    return &s->buckets[(blockid / BLOCK_CACHE_SHARDS) & (s->nbuckets - 1)];
+}
+
+static struct cache_entry *hash_find(struct cache_shard *s, size_t blockid)
+{
+    struct cache_entry *e = *bucket_of(s, blockid);
+    while (e && e->blockid != blockid) {
+        e = e->hnext;
+    }
+    return e;
+}
+
+static void hash_insert(struct cache_shard *s, struct cache_entry *e)
+{
+    struct cache_entry **b = bucket_of(s, e->blockid);
+    e->hnext = *b;
+    *b = e;
+}
+
+static void hash_remove(struct cache_shard *s, struct cache_entry *e)
+{
+    struct cache_entry **p = bucket_of(s, e->blockid);
+    while (*p != e) {
+        assert(*p);
+        p = &(*p)->hnext;
+    }
+    *p = e->hnext;
+}
+
+/* ---------------------------  Replacement  ------------------------------ */
+
 /**
- * list of buffers received
+ * \brief returns the entry of a cached block and updates its recency
+ */
+static struct cache_entry *shard_touch(struct cache_shard *s, size_t blockid)
+{
+    struct cache_entry *e = hash_find(s, blockid);
+    if (e == NULL || e->queue == CACHE_A1OUT) {
+        return NULL;
+    }
+
+    if (e->queue == CACHE_AM) {
+        list_remove(&s->am, e);
+        list_push_head(&s->am, e);
+    }
+    if (e->readahead) {
+        e->readahead = false;
+        s->stats.readahead_hits++;
+    }
+    return e;
+}
+
+/**
+ * \brief frees up an entry with data, evicting a block if necessary
+ */
+static struct cache_entry *shard_reclaim(struct cache_shard *s)
+{
+    struct cache_entry *victim = list_pop_tail(&s->free);
+    if (victim) {
+        return victim;
+    }
+
+    if (s->a1in.count > s->kin || s->am.count == 0) {
+        victim = list_pop_tail(&s->a1in);
+        assert(victim);
+        hash_remove(s, victim);
+
+        /* remember the evicted block in a1out */
+        struct cache_entry *ghost = list_pop_tail(&s->ghosts);
+        if (ghost == NULL) {
+            ghost = list_pop_tail(&s->a1out);
+            if (ghost) {
+                hash_remove(s, ghost);
+            }
+        }
+        if (ghost) {
+            ghost->blockid = victim->blockid;
+            ghost->queue = CACHE_A1OUT;
+            hash_insert(s, ghost);
+            list_push_head(&s->a1out, ghost);
+        }
+    } else {
+        victim = list_pop_tail(&s->am);
+        hash_remove(s, victim);
+    }
+
+    s->stats.evictions++;
+    return victim;
+}
+
+/**
+ * \brief allocates an entry for a block that is not cached yet
  *
- * XXX: maybe maintain one for each pool / channel ?
+ * The caller has to fill in the data.
  */
+static struct cache_entry *shard_alloc(struct cache_shard *s, size_t blockid)
+{
+    enum cache_queue q = CACHE_A1IN;
+
+    struct cache_entry *ghost = hash_find(s, blockid);
+    if (ghost) {
+        /* the block was evicted from a1in recently, it is being reused */
+        assert(ghost->queue == CACHE_A1OUT);
+        list_remove(&s->a1out, ghost);
+        hash_remove(s, ghost);
+        ghost->queue = CACHE_FREE;
+        list_push_head(&s->ghosts, ghost);
+        q = CACHE_AM;
+    }
+
+    struct cache_entry *e = shard_reclaim(s);
+    e->blockid = blockid;
+    e->queue = q;
+    e->readahead = false;
+    hash_insert(s, e);
+    list_push_head(queue_list(s, q), e);
+
+    return e;
+}
+
+static void shard_drop(struct cache_shard *s, struct cache_entry *e)
+{
+    list_remove(queue_list(s, e->queue), e);
+    hash_remove(s, e);
+    e->queue = CACHE_FREE;
+    list_push_head(e->data ? &s->free : &s->ghosts, e);
+}
 
-struct buffer_list *bs_bulk_buffers = NULL;
+static void shard_clear(struct cache_shard *s)
+{
+    struct cache_entry *e;
+    while ((e = s->a1in.tail) || (e = s->am.tail) || (e = s->a1out.tail)) {
+        shard_drop(s, e);
+    }
+}
+
+/**
+ * \brief reads the blocks following a sequential access into the cache
+ */
+static void block_cache_readahead(size_t blockid)
+{
+    size_t end = blockid + BLOCK_CACHE_READAHEAD;
+    if (end > cache.num_blocks) {
+        end = cache.num_blocks;
+    }
+    for (size_t id = blockid; id < end; id++) {
+        struct cache_shard *s = shard_of(id);
+        thread_mutex_lock(&s->lock);
+        struct cache_entry *e = hash_find(s, id);
+        if (e == NULL || e->queue == CACHE_A1OUT) {
+            e = shard_alloc(s, id);
+            errval_t err = block_storage_read(id, e->data);
+            if (err_is_fail(err)) {
+                shard_drop(s, e);
+            } else {
+                e->readahead = true;
+                s->stats.readahead++;
+            }
+        }
+        thread_mutex_unlock(&s->lock);
+    }
+}
+
+/* ---------------------------  Public Interface  ------------------------- */
+
+/**
+ * \brief initializes the block cache
+ *
+ * \param num_blocks    the number of blocks in the block storage
+ * \param block_size    the size of a single block in bytes
+ */
+errval_t block_cache_init(size_t num_blocks, size_t block_size)
+{
+    if (cache.ready) {
+        return SYS_ERR_OK;
+    }
+
+    size_t capacity = BLOCK_CACHE_BLOCKS / BLOCK_CACHE_SHARDS;
+    if (capacity == 0) {
+        capacity = 1;
+    }
+    size_t nghosts = capacity / 2;
+    size_t nbuckets = 1;
+    while (nbuckets < 2 * (capacity + nghosts)) {
+        nbuckets <<= 1;
+    }
+
+    cache.num_blocks = num_blocks;
+    cache.block_size = block_size;
+    cache.last_read = SIZE_MAX;
+
+    for (int i = 0; i < BLOCK_CACHE_SHARDS; i++) {
+        struct cache_shard *s = &cache.shards[i];
+        memset(s, 0, sizeof(*s));
+        thread_mutex_init(&s->lock);
+
+        s->kin = capacity / 4 ? capacity / 4 : 1;
+        s->nbuckets = nbuckets;
+        s->buckets = calloc(nbuckets, sizeof(struct cache_entry *));
+        struct cache_entry *entries = calloc(capacity + nghosts,
+                                             sizeof(struct cache_entry));
+        uint8_t *data = malloc(capacity * block_size);
+        if (s->buckets == NULL || entries == NULL || data == NULL) {
+            return LIB_ERR_MALLOC_FAIL;
+        }
+
+        for (size_t j = 0; j < capacity; j++) {
+            entries[j].data = data + j * block_size;
+            list_push_head(&s->free, &entries[j]);
+        }
+        for (size_t j = capacity; j < capacity + nghosts; j++) {
+            list_push_head(&s->ghosts, &entries[j]);
+        }
+    }
+
+    cache.enabled = BLOCK_CACHE_ENABLE;
+    cache.ready = true;
+
+    return SYS_ERR_OK;
+}
+
+/**
+ * \brief enables or disables the cache. Disabling drops all cached blocks.
+ */
+void block_cache_set_enabled(bool enabled)
+{
+    assert(cache.ready);
+
+    if (!enabled) {
+        for (int i = 0; i < BLOCK_CACHE_SHARDS; i++) {
+            struct cache_shard *s = &cache.shards[i];
+            thread_mutex_lock(&s->lock);
+            shard_clear(s);
+            thread_mutex_unlock(&s->lock);
+        }
+    }
+    cache.last_read = SIZE_MAX;
+    cache.enabled = enabled;
+}
+
+bool block_cache_is_enabled(void)
+{
+    return cache.ready && cache.enabled;
+}
 
 /**
  * \brief inserts a new block into the cache
@@ -34,7 +404,21 @@ struct buffer_list *bs_bulk_buffers = NULL;
  */
 errval_t block_cache_insert(size_t blockid, void *data)
 {
-    assert(!"NYI: block_cache_insert");
+    if (!block_cache_is_enabled()) {
+        return SYS_ERR_OK;
+    }
+
+    struct cache_shard *s = shard_of(blockid);
+    thread_mutex_lock(&s->lock);
+
+    struct cache_entry *e = hash_find(s, blockid);
+    if (e == NULL || e->queue == CACHE_A1OUT) {
+        e = shard_alloc(s, blockid);
+    }
+    memcpy(e->data, data, cache.block_size);
+
+    thread_mutex_unlock(&s->lock);
+
     return SYS_ERR_OK;
 }
 
@@ -45,7 +429,21 @@ errval_t block_cache_insert(size_t blockid, void *data)
  */
 errval_t block_cache_invalidate(size_t blockid)
 {
-    assert(!"NYI: block_cache_invalidate");
+    if (!block_cache_is_enabled()) {
+        return SYS_ERR_OK;
+    }
+
+    struct cache_shard *s = shard_of(blockid);
+    thread_mutex_lock(&s->lock);
+
+    struct cache_entry *e = hash_find(s, blockid);
+    if (e != NULL && e->queue != CACHE_A1OUT) {
+        shard_drop(s, e);
+        s->stats.invalidations++;
+    }
+
+    thread_mutex_unlock(&s->lock);
+
     return SYS_ERR_OK;
 }
 
@@ -54,13 +452,129 @@ errval_t block_cache_invalidate(size_t blockid)
  *
  * \param blockid   the ID of the block to lookup
  * \param ret_data  pointer to the returned data XXX: bulk_buf?
+ *
+ * Returns NULL in ret_data if the block is not cached. The data is valid until
+ * the cache is modified the next time.
  */
 errval_t block_cache_lookup(size_t blockid, void **ret_data)
 {
-    assert(!"NYI: block_cache_lookup");
+    *ret_data = NULL;
+
+    if (!block_cache_is_enabled()) {
+        return SYS_ERR_OK;
+    }
+
+    struct cache_shard *s = shard_of(blockid);
+    thread_mutex_lock(&s->lock);
+
+    s->stats.lookups++;
+    struct cache_entry *e = shard_touch(s, blockid);
+    if (e) {
+        s->stats.hits++;
+        *ret_data = e->data;
+    }
+
+    thread_mutex_unlock(&s->lock);
+
     return SYS_ERR_OK;
 }
 
+/**
+ * \brief reads a block through the cache
+ *
+ * \param blockid   the id of the block to read
+ * \param dst       the destination to copy the contents to
+ */
+errval_t block_cache_read(size_t blockid, void *dst)
+{
+    errval_t err;
+
+    if (!block_cache_is_enabled()) {
+        return block_storage_read(blockid, dst);
+    }
+
+    struct cache_shard *s = shard_of(blockid);
+    thread_mutex_lock(&s->lock);
+
+    s->stats.lookups++;
+    struct cache_entry *e = shard_touch(s, blockid);
+    if (e) {
+        s->stats.hits++;
+        memcpy(dst, e->data, cache.block_size);
+    } else {
+        err = block_storage_read(blockid, dst);
+        if (err_is_fail(err)) {
+            thread_mutex_unlock(&s->lock);
+            return err;
+        }
+        e = shard_alloc(s, blockid);
+        memcpy(e->data, dst, cache.block_size);
+    }
+
+    thread_mutex_unlock(&s->lock);
+
+    /* the previous block was read last, keep the following ones in cache */
+    if (blockid == cache.last_read + 1) {
+        block_cache_readahead(blockid + 1);
+    }
+    cache.last_read = blockid;
+
+    return SYS_ERR_OK;
+}
+
+/**
+ * \brief writes a block through the cache to the block storage
+ *
+ * \param blockid   the id of the block to update
+ * \param src       the data to write
+ */
+errval_t block_cache_write(size_t blockid, void *src)
+{
+    errval_t err = block_storage_write(blockid, src);
+    if (err_is_fail(err)) {
+        return err;
+    }
+
+    return block_cache_insert(blockid, src);
+}
+
+/**
+ * \brief returns the statistics summed up over all shards
+ */
+void block_cache_get_stats(struct block_cache_stats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    if (!cache.ready) {
+        return;
+    }
+
+    for (int i = 0; i < BLOCK_CACHE_SHARDS; i++) {
+        struct cache_shard *s = &cache.shards[i];
+        thread_mutex_lock(&s->lock);
+        stats->lookups += s->stats.lookups;
+        stats->hits += s->stats.hits;
+        stats->readahead += s->stats.readahead;
+        stats->readahead_hits += s->stats.readahead_hits;
+        stats->evictions += s->stats.evictions;
+        stats->invalidations += s->stats.invalidations;
+        thread_mutex_unlock(&s->lock);
+    }
+}
+
+void block_cache_reset_stats(void)
+{
+    if (!cache.ready) {
+        return;
+    }
+
+    for (int i = 0; i < BLOCK_CACHE_SHARDS; i++) {
+        struct cache_shard *s = &cache.shards[i];
+        thread_mutex_lock(&s->lock);
+        memset(&s->stats, 0, sizeof(s->stats));
+        thread_mutex_unlock(&s->lock);
+    }
+}
+
 
 struct buffer_list *bl = NULL;
 
@@ -15,10 +15,34 @@
 #ifndef BLOCK_STORAGE_CACHE_H
 #define BLOCK_STORAGE_CACHE_H
 
+struct block_cache_stats
+{
+    size_t lookups;         ///< number of blocks requested
+    size_t hits;            ///< requests served from the cache
+    size_t readahead;       ///< blocks read ahead of a sequential access
+    size_t readahead_hits;  ///< hits on blocks that were read ahead
+    size_t evictions;       ///< blocks evicted to make room
+    size_t invalidations;   ///< blocks dropped by block_cache_invalidate
+};
+
+errval_t block_cache_init(size_t num_blocks, size_t block_size);
+
+void block_cache_set_enabled(bool enabled);
+
+bool block_cache_is_enabled(void);
+
 errval_t block_cache_insert(size_t blockid, void *data);
 
 errval_t block_cache_invalidate(size_t blockid);
 
 errval_t block_cache_lookup(size_t blockid, void **ret_data);
 
+errval_t block_cache_read(size_t blockid, void *dst);
+
+errval_t block_cache_write(size_t blockid, void *src);
+
+void block_cache_get_stats(struct block_cache_stats *stats);
+
+void block_cache_reset_stats(void);
+
 #endif /* BLOCK_STORAGE_CACHE_H */
@@ -22,6 +22,7 @@
 #include <if/block_service_defs.h>
 
 #include "block_storage.h"
+#include "block_storage_cache.h"
 #include "block_server.h"
 #include "network_client.h"
 #include "local_server.h"
@@ -147,7 +148,7 @@ static void bulk_move_received(struct bulk_channel *channel,
             debug_printf("ERROR: block net write. %s", err_getstring(err));
         }
     } else {
-        err = block_storage_write(bs->block_id, buffer->address);
+        err = block_cache_write(bs->block_id, buffer->address);
         if (err_is_fail(err)) {
             BS_LOCAL_DEBUG("%s", "ERROR: block could not be written");
         }
@@ -333,7 +334,7 @@ static void rx_read_request(struct block_service_binding *binding,
             return ;
         }
 
-        err = block_storage_read(start_block + i, buf->address);
+        err = block_cache_read(start_block + i, buf->address);
         if (err_is_fail(err)) {
             debug_printf("ERROR: block id is out of range: %i",
                          (uint32_t) (start_block + count));
@@ -32,6 +32,8 @@
 #include "local_server.h"
 #include "network_common.h"
 #include "network_client.h"
+#include "block_storage.h"
+#include "block_storage_cache.h"
 
 
 /**
@@ -171,6 +173,129 @@ void testrun_bulk_move_received(struct bulk_channel *channel,
     }
 }
 
+/* ------------------------ block cache benchmark -------------------------- */
+
+/// number of runs per access pattern and cache setting
+#define CACHE_BENCH_RUNS 100
+
+/// number of blocks read in a single run
+#define CACHE_BENCH_REQUESTS (4 * BLOCK_COUNT)
+
+enum cache_bench_pattern
+{
+    CACHE_BENCH_BATCH,      ///< repeated batch reads as in the read benchmark
+    CACHE_BENCH_SCAN,       ///< sequential scans over all blocks
+    CACHE_BENCH_SKEWED,     ///< 80% of the reads go to 20% of the blocks
+    CACHE_BENCH_PATTERNS
+};
+
+static const char *cache_bench_names[CACHE_BENCH_PATTERNS] = {
+    "batch", "scan", "skewed"
+};
+
+static size_t cache_bench_trace[CACHE_BENCH_REQUESTS];
+
+static void cache_bench_fill_trace(enum cache_bench_pattern pattern)
+{
+    size_t hot = BLOCK_COUNT / 5;
+
+    srand(pattern);
+    for (uint32_t i = 0; i < CACHE_BENCH_REQUESTS; ++i) {
+        switch (pattern) {
+        case CACHE_BENCH_BATCH:
+            cache_bench_trace[i] = i % BLOCK_BENCH_READ_BATCHSIZE;
+            break;
+        case CACHE_BENCH_SCAN:
+            cache_bench_trace[i] = i % BLOCK_COUNT;
+            break;
+        default:
+            if (rand() % 5) {
+                cache_bench_trace[i] = rand() % hot;
+            } else {
+                cache_bench_trace[i] = hot + rand() % (BLOCK_COUNT - hot);
+            }
+            break;
+        }
+    }
+}
+
+/**
+ * \brief measures the block cache against the block storage of this domain
+ *
+ * The cache of the server cannot be switched on and off over the network
+ * protocol, so this runs the server side read path locally with the cache
+ * enabled and disabled.
+ */
+static void run_cache_test(uint64_t tscperus)
+{
+    errval_t err;
+
+    err = block_storage_init(BLOCK_COUNT, BLOCK_SIZE);
+    if (err_is_fail(err)) {
+        USER_PANIC_ERR(err, "could not initialize the block storage");
+    }
+
+    err = block_cache_init(BLOCK_COUNT, block_storage_get_block_size());
+    if (err_is_fail(err)) {
+        USER_PANIC_ERR(err, "could not initialize the block cache");
+    }
+
+    void *buf = malloc(block_storage_get_block_size());
+    assert(buf);
+
+    cycles_t tsc_start;
+    cycles_t result;
+    bench_ctl_t *ctl;
+    struct block_cache_stats stats;
+
+    for (int p = 0; p < CACHE_BENCH_PATTERNS; ++p) {
+        cache_bench_fill_trace(p);
+
+        for (int enabled = 0; enabled < 2; ++enabled) {
+            block_cache_set_enabled(enabled);
+            block_cache_reset_stats();
+
+            ctl = bench_ctl_init(BENCH_MODE_FIXEDRUNS, 1, CACHE_BENCH_RUNS);
+            cycles_t total = 0;
+            uint64_t runs = 0;
+            do {
+                tsc_start = rdtsc();
+                for (uint32_t i = 0; i < CACHE_BENCH_REQUESTS; ++i) {
+                    err = block_cache_read(cache_bench_trace[i], buf);
+                    if (err_is_fail(err)) {
+                        USER_PANIC_ERR(err, "failed to read block");
+                    }
+                }
+                result = rdtsc() - tsc_start;
+                total += result;
+                runs++;
+            } while (!bench_ctl_add_run(ctl, &result));
+
+            block_cache_get_stats(&stats);
+
+            uint64_t reqs_per_s = 0;
+            if (total) {
+                reqs_per_s = runs * CACHE_BENCH_REQUESTS * tscperus * 1000000
+                             / total;
+            }
+            size_t hit_ratio = 0;
+            if (stats.lookups) {
+                hit_ratio = stats.hits * 100 / stats.lookups;
+            }
+
+            BS_TEST_CTRL("cache %-3s pattern=%-6s hits=%zu%% readahead=%zu "
+                         "readahead_hits=%zu evictions=%zu reqs/s=%" PRIu64,
+                         enabled ? "on" : "off", cache_bench_names[p],
+                         hit_ratio, stats.readahead, stats.readahead_hits,
+                         stats.evictions, reqs_per_s);
+            bench_ctl_dump_analysis(ctl, 0, cache_bench_names[p], tscperus);
+            bench_ctl_destroy(ctl);
+        }
+    }
+
+    free(buf);
+}
+
 /* ------------------------ test control ----------------------------------- */
 void run_test(struct bulk_channel *txc, struct bulk_channel *rxc, void *block_service)
 {
@@ -343,6 +468,12 @@ void run_test(struct bulk_channel *txc, struct bulk_channel *rxc, void *block_se
     // bench_ctl_dump_csv(ctl, "", tscperus);
     bench_ctl_dump_analysis(ctl, 0, "", tscperus);
     bench_ctl_dump_analysis(ctl, 1, "", tscperus);
+
+    printf("\n\n");
+    BS_TEST_CTRL("%s", "Start with Benchmarks (BLOCK CACHE)");
+
+    run_cache_test(tscperus);
+
     BS_TEST_CTRL("%s", "Test run finished.");
 }
 #endif //< BLOCK_BENCH_ENABLE
@@ -26,6 +26,7 @@
 #include "network_common.h"
 #include "network_server.h"
 #include "block_storage.h"
+#include "block_storage_cache.h"
 
 #if BULK_NET_BACKEND_PROXY
 #include <bulk_transfer/bulk_allocator.h>
@@ -164,7 +165,7 @@ static void bulk_move_received(struct bulk_channel *channel,
     errval_t err;
 
     struct bs_meta_data *bs_meta = (struct bs_meta_data*) meta;
-    err = block_storage_write(bs_meta->block_id, buffer->address);
+    err = block_cache_write(bs_meta->block_id, buffer->address);
     if (err_is_fail(err)) {
         block_send_status_msg(c, BLOCK_NET_MSG_WRITE, bs_meta->req_id, err);
         debug_printf("Failed to update the block!");
@@ -207,7 +208,7 @@ static void bulk_copy_received(struct bulk_channel *channel,
     errval_t err;
 
     struct bs_meta_data *bs_meta = (struct bs_meta_data*) meta;
-    err = block_storage_write(bs_meta->block_id, buffer->address);
+    err = block_cache_write(bs_meta->block_id, buffer->address);
     if (err_is_fail(err)) {
         debug_printf("Failed to update the block!");
     }
@@ -261,7 +262,7 @@ static err_t handle_block_read(struct block_net_service*c,
             return ERR_BUF;
         }
 
-        err = block_storage_read(start_block + i, buf->address);
+        err = block_cache_read(start_block + i, buf->address);
         if (err_is_fail(err)) {
             debug_printf("ERROR: block id is out of range: %i",
                          (uint32_t) (start_block + count));
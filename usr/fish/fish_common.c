@@ -22,7 +22,9 @@
 #include <barrelfish/barrelfish.h>
 #include <barrelfish/dispatch.h>
 #include <barrelfish_kpi/init.h>
+#include <barrelfish_kpi/schedstat.h>
 #include <barrelfish/debug.h>
+#include <barrelfish/deferred.h>
 #include <barrelfish/monitor_client.h>
 #include <barrelfish/nameservice_client.h>
 #include <barrelfish/spawn_client.h>
@@ -36,6 +38,7 @@
 #include <if/pixels_defs.h>
 
 #include <if/octopus_defs.h>
+#include <if/monitor_blocking_defs.h>
 #include <octopus/getset.h> // for oct_read TODO
 #include <octopus/trigger.h> // for NOP_TRIGGER
 #include <octopus/init.h> // oct_init
@@ -171,6 +174,209 @@ static int measure_pmap_res(int argc, char *argv[]) {
     return EXIT_SUCCESS;
 }
 
+/// Scheduler statistics of our core, mapped read-only
+static volatile struct sched_stats *schedstat_frame = NULL;
+
+static errval_t schedstat_map(void)
+{
+    struct monitor_blocking_binding *mb = get_monitor_blocking_binding();
+    struct capref frame;
+    errval_t err, msgerr;
+    void *buf;
+
+    if (schedstat_frame != NULL) {
+        return SYS_ERR_OK;
+    }
+
+    err = slot_alloc(&frame);
+    if (err_is_fail(err)) {
+        return err_push(err, LIB_ERR_SLOT_ALLOC);
+    }
+
+    msgerr = mb->rpc_tx_vtbl.get_schedstat_cap(mb, &err, &frame);
+    if (err_is_fail(msgerr) || err_is_fail(err)) {
+        slot_free(frame);
+        return err_is_fail(msgerr) ? msgerr : err;
+    }
+
+    err = vspace_map_one_frame_attr(&buf, BASE_PAGE_SIZE, frame,
+                                    VREGION_FLAGS_READ, NULL, NULL);
+    if (err_is_fail(err)) {
+        cap_destroy(frame);
+        return err_push(err, LIB_ERR_VSPACE_MAP);
+    }
+
+    schedstat_frame = buf;
+    return SYS_ERR_OK;
+}
+
+/// Copy the statistics while the kernel is not updating them
+static void schedstat_snapshot(struct sched_stats *dst)
+{
+    volatile struct sched_stats *src = schedstat_frame;
+    uint64_t seq;
+
+    do {
+        while ((seq = src->seq) & 1) {
+            // the kernel is updating the statistics
+        }
+        __asm volatile("" ::: "memory");
+        memcpy(dst, (void *)src, sizeof(*dst));
+        __asm volatile("" ::: "memory");
+    } while (src->seq != seq);
+}
+
+static void schedstat_hist_diff(struct schedstat_hist *h,
+                                const struct schedstat_hist *prev)
+{
+    // the maximum can't be taken apart, it stays the one since boot
+    h->count -= prev->count;
+    h->sum -= prev->sum;
+    for (int i = 0; i < SCHEDSTAT_HIST_BUCKETS; i++) {
+        h->bucket[i] -= prev->bucket[i];
+    }
+}
+
+static void schedstat_diff(struct sched_stats *s, const struct sched_stats *prev)
+{
+    s->schedules -= prev->schedules;
+    s->idle -= prev->idle;
+    s->context_switches -= prev->context_switches;
+    s->wakeups -= prev->wakeups;
+    s->yields -= prev->yields;
+    s->preemptions -= prev->preemptions;
+    s->slack_overruns -= prev->slack_overruns;
+    schedstat_hist_diff(&s->wakeup_latency, &prev->wakeup_latency);
+    schedstat_hist_diff(&s->runq, &prev->runq);
+    schedstat_hist_diff(&s->slack, &prev->slack);
+}
+
+/// Upper bound of the log2 bucket holding the given percentile
+static uint64_t schedstat_percentile(const struct schedstat_hist *h, int p)
+{
+    uint64_t seen = 0;
+    for (int i = 0; i < SCHEDSTAT_HIST_BUCKETS; i++) {
+        seen += h->bucket[i];
+        if (seen * 100 >= h->count * p) {
+            uint64_t bound = (2ULL << i) - 1;
+            return bound < h->max ? bound : h->max;
+        }
+    }
+    return h->max;
+}
+
+static void schedstat_print_hist(const char *name,
+                                 const struct schedstat_hist *h,
+                                 uint64_t freq, bool verbose)
+{
+    if (h->count == 0) {
+        printf("%-16s no samples\n", name);
+        return;
+    }
+
+    // systime ticks to microseconds
+    double us = freq > 0 ? 1e6 / freq : 1.0;
+
+    printf("%-16s n=%"PRIu64" mean %.2lf p50 <%.2lf p99 <%.2lf max %.2lf us\n",
+           name, h->count, (double)h->sum / h->count * us,
+           schedstat_percentile(h, 50) * us, schedstat_percentile(h, 99) * us,
+           h->max * us);
+
+    if (verbose) {
+        for (int i = 0; i < SCHEDSTAT_HIST_BUCKETS; i++) {
+            if (h->bucket[i] != 0) {
+                printf("    %12.2lf .. %-12.2lf us %12"PRIu64"\n",
+                       (i == 0 ? 0 : 1ULL << i) * us, (2ULL << i) * us,
+                       h->bucket[i]);
+            }
+        }
+    }
+}
+
+static void schedstat_print(const struct sched_stats *s, bool verbose)
+{
+    printf("core %u: %"PRIu64" schedules (%"PRIu64" idle), "
+           "%"PRIu64" context switches\n", s->core_id, s->schedules, s->idle,
+           s->context_switches);
+    printf("%"PRIu64" wakeups, %"PRIu64" yields, %"PRIu64" preemptions, "
+           "%"PRIu64" slack overruns\n", s->wakeups, s->yields,
+           s->preemptions, s->slack_overruns);
+
+    const struct schedstat_hist *rq = &s->runq;
+    printf("run queue: now %"PRIu64", mean %.2lf, max %"PRIu64"\n",
+           s->runq_len, rq->count > 0 ? (double)rq->sum / rq->count : 0.0,
+           rq->max);
+    if (verbose) {
+        for (int i = 0; i < SCHEDSTAT_HIST_BUCKETS; i++) {
+            if (rq->bucket[i] != 0) {
+                printf("    %s%-3d %12"PRIu64"\n",
+                       i == SCHEDSTAT_HIST_BUCKETS - 1 ? ">=" : "", i,
+                       rq->bucket[i]);
+            }
+        }
+    }
+
+    schedstat_print_hist("wakeup latency", &s->wakeup_latency,
+                         s->systime_frequency, verbose);
+    schedstat_print_hist("deadline slack", &s->slack,
+                         s->systime_frequency, verbose);
+}
+
+static int schedstat(int argc, char *argv[])
+{
+    bool verbose = false;
+    unsigned long interval = 0, count = 1;
+    errval_t err;
+
+    if (argc > 1 && strcmp(argv[1], "-v") == 0) {
+        verbose = true;
+        argc--;
+        argv++;
+    }
+    if (argc > 1) {
+        interval = strtoul(argv[1], NULL, 0);
+        count = argc > 2 ? strtoul(argv[2], NULL, 0) : 1;
+    }
+    if (argc > 3 || (argc > 1 && interval == 0)) {
+        printf("Usage: %s [-v] [interval_ms [count]]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    err = schedstat_map();
+    if (err_is_fail(err)) {
+        DEBUG_ERR(err, "mapping scheduler statistics");
+        return EXIT_FAILURE;
+    }
+
+    struct sched_stats prev, now;
+    schedstat_snapshot(&now);
+    if (now.magic != SCHEDSTAT_MAGIC || now.version != SCHEDSTAT_VERSION) {
+        printf("%s: unknown statistics format\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (interval == 0) {
+        schedstat_print(&now, verbose);
+        return EXIT_SUCCESS;
+    }
+
+    // print what happened in each interval
+    for (unsigned long i = 0; i < count; i++) {
+        prev = now;
+        barrelfish_usleep(interval * 1000);
+        schedstat_snapshot(&now);
+
+        struct sched_stats delta = now;
+        schedstat_diff(&delta, &prev);
+        if (i > 0) {
+            printf("\n");
+        }
+        schedstat_print(&delta, verbose);
+    }
+
+    return EXIT_SUCCESS;
+}
+
 static int setenvcmd(int argc, char *argv[])
 {
     if (argc <= 1) {
@@ -1269,6 +1475,7 @@ static struct cmd commands[] = {
     {"free", freecmd, "Display amount of free memory in the system"},
     {"dump_caps", dump_caps, "Display cspace debug information"},
     {"measure_pmap_res", measure_pmap_res, "Display pmap resource usage for shell"},
+    {"schedstat", schedstat, "Display scheduler statistics of this core"},
 };
 
 static struct cmd *find_command(const char *name)
@@ -146,6 +146,7 @@ struct pending_reply {
     struct mem_binding *b;
     errval_t err;
     struct capref *cap;
+    uint32_t count;
 };
 
 
@@ -257,29 +258,28 @@ static void mem_available_handler(struct mem_binding *b)
 
 }
 
-// FIXME: error handling (not asserts) needed in this function
-static void mem_allocate_handler(struct mem_binding *b, uint8_t bits,
-                                 genpaddr_t minbase, genpaddr_t maxlimit)
+static void mem_stats_handler(struct mem_binding *b)
 {
-    struct capref *cap = malloc(sizeof(struct capref));
-    errval_t err, ret;
-
-    // TODO: do this properly and inform caller, -SG 2016-04-20
-    // XXX: Do we even want to have this restriction here? It's not necessary
-    // for types that are not mappable (e.g. Dispatcher)
-    //if (bits < BASE_PAGE_BITS) {
-    //    bits = BASE_PAGE_BITS;
-    //}
-    //if (bits < BASE_PAGE_BITS) {
-    //    debug_printf("WARNING: ALLOCATING RAM CAP WITH %u BITS\n", bits);
-    //}
+    errval_t err;
+    /* Reply: the central server never steals or gives memory to peers */
+    err = b->tx_vtbl.stats_response(b, NOP_CONT, mem_avail, mem_total,
+                                    0, 0, 0, 0, 0, 0, 0);
+    if (err_is_fail(err)) {
+        // FIXME: handle FLOUNDER_ERR_TX_BUSY
+        DEBUG_ERR(err, "failed to reply to stats request");
+    }
+}
 
-    trace_event(TRACE_SUBSYS_MEMSERV, TRACE_EVENT_MEMSERV_ALLOC, bits);
+/// Refill the slot and slab allocators of the MM instance, if needed
+// FIXME: error handling (not asserts) needed in this function
+static void refill_mm_allocators(void)
+{
+    errval_t err;
 
     /* refill slot allocator if needed */
     err = slot_prealloc_refill(mm_ram.slot_alloc_inst);
     if (err_is_fail(err)) {
-        DEBUG_ERR(err, "slot_prealloc_refill in mem_allocate_handler");
+        DEBUG_ERR(err, "slot_prealloc_refill in refill_mm_allocators");
     }
     assert(err_is_ok(err));
 
@@ -298,6 +298,27 @@ static void mem_allocate_handler(struct mem_binding *b, uint8_t bits,
         }
         slab_grow(&mm_ram.slabs, buf, BASE_PAGE_SIZE * 8);
     }
+}
+
+static void mem_allocate_handler(struct mem_binding *b, uint8_t bits,
+                                 genpaddr_t minbase, genpaddr_t maxlimit)
+{
+    struct capref *cap = malloc(sizeof(struct capref));
+    errval_t err, ret;
+
+    // TODO: do this properly and inform caller, -SG 2016-04-20
+    // XXX: Do we even want to have this restriction here? It's not necessary
+    // for types that are not mappable (e.g. Dispatcher)
+    //if (bits < BASE_PAGE_BITS) {
+    //    bits = BASE_PAGE_BITS;
+    //}
+    //if (bits < BASE_PAGE_BITS) {
+    //    debug_printf("WARNING: ALLOCATING RAM CAP WITH %u BITS\n", bits);
+    //}
+
+    trace_event(TRACE_SUBSYS_MEMSERV, TRACE_EVENT_MEMSERV_ALLOC, bits);
+
+    refill_mm_allocators();
 
 #ifdef OSDI18_PAPER_HACK
     //// XXX HACK for OSDI PAPER!!! BAD!
@@ -359,6 +380,178 @@ static void mem_allocate_handler(struct mem_binding *b, uint8_t bits,
     }
 }
 
+static void allocate_batch_response_done(void *arg)
+{
+    struct capref *cap = arg;
+
+    if (!capref_is_null(*cap)) {
+        errval_t err = cap_delete(*cap);
+        if (err_is_fail(err) && err_no(err) != SYS_ERR_CAP_NOT_FOUND) {
+            DEBUG_ERR(err, "cap_delete of batch CNode after send");
+        }
+        slot_free(*cap);
+    }
+
+    free(cap);
+}
+
+static void retry_batch_reply(void *arg)
+{
+    struct pending_reply *r = arg;
+    assert(r != NULL);
+    struct mem_binding *b = r->b;
+    errval_t err;
+
+    err = b->tx_vtbl.allocate_batch_response(b,
+                MKCONT(allocate_batch_response_done, r->cap), r->err, r->count,
+                *r->cap);
+    if (err_is_ok(err)) {
+        b->st = NULL;
+        free(r);
+    } else if (err_no(err) == FLOUNDER_ERR_TX_BUSY) {
+        err = b->register_send(b, get_default_waitset(),
+                               MKCONT(retry_batch_reply, r));
+        assert(err_is_ok(err));
+    } else {
+        DEBUG_ERR(err, "failed to reply to batch memory request");
+        allocate_batch_response_done(r->cap);
+        free(r);
+    }
+}
+
+/**
+ * \brief Allocate up to count regions into a new L2 CNode
+ *
+ * Stops at the first allocation or copy that fails; it is only an error if
+ * not even one region could be allocated.
+ */
+static errval_t mymm_alloc_batch(uint8_t bits, uint32_t count,
+                                 genpaddr_t minbase, genpaddr_t maxlimit,
+                                 struct capref *retcn, uint32_t *retcount)
+{
+    struct cnoderef cnode;
+    errval_t err;
+
+    *retcount = 0;
+
+    err = cnode_create_l2(retcn, &cnode);
+    if (err_is_fail(err)) {
+        *retcn = NULL_CAP;
+        return err_push(err, LIB_ERR_CNODE_CREATE);
+    }
+    /* the CNode is freed back to us when the client deletes it */
+    mem_avail -= L2_CNODE_SLOTS * (1UL << OBJBITS_CTE);
+
+    for (uint32_t i = 0; i < count; i++) {
+        struct capref cap;
+
+        refill_mm_allocators();
+        err = mymm_alloc(&cap, bits, minbase, maxlimit);
+        if (err_is_fail(err)) {
+            break;
+        }
+        mem_avail -= 1UL << bits;
+
+        struct capref dest = {
+            .cnode = cnode,
+            .slot = i,
+        };
+        err = cap_copy(dest, cap);
+        if (err_is_fail(err)) {
+            DEBUG_ERR(err, "cap_copy to batch CNode");
+            err = err_push(err, LIB_ERR_CAP_COPY);
+            struct capability info;
+            errval_t err2 = debug_cap_identify(cap, &info);
+            if (err_is_ok(err2)) {
+                err2 = mymm_free(cap, info.u.ram.base, bits);
+            }
+            if (err_is_fail(err2)) {
+                DEBUG_ERR(err2, "returning RAM after failed copy to batch CNode");
+            }
+            break;
+        }
+        err = cap_delete(cap);
+        if (err_is_fail(err)) {
+            DEBUG_ERR(err, "cap_delete after copy to batch CNode");
+        }
+        *retcount = i + 1;
+    }
+
+    if (*retcount == 0) {
+        /* nothing to hand out: the CNode's memory comes back via free */
+        errval_t err2 = cap_destroy(*retcn);
+        if (err_is_fail(err2)) {
+            DEBUG_ERR(err2, "cap_destroy of empty batch CNode");
+        }
+        *retcn = NULL_CAP;
+        return err;
+    }
+
+    return SYS_ERR_OK;
+}
+
+/**
+ * \brief Is the client on the other end of the binding on this core?
+ *
+ * Only LMP channels connect dispatchers on the same core. The core ID a
+ * client passes in is not trusted.
+ */
+static bool client_is_local(struct mem_binding *b)
+{
+    struct waitset_chanstate *cs = b->get_receiving_chanstate(b);
+    return cs != NULL && cs->chantype == CHANTYPE_LMP_IN;
+}
+
+static void mem_allocate_batch_handler(struct mem_binding *b, coreid_t core,
+                                       uint8_t bits, uint32_t count,
+                                       genpaddr_t minbase, genpaddr_t maxlimit)
+{
+    struct capref *cap = malloc(sizeof(struct capref));
+    uint32_t retcount;
+    errval_t err, ret;
+
+    assert(cap != NULL);
+
+    trace_event(TRACE_SUBSYS_MEMSERV, TRACE_EVENT_MEMSERV_ALLOC, bits);
+
+    if (count > L2_CNODE_SLOTS) {
+        count = L2_CNODE_SLOTS;
+    }
+
+    if (core != disp_get_core_id() || !client_is_local(b)) {
+        ret = LIB_ERR_RAM_ALLOC_BATCH_REMOTE;
+        retcount = 0;
+        *cap = NULL_CAP;
+    } else if (count == 0) {
+        ret = LIB_ERR_RAM_ALLOC_BATCH_COUNT;
+        retcount = 0;
+        *cap = NULL_CAP;
+    } else {
+        refill_mm_allocators();
+        ret = mymm_alloc_batch(bits, count, minbase, maxlimit, cap, &retcount);
+    }
+
+    /* Reply */
+    err = b->tx_vtbl.allocate_batch_response(b,
+                MKCONT(allocate_batch_response_done, cap), ret, retcount, *cap);
+    if (err_is_fail(err)) {
+        if (err_no(err) == FLOUNDER_ERR_TX_BUSY) {
+            struct pending_reply *r = malloc(sizeof(struct pending_reply));
+            assert(r != NULL);
+            r->b = b;
+            r->err = ret;
+            r->cap = cap;
+            r->count = retcount;
+            err = b->register_send(b, get_default_waitset(),
+                                   MKCONT(retry_batch_reply, r));
+            assert(err_is_ok(err));
+        } else {
+            DEBUG_ERR(err, "failed to reply to batch memory request");
+            allocate_batch_response_done(cap);
+        }
+    }
+}
+
 static void dump_ram_region(int idx, struct mem_region* m)
 {
 #if 0
@@ -558,7 +751,9 @@ static void export_callback(void *st, errval_t err, iref_t iref)
 
 static struct mem_rx_vtbl rx_vtbl = {
     .allocate_call = mem_allocate_handler,
+    .allocate_batch_call = mem_allocate_batch_handler,
     .available_call = mem_available_handler,
+    .stats_call = mem_stats_handler,
     .free_monitor_call = mem_free_handler,
 };
 
@@ -19,6 +19,7 @@
 
 #include <barrelfish/barrelfish.h>
 
+#include "mem_serv.h"
 #include "skb.h"
 
 #include "args.h"
@@ -195,11 +196,13 @@ struct args process_args(int argc, char *argv[])
         .all_cores = false,
         .master = false,
         .ram = 0,
+        .low_watermark = LOW_WATERMARK,
+        .high_watermark = HIGH_WATERMARK,
     };
     
     int opt;
 
-    while ((opt = getopt(argc, argv, "wmax:c:n:r:")) != -1) {
+    while ((opt = getopt(argc, argv, "wmax:c:n:r:l:h:")) != -1) {
  
         switch (opt) {
         case 'w':
@@ -236,6 +239,14 @@ struct args process_args(int argc, char *argv[])
             // memory to use per core
             res.ram = (genpaddr_t) strtoll(optarg, NULL, 10);
             break;
+        case 'l':
+            // steal from peers when free memory drops below this
+            res.low_watermark = (genpaddr_t) strtoll(optarg, NULL, 10);
+            break;
+        case 'h':
+            // amount of free memory to steal up to
+            res.high_watermark = (genpaddr_t) strtoll(optarg, NULL, 10);
+            break;
         default:
             goto fail;
         }
@@ -258,6 +269,10 @@ struct args process_args(int argc, char *argv[])
         goto fail;
     }
 
+    if (res.high_watermark < res.low_watermark) {
+        goto fail;
+    }
+
     if (res.cores != NULL) {
         coreid_t *cores;
         int cores_len;
@@ -278,8 +293,8 @@ struct args process_args(int argc, char *argv[])
     return res;
 
  fail:
-    printf("Usage: %s [-mw] [-a] [-c list] [-x list] [-n num_cores]\n", 
-           argv[0]);
+    printf("Usage: %s [-mw] [-a] [-c list] [-x list] [-n num_cores] "
+           "[-r bytes] [-l low_watermark] [-h high_watermark]\n", argv[0]);
     exit(EXIT_FAILURE);
     return res;
 }
@@ -25,6 +25,8 @@ struct args {
     bool all_cores;
     bool master;
     genpaddr_t ram;
+    genpaddr_t low_watermark;
+    genpaddr_t high_watermark;
 };
 
 struct args process_args(int argc, char *argv[]);
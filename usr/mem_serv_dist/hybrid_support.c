@@ -47,6 +47,7 @@ struct pending_reply {
     struct capref *acap, cap;
     memsize_t mem_avail, mem_total;
     errval_t err;
+    uint32_t count;
 };
 
 
@@ -90,6 +91,46 @@ static void retry_allocate_reply(void *arg)
     }
 }
 
+static void allocate_batch_response_done(void *arg)
+{
+    struct capref *cap = arg;
+
+    if (!capref_is_null(*cap)) {
+        errval_t err = cap_delete(*cap);
+        if (err_is_fail(err)) {
+            DEBUG_ERR(err, "cap_delete of batch CNode after send");
+        }
+        slot_free(*cap);
+    }
+
+    free(cap);
+}
+
+static void retry_allocate_batch_reply(void *arg)
+{
+    struct pending_reply *r = arg;
+    assert(r != NULL);
+    struct mem_binding *b = r->b;
+    errval_t err;
+
+    err = b->tx_vtbl.allocate_batch_response(b,
+                MKCONT(allocate_batch_response_done, r->acap), r->err,
+                r->count, *r->acap);
+    if (err_is_ok(err)) {
+        b->st = NULL;
+        free(r);
+    } else if (err_no(err) == FLOUNDER_ERR_TX_BUSY) {
+        err = b->register_send(b, get_default_waitset(),
+                               MKCONT(retry_allocate_batch_reply,r));
+    }
+
+    if (err_is_fail(err)) {
+        DEBUG_ERR(err, "failed to reply to batch memory request");
+        allocate_batch_response_done(r->acap);
+        free(r);
+    }
+}
+
 static void retry_steal_reply(void *arg)
 {
     struct pending_reply *r = arg;
@@ -135,6 +176,37 @@ static void retry_available_reply(void *arg)
 }
 
 
+/// state for a pending stats reply
+struct pending_stats_reply {
+    struct mem_binding *b;
+    memsize_t mem_avail, mem_total;
+    struct steal_stats stats;
+};
+
+static void retry_stats_reply(void *arg)
+{
+    struct pending_stats_reply *r = arg;
+    assert(r != NULL);
+    struct mem_binding *b = r->b;
+    errval_t err;
+
+    err = b->tx_vtbl.stats_response(b, NOP_CONT, r->mem_avail, r->mem_total,
+                                    r->stats.steals, r->stats.steal_fails,
+                                    r->stats.stolen_bytes, r->stats.served,
+                                    r->stats.served_bytes, r->stats.time,
+                                    r->stats.time_max);
+    if (err_is_ok(err)) {
+        free(r);
+    } else if (err_no(err) == FLOUNDER_ERR_TX_BUSY) {
+        err = b->register_send(b, get_default_waitset(),
+                               MKCONT(retry_stats_reply,r));
+    }
+
+    if (err_is_fail(err)) {
+        DEBUG_ERR(err, "failed to reply to stats request");
+        free(r);
+    }
+}
 
 static void retry_free_reply(void *arg)
 {
@@ -212,6 +284,17 @@ static void mem_available_handler(struct mem_binding *b)
     }
 }
 
+static void mem_stats_handler(struct mem_binding *b)
+{
+    struct pending_stats_reply *r = malloc(sizeof(struct pending_stats_reply));
+    assert(r != NULL);
+    r->b = b;
+    r->mem_avail = mem_available_handler_common();
+    r->mem_total = mem_total;
+    r->stats = steal_stats;
+
+    retry_stats_reply(r);
+}
 
 static void percore_steal_handler(struct mem_binding *b,
                                      uint8_t bits,
@@ -269,6 +352,111 @@ static void percore_allocate_handler(struct mem_binding *b,
     }
 
     trace_event(TRACE_SUBSYS_MEMSERV, TRACE_EVENT_MEMSERV_PERCORE_ALLOC_COMPLETE, 0);
+
+    // now that the client has its memory, top up from our peers if needed
+    steal_refill();
+}
+
+/**
+ * \brief Is the client on the other end of the binding on this core?
+ *
+ * Only LMP channels connect dispatchers on the same core. The core ID a
+ * client passes in is not trusted.
+ */
+static bool client_is_local(struct mem_binding *b)
+{
+    struct waitset_chanstate *cs = b->get_receiving_chanstate(b);
+    return cs != NULL && cs->chantype == CHANTYPE_LMP_IN;
+}
+
+static void percore_allocate_batch_handler(struct mem_binding *b,
+                                           coreid_t core,
+                                           uint8_t bits, uint32_t count,
+                                           genpaddr_t minbase,
+                                           genpaddr_t maxlimit)
+{
+    errval_t ret, err;
+    struct capref *cncap = malloc(sizeof(struct capref));
+    struct cnoderef cnode;
+    uint32_t retcount = 0;
+
+    assert(cncap != NULL);
+
+    if (count > L2_CNODE_SLOTS) {
+        count = L2_CNODE_SLOTS;
+    }
+
+    if (core != disp_get_core_id() || !client_is_local(b)) {
+        ret = LIB_ERR_RAM_ALLOC_BATCH_REMOTE;
+        *cncap = NULL_CAP;
+    } else if (count == 0) {
+        ret = LIB_ERR_RAM_ALLOC_BATCH_COUNT;
+        *cncap = NULL_CAP;
+    } else {
+        ret = cnode_create_l2(cncap, &cnode);
+        if (err_is_fail(ret)) {
+            ret = err_push(ret, LIB_ERR_CNODE_CREATE);
+            *cncap = NULL_CAP;
+        }
+    }
+
+    // fill the CNode until the first allocation fails
+    while (err_is_ok(ret) && retcount < count) {
+        struct capref cap;
+        ret = percore_allocate_handler_common(bits, minbase, maxlimit, &cap);
+        if (err_is_fail(ret)) {
+            break;
+        }
+
+        struct capref dest = {
+            .cnode = cnode,
+            .slot = retcount,
+        };
+        err = cap_copy(dest, cap);
+        if (err_is_fail(err)) {
+            DEBUG_ERR(err, "cap_copy to batch CNode");
+            ret = err_push(err, LIB_ERR_CAP_COPY);
+            errval_t err2 = percore_free(cap);
+            if (err_is_fail(err2)) {
+                DEBUG_ERR(err2, "returning RAM after failed copy to batch CNode");
+            }
+            break;
+        }
+        err = cap_delete(cap);
+        if (err_is_fail(err)) {
+            DEBUG_ERR(err, "cap_delete after copy to batch CNode");
+        }
+        retcount++;
+    }
+
+    if (retcount > 0) {
+        ret = SYS_ERR_OK;
+    } else if (!capref_is_null(*cncap)) {
+        cap_destroy(*cncap);
+        *cncap = NULL_CAP;
+    }
+
+    err = b->tx_vtbl.allocate_batch_response(b,
+                MKCONT(allocate_batch_response_done, cncap), ret, retcount,
+                *cncap);
+    if (err_is_fail(err)) {
+        if (err_no(err) == FLOUNDER_ERR_TX_BUSY) {
+            struct pending_reply *r = malloc(sizeof(struct pending_reply));
+            assert(r != NULL);
+            r->b = b;
+            r->err = ret;
+            r->acap = cncap;
+            r->count = retcount;
+            err = b->register_send(b, get_default_waitset(),
+                                   MKCONT(retry_allocate_batch_reply,r));
+            assert(err_is_ok(err));
+        } else {
+            DEBUG_ERR(err, "failed to reply to batch memory request");
+            allocate_batch_response_done(cncap);
+        }
+    }
+
+    steal_refill();
 }
 
 
@@ -299,7 +487,9 @@ static void percore_export_callback(void *st, errval_t err, iref_t iref)
 
 static struct mem_rx_vtbl percore_rx_vtbl = {
     .allocate_call = percore_allocate_handler,
+    .allocate_batch_call = percore_allocate_batch_handler,
     .available_call = mem_available_handler,
+    .stats_call = mem_stats_handler,
     .free_monitor_call = percore_free_handler,
     .steal_call = percore_steal_handler,
 };
@@ -364,8 +554,12 @@ errval_t percore_mem_serv(coreid_t core, coreid_t *cores,
         USER_PANIC_ERR(err, "nsb_register_n failed");
     }
 
-    // Enter main dispatcher loop
-    THCFinish();
+    // Enter main dispatcher loop, with refills from our peers running
+    // alongside the request handlers
+    DO_FINISH({
+        ASYNC({ steal_refill_task(); });
+        THCFinish();
+    });
 
     assert(!"Should never return");
     abort();
@@ -54,6 +54,13 @@ memsize_t mem_avail = 0;
 /// Globally track the local reserve memory available to allocate
 memsize_t mem_local = 0;
 
+/// Watermarks controlling when and how much we steal from peers
+memsize_t mem_low_watermark = LOW_WATERMARK;
+memsize_t mem_high_watermark = HIGH_WATERMARK;
+
+/// Counters of the steal protocol
+struct steal_stats steal_stats;
+
 /// MM per-core allocator instance data: B-tree to manage mem regions
 struct mm mm_percore;
 // static storage for MM allocator to get it started
@@ -161,7 +168,7 @@ static errval_t do_free(struct mm *mm, struct capref ramcap,
     return SYS_ERR_OK;
 }
 
-static errval_t percore_free(struct capref ramcap)
+errval_t percore_free(struct capref ramcap)
 {
     struct capability info;
     errval_t ret;
@@ -653,6 +660,9 @@ static int run_worker(coreid_t core, struct args *args)
 
     // debug_printf("Distributed mem_serv. percore server on core %d\n", core);
 
+    mem_low_watermark = args->low_watermark;
+    mem_high_watermark = args->high_watermark;
+
     // this should never return
     percore_mem_serv(core, args->cores, args->cores_len, args->ram);
     return EXIT_FAILURE; // so we should never reach here
@@ -680,7 +690,9 @@ static int run_master(coreid_t core, struct args *args)
     // -w
     // -c <core list>
     // -r <percore_mem>
-    char *new_argv[7];
+    // -l <low watermark>
+    // -h <high watermark>
+    char *new_argv[11];
     new_argv[0] = args->path;
     new_argv[1] = "-w";
     new_argv[2] = "-c";
@@ -691,14 +703,20 @@ static int run_master(coreid_t core, struct args *args)
         return EXIT_FAILURE;
     }
     new_argv[4] = "-r";
-    new_argv[5] = malloc(20); // enough to fit a 64 bit number
-    assert(new_argv[5] != NULL);
-    if (new_argv[5] == NULL) {
-        DEBUG_ERR(LIB_ERR_MALLOC_FAIL, "out of memory");
-        return EXIT_FAILURE;
+    new_argv[6] = "-l";
+    new_argv[8] = "-h";
+    for (int i = 5; i <= 9; i += 2) {
+        new_argv[i] = malloc(20); // enough to fit a 64 bit number
+        assert(new_argv[i] != NULL);
+        if (new_argv[i] == NULL) {
+            DEBUG_ERR(LIB_ERR_MALLOC_FAIL, "out of memory");
+            return EXIT_FAILURE;
+        }
     }
     sprintf(new_argv[5], "%"PRIuMEMSIZE, percore_mem);
-    new_argv[6] = NULL;
+    sprintf(new_argv[7], "%"PRIuMEMSIZE, args->low_watermark);
+    sprintf(new_argv[9], "%"PRIuMEMSIZE, args->high_watermark);
+    new_argv[10] = NULL;
 
     for (int i = 0; i < args->cores_len; i++) {
         err = spawn_program(args->cores[i], new_argv[0], new_argv,
@@ -71,6 +71,10 @@ typedef genpaddr_t memsize_t;
 // size of initial RAM cap to fill allocator
 #define SMALLCAP_BITS 20
 
+/* Default watermarks for the steal protocol (see steal.c) */
+#define LOW_WATERMARK  ((memsize_t)1 << 22)  ///< Refill from peers below this
+#define HIGH_WATERMARK ((memsize_t)1 << 24)  ///< Refill up to this
+
 
 /**
  * \brief Size of CNodes to be created by slot allocator.
@@ -88,6 +92,23 @@ typedef genpaddr_t memsize_t;
 extern memsize_t mem_total;
 extern memsize_t mem_avail;
 
+/// Free memory below which we steal from peers, and never give to them
+extern memsize_t mem_low_watermark;
+/// Free memory we try to get back to when stealing
+extern memsize_t mem_high_watermark;
+
+/// Steal protocol counters, reported through the stats RPC
+struct steal_stats {
+    uint64_t steals;            ///< Successful steals from peers
+    uint64_t steal_fails;       ///< Steal attempts where no peer gave anything
+    memsize_t stolen_bytes;     ///< Memory obtained from peers
+    uint64_t served;            ///< Steal requests of peers we satisfied
+    memsize_t served_bytes;     ///< Memory handed to peers
+    systime_t time;             ///< Total time spent stealing
+    systime_t time_max;         ///< Longest single steal
+};
+extern struct steal_stats steal_stats;
+
 /// MM per-core allocator instance data: B-tree to manage mem regions
 extern struct mm mm_percore;
 
@@ -113,6 +134,7 @@ errval_t initialize_percore_mem_serv(coreid_t core,
                                      coreid_t *cores, 
                                      int len_cores,
                                      memsize_t percore_mem);
+errval_t percore_free(struct capref ramcap);
 
 
 errval_t percore_mem_serv(coreid_t core, coreid_t *cores, 
@@ -0,0 +1,120 @@
+/** \file
+ *  \brief Print the allocator statistics of the percore memory servers
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+/*
+ * Usage: mem_serv_dist_stats [core ...]
+ *
+ * Queries the mem_serv_dist instance on each given core (default: our own
+ * core) and prints its free memory and steal protocol counters, for sizing
+ * the per-core pools and the -l/-h watermarks.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include <barrelfish/barrelfish.h>
+#include <barrelfish/nameservice_client.h>
+#include <barrelfish/systime.h>
+#include <if/mem_defs.h>
+
+#include "mem_serv.h"
+
+static struct mem_binding *binding;
+static errval_t bind_err;
+static bool bind_done;
+
+static void bind_cb(void *st, errval_t err, struct mem_binding *b)
+{
+    if (err_is_ok(err)) {
+        mem_rpc_client_init(b);
+        binding = b;
+    }
+    bind_err = err;
+    bind_done = true;
+}
+
+static errval_t print_stats(coreid_t core)
+{
+    errval_t err;
+    iref_t iref;
+    char service_name[NAME_LEN];
+
+    snprintf(service_name, NAME_LEN, "%s.%d", MEMSERV_DIST, core);
+    err = nameservice_blocking_lookup(service_name, &iref);
+    if (err_is_fail(err)) {
+        return err;
+    }
+
+    bind_done = false;
+    err = mem_bind(iref, bind_cb, NULL, get_default_waitset(),
+                   IDC_BIND_FLAGS_DEFAULT);
+    if (err_is_fail(err)) {
+        return err;
+    }
+    while (!bind_done) {
+        event_dispatch(get_default_waitset());
+    }
+    if (err_is_fail(bind_err)) {
+        return bind_err;
+    }
+
+    memsize_t avail, total, stolen_bytes, served_bytes;
+    uint64_t steals, steal_fails, served, steal_time, steal_time_max;
+    err = binding->rpc_tx_vtbl.stats(binding, &avail, &total, &steals,
+                                     &steal_fails, &stolen_bytes, &served,
+                                     &served_bytes, &steal_time,
+                                     &steal_time_max);
+    if (err_is_fail(err)) {
+        return err;
+    }
+
+    uint64_t attempts = steals + steal_fails;
+    printf("core %d: free %"PRIuMEMSIZE" KB of %"PRIuMEMSIZE" KB\n",
+           core, avail / 1024, total / 1024);
+    printf("core %d: stole %"PRIu64" times (%"PRIu64" failed), "
+           "%"PRIuMEMSIZE" KB; gave %"PRIu64" times, %"PRIuMEMSIZE" KB\n",
+           core, steals, steal_fails, stolen_bytes / 1024, served,
+           served_bytes / 1024);
+    printf("core %d: steal latency avg %"PRIu64" us, max %"PRIu64" us\n",
+           core, attempts > 0 ? systime_to_us(steal_time / attempts) : 0,
+           systime_to_us(steal_time_max));
+
+    return SYS_ERR_OK;
+}
+
+int main(int argc, char *argv[])
+{
+    errval_t err;
+    int ret = EXIT_SUCCESS;
+
+    if (argc < 2) {
+        err = print_stats(disp_get_core_id());
+        if (err_is_fail(err)) {
+            DEBUG_ERR(err, "querying mem_serv_dist on core %d",
+                      disp_get_core_id());
+            ret = EXIT_FAILURE;
+        }
+    }
+
+    for (int i = 1; i < argc; i++) {
+        coreid_t core = strtol(argv[i], NULL, 10);
+        err = print_stats(core);
+        if (err_is_fail(err)) {
+            DEBUG_ERR(err, "querying mem_serv_dist on core %d", core);
+            ret = EXIT_FAILURE;
+        }
+    }
+
+    return ret;
+}
@@ -40,6 +40,13 @@ void try_steal(errval_t *ret, struct capref *cap, uint8_t bits,
     *cap = NULL_CAP;
 }
 
+void steal_refill(void)
+{
+}
+
+void steal_refill_task(void)
+{
+}
 
 errval_t init_peers(coreid_t core, int len_cores, coreid_t *cores) 
 {
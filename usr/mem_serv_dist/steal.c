@@ -19,6 +19,7 @@
 
 #include <inttypes.h>
 #include <barrelfish/barrelfish.h>
+#include <barrelfish/systime.h>
 #include <trace/trace.h>
 #include <trace_definitions/trace_defs.h>
 #include <mm/mm.h>
@@ -43,6 +44,7 @@ struct peer_core {
     bool is_bound;
     struct mem_thc_client_binding_t cl;
     thc_lock_t lock;
+    memsize_t avail;    ///< free memory reported by the last query
 };
 
 coreid_t mycore;
@@ -83,18 +85,11 @@ static errval_t connect_peer(struct peer_core *peer)
     return SYS_ERR_OK;
 }
 
-static errval_t steal_from_serv(struct peer_core *peer,
-                                struct capref *ret_cap,
-                                uint8_t bits,
-                                genpaddr_t minbase,
-                                genpaddr_t maxlimit)
+static errval_t bind_peer(struct peer_core *peer)
 {
-    assert(peer != NULL);
-
     errval_t err;
 
     if (!peer->is_bound) {
-      printf("Connecting to new peer\n");
         err = connect_peer(peer);
         if (err_is_fail(err)) {
             DEBUG_ERR(err, "failed to connect to peer");
@@ -103,6 +98,24 @@ static errval_t steal_from_serv(struct peer_core *peer,
         peer->is_bound = true;
     }
 
+    return SYS_ERR_OK;
+}
+
+static errval_t steal_from_serv(struct peer_core *peer,
+                                struct capref *ret_cap,
+                                uint8_t bits,
+                                genpaddr_t minbase,
+                                genpaddr_t maxlimit)
+{
+    assert(peer != NULL);
+
+    errval_t err;
+
+    err = bind_peer(peer);
+    if (err_is_fail(err)) {
+        return err;
+    }
+
     // due to the single-waiter rule of thc we need to make sure we only
     // ever have one of these rpcs outstanding at a time.
     thc_lock_acquire(&peer->lock);
@@ -113,63 +126,90 @@ static errval_t steal_from_serv(struct peer_core *peer,
     return err;
 }
 
-// Round-robin steal. Try to get memory from each peer in turn.
-static errval_t rr_steal(struct capref *ret_cap, uint8_t bits,
-                                genpaddr_t minbase, genpaddr_t maxlimit)
+/// Ask a peer how much memory it has free, and remember the answer
+static errval_t query_peer(struct peer_core *peer)
 {
-    errval_t err = MM_ERR_NOT_FOUND;
-    static int next_serv = 0;
+    assert(peer != NULL);
 
-    int serv = next_serv;
-    struct peer_core *peer = &peer_cores[serv];
+    errval_t err;
+    memsize_t total;
 
-    int i;
-    for (i = 0; i < num_peers; i++) {
-        if (serv >= num_peers) {
-            serv = 0;
-        }
-        peer = &peer_cores[serv++];
+    peer->avail = 0;
+
+    err = bind_peer(peer);
+    if (err_is_fail(err)) {
+        return err;
+    }
+
+    thc_lock_acquire(&peer->lock);
+    err = peer->cl.call_seq.available(&peer->cl, &peer->avail, &total);
+    thc_lock_release(&peer->lock);
+
+    return err;
+}
+
+/**
+ * \brief Steal a range of memory from the richest peers
+ *
+ * Queries all peers for their free memory and asks them in order of
+ * decreasing wealth for a single RAM cap of between 2^minbits and 2^maxbits
+ * bytes. Peers keep mem_low_watermark bytes for themselves, so we never ask
+ * for more than they can give; if a request fails because the peer's free
+ * memory is fragmented we halve it until we reach minbits.
+ */
+static errval_t steal_bulk(struct capref *ret_cap, uint8_t minbits,
+                           uint8_t maxbits, genpaddr_t minbase,
+                           genpaddr_t maxlimit)
+{
+    errval_t err = MM_ERR_NOT_FOUND;
+    memsize_t minsize = (memsize_t)1 << minbits;
+
+    for (int i = 0; i < num_peers; i++) {
+        struct peer_core *peer = &peer_cores[i];
         if (peer->id == mycore) {
+            peer->avail = 0;
             continue;
         }
-	    printf("%d: Trying to steal from %d/%d\n", disp_get_core_id(), i, num_peers);
-        err = steal_from_serv(peer, ret_cap, bits, minbase, maxlimit);
-        if (err_is_ok(err)) {
-            break;
+        errval_t qerr = query_peer(peer);
+        if (err_is_fail(qerr)) {
+            DEBUG_ERR(qerr, "querying free memory of peer %d", peer->id);
         }
     }
-    next_serv = serv;
 
-    /*
-    if (i >= num_peers) {
-        debug_printf("rr_steal: could not steal from any peers\n");
+    for (;;) {
+        // find the richest peer we haven't tried yet
+        struct peer_core *richest = NULL;
+        for (int i = 0; i < num_peers; i++) {
+            if (richest == NULL || peer_cores[i].avail > richest->avail) {
+                richest = &peer_cores[i];
+            }
+        }
+        if (richest == NULL
+            || richest->avail < mem_low_watermark + minsize) {
+            break;
+        }
+
+        uint8_t bits = log2floor(richest->avail - mem_low_watermark);
+        bits = MIN(bits, maxbits);
+        richest->avail = 0;
+
+        for (; bits >= minbits; bits--) {
+            err = steal_from_serv(richest, ret_cap, bits, minbase, maxlimit);
+            if (err_is_ok(err)) {
+                return SYS_ERR_OK;
+            }
+        }
     }
-    */
 
     return err;
 }
 
-
-static errval_t steal_and_alloc(struct capref *ret_cap, uint8_t steal_bits,
-                                uint8_t alloc_bits,
-                                genpaddr_t minbase, genpaddr_t maxlimit)
+/// Add a stolen RAM cap to our per-core allocator
+static errval_t add_stolen(struct capref ramcap)
 {
     errval_t err;
-
-    struct capref ramcap;
     struct capability info;
 
-    /*
-    debug_printf("steal_and_alloc(steal_bits: %d, alloc_bits: %d, "
-                 "minbase: 0x%"PRIxGENPADDR", maxlimit: 0x%"PRIxGENPADDR")\n",
-                 steal_bits, alloc_bits, minbase, maxlimit);
-    */
-
-    err = rr_steal(&ramcap, steal_bits, minbase, maxlimit);
-    if (err_is_fail(err)) {
-        return err;
-    }
-
     // XXX: Mark as local to this core, until we have x-core cap management
     err = monitor_cap_set_remote(ramcap, false);
     if(err_is_fail(err)) {
@@ -187,31 +227,52 @@ static errval_t steal_and_alloc(struct capref *ret_cap, uint8_t steal_bits,
                  info.type, info.u.ram.base, info.u.ram.base,
                  info.u.ram.bits);
 #endif
-    if(steal_bits != log2ceil(info.u.ram.bytes)) {
-      printf("asked for %d bits, but got %d bits of type %d\n",
-	     steal_bits, log2ceil(info.u.ram.bytes), info.type);
+
+    err = percore_free(ramcap);
+    if (err_is_ok(err)) {
+        steal_stats.stolen_bytes += info.u.ram.bytes;
     }
-    assert(steal_bits == log2ceil(info.u.ram.bytes));
+    return err;
+}
 
-    memsize_t mem_to_add = (memsize_t)info.u.ram.bytes;
+/**
+ * \brief Steal memory from peers, bringing us up to the high watermark
+ *
+ * \param minbits Size of the smallest steal that is still useful
+ */
+static errval_t steal(uint8_t minbits, genpaddr_t minbase, genpaddr_t maxlimit)
+{
+    errval_t err;
+    struct capref ramcap;
+    systime_t start, elapsed;
 
-    err = mm_free(&mm_percore, ramcap, info.u.ram.base, log2ceil(info.u.ram.bytes));
-    if (err_is_fail(err)) {
-        if (err_no(err) == MM_ERR_NOT_FOUND) {
-            // memory wasn't there initially, add it
-            err = mm_add(&mm_percore, ramcap, log2ceil(info.u.ram.bytes), info.u.ram.base);
-            if (err_is_fail(err)) {
-                return err_push(err, MM_ERR_MM_ADD);
-            }
-            mem_total += mem_to_add;
-        } else {
-            return err_push(err, MM_ERR_MM_FREE);
-        }
+    // take what we need to get back to the high watermark, but at least
+    // as much as the request that triggered the steal
+    uint8_t maxbits = minbits;
+    if (mem_high_watermark > mem_avail) {
+        maxbits = log2floor(mem_high_watermark - mem_avail);
+    }
+    if (maxbits < minbits) {
+        maxbits = minbits;
     }
+    maxbits = MIN(maxbits, MAXSIZEBITS);
 
-    mem_avail += mem_to_add;
+    start = systime_now();
+    err = steal_bulk(&ramcap, minbits, maxbits, minbase, maxlimit);
+    if (err_is_ok(err)) {
+        err = add_stolen(ramcap);
+    }
+    elapsed = systime_now() - start;
 
-    err = percore_alloc(ret_cap, alloc_bits, minbase, maxlimit);
+    if (err_is_ok(err)) {
+        steal_stats.steals++;
+    } else {
+        steal_stats.steal_fails++;
+    }
+    steal_stats.time += elapsed;
+    if (elapsed > steal_stats.time_max) {
+        steal_stats.time_max = elapsed;
+    }
 
     return err;
 }
@@ -220,24 +281,69 @@ static errval_t steal_and_alloc(struct capref *ret_cap, uint8_t steal_bits,
 void try_steal(errval_t *ret, struct capref *cap, uint8_t bits,
                genpaddr_t minbase, genpaddr_t maxlimit)
 {
-    printf("[%d][%"PRIuDOMAINID"]: failed percore alloc request: bits: %d going to STEAL\n",
-            disp_get_core_id(), disp_get_domain_id(), bits);
-	printf("%p %p %p %p %p %p\n",	__builtin_return_address(0),
-								 	__builtin_return_address(1),
-									__builtin_return_address(2),
-									__builtin_return_address(3),
-									__builtin_return_address(4),
-									__builtin_return_address(5));
-    //DEBUG_ERR(*ret, "allocation of %d bits in 0x%" PRIxGENPADDR
-    //           "-0x%" PRIxGENPADDR " failed", bits, minbase, maxlimit);
-    *ret = steal_and_alloc(cap, bits+1, bits, minbase, maxlimit);
+    *ret = steal(bits + 1, minbase, maxlimit);
+    if (err_is_ok(*ret)) {
+        *ret = percore_alloc(cap, bits, minbase, maxlimit);
+    }
     if (err_is_fail(*ret)) {
         DEBUG_ERR(*ret, "stealing of %d bits in 0x%" PRIxGENPADDR "-0x%"
                  PRIxGENPADDR " failed", bits, minbase, maxlimit);
         *cap = NULL_CAP;
     }
-//	*ret = MM_ERR_NOT_FOUND;
-//	*cap = NULL_CAP;
+}
+
+/// Wakes up steal_refill_task()
+static thc_sem_t refill_sem;
+/// Has steal_refill_task() been woken up and not yet finished the refill?
+static bool refill_pending;
+/// Free memory at which the last refill failed, or 0
+static memsize_t refill_failed_avail;
+
+/**
+ * \brief Schedule a refill from our peers if we are low on memory
+ *
+ * Called by the request handlers after they have replied. This does not
+ * block; the peers are asked by steal_refill_task().
+ */
+void steal_refill(void)
+{
+    if (mem_avail >= mem_low_watermark) {
+        refill_failed_avail = 0;
+        return;
+    }
+
+    // don't keep asking the peers after a failure, but retry once we have
+    // used up half of what was left
+    if (refill_pending || (refill_failed_avail != 0
+                           && mem_avail > refill_failed_avail / 2)) {
+        return;
+    }
+
+    refill_pending = true;
+    thc_sem_v(&refill_sem);
+}
+
+/**
+ * \brief Bring us back up to the high watermark whenever steal_refill()
+ * asks for it
+ *
+ * Runs as a THC task of its own for the lifetime of the server, so the
+ * blocking RPCs to the peers never run on the stack of a request handler.
+ * The steal and available handlers never block, so two servers refilling
+ * from each other cannot wait on each other.
+ */
+void steal_refill_task(void)
+{
+    for (;;) {
+        thc_sem_p(&refill_sem);
+        if (mem_avail < mem_low_watermark) {
+            errval_t err = steal(MINALLOCBITS, 0, 0);
+            if (err_is_fail(err)) {
+                refill_failed_avail = mem_avail;
+            }
+        }
+        refill_pending = false;
+    }
 }
 
 errval_t init_peers(coreid_t core, int len_cores, coreid_t *cores)
@@ -249,10 +355,12 @@ errval_t init_peers(coreid_t core, int len_cores, coreid_t *cores)
     if (peer_cores == NULL) {
         return LIB_ERR_MALLOC_FAIL;
     }
+    thc_sem_init(&refill_sem, 0);
     
     for (int i = 0; i < num_peers; i++) {
         peer_cores[i].id = cores[i];
         peer_cores[i].is_bound = false;
+        peer_cores[i].avail = 0;
     }
 
     return SYS_ERR_OK;
@@ -266,6 +374,12 @@ errval_t percore_steal_handler_common(uint8_t bits,
     struct capref cap;
     errval_t err, ret;
 
+    // keep our low watermark for ourselves
+    if (mem_avail < mem_low_watermark + ((memsize_t)1 << bits)) {
+        *retcap = NULL_CAP;
+        return MM_ERR_NOT_FOUND;
+    }
+
     trace_event(TRACE_SUBSYS_MEMSERV, TRACE_EVENT_MEMSERV_PERCORE_ALLOC, bits);
     /* debug_printf("%d: percore steal request: bits: %d\n", disp_get_core_id(), bits); */
 
@@ -285,7 +399,10 @@ errval_t percore_steal_handler_common(uint8_t bits,
 
     // get actual ram cap
     ret = percore_alloc(&cap, bits, minbase, maxlimit);
-    if (err_is_fail(ret)){
+    if (err_is_ok(ret)) {
+        steal_stats.served++;
+        steal_stats.served_bytes += (memsize_t)1 << bits;
+    } else {
         // debug_printf("percore steal request failed\n");
         //DEBUG_ERR(ret, "allocation of stolen %d bits in 0x%" PRIxGENPADDR
         //          "-0x%" PRIxGENPADDR " failed", bits, minbase, maxlimit);
@@ -23,6 +23,8 @@ errval_t percore_steal_handler_common(uint8_t bits,
                                       struct capref *retcap);
 void try_steal(errval_t *ret, struct capref *cap, uint8_t bits,
                genpaddr_t minbase, genpaddr_t maxlimit);
+void steal_refill(void);
+void steal_refill_task(void);
 errval_t init_peers(coreid_t core, int len_cores, coreid_t *cores);
 
 
@@ -57,6 +57,22 @@ static void mem_available_handler(struct mem_thc_service_binding_t *sv)
 }
 
 
+static void mem_stats_handler(struct mem_thc_service_binding_t *sv)
+{
+    sv->send.stats(sv, mem_available_handler_common(), mem_total,
+                   steal_stats.steals, steal_stats.steal_fails,
+                   steal_stats.stolen_bytes, steal_stats.served,
+                   steal_stats.served_bytes, steal_stats.time,
+                   steal_stats.time_max);
+}
+
+static void percore_allocate_batch_handler(struct mem_thc_service_binding_t *sv)
+{
+    // batches are only implemented by the hybrid server; clients fall back
+    // to single allocations
+    sv->send.allocate_batch(sv, ERR_NOTIMP, 0, NULL_CAP);
+}
+
 static void percore_steal_handler(struct mem_thc_service_binding_t *sv,
                                      uint8_t bits,
                                      genpaddr_t minbase, genpaddr_t maxlimit)
@@ -98,7 +114,9 @@ static void run_server(struct mem_thc_service_binding_t *sv)
     // this is the bitmap of messages we are interested in receiving
     struct mem_service_selector selector = {
         .allocate = 1,
+        .allocate_batch = 1,
         .available = 1,
+        .stats = 1,
         .free = 1,
         .steal = 1,
     };
@@ -119,9 +137,15 @@ static void run_server(struct mem_thc_service_binding_t *sv)
                                      msg.args.allocate.in.minbase,
                                      msg.args.allocate.in.maxlimit);
             break;
+        case mem_allocate_batch:
+            percore_allocate_batch_handler(sv);
+            break;
         case mem_available:
             mem_available_handler(sv);
             break;
+        case mem_stats:
+            mem_stats_handler(sv);
+            break;
         case mem_free_monitor:
             percore_free_handler(sv, msg.args.free.in.mem_cap); 
             break;
@@ -79,6 +79,7 @@ extern iref_t monitor_mem_iref;
 extern coreid_t my_core_id;
 extern bool bsp_monitor;
 extern struct capref trace_cap;
+extern struct capref schedstat_cap;
 extern struct bootinfo *bi;
 extern bool update_ram_alloc_binding;
 
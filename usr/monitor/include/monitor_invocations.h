@@ -146,6 +146,13 @@ invoke_monitor_reclaim_ram(capaddr_t retcn, int retcnlevel, cslot_t retslot)
                        retcn, retcnlevel, retslot).error;
 }
 
+static inline errval_t
+invoke_schedstat_setup(struct capref frame)
+{
+    return cap_invoke2(cap_kernel, KernelCmd_Setup_schedstat,
+                       get_cap_addr(frame)).error;
+}
+
 //{{{1 Register EP
 static inline errval_t
 invoke_monitor_register(struct capref ep)
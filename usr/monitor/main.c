@@ -19,6 +19,7 @@
 #include <barrelfish/domain.h>
 #include <barrelfish/spawn_client.h>
 #include <trace/trace.h>
+#include <barrelfish_kpi/schedstat.h>
 
 #include "capops.h" // for delete_steps_init() and reclaim_ram_init()
 
@@ -36,6 +37,9 @@ iref_t monitor_rpc_iref = 0;
 // Capref to trace cap
 struct capref trace_cap;
 
+// Read-only capref to the scheduler statistics frame, if the kernel keeps them
+struct capref schedstat_cap;
+
 /* Set to the core id so no need to load from dispatcher */
 coreid_t my_core_id = -1;
 
@@ -336,6 +340,50 @@ static void mon_heartbeat(void *arg) {
 }
 #endif
 
+STATIC_ASSERT(sizeof(struct sched_stats) <= BASE_PAGE_SIZE,
+              "scheduler statistics fit a page");
+
+/**
+ * \brief Hand the kernel a frame to keep scheduler statistics in
+ *
+ * Not all kernels support this, in which case the statistics are simply not
+ * available on this core.
+ */
+static void schedstat_init(void)
+{
+    struct capref frame;
+    errval_t err;
+
+    err = frame_alloc(&frame, BASE_PAGE_SIZE, NULL);
+    if (err_is_fail(err)) {
+        DEBUG_ERR(err, "frame_alloc for scheduler statistics");
+        return;
+    }
+
+    err = invoke_schedstat_setup(frame);
+    if (err_is_fail(err)) {
+        if (err_no(err) != SYS_ERR_ILLEGAL_INVOCATION) {
+            DEBUG_ERR(err, "invoke_schedstat_setup failed");
+        }
+        cap_destroy(frame);
+        return;
+    }
+
+    // the kernel keeps writing to the frame, only hand out read-only copies
+    err = slot_alloc(&schedstat_cap);
+    if (err_is_fail(err)) {
+        DEBUG_ERR(err, "slot_alloc for scheduler statistics");
+        schedstat_cap = NULL_CAP;
+        return;
+    }
+    err = cap_mint(schedstat_cap, frame, CAPRIGHTS_READ, 0);
+    if (err_is_fail(err)) {
+        DEBUG_ERR(err, "cap_mint of scheduler statistics");
+        slot_free(schedstat_cap);
+        schedstat_cap = NULL_CAP;
+    }
+}
+
 /**
  * \brief Use cmdline args to figure out which core the monitor is running on
  * and which cores to boot.
@@ -403,6 +451,8 @@ int main(int argc, char *argv[])
 tracing_not_available:
 #endif // tracing
 
+    schedstat_init();
+
     domain_mgmt_init();
 
 #ifdef MONITOR_HEARTBEAT
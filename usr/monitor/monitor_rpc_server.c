@@ -493,6 +493,21 @@ static void get_ipi_cap(struct monitor_blocking_binding *b)
     assert(err_is_ok(err));
 }
 
+static void get_schedstat_cap(struct monitor_blocking_binding *b)
+{
+    errval_t err, reterr = SYS_ERR_OK;
+
+    if (capref_is_null(schedstat_cap)) {
+        reterr = MON_ERR_NO_SCHEDSTAT;
+    }
+
+    err = b->tx_vtbl.get_schedstat_cap_response(b, NOP_CONT, reterr,
+                                                schedstat_cap);
+    if (err_is_fail(err)) {
+        USER_PANIC_ERR(err, "sending get_schedstat_cap_response failed");
+    }
+}
+
 // XXX: these look suspicious in combination with distops!
 static void forward_kcb_request(struct monitor_blocking_binding *b,
                                 coreid_t destination, struct capref kcb)
@@ -799,6 +814,7 @@ static struct monitor_blocking_rx_vtbl rx_vtbl = {
 
     .cap_set_remote_call     = cap_set_remote,
     .get_ipi_cap_call = get_ipi_cap,
+    .get_schedstat_cap_call = get_schedstat_cap,
 
     .forward_kcb_request_call = forward_kcb_request,
 
@@ -0,0 +1,217 @@
+/**
+ * \file
+ * \brief malloc stress and performance test
+ *
+ * Runs a set of allocation workloads against malloc()/free(), checks that
+ * allocated memory is not corrupted, and reports throughput (ops/sec) for
+ * each of them. With the size-class malloc, it also reports fragmentation:
+ * the bytes the heap holds in spans and large runs, relative to the bytes
+ * the program has live at the end of the workload.
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <barrelfish/barrelfish.h>
+#include <barrelfish/heap.h>
+#include <barrelfish/systime.h>
+
+#define MAX_THREADS 8
+
+struct workload {
+    const char *name;
+    size_t nslots;      ///< Number of live objects (at most)
+    size_t nops;        ///< Number of alloc/free operations
+    size_t minsize;     ///< Smallest allocation
+    size_t maxsize;     ///< Largest allocation (log-uniformly distributed)
+    int nthreads;       ///< Number of threads running the workload
+};
+
+static struct workload workloads[] = {
+    // many small records, as held by octopus or the SKB
+    { "small-records",  200000, 2000000,   16,   256, 1 },
+    { "mixed",           20000, 1000000,   16, 65536, 1 },
+    { "large",            1000,  100000, 4096, 1 << 20, 1 },
+    { "small-threads",   50000, 1000000,   16,   256, 4 },
+};
+
+struct slot {
+    uint8_t *ptr;
+    size_t size;
+};
+
+struct run_state {
+    struct workload *w;
+    struct slot *slots; ///< Live objects at the end of the run
+    uint32_t seed;
+    size_t live_bytes;
+    size_t ops;
+};
+
+static uint32_t xorshift(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+/// Log-uniformly distributed size in [min, max]
+static size_t random_size(uint32_t *seed, size_t min, size_t max)
+{
+    unsigned minbits = 0, maxbits = 0;
+    while ((1UL << minbits) < min) { minbits++; }
+    while ((1UL << maxbits) < max) { maxbits++; }
+    unsigned bits = minbits + xorshift(seed) % (maxbits - minbits + 1);
+    size_t size = (1UL << bits) + xorshift(seed) % (1UL << bits);
+    return size < min ? min : (size > max ? max : size);
+}
+
+static void fill(struct slot *s, uint8_t tag)
+{
+    // only touch head and tail of large blocks to keep the test fast
+    size_t n = s->size < 64 ? s->size : 64;
+    memset(s->ptr, tag, n);
+    memset(s->ptr + s->size - n, tag, n);
+}
+
+static void check(struct slot *s, uint8_t tag)
+{
+    size_t n = s->size < 64 ? s->size : 64;
+    for (size_t i = 0; i < n; i++) {
+        if (s->ptr[i] != tag || s->ptr[s->size - 1 - i] != tag) {
+            USER_PANIC("malloc stress: corrupted block %p (size %zu)\n",
+                       s->ptr, s->size);
+        }
+    }
+}
+
+static int run_workload(void *arg)
+{
+    struct run_state *rs = arg;
+    struct workload *w = rs->w;
+    size_t nslots = w->nslots / w->nthreads;
+
+    struct slot *slots = calloc(nslots, sizeof(struct slot));
+    assert(slots != NULL);
+
+    for (size_t op = 0; op < w->nops / w->nthreads; op++) {
+        size_t i = xorshift(&rs->seed) % nslots;
+        struct slot *s = &slots[i];
+        if (s->ptr != NULL) {
+            check(s, (uint8_t)i);
+            free(s->ptr);
+            rs->live_bytes -= s->size;
+            s->ptr = NULL;
+        } else {
+            s->size = random_size(&rs->seed, w->minsize, w->maxsize);
+            s->ptr = malloc(s->size);
+            if (s->ptr == NULL) {
+                USER_PANIC("malloc stress: malloc(%zu) failed\n", s->size);
+            }
+            fill(s, (uint8_t)i);
+            rs->live_bytes += s->size;
+        }
+        rs->ops++;
+    }
+
+    for (size_t i = 0; i < nslots; i++) {
+        if (slots[i].ptr != NULL) {
+            check(&slots[i], (uint8_t)i);
+        }
+    }
+
+    // caller frees remaining objects after measuring the footprint
+    rs->slots = slots;
+    return 0;
+}
+
+static void run(struct workload *w)
+{
+    struct run_state rs[MAX_THREADS];
+    struct thread *threads[MAX_THREADS];
+    assert(w->nthreads <= MAX_THREADS);
+
+#ifdef CONFIG_MALLOC_SIZECLASS
+    // objects allocated before the workload are still live afterwards
+    struct heap_sc_stats before;
+    __malloc_get_stats(&before);
+#endif
+    systime_t start = systime_now();
+
+    for (int t = 0; t < w->nthreads; t++) {
+        rs[t] = (struct run_state) { .w = w, .seed = 42 + t };
+        if (w->nthreads == 1) {
+            run_workload(&rs[t]);
+        } else {
+            threads[t] = thread_create(run_workload, &rs[t]);
+            assert(threads[t] != NULL);
+        }
+    }
+    if (w->nthreads > 1) {
+        for (int t = 0; t < w->nthreads; t++) {
+            int ret;
+            errval_t err = thread_join(threads[t], &ret);
+            assert(err_is_ok(err));
+        }
+    }
+
+    uint64_t ns = systime_to_ns(systime_now() - start);
+    size_t ops = 0, live = 0;
+    for (int t = 0; t < w->nthreads; t++) {
+        ops += rs[t].ops;
+        live += rs[t].live_bytes;
+        // the slot arrays are live heap objects, too
+        live += w->nslots / w->nthreads * sizeof(struct slot);
+    }
+
+#ifdef CONFIG_MALLOC_SIZECLASS
+    struct heap_sc_stats after;
+    __malloc_get_stats(&after);
+    live += before.live_bytes;
+    size_t footprint = after.span_bytes;
+
+    printf("mallocstress: %-14s %8" PRIu64 " kops/s  live %8zu KiB  "
+           "footprint %8zu KiB  fragmentation %3zu%%\n", w->name,
+           ns ? ops * 1000000ULL / ns : 0, live >> 10, footprint >> 10,
+           footprint > live ? (footprint - live) * 100 / footprint : 0);
+#else
+    printf("mallocstress: %-14s %8" PRIu64 " kops/s  live %8zu KiB\n",
+           w->name, ns ? ops * 1000000ULL / ns : 0, live >> 10);
+#endif
+
+    for (int t = 0; t < w->nthreads; t++) {
+        struct slot *slots = rs[t].slots;
+        for (size_t i = 0; i < w->nslots / w->nthreads; i++) {
+            free(slots[i].ptr);
+        }
+        free(slots);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+#ifdef CONFIG_MALLOC_SIZECLASS
+    printf("mallocstress: size-class malloc\n");
+#else
+    printf("mallocstress: K&R malloc\n");
+#endif
+
+    for (size_t i = 0; i < sizeof(workloads) / sizeof(workloads[0]); i++) {
+        run(&workloads[i]);
+    }
+
+    printf("mallocstress done.\n");
+    return 0;
+}
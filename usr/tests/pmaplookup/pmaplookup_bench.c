@@ -0,0 +1,135 @@
+/**
+ * \file
+ * \brief pmap lookup benchmark
+ *
+ * Maps a number of small frames sparsely across a large region, so the leaf
+ * page tables are only partially populated, and times pmap lookups of the
+ * mapped pages in random order. Also reports the memory the pmap uses for
+ * its shadow page tables. The same program is built against each pmap
+ * datastructure so the results can be compared.
+ *
+ * Usage: pmaplookup_bench [mappings]
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <barrelfish/barrelfish.h>
+
+#include <bench/bench.h>
+
+#if defined(PMAP_RADIX)
+#define PMAP_DS "radix"
+#elif defined(PMAP_ARRAY)
+#define PMAP_DS "array"
+#elif defined(PMAP_LL)
+#define PMAP_DS "list"
+#else
+#define PMAP_DS "default"
+#endif
+
+#define DEFAULT_MAPPINGS 4096
+#define MIN_MAPPINGS     64
+
+// one mapping every STRIDE pages, leaf tables hold PTABLE_ENTRIES / STRIDE
+#define STRIDE    37
+
+#define RUN_COUNT 10
+
+#define EXPECT_SUCCESS(err, msg) \
+    if (err_is_fail(err)) {USER_PANIC_ERR(err, msg);}
+
+static genvaddr_t *addrs;
+
+static void measure_res(struct pmap *pmap, const char *when)
+{
+    struct pmap_res_info res;
+    errval_t err = pmap->f.measure_res(pmap, &res);
+    EXPECT_SUCCESS(err, "measure_res");
+    printf("%-7s %-8s metadata %8zu bytes used, %8zu bytes free, "
+           "%6zu slots\n", PMAP_DS, when, res.vnode_used, res.vnode_free,
+           res.slots_used);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t mappings = DEFAULT_MAPPINGS;
+    struct capref frame;
+    errval_t err;
+
+    if (!bench_size_arg(argc, argv, "mappings", MIN_MAPPINGS, &mappings)) {
+        return EXIT_FAILURE;
+    }
+
+    bench_init();
+
+    struct pmap *pmap = get_current_pmap();
+    addrs = malloc(mappings * sizeof(*addrs));
+    if (addrs == NULL) {
+        USER_PANIC("no memory for %zu mappings", mappings);
+    }
+
+    measure_res(pmap, "before");
+
+    err = frame_alloc(&frame, BASE_PAGE_SIZE, NULL);
+    EXPECT_SUCCESS(err, "frame_alloc");
+
+    // reserve the region and map the same frame at every STRIDE-th page
+    size_t bytes = mappings * STRIDE * BASE_PAGE_SIZE;
+    struct memobj_one_frame_one_map memobj;
+    struct vregion vregion;
+    err = memobj_create_one_frame_one_map(&memobj, bytes, 0);
+    EXPECT_SUCCESS(err, "memobj_create_one_frame_one_map");
+    err = vregion_map(&vregion, get_current_vspace(), &memobj.m, 0, bytes,
+                      VREGION_FLAGS_READ);
+    EXPECT_SUCCESS(err, "vregion_map");
+    genvaddr_t base = vregion_get_base_addr(&vregion);
+
+    for (size_t i = 0; i < mappings; i++) {
+        addrs[i] = base + i * STRIDE * BASE_PAGE_SIZE;
+        err = pmap->f.map(pmap, addrs[i], frame, 0, BASE_PAGE_SIZE,
+                          VREGION_FLAGS_READ, NULL, NULL);
+        EXPECT_SUCCESS(err, "map");
+    }
+
+    measure_res(pmap, "mapped");
+
+    srand(42);
+    bench_shuffle(addrs, mappings, sizeof(*addrs));
+
+    cycles_t start, end, total = 0;
+    struct pmap_mapping_info info;
+    for (int r = 0; r < RUN_COUNT; r++) {
+        start = bench_tsc();
+        for (size_t i = 0; i < mappings; i++) {
+            err = pmap->f.lookup(pmap, addrs[i], &info);
+            if (err_is_fail(err)) {
+                USER_PANIC_ERR(err, "lookup");
+            }
+        }
+        end = bench_tsc();
+        total += bench_time_diff(start, end);
+    }
+
+    printf("%-7s mappings=%-6zu lookup %6"PRIuCYCLES" cycles/op\n", PMAP_DS,
+           mappings, total / RUN_COUNT / mappings);
+
+    for (size_t i = 0; i < mappings; i++) {
+        err = pmap->f.unmap(pmap, addrs[i], BASE_PAGE_SIZE, NULL);
+        EXPECT_SUCCESS(err, "unmap");
+    }
+    measure_res(pmap, "unmapped");
+
+    free(addrs);
+
+    printf("pmaplookup_bench done.\n");
+    return EXIT_SUCCESS;
+}
@@ -1,9 +1,9 @@
 /** \file
- *  \brief A non-blocking linked list implementation, derived from Tim Harris' `pragmatic implementation`.
+ *  \brief Tests and scalability benchmark for the non-blocking data structures
  */
 
 /*
- * Copyright (c) 2009, ETH Zurich.
+ * Copyright (c) 2009, 2026, ETH Zurich.
  * All rights reserved.
  *
  * This file is distributed under the terms in the attached LICENSE file.
@@ -11,20 +11,35 @@
  * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
  */
 
+/*
+ * Usage: testconcurrent [cores [ops]]
+ *
+ * Runs the functional tests and, if cores is given, spans the domain to that
+ * many cores and measures the throughput of the linked list, the skiplist
+ * and the hash set under a mixed workload (80% lookups, 10% inserts, 10%
+ * deletes) with 1 to cores threads, one per core.
+ */
+
 #include <stdio.h>
+#include <stdlib.h>
+#include <barrelfish/barrelfish.h>
+#include <bench/bench.h>
 #include <concurrent/arch/cas.h>
 #include <concurrent/linked_list.h>
+#include <concurrent/epoch.h>
+#include <concurrent/skiplist.h>
+#include <concurrent/hashset.h>
+
+#define DEFAULT_OPS     100000
+#define KEY_RANGE       1024
 
 static struct ll_element *list_head;
 static struct ll_element *list_tail;
+static struct skiplist *skiplist;
+static struct hashset *hashset;
 
-int main(void) {
-    /// cas test
-    uint64_t location = 10;
-    uint64_t res = cas(&location, 10, 20);
-    printf("cas: %ld, %ld\n", res, location);
-
-    /// linked list test
+static void test_linked_list(void)
+{
     ll_create(&list_head, &list_tail);
     ll_print(list_head, list_tail);
 
@@ -47,3 +62,296 @@ int main(void) {
     printf("delete: %d\n", ll_delete(list_head, list_tail, &l));
     ll_print(list_head, list_tail);
 }
+
+static void test_skiplist(void)
+{
+    void *data;
+
+    sl_create(&skiplist);
+    for (uintptr_t key = 1; key <= 10; key++) {
+        assert(sl_insert(skiplist, (void *) key, (void *) (key * 2)));
+    }
+    assert(!sl_insert(skiplist, (void *) 5, NULL));
+    sl_print(skiplist);
+    for (uintptr_t key = 1; key <= 10; key += 2) {
+        assert(sl_delete(skiplist, (void *) key));
+    }
+    assert(!sl_delete(skiplist, (void *) 1));
+    sl_print(skiplist);
+    for (uintptr_t key = 1; key <= 10; key++) {
+        bool found = sl_get(skiplist, (void *) key, &data);
+        assert(found == (key % 2 == 0));
+        assert(!found || data == (void *) (key * 2));
+    }
+    sl_destroy(skiplist);
+    printf("skiplist: ok\n");
+}
+
+static void test_hashset(void)
+{
+    void *data;
+
+    hs_create(&hashset);
+    for (uintptr_t key = 1; key <= 10000; key++) {
+        assert(hs_insert(hashset, (void *) key, (void *) (key * 2)));
+    }
+    assert(!hs_insert(hashset, (void *) 5, NULL));
+    for (uintptr_t key = 1; key <= 10000; key += 2) {
+        assert(hs_delete(hashset, (void *) key));
+    }
+    assert(!hs_delete(hashset, (void *) 1));
+    for (uintptr_t key = 1; key <= 10000; key++) {
+        bool found = hs_get(hashset, (void *) key, &data);
+        assert(found == (key % 2 == 0));
+        assert(!found || data == (void *) (key * 2));
+    }
+    printf("hashset: %lu elements in %lu buckets\n", hashset->count,
+           hashset->size);
+    hs_destroy(hashset);
+    printf("hashset: ok\n");
+}
+
+/*
+ * Scalability benchmark
+ */
+
+struct ds {
+    const char *name;
+    void (*create)(void);
+    void (*destroy)(void);
+    bool (*insert)(void *key);
+    bool (*delete)(void *key);
+    bool (*contains)(void *key);
+};
+
+static void ll_bench_create(void)
+{
+    ll_create(&list_head, &list_tail);
+}
+
+static void ll_bench_destroy(void)
+{
+    // the linked list does not reclaim memory, so we leak it here
+}
+
+static bool ll_bench_insert(void *key)
+{
+    return ll_insert(list_head, list_tail, key, NULL);
+}
+
+static bool ll_bench_delete(void *key)
+{
+    return ll_delete(list_head, list_tail, key);
+}
+
+static bool ll_bench_contains(void *key)
+{
+    return ll_contains(list_head, list_tail, key);
+}
+
+static void sl_bench_create(void)
+{
+    sl_create(&skiplist);
+}
+
+static void sl_bench_destroy(void)
+{
+    sl_destroy(skiplist);
+}
+
+static bool sl_bench_insert(void *key)
+{
+    return sl_insert(skiplist, key, NULL);
+}
+
+static bool sl_bench_delete(void *key)
+{
+    return sl_delete(skiplist, key);
+}
+
+static bool sl_bench_contains(void *key)
+{
+    return sl_contains(skiplist, key);
+}
+
+static void hs_bench_create(void)
+{
+    hs_create(&hashset);
+}
+
+static void hs_bench_destroy(void)
+{
+    hs_destroy(hashset);
+}
+
+static bool hs_bench_insert(void *key)
+{
+    return hs_insert(hashset, key, NULL);
+}
+
+static bool hs_bench_delete(void *key)
+{
+    return hs_delete(hashset, key);
+}
+
+static bool hs_bench_contains(void *key)
+{
+    return hs_contains(hashset, key);
+}
+
+static struct ds structures[] = {
+    { "linked_list", ll_bench_create, ll_bench_destroy, ll_bench_insert,
+      ll_bench_delete, ll_bench_contains },
+    { "skiplist", sl_bench_create, sl_bench_destroy, sl_bench_insert,
+      sl_bench_delete, sl_bench_contains },
+    { "hashset", hs_bench_create, hs_bench_destroy, hs_bench_insert,
+      hs_bench_delete, hs_bench_contains },
+};
+#define NSTRUCTURES (sizeof(structures) / sizeof(structures[0]))
+
+static struct ds *current_ds;
+static size_t ops_per_thread;
+static volatile uintptr_t threads_ready;
+static volatile bool go;
+static cycles_t thread_cycles[MAX_COREID];
+
+static int bench_thread(void *arg)
+{
+    int id = (int) (uintptr_t) arg;
+    uint32_t seed = (id + 1) * 2654435761U;
+
+    __sync_fetch_and_add(&threads_ready, 1);
+    while (!go) {
+        // wait for the other threads
+    }
+
+    cycles_t start = bench_tsc();
+    for (size_t i = 0; i < ops_per_thread; i++) {
+        seed = seed * 1103515245 + 12345;
+        void *key = (void *) (uintptr_t) ((seed >> 8) % KEY_RANGE + 1);
+        uint32_t op = (seed >> 4) % 10;
+        if (op == 0) {
+            current_ds->insert(key);
+        } else if (op == 1) {
+            current_ds->delete(key);
+        } else {
+            current_ds->contains(key);
+        }
+    }
+    thread_cycles[id] = bench_time_diff(start, bench_tsc());
+
+    epoch_unregister();
+    return 0;
+}
+
+static void run_bench(struct ds *ds, int nthreads)
+{
+    errval_t err;
+    struct thread *threads[MAX_COREID];
+    coreid_t my_core = disp_get_core_id();
+
+    current_ds = ds;
+    ds->create();
+    // fill half of the key range
+    for (uintptr_t key = 1; key <= KEY_RANGE; key += 2) {
+        ds->insert((void *) key);
+    }
+
+    threads_ready = 0;
+    go = false;
+    for (int i = 1; i < nthreads; i++) {
+        err = domain_thread_create_on(my_core + i, bench_thread,
+                                      (void *) (uintptr_t) i, &threads[i]);
+        if (err_is_fail(err)) {
+            USER_PANIC_ERR(err, "domain_thread_create_on failed");
+        }
+    }
+    while (threads_ready < (uintptr_t) nthreads - 1) {
+        thread_yield();
+    }
+    go = true;
+    bench_thread((void *) 0);
+
+    cycles_t max_cycles = thread_cycles[0];
+    for (int i = 1; i < nthreads; i++) {
+        err = domain_thread_join(threads[i], NULL);
+        if (err_is_fail(err)) {
+            USER_PANIC_ERR(err, "domain_thread_join failed");
+        }
+        if (thread_cycles[i] > max_cycles) {
+            max_cycles = thread_cycles[i];
+        }
+    }
+
+    uint64_t us = bench_tsc_to_us(max_cycles);
+    uint64_t total_ops = (uint64_t) ops_per_thread * nthreads;
+    printf("%-12s cores %2d: %8"PRIu64" kops/s, %6"PRIuCYCLES" cycles/op\n",
+           ds->name, nthreads, us > 0 ? total_ops * 1000 / us : 0,
+           max_cycles / ops_per_thread);
+
+    ds->destroy();
+}
+
+static int ndispatchers = 1;
+
+static void domain_spanned_callback(void *arg, errval_t err)
+{
+    if (err_is_fail(err)) {
+        USER_PANIC_ERR(err, "spanning domain failed");
+    }
+    ndispatchers++;
+}
+
+static void scalability(int cores)
+{
+    errval_t err;
+
+    for (int i = 1; i < cores; i++) {
+        err = domain_new_dispatcher(i + disp_get_core_id(),
+                                    domain_spanned_callback,
+                                    (void *) (uintptr_t) i);
+        if (err_is_fail(err)) {
+            USER_PANIC_ERR(err, "domain_new_dispatcher failed");
+        }
+    }
+    while (ndispatchers < cores) {
+        thread_yield();
+    }
+
+    bench_init();
+    for (size_t s = 0; s < NSTRUCTURES; s++) {
+        for (int n = 1; n <= cores; n++) {
+            run_bench(&structures[s], n);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    /// cas test
+    uint64_t location = 10;
+    uint64_t res = cas(&location, 10, 20);
+    printf("cas: %ld, %ld\n", res, location);
+
+    /// functional tests
+    test_linked_list();
+    test_skiplist();
+    test_hashset();
+
+    /// scalability
+    if (argc > 1) {
+        int cores = strtol(argv[1], NULL, 10);
+        ops_per_thread = DEFAULT_OPS;
+        if (argc > 2) {
+            ops_per_thread = strtoul(argv[2], NULL, 10);
+        }
+        if (cores < 1 || cores > MAX_COREID || ops_per_thread == 0) {
+            printf("Usage: %s [cores [ops]]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        scalability(cores);
+    }
+
+    printf("testconcurrent done.\n");
+    return EXIT_SUCCESS;
+}
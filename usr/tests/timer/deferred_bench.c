@@ -0,0 +1,156 @@
+/**
+ * \file
+ * \brief Deferred event (timer) benchmark
+ *
+ * Arms and cancels large numbers of deferred events to measure the cost of
+ * deferred_event_register() and deferred_event_cancel() with many timers
+ * live, then lets a set of timers spread over a short window fire and reports
+ * how late they were dispatched.
+ *
+ * Usage: deferred_bench [max_timers]
+ */
+
+/*
+ * Copyright (c) 2026, ETH Zurich.
+ * All rights reserved.
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ * If you do not find this file, copies can be found by writing to:
+ * ETH Zurich D-INFK, Universitaetstrasse 6, CH-8092 Zurich. Attn: Systems Group.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <barrelfish/barrelfish.h>
+#include <barrelfish/deferred.h>
+#include <barrelfish/systime.h>
+
+#include <bench/bench.h>
+
+#define DEFAULT_MAX_TIMERS 100000
+
+// timers armed for the cost measurement never fire during the benchmark
+#define ARM_MIN_DELAY_US   (10 * 1000 * 1000)
+#define ARM_SPREAD_US      (10 * 1000 * 1000)
+
+// timers of the jitter measurement fire within this window
+#define FIRE_SPREAD_US     (200 * 1000)
+
+static struct deferred_event *events;
+static delayus_t *delays;
+static size_t fired;
+static uint64_t late_sum, late_max;
+
+static void nop_handler(void *arg)
+{
+    USER_PANIC("timer fired during arm/cancel measurement");
+}
+
+static void fire_handler(void *arg)
+{
+    struct deferred_event *e = arg;
+    uint64_t late = systime_to_us(systime_now() - e->time);
+    late_sum += late;
+    if (late > late_max) {
+        late_max = late;
+    }
+    fired++;
+}
+
+static void measure_arm_cancel(size_t n)
+{
+    struct waitset *ws = get_default_waitset();
+    cycles_t start, end;
+    errval_t err;
+
+    for (size_t i = 0; i < n; i++) {
+        delays[i] = ARM_MIN_DELAY_US + rand() % ARM_SPREAD_US;
+        deferred_event_init(&events[i]);
+    }
+
+    start = bench_tsc();
+    for (size_t i = 0; i < n; i++) {
+        err = deferred_event_register(&events[i], ws, delays[i],
+                                      MKCLOSURE(nop_handler, NULL));
+        if (err_is_fail(err)) {
+            USER_PANIC_ERR(err, "deferred_event_register");
+        }
+    }
+    end = bench_tsc();
+    printf("timers=%-7zu arm    %6"PRIuCYCLES" cycles/op\n", n,
+           bench_time_diff(start, end) / n);
+
+    // cancel in a different order than armed
+    start = bench_tsc();
+    for (size_t i = 0; i < n; i++) {
+        size_t idx = (i * 7919) % n;
+        err = deferred_event_cancel(&events[idx]);
+        if (err_is_fail(err)) {
+            USER_PANIC_ERR(err, "deferred_event_cancel");
+        }
+    }
+    end = bench_tsc();
+    printf("timers=%-7zu cancel %6"PRIuCYCLES" cycles/op\n", n,
+           bench_time_diff(start, end) / n);
+}
+
+static void measure_jitter(size_t n)
+{
+    struct waitset *ws = get_default_waitset();
+    errval_t err;
+
+    fired = 0;
+    late_sum = late_max = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        deferred_event_init(&events[i]);
+        err = deferred_event_register(&events[i], ws, rand() % FIRE_SPREAD_US,
+                                      MKCLOSURE(fire_handler, &events[i]));
+        if (err_is_fail(err)) {
+            USER_PANIC_ERR(err, "deferred_event_register");
+        }
+    }
+
+    while (fired < n) {
+        err = event_dispatch(ws);
+        if (err_is_fail(err)) {
+            USER_PANIC_ERR(err, "event_dispatch");
+        }
+    }
+
+    printf("timers=%-7zu fired late avg %"PRIu64" us, max %"PRIu64" us\n", n,
+           late_sum / n, late_max);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t max_timers = DEFAULT_MAX_TIMERS;
+
+    if (argc > 1) {
+        max_timers = strtoul(argv[1], NULL, 0);
+    }
+    if (max_timers < 10000) {
+        printf("Usage: %s [max_timers >= 10000]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    bench_init();
+
+    events = malloc(max_timers * sizeof(*events));
+    delays = malloc(max_timers * sizeof(*delays));
+    if (events == NULL || delays == NULL) {
+        USER_PANIC("no memory for %zu timers", max_timers);
+    }
+
+    srand(42);
+    for (size_t n = 10000; n <= max_timers; n *= 10) {
+        measure_arm_cancel(n);
+        measure_jitter(n);
+    }
+
+    free(events);
+    free(delays);
+
+    printf("deferred_bench done.\n");
+    return EXIT_SUCCESS;
+}